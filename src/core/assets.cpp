@@ -0,0 +1,323 @@
+#include "assets.h"
+
+#include "neonengine.h"
+
+#include <ace/managers/log.h>
+#include <ace/managers/memory.h>
+#include <ace/managers/system.h>
+
+#include <string.h>
+
+#include <mtl/hash.h>
+#include <mtl/memory.h>
+
+#include "core/vfs.h"
+
+namespace NEONengine
+{
+    enum class AssetType : UBYTE
+    {
+        FONT,
+        BITMAP,
+        PALETTE,
+        MOD,
+    };
+
+    struct AssetEntry
+    {
+        void *pAsset;  // NULL if the entry is free
+        AssetType eType;
+        UBYTE ubFlags;
+        UWORD uwRefs;
+        ULONG ulHash;
+        ULONG ulLastUse;  // When the last reference was dropped
+        ULONG ulChipSize;
+        ULONG ulFastSize;
+        char szPath[ASSETS_PATH_LENGTH];
+    };
+
+    static AssetEntry s_entries[ASSETS_MAX_ENTRIES];
+    static ULONG s_ulChipBudget;
+    static ULONG s_ulFastBudget;
+    static ULONG s_ulCachedChip;  // Of the assets nothing references
+    static ULONG s_ulCachedFast;
+    static ULONG s_ulClock;
+
+    /* Internal function. */
+    static ULONG assetsBitmapSize(tBitMap const *pBitMap)
+    {
+        return bitmapGetByteWidth(pBitMap) * pBitMap->Rows * pBitMap->Depth;
+    }
+
+    /* Internal function. Size of a file, 0 if it can't be opened. */
+    static ULONG assetsFileSize(char const *szFilePath)
+    {
+        tFile *pFile = vfsOpen(szFilePath);
+        if (!pFile) { return 0; }
+
+        LONG lSize = fileGetSize(pFile);
+        fileClose(pFile);
+        return lSize > 0 ? (ULONG)lSize : 0;
+    }
+
+    /* Internal function. Frees the asset and the entry. */
+    static void assetsFree(AssetEntry *pEntry)
+    {
+        if (!pEntry->uwRefs)
+        {
+            s_ulCachedChip -= pEntry->ulChipSize;
+            s_ulCachedFast -= pEntry->ulFastSize;
+        }
+
+        systemUse();
+        switch (pEntry->eType)
+        {
+            case AssetType::FONT: fontDestroy((tFont *)pEntry->pAsset); break;
+            case AssetType::BITMAP: bitmapDestroy((tBitMap *)pEntry->pAsset); break;
+            case AssetType::PALETTE: memFree(pEntry->pAsset, pEntry->ulFastSize); break;
+            case AssetType::MOD: ptplayerModDestroy((tPtplayerMod *)pEntry->pAsset); break;
+        }
+        systemUnuse();
+
+        *pEntry = {};
+    }
+
+    /*
+     * Internal function. Frees the unreferenced asset that was released
+     * longest ago, of those using the given memory if ubChip/ubFast is set.
+     * Returns how many bytes it used, 0 if there is none.
+     */
+    static ULONG assetsEvict(UBYTE ubChip, UBYTE ubFast)
+    {
+        AssetEntry *pOldest = NULL;
+        for (AssetEntry &entry : s_entries)
+        {
+            if (!entry.pAsset || entry.uwRefs) { continue; }
+            if ((ubChip && !entry.ulChipSize) || (ubFast && !entry.ulFastSize)) { continue; }
+            if (!pOldest || entry.ulLastUse < pOldest->ulLastUse) { pOldest = &entry; }
+        }
+        if (!pOldest) { return 0; }
+
+        // Counts as one byte at least, so every eviction reports progress
+        ULONG ulSize = pOldest->ulChipSize + pOldest->ulFastSize;
+        assetsFree(pOldest);
+        return ulSize ? ulSize : 1;
+    }
+
+    /*
+     * Internal function. Frees released assets when an allocation fails, see
+     * mtl::add_purger(). Only Chip memory helps a Chip allocation.
+     */
+    static size_t assetsPurge(size_t bytes, ULONG memFlags)
+    {
+        UBYTE ubChip = (memFlags & MEMF_CHIP) != 0;
+        size_t freed = 0;
+        ULONG ulEvicted;
+        while (freed < bytes && (ulEvicted = assetsEvict(ubChip, 0))) { freed += ulEvicted; }
+        return freed;
+    }
+
+    /* Internal function. Evicts until the released assets fit the budgets. */
+    static void assetsTrim(void)
+    {
+        while (s_ulCachedChip > s_ulChipBudget && assetsEvict(1, 0)) {}
+        while (s_ulCachedFast > s_ulFastBudget && assetsEvict(0, 1)) {}
+    }
+
+    /* Internal function. Adds a reference to a loaded asset, NULL if not loaded. */
+    static void *assetsFind(AssetType eType, char const *szFilePath, UBYTE ubFlags, ULONG ulHash)
+    {
+        for (AssetEntry &entry : s_entries)
+        {
+            if (entry.pAsset && entry.ulHash == ulHash && entry.eType == eType
+                && entry.ubFlags == ubFlags && strcmp(entry.szPath, szFilePath) == 0)
+            {
+                if (!entry.uwRefs++)
+                {
+                    s_ulCachedChip -= entry.ulChipSize;
+                    s_ulCachedFast -= entry.ulFastSize;
+                }
+                return entry.pAsset;
+            }
+        }
+        return NULL;
+    }
+
+    /* Internal function. A free entry, evicting the oldest released asset if needed. */
+    static AssetEntry *assetsFreeEntry(void)
+    {
+        do
+        {
+            for (AssetEntry &entry : s_entries)
+            {
+                if (!entry.pAsset) { return &entry; }
+            }
+        } while (assetsEvict(0, 0));
+
+        return NULL;
+    }
+
+    /* Internal function. Shared by all the assetsGet functions. */
+    static void *assetsGet(AssetType eType, char const *szFilePath, UBYTE ubFlags)
+    {
+        if (!szFilePath) { return NULL; }
+
+        size_t length = strlen(szFilePath);
+        if (length >= ASSETS_PATH_LENGTH)
+        {
+            NE_LOG("Assets: path too long '%s'", szFilePath);
+            return NULL;
+        }
+
+        ULONG ulHash = mtl::hash_bytes(szFilePath, length);
+        void *pAsset = assetsFind(eType, szFilePath, ubFlags, ulHash);
+        if (pAsset) { return pAsset; }
+
+        AssetEntry *pEntry = assetsFreeEntry();
+        if (!pEntry)
+        {
+            NE_LOG("Assets: no free entry, '%s' not loaded", szFilePath);
+            return NULL;
+        }
+
+        ULONG ulChipSize = 0;
+        ULONG ulFastSize = 0;
+        systemUse();
+        switch (eType)
+        {
+            case AssetType::FONT:
+            {
+                tFont *pFont = vfsFontCreate(szFilePath);
+                if (pFont)
+                {
+                    ulChipSize = assetsBitmapSize(pFont->pRawData);
+                    ulFastSize = sizeof(tFont) + pFont->ubChars * sizeof(UWORD);
+                }
+                pAsset = pFont;
+                break;
+            }
+
+            case AssetType::BITMAP:
+            {
+                tBitMap *pBitMap = vfsBitmapCreate(szFilePath, ubFlags);
+                if (pBitMap)
+                {
+                    ULONG ulSize = assetsBitmapSize(pBitMap);
+                    if (bitmapIsChip(pBitMap)) { ulChipSize = ulSize; }
+                    else { ulFastSize = ulSize; }
+                }
+                pAsset = pBitMap;
+                break;
+            }
+
+            case AssetType::PALETTE:
+                ulFastSize = ASSETS_PALETTE_LENGTH * sizeof(UWORD);
+                pAsset     = memAllocFastClear(ulFastSize);
+                if (pAsset
+                    && !vfsPaletteLoad(szFilePath, (UWORD *)pAsset, ASSETS_PALETTE_LENGTH - 1))
+                {
+                    memFree(pAsset, ulFastSize);
+                    pAsset = NULL;
+                }
+                break;
+
+            case AssetType::MOD:
+                // The samples are most of a module, and go to Chip memory
+                ulChipSize = assetsFileSize(szFilePath);
+                pAsset     = vfsModCreate(szFilePath);
+                break;
+        }
+        systemUnuse();
+
+        if (!pAsset)
+        {
+            NE_LOG("Assets: could not load '%s'", szFilePath);
+            return NULL;
+        }
+
+        pEntry->pAsset     = pAsset;
+        pEntry->eType      = eType;
+        pEntry->ubFlags    = ubFlags;
+        pEntry->uwRefs     = 1;
+        pEntry->ulHash     = ulHash;
+        pEntry->ulChipSize = ulChipSize;
+        pEntry->ulFastSize = ulFastSize;
+        memcpy(pEntry->szPath, szFilePath, length + 1);
+        return pAsset;
+    }
+
+    void assetsCreate(ULONG ulChipBudget, ULONG ulFastBudget)
+    {
+        s_ulChipBudget = ulChipBudget;
+        s_ulFastBudget = ulFastBudget;
+        s_ulCachedChip = 0;
+        s_ulCachedFast = 0;
+        s_ulClock      = 0;
+        for (AssetEntry &entry : s_entries) { entry = {}; }
+
+        mtl::add_purger(assetsPurge, ASSETS_PURGE_PRIORITY);
+    }
+
+    void assetsDestroy(void)
+    {
+        mtl::remove_purger(assetsPurge);
+        for (AssetEntry &entry : s_entries)
+        {
+            if (!entry.pAsset) { continue; }
+            if (entry.uwRefs)
+            {
+                NE_LOG("Assets: '%s' still has %d references", entry.szPath, entry.uwRefs);
+            }
+            assetsFree(&entry);
+        }
+    }
+
+    tFont *assetsGetFont(char const *szFilePath)
+    {
+        return (tFont *)assetsGet(AssetType::FONT, szFilePath, 0);
+    }
+
+    tBitMap *assetsGetBitmap(char const *szFilePath, UBYTE ubFlags)
+    {
+        return (tBitMap *)assetsGet(AssetType::BITMAP, szFilePath, ubFlags);
+    }
+
+    UWORD *assetsGetPalette(char const *szFilePath)
+    {
+        return (UWORD *)assetsGet(AssetType::PALETTE, szFilePath, 0);
+    }
+
+    tPtplayerMod *assetsGetMod(char const *szFilePath)
+    {
+        return (tPtplayerMod *)assetsGet(AssetType::MOD, szFilePath, 0);
+    }
+
+    UBYTE assetsLoadPalette(char const *szFilePath, UWORD *pPalette, UBYTE ubColorCount)
+    {
+        UWORD *pColors = assetsGetPalette(szFilePath);
+        if (!pColors) { return 0; }
+
+        memcpy(pPalette, pColors, ubColorCount * sizeof(UWORD));
+        assetsRelease(pColors);
+        return 1;
+    }
+
+    void assetsRelease(void const *pAsset)
+    {
+        if (!pAsset) { return; }
+
+        for (AssetEntry &entry : s_entries)
+        {
+            if (entry.pAsset != pAsset || !entry.uwRefs) { continue; }
+
+            if (!--entry.uwRefs)
+            {
+                entry.ulLastUse = ++s_ulClock;
+                s_ulCachedChip += entry.ulChipSize;
+                s_ulCachedFast += entry.ulFastSize;
+                assetsTrim();
+            }
+            return;
+        }
+    }
+}  // namespace NEONengine
@@ -0,0 +1,106 @@
+#ifndef __ASSETS_H__INCLUDED__
+#define __ASSETS_H__INCLUDED__
+
+#include <ace/managers/ptplayer.h>
+#include <ace/utils/bitmap.h>
+#include <ace/utils/font.h>
+
+#include <mtl/memory.h>
+
+namespace NEONengine
+{
+    /**
+     * @brief Most assets loaded or cached at once.
+     */
+#define ASSETS_MAX_ENTRIES 32
+
+    /**
+     * @brief Longest path an asset can be loaded from, including the
+     * terminator.
+     */
+#define ASSETS_PATH_LENGTH 48
+
+    /**
+     * @brief Colors kept for each palette.
+     */
+#define ASSETS_PALETTE_LENGTH 256
+
+    /**
+     * @brief Default sizes of the cache of released assets.
+     *
+     * @see assetsCreate()
+     */
+#define ASSETS_CHIP_BUDGET (64 * 1024)
+#define ASSETS_FAST_BUDGET (32 * 1024)
+
+    /**
+     * @brief When released assets are freed on an allocation failure, see
+     * mtl::add_purger(). After the prefetcher's, which may never be used.
+     */
+#define ASSETS_PURGE_PRIORITY 64
+
+    /**
+     * @brief Sets up the asset manager.
+     *
+     * Assets are loaded once per path and shared: every assetsGet call adds
+     * a reference and every assetsRelease() removes one. Released assets
+     * stay in memory until the ones released longest ago no longer fit the
+     * budgets, or an allocation fails for lack of memory, so getting them
+     * again does not touch the disk.
+     *
+     * @param ulChipBudget Most bytes of Chip memory released assets keep.
+     * @param ulFastBudget Most bytes of Fast memory released assets keep.
+     *
+     * @see assetsDestroy()
+     */
+    void assetsCreate(ULONG ulChipBudget = ASSETS_CHIP_BUDGET,
+                      ULONG ulFastBudget = ASSETS_FAST_BUDGET);
+
+    /**
+     * @brief Frees every asset, including those still referenced, which are
+     * logged. Releasing them afterwards does nothing.
+     *
+     * @see assetsCreate()
+     */
+    void assetsDestroy(void);
+
+    /**
+     * @brief Get a shared asset, loading it if it is not in memory.
+     *
+     * @return The asset, or NULL if it could not be loaded. Each call must be
+     * matched by an assetsRelease().
+     */
+    tFont *assetsGetFont(char const *szFilePath);
+    tBitMap *assetsGetBitmap(char const *szFilePath, UBYTE ubFlags);
+    UWORD *assetsGetPalette(char const *szFilePath);
+    tPtplayerMod *assetsGetMod(char const *szFilePath);
+
+    /**
+     * @brief Same as vfsPaletteLoad(), with the palette shared and
+     * cached like any other asset.
+     *
+     * @return UBYTE 1 if the palette was copied, 0 if it could not be loaded.
+     */
+    UBYTE assetsLoadPalette(char const *szFilePath, UWORD *pPalette, UBYTE ubColorCount);
+
+    /**
+     * @brief Drops a reference to an asset returned by an assetsGet function.
+     * Does nothing for NULL.
+     */
+    void assetsRelease(void const *pAsset);
+
+    /* Internal function. Releases the asset held by a handle. */
+    template<class T>
+    inline void assetsReleaseHandle(T *pAsset)
+    {
+        assetsRelease(pAsset);
+    }
+
+    /**
+     * @brief Handles holding one reference each.
+     */
+    using font_handle   = mtl::unique_ptr<tFont, assetsReleaseHandle<tFont>>;
+    using bitmap_handle = mtl::unique_ptr<tBitMap, assetsReleaseHandle<tBitMap>>;
+}  // namespace NEONengine
+
+#endif  //__ASSETS_H__INCLUDED__
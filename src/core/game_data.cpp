@@ -4,9 +4,17 @@
 
 #include <ace/managers/log.h>
 #include <ace/managers/system.h>
-#include <ace/utils/disk_file.h>
+#include <ace/managers/timer.h>
+#include <ace/utils/file.h>
 
+#include <stddef.h>
+
+#include "core/game_flags.h"
+#include "core/script.h"
+#include "core/vfs.h"
+#include "mtl/alloc_stats.h"
 #include "mtl/memory.h"
+#include "utils/lz.h"
 
 namespace NEONengine
 {
@@ -33,6 +41,20 @@ namespace NEONengine
     char const dataFileMagic[4] = { 'N', 'E', 'O', 'N' };
 
 #define GDL_SUPPORTED_VERSION 0x00020000
+#define GDL_TOC_VERSION 0x00030000
+
+// Most chunks a version 3 directory can list
+#define GDL_MAX_CHUNKS 16
+
+// Chunks a version 3 file loads one Location at a time
+#define GDL_SLOT_SCENES 0
+#define GDL_SLOT_INTERACTIONS 1
+#define GDL_SLOT_TEXT_REGIONS 2
+#define GDL_SLOT_SHAPES 3
+#define GDL_SLOT_COUNT 4
+#define GDL_SLOT_NONE 0xFF
+
+#define GDL_NO_LOCATION 0xFFFF
 
 #define GDL_CHUNK_NAME(a, b, c, d) (a << 24) | (b << 16) | (c << 8) | d
 
@@ -46,32 +68,291 @@ namespace NEONengine
         return (error);                                            \
     }
 
+    /*
+     * Where a chunk is loaded to: the GameData pointer, the count it fills in
+     * and the size of one entry.
+     */
+    typedef struct _GameDataChunk
+    {
+        ULONG ulName;
+        char const *szName;
+        UWORD uwDataOffset;
+        UWORD uwCountOffset;
+        ULONG ulEntrySize;
+        UBYTE ubSlot;
+    } GameDataChunk;
+
+#define GDL_CHUNK(a, b, c, d, szName, data, count, size, slot)                          \
+    {                                                                                   \
+        GDL_CHUNK_NAME(a, b, c, d), szName, offsetof(GameData, data),                   \
+            offsetof(GameDataCounts, count), size, slot                                 \
+    }
+
+    static GameDataChunk const s_chunks[] = {
+        GDL_CHUNK('L', 'O', 'C', 'S',
+                  "Locations",
+                  pLocations,
+                  ulLocationCount,
+                  sizeof(Location),
+                  GDL_SLOT_NONE),
+        GDL_CHUNK('S', 'C', 'N', 'S',
+                  "Scenes",
+                  pScenes,
+                  ulSceneCount,
+                  sizeof(Scene),
+                  GDL_SLOT_SCENES),
+        GDL_CHUNK('R', 'G', 'N', 'S',
+                  "Interactions",
+                  pIteractables,
+                  ulInteractableCount,
+                  sizeof(Interaction),
+                  GDL_SLOT_INTERACTIONS),
+        GDL_CHUNK('T', 'E', 'X', 'T',
+                  "TextRegions",
+                  pTextRegions,
+                  ulTextRegionCount,
+                  sizeof(TextRegion),
+                  GDL_SLOT_TEXT_REGIONS),
+        GDL_CHUNK('D', 'L', 'G', 'S',
+                  "Dialogues",
+                  pDialogues,
+                  ulDialogueCount,
+                  sizeof(Dialogue),
+                  GDL_SLOT_NONE),
+        GDL_CHUNK('P', 'A', 'G', 'E',
+                  "Dialogue Pages",
+                  pDialoguePages,
+                  ulDialoguePageCount,
+                  sizeof(DialoguePage),
+                  GDL_SLOT_NONE),
+        GDL_CHUNK('C', 'H', 'C', 'E',
+                  "Dialogue Choices",
+                  pDialogueChoices,
+                  ulDialogueChoiceCount,
+                  sizeof(DialogueChoice),
+                  GDL_SLOT_NONE),
+        GDL_CHUNK('B', 'Y', 'T', 'E',
+                  "Bytecode",
+                  puwScriptData,
+                  ulScriptDataSize,
+                  sizeof(UWORD),
+                  GDL_SLOT_NONE),
+        GDL_CHUNK('S', 'H', 'P', 'E',
+                  "Shapes",
+                  pShapes,
+                  ulShapeCount,
+                  sizeof(Shape),
+                  GDL_SLOT_SHAPES),
+        GDL_CHUNK('P', 'A', 'L', 'S',
+                  "Shape Palettes",
+                  pPalettes,
+                  ulPaletteCount,
+                  sizeof(PaletteEntry) * 32 /* Number of colors per palette*/,
+                  GDL_SLOT_NONE),
+        GDL_CHUNK('P', 'A', 'L', 'U',
+                  "UI Palette",
+                  pUiPalette,
+                  ulUiPaletteSize,
+                  sizeof(PaletteEntry),
+                  GDL_SLOT_NONE),
+    };
+
+    static void **gameDataChunkData(GameDataChunk const *pChunk)
+    {
+        return (void **)((UBYTE *)g_pGameData + pChunk->uwDataOffset);
+    }
+
+    static ULONG *gameDataChunkCount(GameDataChunk const *pChunk)
+    {
+        return (ULONG *)((UBYTE *)s_pGameDataCounts + pChunk->uwCountOffset);
+    }
+
+    // Set when the data was loaded as one image, GameData and the counts live in it
+    static UBYTE *s_pImage;
+    static ULONG s_ulImageSize;
+
+    /*
+     * Entry of the chunk directory of a version 3 file.
+     */
+    typedef struct _GameDataTocEntry
+    {
+        ULONG ulName;
+        ULONG ulCount;
+        ULONG ulOffset;      // From the start of the file
+        ULONG ulPackedSize;  // Size of the LZ stream, 0 if the chunk is stored
+    } GameDataTocEntry;
+
+    /*
+     * A chunk loaded one Location at a time: where it is in the file and the
+     * first id of the slice in memory.
+     */
+    typedef struct _GameDataSlot
+    {
+        GameDataChunk const *pChunk;
+        ULONG ulFileOffset;
+        ULONG ulFileCount;
+        UWORD uwFirstId;
+    } GameDataSlot;
+
+    // Only used for version 3 files, which stay open to load locations from
+    static tFile *s_pFile;
+    static GameDataSlot s_slots[GDL_SLOT_COUNT];
+    static Range *s_pLocationRanges;  // Interactions and text regions of each location
+    static UBYTE *s_pLocationData;
+    static ULONG s_ulLocationDataSize;
+    static UWORD s_uwLocationId = GDL_NO_LOCATION;
+
     GameDataResult gameDataLoadChunk(tFile *pFile,
                                      const char *szChunkName,
                                      void **pChunkData,
                                      ULONG *pulCount,
                                      ULONG size);
 
-    GameDataResult gameDataLoad(char const *szFilePath)
+    GameDataResult gameDataLoadChunks(tFile *pFile);
+    GameDataResult gameDataLoadImage(tFile *pFile);
+    GameDataResult gameDataLoadToc(tFile *pFile);
+    static GameDataResult gameDataCheckHeader(ULONG ulMagic, ULONG ulVersion);
+    static void gameDataEvictLocation();
+
+    ULONG gameDataFlagCount();
+
+    GameDataResult gameDataLoad(char const *szFilePath, GameDataLoadMode eMode)
     {
         logBlockBegin("gameDataLoad: %s", szFilePath);
         systemUse();
 
-        auto result = GameDataResult::SUCCESS;
+        ULONG ulStart = timerGetPrec();
 
         // Get rid of any existing game data
         if (g_pGameData) gameDataDestroy();
 
-        tFile *pFile = diskFileOpen(szFilePath, DISK_FILE_MODE_READ, 0);
+        tFile *pFile = vfsOpen(szFilePath);
         GDL_VERIFY(pFile, GameDataResult::FILE_NOT_FOUND);
 
+        auto tag = alloc_tag_scope(alloc_tag::GameData);
+
         // Read in the header and verify it's a valid file
-        ULONG ulMagic, ulVersion;
+        ULONG ulMagic = 0, ulVersion = 0;
         fileRead(pFile, &ulMagic, sizeof(ULONG));
         fileRead(pFile, &ulVersion, sizeof(ULONG));
 
-        GDL_VERIFY(ulMagic == *(ULONG *)dataFileMagic, GameDataResult::NOT_NEON_FILE);
-        GDL_VERIFY(ulVersion == GDL_SUPPORTED_VERSION, GameDataResult::VERSION_NOT_SUPPORTED);
+        auto result = gameDataCheckHeader(ulMagic, ulVersion);
+        if (result == GameDataResult::SUCCESS)
+        {
+            if (ulVersion == GDL_TOC_VERSION) result = gameDataLoadToc(pFile);
+            else if (eMode == GameDataLoadMode::IMAGE) result = gameDataLoadImage(pFile);
+            else result = gameDataLoadChunks(pFile);
+        }
+
+        // A version 3 file stays open for gameDataLoadLocation(), once it loaded
+        if (result != GameDataResult::SUCCESS) s_pFile = NULL;
+        if (pFile != s_pFile) fileClose(pFile);
+
+        GDL_VERIFY(result == GameDataResult::SUCCESS, result);
+        ULONG ulScriptFlagCount = 0;
+        GDL_VERIFY(scriptLoad(g_pGameData->puwScriptData,
+                              s_pGameDataCounts->ulScriptDataSize,
+                              &ulScriptFlagCount),
+                   GameDataResult::CORRUPTED_FILE);
+        GDL_VERIFY(gameFlagsReserve(MAX(gameDataFlagCount(), ulScriptFlagCount)),
+                   GameDataResult::OUT_OF_MEMORY);
+
+        char szTime[16];
+        timerFormatPrec(szTime, timerGetDelta(ulStart, timerGetPrec()));
+        char const *szHow = eMode == GameDataLoadMode::IMAGE ? "as one image" : "chunk by chunk";
+        if (s_pFile) szHow = "the directory";
+        logWrite("Loaded %s in %s", szHow, szTime);
+
+        systemUnuse();
+        logBlockEnd("gameDataLoad");
+
+        return result;
+    }
+
+    void gameDataDestroy()
+    {
+        logBlockBegin("gameDataDestroy");
+
+        if (!g_pGameData) return;
+
+        scriptUnload();
+        gameDataEvictLocation();
+
+        if (s_pFile)
+        {
+            systemUse();
+            fileClose(s_pFile);
+            systemUnuse();
+            s_pFile = NULL;
+        }
+
+        for (GameDataSlot &slot : s_slots) { slot = GameDataSlot(); }
+        s_pLocationRanges = NULL;
+
+        if (s_pImage)
+        {
+            // GameData, the counts and every chunk are in the image
+            memFree(s_pImage, s_ulImageSize);
+            s_pImage      = NULL;
+            s_ulImageSize = 0;
+        }
+        else
+        {
+            // Free individual resources
+            for (GameDataChunk const &chunk : s_chunks)
+            {
+                void *pData = *gameDataChunkData(&chunk);
+                if (pData) memFree(pData, *gameDataChunkCount(&chunk) * chunk.ulEntrySize);
+            }
+
+            // Free the data container (allocated through operator new, not memAlloc)
+            delete g_pGameData;
+            delete s_pGameDataCounts;
+        }
+
+        g_pGameData       = NULL;
+        s_pGameDataCounts = NULL;
+
+        logBlockEnd("gameDataDestroy");
+    }
+
+    /*
+     * Internal function.
+     * Chunk description for a chunk name, or NULL if the name is unknown.
+     */
+    static GameDataChunk const *gameDataFindChunk(ULONG ulName)
+    {
+        for (GameDataChunk const &chunk : s_chunks)
+        {
+            if (chunk.ulName == ulName) return &chunk;
+        }
+
+        logWrite("Unknown chunk '%.4s'", (char *)&ulName);
+        return NULL;
+    }
+
+    /*
+     * Internal function.
+     * Checks the magic and version at the start of the file.
+     */
+    static GameDataResult gameDataCheckHeader(ULONG ulMagic, ULONG ulVersion)
+    {
+        if (ulMagic != *(ULONG *)dataFileMagic) return GameDataResult::NOT_NEON_FILE;
+        if (ulVersion != GDL_SUPPORTED_VERSION && ulVersion != GDL_TOC_VERSION)
+        {
+            return GameDataResult::VERSION_NOT_SUPPORTED;
+        }
+
+        return GameDataResult::SUCCESS;
+    }
+
+    /*
+     * Internal function.
+     * Loads the file one chunk at a time, with a read and an allocation each.
+     */
+    GameDataResult gameDataLoadChunks(tFile *pFile)
+    {
+        GameDataResult result;
 
         g_pGameData       = new (MemF::Fast | MemF::Clear) GameData();
         s_pGameDataCounts = new (MemF::Fast | MemF::Clear) GameDataCounts();
@@ -80,147 +361,411 @@ namespace NEONengine
         while (!fileIsEof(pFile))
         {
             ULONG ulChunkHeader;
-            GameDataResult chunkResult = GameDataResult::SUCCESS;
-
             fileRead(pFile, &ulChunkHeader, sizeof(ULONG));
 
-            switch (ulChunkHeader)
+            GameDataChunk const *pChunk = gameDataFindChunk(ulChunkHeader);
+            if (!pChunk) continue;
+
+            result = gameDataLoadChunk(pFile,
+                                       pChunk->szName,
+                                       gameDataChunkData(pChunk),
+                                       gameDataChunkCount(pChunk),
+                                       pChunk->ulEntrySize);
+            if (result != GameDataResult::SUCCESS) return result;
+        }
+
+        return GameDataResult::SUCCESS;
+    }
+
+    /*
+     * Internal function.
+     * Reads the rest of the file into one Fast block, after GameData and the
+     * counts, and points GameData at the chunks inside it. The structs are
+     * stored as they are laid out in memory, so nothing needs converting.
+     */
+    GameDataResult gameDataLoadImage(tFile *pFile)
+    {
+        // The header was read already
+        LONG lFileSize = fileGetSize(pFile) - 2 * sizeof(ULONG);
+        if (lFileSize < 0) return GameDataResult::CORRUPTED_FILE;
+
+        ULONG ulHeadSize = sizeof(GameData) + sizeof(GameDataCounts);
+        s_ulImageSize    = ulHeadSize + lFileSize;
+        s_pImage         = (UBYTE *)memAllocFast(s_ulImageSize);
+        if (!s_pImage) return GameDataResult::OUT_OF_MEMORY;
+
+        g_pGameData       = new (s_pImage) GameData();
+        s_pGameDataCounts = new (s_pImage + sizeof(GameData)) GameDataCounts();
+
+        UBYTE *pFileData = s_pImage + ulHeadSize;
+        if (fileRead(pFile, pFileData, lFileSize) != (ULONG)lFileSize)
+        {
+            return GameDataResult::GENERIC_READ_ERROR;
+        }
+
+        // Every chunk size is a multiple of two, so the payloads stay word aligned
+        ULONG ulOffset = 0;
+        while (ulOffset + 2 * sizeof(ULONG) <= (ULONG)lFileSize)
+        {
+            ULONG *pChunkHeader = (ULONG *)(pFileData + ulOffset);
+            ulOffset += 2 * sizeof(ULONG);
+
+            // The size of an unknown chunk is unknown too, so nothing after it can be found
+            GameDataChunk const *pChunk = gameDataFindChunk(pChunkHeader[0]);
+            if (!pChunk) break;
+
+            ULONG ulCount = pChunkHeader[1];
+            if (ulCount > (lFileSize - ulOffset) / pChunk->ulEntrySize)
             {
-                case GDL_CHUNK_NAME('L', 'O', 'C', 'S'):
-                    chunkResult = gameDataLoadChunk(pFile,
-                                                    "Locations",
-                                                    (void **)&g_pGameData->pLocations,
-                                                    &s_pGameDataCounts->ulLocationCount,
-                                                    sizeof(Location));
-                    break;
-
-                case GDL_CHUNK_NAME('S', 'C', 'N', 'S'):
-                    chunkResult = gameDataLoadChunk(pFile,
-                                                    "Scenes",
-                                                    (void **)&g_pGameData->pScenes,
-                                                    &s_pGameDataCounts->ulSceneCount,
-                                                    sizeof(Scene));
-                    break;
-
-                case GDL_CHUNK_NAME('R', 'G', 'N', 'S'):
-                    chunkResult = gameDataLoadChunk(pFile,
-                                                    "Interactions",
-                                                    (void **)&g_pGameData->pIteractables,
-                                                    &s_pGameDataCounts->ulInteractableCount,
-                                                    sizeof(Interaction));
-                    break;
-
-                case GDL_CHUNK_NAME('T', 'E', 'X', 'T'):
-                    chunkResult = gameDataLoadChunk(pFile,
-                                                    "TextRegions",
-                                                    (void **)&g_pGameData->pTextRegions,
-                                                    &s_pGameDataCounts->ulTextRegionCount,
-                                                    sizeof(TextRegion));
-                    break;
-
-                case GDL_CHUNK_NAME('D', 'L', 'G', 'S'):
-                    chunkResult = gameDataLoadChunk(pFile,
-                                                    "Dialogues",
-                                                    (void **)&g_pGameData->pDialogues,
-                                                    &s_pGameDataCounts->ulDialogueCount,
-                                                    sizeof(Dialogue));
-                    break;
-
-                case GDL_CHUNK_NAME('P', 'A', 'G', 'E'):
-                    chunkResult = gameDataLoadChunk(pFile,
-                                                    "Dialogue Pages",
-                                                    (void **)&g_pGameData->pDialoguePages,
-                                                    &s_pGameDataCounts->ulDialoguePageCount,
-                                                    sizeof(DialoguePage));
-                    break;
-
-                case GDL_CHUNK_NAME('C', 'H', 'C', 'E'):
-                    chunkResult = gameDataLoadChunk(pFile,
-                                                    "Dialogue Choices",
-                                                    (void **)&g_pGameData->pDialogueChoices,
-                                                    &s_pGameDataCounts->ulDialogueChoiceCount,
-                                                    sizeof(DialogueChoice));
-                    break;
-
-                case GDL_CHUNK_NAME('B', 'Y', 'T', 'E'):
-                    chunkResult = gameDataLoadChunk(pFile,
-                                                    "Bytecode",
-                                                    (void **)&g_pGameData->puwScriptData,
-                                                    &s_pGameDataCounts->ulScriptDataSize,
-                                                    sizeof(UWORD));
-                    break;
-
-                case GDL_CHUNK_NAME('S', 'H', 'P', 'E'):
-                    chunkResult = gameDataLoadChunk(pFile,
-                                                    "Shapes",
-                                                    (void **)&g_pGameData->pShapes,
-                                                    &s_pGameDataCounts->ulShapeCount,
-                                                    sizeof(Shape));
-                    break;
-
-                case GDL_CHUNK_NAME('P', 'A', 'L', 'S'):
-                    chunkResult = gameDataLoadChunk(
-                        pFile,
-                        "Shape Palettes",
-                        (void **)&g_pGameData->pPalettes,
-                        &s_pGameDataCounts->ulPaletteCount,
-                        sizeof(PaletteEntry) * 32 /* Number of colors per palette*/
-                    );
-                    break;
-
-                case GDL_CHUNK_NAME('P', 'A', 'L', 'U'):
-                    chunkResult = gameDataLoadChunk(pFile,
-                                                    "UI Palette",
-                                                    (void **)&g_pGameData->pUiPalette,
-                                                    &s_pGameDataCounts->ulUiPaletteSize,
-                                                    sizeof(PaletteEntry));
-                    break;
-
-                default: logWrite("Unknown chunk '%s'", (char *)&ulChunkHeader); break;
+                logWrite("'%s' chunk is cut short", pChunk->szName);
+                return GameDataResult::CORRUPTED_FILE;
             }
 
-            GDL_VERIFY(chunkResult == GameDataResult::SUCCESS, chunkResult);
+            logWrite("Found '%s' chunk...", pChunk->szName);
+            *gameDataChunkCount(pChunk) = ulCount;
+            if (ulCount) *gameDataChunkData(pChunk) = pFileData + ulOffset;
+            ulOffset += ulCount * pChunk->ulEntrySize;
         }
 
-        fileClose(pFile);
+        return GameDataResult::SUCCESS;
+    }
+
+    /*
+     * Internal function.
+     * Number of ids in a range. The editor writes empty ranges with the last
+     * id before the first, or with both set to 0xFFFF.
+     */
+    static ULONG gameDataRangeCount(Range const &range)
+    {
+        if (range.uwFirstIndex == 0xFFFF || range.uwLastIndex < range.uwFirstIndex) return 0;
+
+        return range.uwLastIndex - range.uwFirstIndex + 1;
+    }
 
+    /*
+     * Internal function.
+     * Grows *pRange so it also covers other.
+     */
+    static void gameDataMergeRange(Range *pRange, Range const &other)
+    {
+        if (!gameDataRangeCount(other)) return;
+
+        if (!gameDataRangeCount(*pRange))
+        {
+            *pRange = other;
+            return;
+        }
+
+        pRange->uwFirstIndex = MIN(pRange->uwFirstIndex, other.uwFirstIndex);
+        pRange->uwLastIndex  = MAX(pRange->uwLastIndex, other.uwLastIndex);
+    }
+
+    /*
+     * Internal function.
+     * Reads ulSize bytes at ulOffset of the open version 3 file.
+     */
+    static UBYTE gameDataReadAt(ULONG ulOffset, void *pDest, ULONG ulSize)
+    {
+        fileSeek(s_pFile, ulOffset, FILE_SEEK_SET);
+        return fileRead(s_pFile, pDest, ulSize) == ulSize;
+    }
+
+    /*
+     * Internal function.
+     * Works out which interactions and text regions each location uses, from
+     * the ranges of its scenes, so a location can be loaded with one read
+     * per chunk. Reads all scenes once and drops them again.
+     */
+    static GameDataResult gameDataIndexLocations()
+    {
+        GameDataSlot const &scenes = s_slots[GDL_SLOT_SCENES];
+        ULONG ulSize               = scenes.ulFileCount * sizeof(Scene);
+        Scene *pScenes             = NULL;
+        if (ulSize)
+        {
+            pScenes = (Scene *)memAllocFast(ulSize);
+            if (!pScenes) return GameDataResult::OUT_OF_MEMORY;
+
+            if (!gameDataReadAt(scenes.ulFileOffset, pScenes, ulSize))
+            {
+                memFree(pScenes, ulSize);
+                return GameDataResult::CORRUPTED_FILE;
+            }
+        }
+
+        auto result = GameDataResult::SUCCESS;
+        for (ULONG i = 0; i < s_pGameDataCounts->ulLocationCount; ++i)
+        {
+            Range const &sceneRange = g_pGameData->pLocations[i].scenes;
+            Range *pRanges          = &s_pLocationRanges[i * 2];
+            pRanges[0]              = { 0xFFFF, 0xFFFF };
+            pRanges[1]              = { 0xFFFF, 0xFFFF };
+
+            ULONG ulSceneCount = gameDataRangeCount(sceneRange);
+            if (ulSceneCount && sceneRange.uwLastIndex >= scenes.ulFileCount)
+            {
+                result = GameDataResult::CORRUPTED_FILE;
+                break;
+            }
+
+            for (ULONG j = 0; j < ulSceneCount; ++j)
+            {
+                Scene const &scene = pScenes[sceneRange.uwFirstIndex + j];
+                gameDataMergeRange(&pRanges[0], scene.interactiveAreas);
+                gameDataMergeRange(&pRanges[1], scene.textRegions);
+            }
+        }
+
+        if (pScenes) memFree(pScenes, ulSize);
+        return result;
+    }
+
+    /*
+     * Internal function.
+     * Loads a version 3 file: reads the chunk directory, then every chunk
+     * but the per-location ones into one Fast block. The file stays open.
+     *
+     * Compressed chunks are decompressed in place: the stream is read to the
+     * end of the chunk's space plus the margin from the header and
+     * decompressed to its start. The space after a chunk is free until the
+     * next one is read, so the margin is only allocated once, at the end.
+     *
+     * s_pFile is set for gameDataReadAt(), gameDataLoad() clears it again if
+     * loading fails.
+     */
+    GameDataResult gameDataLoadToc(tFile *pFile)
+    {
+        s_pFile = pFile;
+
+        ULONG ulChunkCount = 0;
+        ULONG ulMargin     = 0;
+        fileRead(pFile, &ulChunkCount, sizeof(ULONG));
+        fileRead(pFile, &ulMargin, sizeof(ULONG));
+        if (ulChunkCount > GDL_MAX_CHUNKS) return GameDataResult::CORRUPTED_FILE;
+
+        GameDataTocEntry toc[GDL_MAX_CHUNKS];
+        ULONG ulTocSize = ulChunkCount * sizeof(GameDataTocEntry);
+        if (fileRead(pFile, toc, ulTocSize) != ulTocSize) return GameDataResult::CORRUPTED_FILE;
+
+        // One block for GameData, the counts, the global chunks and the location ranges
+        GameDataChunk const *pChunks[GDL_MAX_CHUNKS];
+        ULONG ulHeadSize      = sizeof(GameData) + sizeof(GameDataCounts);
+        ULONG ulSize          = ulHeadSize;
+        ULONG ulLocationCount = 0;
+        for (ULONG i = 0; i < ulChunkCount; ++i)
+        {
+            pChunks[i] = gameDataFindChunk(toc[i].ulName);
+            if (!pChunks[i]) continue;
+
+            // Per-location chunks are read a slice at a time, which a stream can't be
+            if (pChunks[i]->ubSlot != GDL_SLOT_NONE && toc[i].ulPackedSize)
+            {
+                logWrite("'%s' chunk can not be compressed", pChunks[i]->szName);
+                return GameDataResult::CORRUPTED_FILE;
+            }
+
+            if (pChunks[i]->ubSlot == GDL_SLOT_NONE)
+            {
+                ulSize += toc[i].ulCount * pChunks[i]->ulEntrySize;
+            }
+            if (pChunks[i]->uwDataOffset == offsetof(GameData, pLocations))
+            {
+                ulLocationCount = toc[i].ulCount;
+            }
+        }
+        ulSize += ulLocationCount * 2 * sizeof(Range) + ulMargin;
+
+        s_pImage = (UBYTE *)memAllocFast(ulSize);
+        if (!s_pImage) return GameDataResult::OUT_OF_MEMORY;
+        s_ulImageSize = ulSize;
+
+        g_pGameData       = new (s_pImage) GameData();
+        s_pGameDataCounts = new (s_pImage + sizeof(GameData)) GameDataCounts();
+
+        UBYTE *pDest = s_pImage + ulHeadSize;
+        for (ULONG i = 0; i < ulChunkCount; ++i)
+        {
+            GameDataChunk const *pChunk = pChunks[i];
+            if (!pChunk) continue;
+
+            if (pChunk->ubSlot != GDL_SLOT_NONE)
+            {
+                s_slots[pChunk->ubSlot] = { pChunk, toc[i].ulOffset, toc[i].ulCount, 0 };
+                continue;
+            }
+
+            logWrite("Loading '%s' chunk...", pChunk->szName);
+            ULONG ulChunkSize = toc[i].ulCount * pChunk->ulEntrySize;
+            if (!ulChunkSize) continue;
+
+            ULONG ulPackedSize = toc[i].ulPackedSize;
+            if (!ulPackedSize)
+            {
+                if (!gameDataReadAt(toc[i].ulOffset, pDest, ulChunkSize))
+                {
+                    return GameDataResult::CORRUPTED_FILE;
+                }
+            }
+            else
+            {
+                UBYTE *pStream = pDest + ulChunkSize + ulMargin - ulPackedSize;
+                if (ulPackedSize > ulChunkSize + ulMargin
+                    || !gameDataReadAt(toc[i].ulOffset, pStream, ulPackedSize)
+                    || !lzDecompress(pStream, ulPackedSize, pDest, ulChunkSize))
+                {
+                    logWrite("'%s' chunk does not decompress", pChunk->szName);
+                    return GameDataResult::CORRUPTED_FILE;
+                }
+            }
+
+            *gameDataChunkCount(pChunk) = toc[i].ulCount;
+            *gameDataChunkData(pChunk)  = pDest;
+            pDest += ulChunkSize;
+        }
+
+        s_pLocationRanges = (Range *)pDest;
+        return gameDataIndexLocations();
+    }
+
+    /*
+     * Internal function.
+     * Frees the slices of the loaded location.
+     */
+    static void gameDataEvictLocation()
+    {
+        if (s_pLocationData) memFree(s_pLocationData, s_ulLocationDataSize);
+        s_pLocationData     = NULL;
+        s_ulLocationDataSize = 0;
+        s_uwLocationId      = GDL_NO_LOCATION;
+
+        for (GameDataSlot &slot : s_slots)
+        {
+            if (!slot.pChunk) continue;
+
+            *gameDataChunkData(slot.pChunk)  = NULL;
+            *gameDataChunkCount(slot.pChunk) = 0;
+            slot.uwFirstId                  = 0;
+        }
+    }
+
+    GameDataResult gameDataLoadLocation(UWORD uwLocationId)
+    {
+        if (!g_pGameData || uwLocationId >= s_pGameDataCounts->ulLocationCount)
+        {
+            return GameDataResult::INVALID_LOCATION;
+        }
+
+        // Version 2 files have every location loaded already
+        if (!s_pFile || uwLocationId == s_uwLocationId) return GameDataResult::SUCCESS;
+
+        logBlockBegin("gameDataLoadLocation: %u", uwLocationId);
+        gameDataEvictLocation();
+
+        Location const &location           = g_pGameData->pLocations[uwLocationId];
+        Range const ranges[GDL_SLOT_COUNT] = {
+            location.scenes,
+            s_pLocationRanges[uwLocationId * 2],
+            s_pLocationRanges[uwLocationId * 2 + 1],
+            location.shapes,
+        };
+
+        auto result = GameDataResult::SUCCESS;
+        ULONG ulSize = 0;
+        for (UBYTE i = 0; i < GDL_SLOT_COUNT; ++i)
+        {
+            GameDataSlot const &slot = s_slots[i];
+            ULONG ulCount            = slot.pChunk ? gameDataRangeCount(ranges[i]) : 0;
+            if (ulCount && ranges[i].uwLastIndex >= slot.ulFileCount)
+            {
+                result = GameDataResult::CORRUPTED_FILE;
+            }
+            else if (ulCount)
+            {
+                ulSize += ulCount * slot.pChunk->ulEntrySize;
+            }
+        }
+
+        if (result == GameDataResult::SUCCESS && ulSize)
+        {
+            auto tag        = alloc_tag_scope(alloc_tag::GameData);
+            s_pLocationData = (UBYTE *)memAllocFast(ulSize);
+            if (s_pLocationData) s_ulLocationDataSize = ulSize;
+            else result = GameDataResult::OUT_OF_MEMORY;
+        }
+
+        // One read per chunk, each slice is contiguous in the file
+        systemUse();
+        UBYTE *pDest = s_pLocationData;
+        for (UBYTE i = 0; i < GDL_SLOT_COUNT && result == GameDataResult::SUCCESS; ++i)
+        {
+            GameDataSlot &slot = s_slots[i];
+            ULONG ulCount      = slot.pChunk ? gameDataRangeCount(ranges[i]) : 0;
+            if (!ulCount) continue;
+
+            ULONG ulEntrySize = slot.pChunk->ulEntrySize;
+            ULONG ulBytes     = ulCount * ulEntrySize;
+            if (!gameDataReadAt(slot.ulFileOffset + ranges[i].uwFirstIndex * ulEntrySize,
+                                pDest,
+                                ulBytes))
+            {
+                result = GameDataResult::GENERIC_READ_ERROR;
+                break;
+            }
+
+            *gameDataChunkData(slot.pChunk)  = pDest;
+            *gameDataChunkCount(slot.pChunk) = ulCount;
+            slot.uwFirstId                  = ranges[i].uwFirstIndex;
+            pDest += ulBytes;
+        }
         systemUnuse();
-        logBlockEnd("gameDataLoad");
 
+        if (result == GameDataResult::SUCCESS) s_uwLocationId = uwLocationId;
+        else gameDataEvictLocation();
+
+        logBlockEnd("gameDataLoadLocation");
         return result;
     }
 
-    void gameDataDestroy()
+    Location *gameDataGetLocation(UWORD uwLocationId)
     {
-        logBlockBegin("gameDataDestroy");
+        if (!g_pGameData || uwLocationId >= s_pGameDataCounts->ulLocationCount) return NULL;
 
-        if (!g_pGameData) return;
+        return &g_pGameData->pLocations[uwLocationId];
+    }
 
-        // Free individual resources
-        memFree(g_pGameData->pLocations, s_pGameDataCounts->ulLocationCount * sizeof(Location));
-        memFree(g_pGameData->pScenes, s_pGameDataCounts->ulSceneCount * sizeof(Scene));
-        memFree(g_pGameData->pIteractables,
-                s_pGameDataCounts->ulInteractableCount * sizeof(Interaction));
-        memFree(g_pGameData->pTextRegions,
-                s_pGameDataCounts->ulTextRegionCount * sizeof(TextRegion));
-        memFree(g_pGameData->pDialogues, s_pGameDataCounts->ulDialogueCount * sizeof(Dialogue));
-        memFree(g_pGameData->pDialoguePages,
-                s_pGameDataCounts->ulDialoguePageCount * sizeof(DialoguePage));
-        memFree(g_pGameData->pDialogueChoices,
-                s_pGameDataCounts->ulDialogueChoiceCount * sizeof(DialogueChoice));
-        memFree(g_pGameData->puwScriptData, s_pGameDataCounts->ulScriptDataSize * sizeof(UWORD));
-        memFree(g_pGameData->pShapes, s_pGameDataCounts->ulShapeCount * sizeof(Shape));
-        memFree(g_pGameData->pPalettes, s_pGameDataCounts->ulPaletteCount * sizeof(PaletteEntry));
-        memFree(g_pGameData->pUiPalette, s_pGameDataCounts->ulUiPaletteSize * sizeof(PaletteEntry));
-
-        // Free the data container
-        memFree(g_pGameData, sizeof(GameData));
-        g_pGameData = NULL;
-
-        memFree(s_pGameDataCounts, sizeof(GameDataCounts));
-        s_pGameDataCounts = NULL;
+    Scene *gameDataGetScene(UWORD uwSceneId)
+    {
+        if (!g_pGameData) return NULL;
 
-        logBlockEnd("gameDataDestroy");
+        UWORD uwIndex = uwSceneId - s_slots[GDL_SLOT_SCENES].uwFirstId;
+        return uwIndex < s_pGameDataCounts->ulSceneCount ? &g_pGameData->pScenes[uwIndex] : NULL;
+    }
+
+    Interaction *gameDataGetInteraction(UWORD uwInteractionId)
+    {
+        if (!g_pGameData) return NULL;
+
+        UWORD uwIndex = uwInteractionId - s_slots[GDL_SLOT_INTERACTIONS].uwFirstId;
+        return uwIndex < s_pGameDataCounts->ulInteractableCount
+                   ? &g_pGameData->pIteractables[uwIndex]
+                   : NULL;
+    }
+
+    TextRegion *gameDataGetTextRegion(UWORD uwTextRegionId)
+    {
+        if (!g_pGameData) return NULL;
+
+        UWORD uwIndex = uwTextRegionId - s_slots[GDL_SLOT_TEXT_REGIONS].uwFirstId;
+        return uwIndex < s_pGameDataCounts->ulTextRegionCount ? &g_pGameData->pTextRegions[uwIndex]
+                                                               : NULL;
+    }
+
+    Shape *gameDataGetShape(UWORD uwShapeId)
+    {
+        if (!g_pGameData) return NULL;
+
+        UWORD uwIndex = uwShapeId - s_slots[GDL_SLOT_SHAPES].uwFirstId;
+        return uwIndex < s_pGameDataCounts->ulShapeCount ? &g_pGameData->pShapes[uwIndex] : NULL;
     }
 
     GameDataResult gameDataLoadChunk(tFile *pFile,
@@ -246,4 +791,40 @@ namespace NEONengine
 
         return GameDataResult::SUCCESS;
     }
+
+    /*
+     * Internal function.
+     * Grows *pulCount so it covers uwFlagId, unless it is GAME_FLAG_NONE.
+     */
+    static void gameDataCoverFlag(ULONG *pulCount, UWORD uwFlagId)
+    {
+        if (uwFlagId != GAME_FLAG_NONE && uwFlagId >= *pulCount) *pulCount = uwFlagId + 1;
+    }
+
+    /*
+     * Internal function.
+     * Number of flags needed to cover every flag id used by the dialogues. Those of the scripts
+     * are counted by scriptLoad().
+     */
+    ULONG gameDataFlagCount()
+    {
+        ULONG ulFlagCount = 0;
+        for (ULONG i = 0; i < s_pGameDataCounts->ulDialoguePageCount; ++i)
+        {
+            DialoguePage const &page = g_pGameData->pDialoguePages[i];
+            gameDataCoverFlag(&ulFlagCount, page.uwSetFlagIdOnSelection);
+            gameDataCoverFlag(&ulFlagCount, page.uwClearFlagIdOnSelection);
+            gameDataCoverFlag(&ulFlagCount, page.uwCheckFlag);
+        }
+
+        for (ULONG i = 0; i < s_pGameDataCounts->ulDialogueChoiceCount; ++i)
+        {
+            DialogueChoice const &choice = g_pGameData->pDialogueChoices[i];
+            gameDataCoverFlag(&ulFlagCount, choice.uwSetFlagIdOnSelection);
+            gameDataCoverFlag(&ulFlagCount, choice.uwClearFlagIdOnSelection);
+            gameDataCoverFlag(&ulFlagCount, choice.uwCheckFlag);
+        }
+
+        return ulFlagCount;
+    }
 }  // namespace NEONengine
\ No newline at end of file
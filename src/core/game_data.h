@@ -160,16 +160,58 @@ namespace NEONengine
         VERSION_NOT_SUPPORTED,
         OUT_OF_MEMORY,
         CORRUPTED_FILE,
+        INVALID_LOCATION,
+    };
+
+    /**
+     * @brief How gameDataLoad() reads a version 2 file. Version 3 files are
+     * always read through their chunk directory.
+     */
+    enum class GameDataLoadMode
+    {
+        IMAGE,      ///< One read into one Fast block, GameData points into it
+        PER_CHUNK,  ///< One read and one allocation per chunk
     };
 
     /**
      * @brief Loads the specified game data file.
-     * Currently only supports version 2.0
+     * Supports version 2.0, which is loaded whole, and version 3.0, which
+     * starts with a chunk directory. Of a version 3 file only the global
+     * chunks are loaded, decompressing those that are compressed. The
+     * scenes, interactions, text regions and shapes follow one location at a
+     * time through gameDataLoadLocation().
+     * Logs how long loading took, so the modes can be compared.
      *
      * @param szFilePath The file path of the game data file, generally ending in .NEON.
+     * @param eMode How to read the file.
      * @return GameDataResult Indicates if an error occured while reading.
      */
-    GameDataResult gameDataLoad(const char *szFilePath);
+    GameDataResult gameDataLoad(const char *szFilePath,
+                                GameDataLoadMode eMode = GameDataLoadMode::IMAGE);
+
+    /**
+     * @brief Loads the scenes, interactions, text regions and shapes of one
+     * location and frees those of the previous one. The file stays open
+     * while a version 3 file is loaded; for version 2 files everything is
+     * loaded already and this does nothing.
+     *
+     * @param uwLocationId The location to load.
+     * @return GameDataResult SUCCESS, or why the location could not be loaded.
+     * Nothing of any location is loaded afterwards then.
+     */
+    GameDataResult gameDataLoadLocation(UWORD uwLocationId);
+
+    /**
+     * @brief Look up game objects by id.
+     *
+     * @return The object, or NULL if the id is out of range or belongs to a
+     * location that is not loaded.
+     */
+    Location *gameDataGetLocation(UWORD uwLocationId);
+    Scene *gameDataGetScene(UWORD uwSceneId);
+    Interaction *gameDataGetInteraction(UWORD uwInteractionId);
+    TextRegion *gameDataGetTextRegion(UWORD uwTextRegionId);
+    Shape *gameDataGetShape(UWORD uwShapeId);
 
     /**
      * @brief Frees all the game data.
@@ -0,0 +1,113 @@
+#include "game_flags.h"
+
+#include <ace/managers/log.h>
+
+#include "mtl/bitset.h"
+
+namespace NEONengine
+{
+    using namespace mtl;
+
+    static dynamic_bitset<MemF::Fast> s_flags;
+
+    UBYTE gameFlagsReserve(ULONG ulFlagCount)
+    {
+        if (ulFlagCount <= s_flags.size()) return 1;
+
+        if (!s_flags.resize(ulFlagCount))
+        {
+            logWrite("gameFlagsReserve: Unable to allocate %lu flags", ulFlagCount);
+            return 0;
+        }
+
+        return 1;
+    }
+
+    void gameFlagsClearAll(void)
+    {
+        s_flags.clear_all();
+    }
+
+    void gameFlagsDestroy(void)
+    {
+        s_flags.release();
+    }
+
+    void gameFlagSet(UWORD uwFlagId)
+    {
+        if (uwFlagId == GAME_FLAG_NONE) return;
+
+        if (uwFlagId >= s_flags.size())
+        {
+            logWrite("gameFlagSet: no flag with id %u", uwFlagId);
+            return;
+        }
+
+        s_flags.set(uwFlagId);
+    }
+
+    void gameFlagClear(UWORD uwFlagId)
+    {
+        if (uwFlagId == GAME_FLAG_NONE) return;
+
+        if (uwFlagId >= s_flags.size())
+        {
+            logWrite("gameFlagClear: no flag with id %u", uwFlagId);
+            return;
+        }
+
+        s_flags.clear(uwFlagId);
+    }
+
+    UBYTE gameFlagIsSet(UWORD uwFlagId)
+    {
+        return uwFlagId < s_flags.size() && s_flags.test(uwFlagId);
+    }
+
+    UBYTE dialogueChoiceIsAvailable(DialogueChoice const *pChoice)
+    {
+        UWORD uwFlagId = pChoice->uwCheckFlag;
+        return pChoice->ubEnabled && (uwFlagId == GAME_FLAG_NONE || s_flags.test(uwFlagId));
+    }
+
+    void dialogueChoiceApplyFlags(DialogueChoice const *pChoice)
+    {
+        gameFlagSet(pChoice->uwSetFlagIdOnSelection);
+        gameFlagClear(pChoice->uwClearFlagIdOnSelection);
+    }
+
+    void dialoguePageApplyFlags(DialoguePage const *pPage)
+    {
+        gameFlagSet(pPage->uwSetFlagIdOnSelection);
+        gameFlagClear(pPage->uwClearFlagIdOnSelection);
+    }
+
+    ULONG gameFlagsSnapshotSize(void)
+    {
+        return s_flags.snapshot_size();
+    }
+
+    void gameFlagsSnapshot(void *pDest)
+    {
+        s_flags.snapshot(pDest);
+    }
+
+    UBYTE gameFlagsRestore(void const *pSrc, ULONG ulSize)
+    {
+        if (!s_flags.size())
+        {
+            logWrite("gameFlagsRestore: no game data loaded");
+            return 0;
+        }
+
+        UBYTE ubExact = s_flags.restore(pSrc, ulSize);
+
+        if (!ubExact)
+        {
+            logWrite("gameFlagsRestore: %lu bytes given, %lu expected",
+                     ulSize,
+                     gameFlagsSnapshotSize());
+        }
+        return ubExact;
+    }
+}  // namespace NEONengine
@@ -0,0 +1,100 @@
+#ifndef __GAME_FLAGS_H__INCLUDED__
+#define __GAME_FLAGS_H__INCLUDED__
+
+#include <ace/types.h>
+
+#include "core/game_data.h"
+
+namespace NEONengine
+{
+    /**
+     * @brief Flag id meaning "no flag", as stored in the .neon data. Setting
+     * or clearing it does nothing and a choice checking it is always offered.
+     */
+    #define GAME_FLAG_NONE 0xFFFF
+
+    /**
+     * @brief Makes room for flag ids below ulFlagCount. Flags already set are
+     * kept, so loading more game data does not lose progress.
+     * Called by gameDataLoad() with enough flags for the loaded dialogues
+     * and scripts.
+     *
+     * @param ulFlagCount Number of flags.
+     * @return UBYTE 1 on success, 0 if out of memory.
+     *
+     * @see gameFlagsDestroy()
+     */
+    UBYTE gameFlagsReserve(ULONG ulFlagCount);
+
+    /**
+     * @brief Clears every flag, e.g. when starting a new game.
+     */
+    void gameFlagsClearAll(void);
+
+    /**
+     * @brief Frees the flag store.
+     *
+     * @see gameFlagsReserve()
+     */
+    void gameFlagsDestroy(void);
+
+    /**
+     * @brief Sets a flag. Ids beyond the store are logged and ignored.
+     */
+    void gameFlagSet(UWORD uwFlagId);
+
+    /**
+     * @brief Clears a flag. Ids beyond the store are logged and ignored.
+     */
+    void gameFlagClear(UWORD uwFlagId);
+
+    /**
+     * @brief Checks a flag.
+     *
+     * @return UBYTE 1 if set, 0 if clear or out of range.
+     */
+    UBYTE gameFlagIsSet(UWORD uwFlagId);
+
+    /**
+     * @brief Checks if a choice should be offered: it is enabled and the
+     * flag it checks is set. Runs for every visible choice each frame, so
+     * it relies on gameFlagsReserve() having covered every id in the data.
+     */
+    UBYTE dialogueChoiceIsAvailable(DialogueChoice const *pChoice);
+
+    /**
+     * @brief Applies the set and clear flags of a selected choice.
+     */
+    void dialogueChoiceApplyFlags(DialogueChoice const *pChoice);
+
+    /**
+     * @brief Applies the set and clear flags of a page once it is shown.
+     */
+    void dialoguePageApplyFlags(DialoguePage const *pPage);
+
+    /**
+     * @brief Number of bytes needed to save all flags.
+     *
+     * @see gameFlagsSnapshot()
+     */
+    ULONG gameFlagsSnapshotSize(void);
+
+    /**
+     * @brief Copies all flags into a save game buffer.
+     *
+     * @param pDest Buffer of at least gameFlagsSnapshotSize() bytes.
+     */
+    void gameFlagsSnapshot(void *pDest);
+
+    /**
+     * @brief Restores flags from a save game buffer. A buffer from a build
+     * with a different number of flags restores as many as it holds.
+     *
+     * @param pSrc Data written by gameFlagsSnapshot().
+     * @param ulSize Size of the data.
+     * @return UBYTE 1 if the size matched the current store exactly.
+     */
+    UBYTE gameFlagsRestore(void const *pSrc, ULONG ulSize);
+}
+
+#endif // __GAME_FLAGS_H__INCLUDED__
@@ -0,0 +1,215 @@
+#include "language.h"
+
+#include "neonengine.h"
+
+#include <ace/managers/system.h>
+
+#include <mtl/utility.h>
+
+#include "core/vfs.h"
+
+namespace NEONengine
+{
+#define LANGUAGE_MAGIC   0x4E4C4E47  // 'NLNG'
+#define LANGUAGE_VERSION 0x00010000
+#define LANGUAGE_COUNT   mtl::to<ULONG>(Language::LAST_LANGUAGE)
+
+    struct LanguageHeader
+    {
+        ULONG ulMagic;
+        ULONG ulVersion;
+        ULONG ulLanguageCount;
+        ULONG ulStringCount;
+    };
+
+    // As stored in the pack, one per language in it
+    struct LanguageEntry
+    {
+        ULONG ulLanguage;
+        ULONG ulOffset;  // Of the language's .noir, from the start of the pack
+        ULONG ulSize;
+    };
+
+    // Where the table of each language is without a pack, in the order of Language
+    static char const *const s_szLanguagePaths[] = {
+        "data/lang/en.noir",
+        "data/lang/it.noir",
+        "data/lang/de.noir",
+    };
+
+    static tFile *s_pPack;
+    static LanguageEntry s_entries[LANGUAGE_COUNT];
+    static ULONG s_ulEntryCount;
+    static string_table_ptr s_pStrings{ nullptr };
+    static text_layout_table_ptr s_pLayouts{ nullptr };
+    static Language s_eLanguage;
+    static tCbLanguageChanged s_listeners[LANGUAGE_MAX_LISTENERS];
+    static UBYTE s_ubListenerCount;
+
+    /* Internal function. Reads the directory of the pack, closing it if it is not one. */
+    static UBYTE languageOpenPack(char const *szPackPath)
+    {
+        tFile *pPack = vfsOpen(szPackPath);
+        if (!pPack)
+        {
+            NE_LOG("Language: no '%s', loading a file per language", szPackPath);
+            return 0;
+        }
+
+        LanguageHeader header;
+        if (fileRead(pPack, &header, sizeof(header)) != sizeof(header)
+            || header.ulMagic != LANGUAGE_MAGIC || header.ulVersion != LANGUAGE_VERSION
+            || header.ulLanguageCount > LANGUAGE_COUNT)
+        {
+            NE_LOG("Language: '%s' is not a language pack", szPackPath);
+            fileClose(pPack);
+            return 0;
+        }
+
+        ULONG ulDirectorySize = header.ulLanguageCount * sizeof(LanguageEntry);
+        if (fileRead(pPack, s_entries, ulDirectorySize) != ulDirectorySize)
+        {
+            NE_LOG("Language: could not read the directory of '%s'", szPackPath);
+            fileClose(pPack);
+            return 0;
+        }
+
+        s_pPack        = pPack;
+        s_ulEntryCount = header.ulLanguageCount;
+        NE_LOG("Language: %lu languages in '%s'", s_ulEntryCount, szPackPath);
+        return 1;
+    }
+
+    /* Internal function. Loads the strings of a language, and the text layouts after them if
+       there are any, from the pack if it is open. */
+    static string_table::result languageLoad(Language eLanguage, text_layout_table_ptr *pLayouts)
+    {
+        tFile *pFile = s_pPack;
+        if (!pFile)
+        {
+            char const *szPath = s_szLanguagePaths[mtl::to<ULONG>(eLanguage)];
+            pFile              = vfsOpen(szPath);
+            if (!pFile)
+            {
+                NE_LOG("Language: could not open '%s'", szPath);
+                return mtl::make_error<string_table_ptr, string_table::error_code>(
+                    string_table::error_code::MISSING_HEADER);
+            }
+        }
+        else
+        {
+            ULONG i = 0;
+            while (i < s_ulEntryCount && s_entries[i].ulLanguage != mtl::to<ULONG>(eLanguage))
+            {
+                ++i;
+            }
+            if (i == s_ulEntryCount)
+            {
+                return mtl::make_error<string_table_ptr, string_table::error_code>(
+                    string_table::error_code::UNSUPPORTED_LANGUAGE);
+            }
+
+            // The table follows in one piece, this is the only seek
+            fileSeek(s_pPack, s_entries[i].ulOffset, FILE_SEEK_SET);
+        }
+
+        auto result = string_table::create_from_fd(pFile);
+        if (result)
+        {
+            auto layouts = text_layout_table::create_from_fd(pFile);
+            if (layouts) { *pLayouts = mtl::move(layouts.value()); }
+        }
+
+        if (pFile != s_pPack) { fileClose(pFile); }
+        return result;
+    }
+
+    UBYTE languageCreate(Language eLanguage, char const *szPackPath)
+    {
+        languageDestroy();
+
+        systemUse();
+        languageOpenPack(szPackPath);
+        systemUnuse();
+
+        return languageSet(eLanguage);
+    }
+
+    void languageDestroy(void)
+    {
+        s_pStrings.reset(nullptr);
+        s_pLayouts.reset(nullptr);
+        if (s_pPack)
+        {
+            fileClose(s_pPack);
+            s_pPack = NULL;
+        }
+        s_ulEntryCount = 0;
+    }
+
+    UBYTE languageSet(Language eLanguage)
+    {
+        if (eLanguage >= Language::LAST_LANGUAGE) { return 0; }
+        if (s_pStrings && eLanguage == s_eLanguage) { return 1; }
+
+        text_layout_table_ptr pLayouts{ nullptr };
+        systemUse();
+        auto result = languageLoad(eLanguage, &pLayouts);
+        systemUnuse();
+
+        if (!result)
+        {
+            NE_LOG("Language: could not load language %lu, error %d",
+                   mtl::to<ULONG>(eLanguage),
+                   mtl::to<int>(result.error()));
+            return 0;
+        }
+
+        // Swapped before anyone hears of it, the old strings go once they have
+        string_table_ptr pOldStrings      = mtl::move(s_pStrings);
+        text_layout_table_ptr pOldLayouts = mtl::move(s_pLayouts);
+        s_pStrings                        = mtl::move(result.value());
+        s_pLayouts                        = mtl::move(pLayouts);
+        s_eLanguage                  = eLanguage;
+        for (UBYTE i = 0; i < s_ubListenerCount; ++i) { s_listeners[i](eLanguage); }
+
+        return 1;
+    }
+
+    Language languageGet(void)
+    {
+        return s_eLanguage;
+    }
+
+    string_table const *languageGetStrings(void)
+    {
+        return s_pStrings.get();
+    }
+
+    text_layout_table const *languageGetLayouts(void)
+    {
+        return s_pLayouts.get();
+    }
+
+    UBYTE languageAddListener(tCbLanguageChanged cbOnChanged)
+    {
+        if (s_ubListenerCount == LANGUAGE_MAX_LISTENERS) { return 0; }
+
+        s_listeners[s_ubListenerCount++] = cbOnChanged;
+        return 1;
+    }
+
+    void languageRemoveListener(tCbLanguageChanged cbOnChanged)
+    {
+        for (UBYTE i = 0; i < s_ubListenerCount; ++i)
+        {
+            if (s_listeners[i] != cbOnChanged) { continue; }
+
+            for (--s_ubListenerCount; i < s_ubListenerCount; ++i)
+            {
+                s_listeners[i] = s_listeners[i + 1];
+            }
+            return;
+        }
+    }
+}  // namespace NEONengine
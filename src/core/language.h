@@ -0,0 +1,93 @@
+#ifndef __LANGUAGE_H__INCLUDED__
+#define __LANGUAGE_H__INCLUDED__
+
+#include <exec/types.h>
+
+#include "core/string_table.h"
+#include "core/text_layout_table.h"
+
+namespace NEONengine
+{
+    /**
+     * @brief The pack of the string tables of every language, see
+     * tools/noir/noirpack.cpp for its layout. Builds without the host tools
+     * have none, and load the table of each language from its own file.
+     */
+#define LANGUAGE_PACK_PATH "data/lang/lang.noir"
+
+    /**
+     * @brief Most callbacks that can be told of a language change at once.
+     */
+#define LANGUAGE_MAX_LISTENERS 8
+
+    using Language = string_table::supported_languages;
+
+    /**
+     * @brief Called when the language changed, to drop whatever was made
+     * from the strings of the old one, e.g. text bitmaps and layouts.
+     *
+     * @param eLanguage The new language, whose strings languageGetStrings()
+     * already returns.
+     */
+    typedef void (*tCbLanguageChanged)(Language eLanguage);
+
+    /**
+     * @brief Opens the language pack and loads the strings of a language.
+     * The pack stays open, so changing the language is a seek and a read.
+     *
+     * @return UBYTE 1 if the strings were loaded, 0 otherwise.
+     *
+     * @see languageDestroy()
+     */
+    UBYTE languageCreate(Language eLanguage, char const *szPackPath = LANGUAGE_PACK_PATH);
+
+    /**
+     * @brief Frees the strings and closes the pack. Must come before
+     * vfsDestroy(), the pack may have been opened from data.pak.
+     *
+     * @see languageCreate()
+     */
+    void languageDestroy(void);
+
+    /**
+     * @brief Loads the strings of another language in place of those of the
+     * current one, then calls the listeners, all before it returns, so no
+     * text of the old language is drawn once it has. The old strings are
+     * freed last, only the new ones stay in memory.
+     *
+     * @return UBYTE 1 if the language changed or already was the one asked
+     * for, 0 if its strings could not be loaded, the old ones are then kept.
+     */
+    UBYTE languageSet(Language eLanguage);
+
+    /**
+     * @brief The current language.
+     */
+    Language languageGet(void);
+
+    /**
+     * @brief The strings of the current language, NULL if none are loaded.
+     * Only valid until the language changes.
+     */
+    string_table const *languageGetStrings(void);
+
+    /**
+     * @brief The text layouts of the current language, NULL if its table
+     * was built without them. Only valid until the language changes.
+     */
+    text_layout_table const *languageGetLayouts(void);
+
+    /**
+     * @brief Registers a callback for language changes.
+     *
+     * @return UBYTE 0 if LANGUAGE_MAX_LISTENERS are registered already.
+     */
+    UBYTE languageAddListener(tCbLanguageChanged cbOnChanged);
+
+    /**
+     * @brief Unregisters a callback added with languageAddListener().
+     */
+    void languageRemoveListener(tCbLanguageChanged cbOnChanged);
+}  // namespace NEONengine
+
+#endif  //__LANGUAGE_H__INCLUDED__
@@ -8,6 +8,7 @@
 
 #include "core/mouse_pointer.h"
 #include "core/screen.h"
+#include "mtl/flat_hash_map.h"
 #include "mtl/utility.h"
 
 namespace NEONengine
@@ -35,6 +36,7 @@ namespace NEONengine
         UWORD uwHotspotCount;
         HotspotId nextHotspotId;
         HotspotInternal *pFirstHotspot;
+        flat_hash_map<HotspotId, HotspotInternal *> hotspotsById;
         UBYTE ubIsEnabled;
         UBYTE ubUpdateOutsideBounds;
         UWORD uwOffsetY;
@@ -45,7 +47,7 @@ namespace NEONengine
     Layer *layerCreate()
     {
         logBlockBegin("layerCreate");
-        Layer *pLayer     = (Layer *)memAllocFastClear(sizeof(Layer));
+        Layer *pLayer     = new (MemF::Fast) Layer();
         pLayer->uwOffsetY = systemIsPal() ? 28 : 0;
         logBlockEnd("layerCreate");
 
@@ -191,7 +193,7 @@ namespace NEONengine
                 pCurrent = pNext;
             }
 
-            memFree(pLayer, sizeof(Layer));
+            delete pLayer;
         }
 
         logBlockEnd("layerDestroy");
@@ -246,6 +248,7 @@ namespace NEONengine
 
         pNewHotspot->id = pLayer->nextHotspotId;
         pLayer->nextHotspotId++;
+        pLayer->hotspotsById.insert(pNewHotspot->id, pNewHotspot);
 
         memcpy(&pNewHotspot->hotspot, pHotspot, sizeof(Hotspot));
         pNewHotspot->pNext = 0;
@@ -275,10 +278,9 @@ namespace NEONengine
             return 0;
         }
 
-        HotspotInternal *pCurrent = pLayer->pFirstHotspot;
-        while (pCurrent && pCurrent->id != id) { pCurrent = pCurrent->pNext; }
+        HotspotInternal *const *ppHotspot = pLayer->hotspotsById.find(id);
 
-        return (pCurrent) ? &pCurrent->hotspot : nullptr;
+        return (ppHotspot) ? &(*ppHotspot)->hotspot : nullptr;
     }
 
     void layerRemoveHotspot(Layer *pLayer, HotspotId id)
@@ -295,6 +297,7 @@ namespace NEONengine
 
         if (pCurrent->id == id)
         {
+            pLayer->hotspotsById.erase(id);
             pLayer->pFirstHotspot = pCurrent->pNext;
             memFree(pCurrent, sizeof(HotspotInternal));
             return;
@@ -313,6 +316,7 @@ namespace NEONengine
         }
 
         pPrev->pNext = pCurrent->pNext;
+        pLayer->hotspotsById.erase(id);
 
         pLayer->bounds = calculateLayerBounds(pLayer);
 
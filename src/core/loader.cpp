@@ -0,0 +1,276 @@
+#include "loader.h"
+
+#include "neonengine.h"
+
+#include <ace/managers/log.h>
+#include <ace/managers/memory.h>
+#include <ace/managers/system.h>
+
+#include "core/game_data.h"
+#include "core/music.h"
+#include "core/vfs.h"
+
+namespace NEONengine
+{
+    enum class LoadJobType : UBYTE
+    {
+        RAW,
+        PALETTE,
+        BITMAP,
+        MUSIC,
+        GAME_DATA,
+    };
+
+    enum class LoadStep : UBYTE
+    {
+        MORE,    ///< Out of budget for this frame
+        DONE,
+        FAILED,
+    };
+
+    struct LoadJob
+    {
+        LoadJobType eType;
+        UBYTE ubParam;  // Bitmap flags or palette length
+        UWORD uwLocationId;
+        char const *szFilePath;
+        void *pResult;  // Depends on the type, see the loaderAdd functions
+        ULONG *pulSize;
+
+        // Progress, a RAW job reads across frames, GAME_DATA runs in two steps
+        tFile *pFile;
+        UBYTE *pData;
+        ULONG ulSize;
+        ULONG ulRead;
+        UBYTE ubStep;
+    };
+
+    static LoadJob s_jobs[LOADER_MAX_JOBS];
+    static UBYTE s_ubJobCount;
+    static UBYTE s_ubNextJob;
+    static UBYTE s_ubRunning;
+    static UBYTE s_ubFailed;
+    static ULONG s_ulFrameBudget = LOADER_FRAME_BUDGET;
+    static tCbLoaderDone s_cbOnDone;
+
+    /* Internal function. Returns NULL if the queue is full. */
+    static LoadJob *loaderQueue(LoadJobType eType, char const *szFilePath)
+    {
+        if (s_ubJobCount == LOADER_MAX_JOBS)
+        {
+            NE_LOG("Loader: queue full, '%s' not added", szFilePath);
+            return NULL;
+        }
+
+        LoadJob *pJob    = &s_jobs[s_ubJobCount++];
+        *pJob            = {};
+        pJob->eType      = eType;
+        pJob->szFilePath = szFilePath;
+        return pJob;
+    }
+
+    /* Internal function. Reads as much of the file as the budget allows. */
+    static LoadStep loaderReadFile(LoadJob *pJob, ULONG *pulBudget)
+    {
+        if (!pJob->pFile)
+        {
+            pJob->pFile = vfsOpen(pJob->szFilePath);
+            if (!pJob->pFile) { return LoadStep::FAILED; }
+
+            // An empty file loads as no block and a size of 0
+            LONG lSize = fileGetSize(pJob->pFile);
+            if (lSize <= 0)
+            {
+                fileClose(pJob->pFile);
+                pJob->pFile = NULL;
+                return lSize ? LoadStep::FAILED : LoadStep::DONE;
+            }
+
+            pJob->ulSize = (ULONG)lSize;
+            pJob->pData  = (UBYTE *)memAllocFast(pJob->ulSize);
+            if (!pJob->pData)
+            {
+                fileClose(pJob->pFile);
+                pJob->pFile = NULL;
+                return LoadStep::FAILED;
+            }
+        }
+
+        ULONG ulSlice = pJob->ulSize - pJob->ulRead;
+        if (ulSlice > *pulBudget) { ulSlice = *pulBudget; }
+
+        if (fileRead(pJob->pFile, pJob->pData + pJob->ulRead, ulSlice) != ulSlice)
+        {
+            fileClose(pJob->pFile);
+            pJob->pFile = NULL;
+            memFree(pJob->pData, pJob->ulSize);
+            pJob->pData = NULL;
+            return LoadStep::FAILED;
+        }
+
+        pJob->ulRead += ulSlice;
+        *pulBudget -= ulSlice;
+        if (pJob->ulRead < pJob->ulSize) { return LoadStep::MORE; }
+
+        fileClose(pJob->pFile);
+        pJob->pFile              = NULL;
+        *(UBYTE **)pJob->pResult = pJob->pData;
+        *pJob->pulSize           = pJob->ulSize;
+        return LoadStep::DONE;
+    }
+
+    /*
+     * Internal function. ACE reads these files in one go, so each step gets a
+     * frame of its own: it only runs while nothing else was read this frame,
+     * and uses up the whole budget.
+     */
+    static LoadStep loaderRunWhole(LoadJob *pJob, ULONG *pulBudget)
+    {
+        if (*pulBudget != s_ulFrameBudget) { return LoadStep::MORE; }
+        *pulBudget = 0;
+
+        switch (pJob->eType)
+        {
+            case LoadJobType::PALETTE:
+                return vfsPaletteLoad(pJob->szFilePath, (UWORD *)pJob->pResult, pJob->ubParam)
+                           ? LoadStep::DONE
+                           : LoadStep::FAILED;
+
+            case LoadJobType::BITMAP:
+            {
+                tBitMap *pBitMap = vfsBitmapCreate(pJob->szFilePath, pJob->ubParam);
+                *(tBitMap **)pJob->pResult = pBitMap;
+                return pBitMap ? LoadStep::DONE : LoadStep::FAILED;
+            }
+
+            case LoadJobType::MUSIC:
+                musicLoad(pJob->szFilePath);
+                return LoadStep::DONE;
+
+            case LoadJobType::GAME_DATA:
+                if (pJob->ubStep++ == 0)
+                {
+                    return gameDataLoad(pJob->szFilePath) == GameDataResult::SUCCESS
+                               ? LoadStep::MORE
+                               : LoadStep::FAILED;
+                }
+                return gameDataLoadLocation(pJob->uwLocationId) == GameDataResult::SUCCESS
+                           ? LoadStep::DONE
+                           : LoadStep::FAILED;
+
+            default:
+                return LoadStep::FAILED;
+        }
+    }
+
+    /* Internal function. Runs the jobs for one frame's budget. */
+    static void loaderRunFrame(void)
+    {
+        ULONG ulBudget = s_ulFrameBudget;
+
+        systemUse();
+        while (ulBudget && s_ubNextJob < s_ubJobCount)
+        {
+            LoadJob *pJob  = &s_jobs[s_ubNextJob];
+            LoadStep eStep = pJob->eType == LoadJobType::RAW ? loaderReadFile(pJob, &ulBudget)
+                                                             : loaderRunWhole(pJob, &ulBudget);
+            if (eStep == LoadStep::MORE) { break; }
+
+            if (eStep == LoadStep::FAILED)
+            {
+                NE_LOG("Loader: could not load '%s'", pJob->szFilePath);
+                s_ubFailed = 1;
+            }
+            ++s_ubNextJob;
+        }
+        systemUnuse();
+    }
+
+    /* Internal function. Empties the queue before the callback, so it can queue more. */
+    static void loaderComplete(void)
+    {
+        tCbLoaderDone cbOnDone = s_cbOnDone;
+        UBYTE ubSuccess        = !s_ubFailed;
+
+        s_ubRunning  = 0;
+        s_ubFailed   = 0;
+        s_ubJobCount = 0;
+        s_ubNextJob  = 0;
+        s_cbOnDone   = NULL;
+
+        SAFE_CB_CALL(cbOnDone, ubSuccess);
+    }
+
+    UBYTE loaderAddFile(char const *szFilePath, UBYTE **ppData, ULONG *pulSize)
+    {
+        LoadJob *pJob = loaderQueue(LoadJobType::RAW, szFilePath);
+        if (!pJob) { return 0; }
+
+        *ppData       = NULL;
+        *pulSize      = 0;
+        pJob->pResult = ppData;
+        pJob->pulSize = pulSize;
+        return 1;
+    }
+
+    UBYTE loaderAddPalette(char const *szFilePath, UWORD *pPalette, UBYTE ubMaxLength)
+    {
+        LoadJob *pJob = loaderQueue(LoadJobType::PALETTE, szFilePath);
+        if (!pJob) { return 0; }
+
+        pJob->pResult = pPalette;
+        pJob->ubParam = ubMaxLength;
+        return 1;
+    }
+
+    UBYTE loaderAddBitmap(char const *szFilePath, UBYTE ubFlags, tBitMap **ppBitMap)
+    {
+        LoadJob *pJob = loaderQueue(LoadJobType::BITMAP, szFilePath);
+        if (!pJob) { return 0; }
+
+        *ppBitMap     = NULL;
+        pJob->pResult = ppBitMap;
+        pJob->ubParam = ubFlags;
+        return 1;
+    }
+
+    UBYTE loaderAddMusic(char const *szFilePath)
+    {
+        return loaderQueue(LoadJobType::MUSIC, szFilePath) != NULL;
+    }
+
+    UBYTE loaderAddGameData(char const *szFilePath, UWORD uwLocationId)
+    {
+        LoadJob *pJob = loaderQueue(LoadJobType::GAME_DATA, szFilePath);
+        if (!pJob) { return 0; }
+
+        pJob->uwLocationId = uwLocationId;
+        return 1;
+    }
+
+    void loaderStart(tCbLoaderDone cbOnDone, ULONG ulFrameBudget)
+    {
+        s_cbOnDone      = cbOnDone;
+        s_ulFrameBudget = ulFrameBudget ? ulFrameBudget : LOADER_FRAME_BUDGET;
+        s_ubRunning     = 1;
+    }
+
+    void loaderProcess(void)
+    {
+        if (!s_ubRunning) { return; }
+
+        loaderRunFrame();
+        if (s_ubNextJob == s_ubJobCount) { loaderComplete(); }
+    }
+
+    void loaderFinish(void)
+    {
+        while (s_ubNextJob < s_ubJobCount) { loaderRunFrame(); }
+        loaderComplete();
+    }
+
+    UBYTE loaderIsBusy(void)
+    {
+        return s_ubRunning || s_ubJobCount;
+    }
+}  // namespace NEONengine
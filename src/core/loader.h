@@ -0,0 +1,101 @@
+#ifndef __LOADER_H__INCLUDED__
+#define __LOADER_H__INCLUDED__
+
+#include <ace/utils/bitmap.h>
+
+namespace NEONengine
+{
+    /**
+     * @brief Bytes of file data read per frame by default.
+     *
+     * @see loaderStart()
+     */
+#define LOADER_FRAME_BUDGET 4096
+
+    /**
+     * @brief Most jobs that can be queued at once.
+     */
+#define LOADER_MAX_JOBS 16
+
+    /**
+     * @brief Called once every queued job has run.
+     *
+     * @param ubSuccess 1 if all of them loaded, 0 if any failed.
+     */
+    typedef void (*tCbLoaderDone)(UBYTE ubSuccess);
+
+    /**
+     * @brief Queues a file to be read whole into a Fast memory block, a
+     * slice of the frame budget at a time.
+     *
+     * @param szFilePath Path of the file, must stay valid until it is read.
+     * @param ppData Receives the block, NULL if the file could not be read or
+     * is empty. Free it with memFree() and the size.
+     * @param pulSize Receives the size of the file.
+     * @return UBYTE 1 if the job was queued, 0 if the queue is full.
+     */
+    UBYTE loaderAddFile(char const *szFilePath, UBYTE **ppData, ULONG *pulSize);
+
+    /**
+     * @brief Queues a vfsPaletteLoad(). Don't load into a palette that is
+     * fading, load into a copy and put it in place once the fade is done.
+     *
+     * @return UBYTE 1 if the job was queued, 0 if the queue is full.
+     */
+    UBYTE loaderAddPalette(char const *szFilePath, UWORD *pPalette, UBYTE ubMaxLength);
+
+    /**
+     * @brief Queues a vfsBitmapCreate().
+     *
+     * @param ppBitMap Receives the bitmap, NULL if it could not be loaded.
+     * @return UBYTE 1 if the job was queued, 0 if the queue is full.
+     */
+    UBYTE loaderAddBitmap(char const *szFilePath, UBYTE ubFlags, tBitMap **ppBitMap);
+
+    /**
+     * @brief Queues a musicLoad(), which stops the module that is playing.
+     *
+     * @return UBYTE 1 if the job was queued, 0 if the queue is full.
+     */
+    UBYTE loaderAddMusic(char const *szFilePath);
+
+    /**
+     * @brief Queues a gameDataLoad() followed by a gameDataLoadLocation(),
+     * each in a frame of its own.
+     *
+     * @return UBYTE 1 if the job was queued, 0 if the queue is full.
+     */
+    UBYTE loaderAddGameData(char const *szFilePath, UWORD uwLocationId);
+
+    /**
+     * @brief Starts running the queued jobs from loaderProcess(). Jobs can
+     * still be added until the last one is done.
+     *
+     * @param cbOnDone Called from loaderProcess() once the queue is empty, may
+     * be NULL.
+     * @param ulFrameBudget Bytes of file data read per frame. Files read by
+     * ACE are read in one go, those get a frame of their own instead.
+     */
+    void loaderStart(tCbLoaderDone cbOnDone, ULONG ulFrameBudget = LOADER_FRAME_BUDGET);
+
+    /**
+     * @brief Runs the jobs for one frame's budget, so loading overlaps a fade
+     * instead of stalling the display. Must be called once per frame, does
+     * nothing unless the loader was started.
+     */
+    void loaderProcess(void);
+
+    /**
+     * @brief Runs every job left right away, then calls the callback. For
+     * when the data is needed now, e.g. a state that was entered without
+     * being preloaded.
+     */
+    void loaderFinish(void);
+
+    /**
+     * @brief Whether jobs are queued or running.
+     */
+    UBYTE loaderIsBusy(void);
+}  // namespace NEONengine
+
+#endif  //__LOADER_H__INCLUDED__
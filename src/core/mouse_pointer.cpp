@@ -8,6 +8,7 @@
 #include <ace/managers/system.h>
 #include <ace/managers/viewport/simplebuffer.h>
 
+#include "core/assets.h"
 #include "core/screen.h"
 
 namespace NEONengine
@@ -27,7 +28,7 @@ namespace NEONengine
         UWORD uwSourceWidth;
 
         systemUse();
-        tBitMap *pAtlas = bitmapCreateFromPath(szFilePath, 0);
+        tBitMap *pAtlas = assetsGetBitmap(szFilePath, 0);
 
         for (BYTE idx = 0; idx < MOUSE_MAX_COUNT; idx++)
         {
@@ -67,7 +68,7 @@ namespace NEONengine
             bitmapDestroy(pPointer);
         }
 
-        bitmapDestroy(pAtlas);
+        assetsRelease(pAtlas);
 
         spriteManagerCreate(screenGetView(g_mainScreen), 0, NULL);
         systemSetDmaBit(DMAB_SPRITE, 1);
@@ -4,21 +4,34 @@
 
 #include <ace/managers/ptplayer.h>
 
+#include <mtl/ring_buffer.h>
+
+#include "core/assets.h"
+
 namespace NEONengine
 {
     static tPtplayerMod *s_currentMod;
 
+    // Filled by ptplayer's interrupt, drained by musicPollEvent()
+    static mtl::ring_buffer<MusicEvent, 8> s_events;
+
+    static void musicOnSongEnd(void)
+    {
+        s_events.push(MusicEvent::SONG_END);
+    }
+
     void musicLoad(char const *szFilePath)
     {
         systemUse();
         if (s_currentMod)
         {
             ptplayerStop();
-            ptplayerModDestroy(s_currentMod);
+            assetsRelease(s_currentMod);
             s_currentMod = 0;
         }
+        s_events.clear();
 
-        s_currentMod = ptplayerModCreateFromPath(szFilePath);
+        s_currentMod = assetsGetMod(szFilePath);
 
         systemUnuse();
     }
@@ -26,14 +39,20 @@ namespace NEONengine
     void musicPlayCurrent(UBYTE ubLoop)
     {
         ptplayerLoadMod(s_currentMod, NULL, 0);
-        ptplayerConfigureSongRepeat(ubLoop, 0);
+        ptplayerConfigureSongRepeat(ubLoop, musicOnSongEnd);
         ptplayerEnableMusic(1);
     }
 
     void musicFree(void)
     {
         systemUse();
-        if (s_currentMod) { ptplayerModDestroy(s_currentMod); }
+        assetsRelease(s_currentMod);
+        s_currentMod = 0;
         systemUnuse();
     }
+
+    UBYTE musicPollEvent(MusicEvent *pEvent)
+    {
+        return s_events.pop(*pEvent);
+    }
 }  // namespace NEONengine
@@ -5,9 +5,29 @@
 
 namespace NEONengine
 {
+    /**
+     * @brief Things that happen during playback, raised from the player's
+     * interrupt and read back in the main loop.
+     *
+     * @see musicPollEvent()
+     */
+    enum class MusicEvent : UBYTE
+    {
+        SONG_END,
+    };
+
     void musicLoad(char const *szFilePath);
     void musicPlayCurrent(UBYTE ubLoop);
     void musicFree(void);
+
+    /**
+     * @brief Takes the oldest playback event. Call from the main loop until
+     * it returns 0.
+     *
+     * @param pEvent Receives the event.
+     * @return UBYTE 1 if an event was returned, 0 if there are none.
+     */
+    UBYTE musicPollEvent(MusicEvent *pEvent);
 }  // namespace NEONengine
 
 #endif  //__MUSIC_H__INCLUDED__
\ No newline at end of file
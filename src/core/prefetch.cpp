@@ -0,0 +1,319 @@
+#include "prefetch.h"
+
+#include "neonengine.h"
+
+#include <ace/managers/log.h>
+#include <ace/managers/memory.h>
+#include <ace/managers/system.h>
+
+#include <mtl/memory.h>
+
+#include "core/game_data.h"
+#include "core/loader.h"
+#include "core/vfs.h"
+
+namespace NEONengine
+{
+#define PREFETCH_NONE 0xFFFF
+
+    enum class PrefetchState : UBYTE
+    {
+        FREE,
+        QUEUED,
+        READY,
+    };
+
+    struct PrefetchSlot
+    {
+        PrefetchState eState;
+        PrefetchAsset eAsset;
+        UBYTE ubWanted;  // Used by a neighbour of the current scene
+        UWORD uwId;
+        UWORD uwSceneId;  // The neighbour it was queued for
+        void *pData;      // tBitMap, or the palette colors
+        ULONG ulSize;
+    };
+
+    static PrefetchSlot s_slots[PREFETCH_MAX_ASSETS];
+    static ULONG s_ulChipBudget;
+    static ULONG s_ulFastBudget;
+    static ULONG s_ulChipUsed;
+    static ULONG s_ulFastUsed;
+    static tCbPrefetchPath s_cbPath;
+
+    /* Internal function. Empty ranges are 0xFFFF-0xFFFF, or end before they start. */
+    static UBYTE prefetchInRange(Range const &range, UWORD uwId)
+    {
+        return range.uwFirstIndex != PREFETCH_NONE && uwId >= range.uwFirstIndex
+               && uwId <= range.uwLastIndex;
+    }
+
+    /* Internal function. */
+    static Location *prefetchFindLocation(UWORD uwSceneId)
+    {
+        Location *pLocation;
+        for (UWORD i = 0; (pLocation = gameDataGetLocation(i)); ++i)
+        {
+            if (prefetchInRange(pLocation->scenes, uwSceneId)) { return pLocation; }
+        }
+        return NULL;
+    }
+
+    /*
+     * Internal function. Chip bytes a .bm file takes once loaded, from its
+     * header: width, height and depth, 0 if it can't be read.
+     */
+    static ULONG prefetchBitmapSize(char const *szPath)
+    {
+        tFile *pFile = vfsOpen(szPath);
+        if (!pFile) { return 0; }
+
+        UWORD uwWidth = 0, uwHeight = 0;
+        UBYTE ubDepth = 0;
+        UBYTE ubRead  = fileRead(pFile, &uwWidth, sizeof(UWORD)) == sizeof(UWORD)
+                       && fileRead(pFile, &uwHeight, sizeof(UWORD)) == sizeof(UWORD)
+                       && fileRead(pFile, &ubDepth, sizeof(UBYTE)) == sizeof(UBYTE);
+        fileClose(pFile);
+
+        return ubRead ? ((uwWidth + 15) >> 4) * sizeof(UWORD) * uwHeight * ubDepth : 0;
+    }
+
+    /* Internal function. Frees whatever the slot holds. */
+    static void prefetchFree(PrefetchSlot *pSlot)
+    {
+        if (pSlot->eState == PrefetchState::READY)
+        {
+            if (pSlot->eAsset == PrefetchAsset::PALETTE)
+            {
+                memFree(pSlot->pData, pSlot->ulSize);
+                s_ulFastUsed -= pSlot->ulSize;
+            }
+            else
+            {
+                bitmapDestroy((tBitMap *)pSlot->pData);
+                s_ulChipUsed -= pSlot->ulSize;
+            }
+        }
+
+        pSlot->eState = PrefetchState::FREE;
+        pSlot->pData  = NULL;
+    }
+
+    /* Internal function. */
+    static PrefetchSlot *prefetchFind(PrefetchAsset eAsset, UWORD uwId)
+    {
+        for (PrefetchSlot &slot : s_slots)
+        {
+            if (slot.eState != PrefetchState::FREE && slot.eAsset == eAsset && slot.uwId == uwId)
+            {
+                return &slot;
+            }
+        }
+        return NULL;
+    }
+
+    /* Internal function. Marks the asset as wanted, queueing it if it is new. */
+    static void prefetchWant(PrefetchAsset eAsset, UWORD uwId, UWORD uwSceneId)
+    {
+        if (uwId == PREFETCH_NONE) { return; }
+
+        PrefetchSlot *pSlot = prefetchFind(eAsset, uwId);
+        if (!pSlot)
+        {
+            for (PrefetchSlot &slot : s_slots)
+            {
+                if (slot.eState == PrefetchState::FREE)
+                {
+                    pSlot = &slot;
+                    break;
+                }
+            }
+            if (!pSlot) { return; }
+
+            pSlot->eState    = PrefetchState::QUEUED;
+            pSlot->eAsset    = eAsset;
+            pSlot->uwId      = uwId;
+            pSlot->uwSceneId = uwSceneId;
+        }
+
+        pSlot->ubWanted = 1;
+    }
+
+    /* Internal function. Loads the asset of a queued slot within the budgets. */
+    static void prefetchLoad(PrefetchSlot *pSlot)
+    {
+        char const *szPath = s_cbPath ? s_cbPath(pSlot->eAsset, pSlot->uwId) : NULL;
+        if (!szPath)
+        {
+            prefetchFree(pSlot);
+            return;
+        }
+
+        systemUse();
+        if (pSlot->eAsset == PrefetchAsset::PALETTE)
+        {
+            ULONG ulSize = PREFETCH_PALETTE_LENGTH * sizeof(UWORD);
+            UWORD *pPalette
+                = s_ulFastUsed + ulSize <= s_ulFastBudget ? (UWORD *)memAllocFast(ulSize) : NULL;
+            if (pPalette && !vfsPaletteLoad(szPath, pPalette, PREFETCH_PALETTE_LENGTH - 1))
+            {
+                memFree(pPalette, ulSize);
+                pPalette = NULL;
+            }
+            if (pPalette)
+            {
+                pSlot->pData  = pPalette;
+                pSlot->ulSize = ulSize;
+                s_ulFastUsed += ulSize;
+            }
+        }
+        else
+        {
+            // Sized from its header, so one that doesn't fit is never loaded
+            ULONG ulSize     = prefetchBitmapSize(szPath);
+            tBitMap *pBitMap = ulSize && s_ulChipUsed + ulSize <= s_ulChipBudget
+                                   ? vfsBitmapCreate(szPath, 0)
+                                   : NULL;
+            if (pBitMap)
+            {
+                pSlot->pData  = pBitMap;
+                pSlot->ulSize = ulSize;
+                s_ulChipUsed += ulSize;
+            }
+        }
+        systemUnuse();
+
+        if (!pSlot->pData)
+        {
+            NE_LOG("Prefetch: skipped '%s', out of budget or not found", szPath);
+            prefetchFree(pSlot);
+            return;
+        }
+        pSlot->eState = PrefetchState::READY;
+    }
+
+    /*
+     * Internal function. Drops prefetched assets when an allocation fails,
+     * see mtl::add_purger(). Palettes are in Fast memory, so they don't help
+     * a Chip allocation.
+     */
+    static size_t prefetchPurge(size_t bytes, ULONG memFlags)
+    {
+        UBYTE ubChip = (memFlags & MEMF_CHIP) != 0;
+        size_t freed = 0;
+        for (PrefetchSlot &slot : s_slots)
+        {
+            if (freed >= bytes) { break; }
+            if (slot.eState != PrefetchState::READY) { continue; }
+            if (ubChip && slot.eAsset == PrefetchAsset::PALETTE) { continue; }
+
+            freed += slot.ulSize;
+            prefetchFree(&slot);
+        }
+        return freed;
+    }
+
+    void prefetchCreate(ULONG ulChipBudget, ULONG ulFastBudget, tCbPrefetchPath cbPath)
+    {
+        s_ulChipBudget = ulChipBudget;
+        s_ulFastBudget = ulFastBudget;
+        s_ulChipUsed   = 0;
+        s_ulFastUsed   = 0;
+        s_cbPath       = cbPath;
+        for (PrefetchSlot &slot : s_slots) { slot = {}; }
+
+        mtl::add_purger(prefetchPurge, PREFETCH_PURGE_PRIORITY);
+    }
+
+    void prefetchDestroy(void)
+    {
+        mtl::remove_purger(prefetchPurge);
+        for (PrefetchSlot &slot : s_slots) { prefetchFree(&slot); }
+        s_cbPath = NULL;
+    }
+
+    void prefetchSetScene(UWORD uwSceneId)
+    {
+        for (PrefetchSlot &slot : s_slots) { slot.ubWanted = 0; }
+
+        // Goto targets and backgrounds are relative to the location, and a
+        // goto never leaves it, so its shapes are loaded already
+        Scene *pScene       = gameDataGetScene(uwSceneId);
+        Location *pLocation = prefetchFindLocation(uwSceneId);
+        if (pScene && pLocation && pScene->interactiveAreas.uwFirstIndex != PREFETCH_NONE)
+        {
+            UWORD uwSceneCount = pLocation->scenes.uwLastIndex - pLocation->scenes.uwFirstIndex + 1;
+            for (ULONG i = pScene->interactiveAreas.uwFirstIndex;
+                 i <= pScene->interactiveAreas.uwLastIndex;
+                 ++i)
+            {
+                Interaction *pInteraction = gameDataGetInteraction(i);
+                if (!pInteraction) { continue; }
+
+                if (pInteraction->uwGotoScene >= uwSceneCount) { continue; }
+
+                UWORD uwGoto = pLocation->scenes.uwFirstIndex + pInteraction->uwGotoScene;
+                Scene *pNext = uwGoto != uwSceneId ? gameDataGetScene(uwGoto) : NULL;
+                if (!pNext || pNext->uwBackgroundId == PREFETCH_NONE) { continue; }
+
+                UWORD uwBackground = pLocation->backgrounds.uwFirstIndex + pNext->uwBackgroundId;
+                prefetchWant(PrefetchAsset::BACKGROUND, uwBackground, uwGoto);
+                prefetchWant(PrefetchAsset::PALETTE, uwBackground, uwGoto);
+            }
+        }
+
+        for (PrefetchSlot &slot : s_slots)
+        {
+            if (!slot.ubWanted) { prefetchFree(&slot); }
+        }
+    }
+
+    void prefetchCommit(UWORD uwSceneId)
+    {
+        for (PrefetchSlot &slot : s_slots)
+        {
+            if (slot.eState == PrefetchState::QUEUED && slot.uwSceneId != uwSceneId)
+            {
+                prefetchFree(&slot);
+            }
+        }
+    }
+
+    void prefetchProcess(void)
+    {
+        if (loaderIsBusy()) { return; }
+
+        for (PrefetchSlot &slot : s_slots)
+        {
+            if (slot.eState == PrefetchState::QUEUED)
+            {
+                prefetchLoad(&slot);
+                return;
+            }
+        }
+    }
+
+    tBitMap *prefetchTakeBitmap(PrefetchAsset eAsset, UWORD uwId)
+    {
+        PrefetchSlot *pSlot = prefetchFind(eAsset, uwId);
+        if (!pSlot || pSlot->eState != PrefetchState::READY) { return NULL; }
+
+        tBitMap *pBitMap = (tBitMap *)pSlot->pData;
+        s_ulChipUsed -= pSlot->ulSize;
+        pSlot->eState = PrefetchState::FREE;
+        pSlot->pData  = NULL;
+        return pBitMap;
+    }
+
+    UBYTE prefetchTakePalette(UWORD uwBackgroundId, UWORD *pPalette, UBYTE ubColorCount)
+    {
+        PrefetchSlot *pSlot = prefetchFind(PrefetchAsset::PALETTE, uwBackgroundId);
+        if (!pSlot || pSlot->eState != PrefetchState::READY) { return 0; }
+
+        UWORD const *pColors = (UWORD const *)pSlot->pData;
+        for (UWORD i = 0; i < ubColorCount; ++i) { pPalette[i] = pColors[i]; }
+
+        prefetchFree(pSlot);
+        return 1;
+    }
+}  // namespace NEONengine
@@ -0,0 +1,108 @@
+#ifndef __PREFETCH_H__INCLUDED__
+#define __PREFETCH_H__INCLUDED__
+
+#include <ace/utils/bitmap.h>
+
+namespace NEONengine
+{
+    /**
+     * @brief Most assets prefetched or queued at once.
+     */
+#define PREFETCH_MAX_ASSETS 16
+
+    /**
+     * @brief Colors kept for each prefetched palette.
+     */
+#define PREFETCH_PALETTE_LENGTH 256
+
+    /**
+     * @brief When prefetched assets are dropped on an allocation failure, see
+     * mtl::add_purger(). Before anything else, they may never be used.
+     */
+#define PREFETCH_PURGE_PRIORITY 0
+
+    /**
+     * @brief The files the prefetcher warms for a scene.
+     */
+    enum class PrefetchAsset : UBYTE
+    {
+        BACKGROUND,  ///< A background of a location, a bitmap in Chip memory
+        PALETTE,     ///< The palette of that background
+    };
+
+    /**
+     * @brief Builds the path of an asset. Backgrounds are numbered across
+     * every location: Location::backgrounds::uwFirstIndex plus
+     * Scene::uwBackgroundId.
+     *
+     * @return char const* The path, which only needs to stay valid until the
+     * next call, or NULL if the asset has no file.
+     */
+    typedef char const *(*tCbPrefetchPath)(PrefetchAsset eAsset, UWORD uwId);
+
+    /**
+     * @brief Sets up the prefetcher.
+     *
+     * @param ulChipBudget Most bytes of Chip memory the prefetched bitmaps can
+     * use together.
+     * @param ulFastBudget Most bytes of Fast memory the prefetched palettes
+     * can use together.
+     * @param cbPath Builds the path of each asset.
+     *
+     * @see prefetchDestroy()
+     */
+    void prefetchCreate(ULONG ulChipBudget, ULONG ulFastBudget, tCbPrefetchPath cbPath);
+
+    /**
+     * @brief Frees everything that was prefetched and not taken.
+     *
+     * @see prefetchCreate()
+     */
+    void prefetchDestroy(void);
+
+    /**
+     * @brief The player entered a scene. Queues the assets of every scene one
+     * of its interactions goes to and frees the prefetched assets none of
+     * them use. Interactions go to scenes of the same location, whose shapes
+     * are loaded already, so only backgrounds and palettes are prefetched.
+     *
+     * @param uwSceneId The scene the player is in, numbered across every
+     * location as gameDataGetScene() takes it.
+     */
+    void prefetchSetScene(UWORD uwSceneId);
+
+    /**
+     * @brief The player took an exit. Cancels whatever is queued for the
+     * other scenes, so only the assets of the one being entered are loaded
+     * from now on.
+     *
+     * @param uwSceneId The scene the player is going to.
+     */
+    void prefetchCommit(UWORD uwSceneId);
+
+    /**
+     * @brief Loads the next queued asset, one per call. Call once per frame
+     * while the player is idle. Does nothing while the loader is busy.
+     */
+    void prefetchProcess(void);
+
+    /**
+     * @brief Hands a prefetched bitmap over to the caller.
+     *
+     * @param eAsset PrefetchAsset::BACKGROUND.
+     * @return tBitMap* The bitmap, to be freed with bitmapDestroy(), or NULL
+     * if it was not prefetched and has to be loaded.
+     */
+    tBitMap *prefetchTakeBitmap(PrefetchAsset eAsset, UWORD uwId);
+
+    /**
+     * @brief Copies a prefetched background palette and frees it.
+     *
+     * @param pPalette Receives ubColorCount colors.
+     * @return UBYTE 1 if it was copied, 0 if it was not prefetched and has to
+     * be loaded.
+     */
+    UBYTE prefetchTakePalette(UWORD uwBackgroundId, UWORD *pPalette, UBYTE ubColorCount);
+}  // namespace NEONengine
+
+#endif  //__PREFETCH_H__INCLUDED__
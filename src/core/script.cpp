@@ -0,0 +1,321 @@
+#include "script.h"
+
+#include <ace/managers/log.h>
+
+#include "core/game_flags.h"
+#include "mtl/bitset.h"
+
+namespace NEONengine
+{
+    using namespace mtl;
+
+    static UWORD const *s_puwCode;
+    static ULONG s_ulCodeSize;
+
+    // One bit per word, set where an instruction starts
+    static dynamic_bitset<MemF::Fast> s_instructionStarts;
+
+    WORD scriptOperandCount(UWORD uwOp)
+    {
+        switch (static_cast<ScriptOp>(uwOp))
+        {
+            case ScriptOp::NOT:
+            case ScriptOp::END:
+            case ScriptOp::COMMAND_140:
+            case ScriptOp::COMMAND_141:
+            case ScriptOp::COMMAND_142:
+            case ScriptOp::MENU_COLUMN: return 0;
+
+            case ScriptOp::PUSH_FLAG:
+            case ScriptOp::AND_FLAG:
+            case ScriptOp::OR_FLAG:
+            case ScriptOp::JUMP:
+            case ScriptOp::JUMP_IF_TRUE:
+            case ScriptOp::JUMP_IF_FALSE:
+            case ScriptOp::SET_SPEAKER:
+            case ScriptOp::START_DIALOGUE:
+            case ScriptOp::GOTO_SCENE:
+            case ScriptOp::SAY:
+            case ScriptOp::MENU_BEGIN: return 1;
+
+            case ScriptOp::CLEAR:
+            case ScriptOp::SET:
+            case ScriptOp::PLAY_SOUND:
+            case ScriptOp::GOTO_LOCATION:
+            case ScriptOp::MENU_ITEM: return 2;
+
+            case ScriptOp::MENU_SHOW: return 3;
+        }
+
+        return -1;
+    }
+
+    /* Internal function. The flag an instruction sets, clears or tests, GAME_FLAG_NONE if none. */
+    static UWORD scriptFlagOperand(UWORD const *puwInstruction)
+    {
+        switch (static_cast<ScriptOp>(puwInstruction[0]))
+        {
+            case ScriptOp::CLEAR:
+            case ScriptOp::SET: return puwInstruction[2];
+
+            case ScriptOp::PUSH_FLAG:
+            case ScriptOp::AND_FLAG:
+            case ScriptOp::OR_FLAG: return puwInstruction[1];
+
+            default: return GAME_FLAG_NONE;
+        }
+    }
+
+    static UBYTE scriptIsJump(UWORD uwOp)
+    {
+        return uwOp == static_cast<UWORD>(ScriptOp::JUMP)
+               || uwOp == static_cast<UWORD>(ScriptOp::JUMP_IF_TRUE)
+               || uwOp == static_cast<UWORD>(ScriptOp::JUMP_IF_FALSE);
+    }
+
+    UBYTE scriptLoad(UWORD const *puwCode, ULONG ulWordCount, ULONG *pulFlagCount)
+    {
+        scriptUnload();
+        if (pulFlagCount) *pulFlagCount = 0;
+        if (!ulWordCount) return 1;
+
+        // Offsets are UWORDs and SCRIPT_NONE is not one
+        if (ulWordCount > SCRIPT_NONE)
+        {
+            logWrite("scriptLoad: %lu words of bytecode is too many", ulWordCount);
+            return 0;
+        }
+
+        if (!s_instructionStarts.resize(ulWordCount))
+        {
+            logWrite("scriptLoad: Unable to allocate the instruction map");
+            return 0;
+        }
+
+        // Decode every instruction once, so scriptRun() can trust the code
+        UWORD uwLastOp    = 0;
+        ULONG ulFlagCount = 0;
+        for (ULONG ulPc = 0; ulPc < ulWordCount;)
+        {
+            UWORD uwOp     = puwCode[ulPc];
+            WORD wOperands = scriptOperandCount(uwOp);
+            if (wOperands < 0 || ulPc + 1 + wOperands > ulWordCount)
+            {
+                logWrite("scriptLoad: Invalid instruction %u at %lu", uwOp, ulPc);
+                scriptUnload();
+                return 0;
+            }
+
+            if ((uwOp == static_cast<UWORD>(ScriptOp::SET)
+                 || uwOp == static_cast<UWORD>(ScriptOp::CLEAR))
+                && puwCode[ulPc + 1] != SCRIPT_STORE_FLAGS)
+            {
+                logWrite("scriptLoad: Unknown store %u at %lu", puwCode[ulPc + 1], ulPc);
+                scriptUnload();
+                return 0;
+            }
+
+            UWORD uwFlag = scriptFlagOperand(puwCode + ulPc);
+            if (uwFlag != GAME_FLAG_NONE && uwFlag >= ulFlagCount) ulFlagCount = uwFlag + 1;
+
+            s_instructionStarts.set(ulPc);
+            uwLastOp = uwOp;
+            ulPc += 1 + wOperands;
+        }
+
+        if (uwLastOp != static_cast<UWORD>(ScriptOp::END)
+            && uwLastOp != static_cast<UWORD>(ScriptOp::JUMP))
+        {
+            logWrite("scriptLoad: The last script does not end");
+            scriptUnload();
+            return 0;
+        }
+
+        for (ULONG ulPc = 0; ulPc < ulWordCount; ulPc += 1 + scriptOperandCount(puwCode[ulPc]))
+        {
+            if (!scriptIsJump(puwCode[ulPc])) continue;
+
+            LONG lTarget = (LONG)ulPc + (WORD)puwCode[ulPc + 1];
+            if (lTarget < 0 || (ULONG)lTarget >= ulWordCount || !s_instructionStarts.test(lTarget))
+            {
+                logWrite("scriptLoad: Jump at %lu to invalid offset %ld", ulPc, lTarget);
+                scriptUnload();
+                return 0;
+            }
+        }
+
+        s_puwCode    = puwCode;
+        s_ulCodeSize = ulWordCount;
+        if (pulFlagCount) *pulFlagCount = ulFlagCount;
+        return 1;
+    }
+
+    void scriptUnload(void)
+    {
+        s_instructionStarts.release();
+        s_puwCode    = 0;
+        s_ulCodeSize = 0;
+    }
+
+    void scriptVmInit(ScriptVm *pVm, tScriptCommandCb cbCommand, void *pUserData)
+    {
+        pVm->cbCommand          = cbCommand;
+        pVm->pUserData          = pUserData;
+        pVm->ulInstructionCount = 0;
+        pVm->uwPc               = 0;
+        pVm->ubStackSize        = 0;
+        pVm->eStatus            = ScriptStatus::IDLE;
+    }
+
+    UBYTE scriptStart(ScriptVm *pVm, UWORD uwOffset)
+    {
+        pVm->eStatus     = ScriptStatus::IDLE;
+        pVm->ubStackSize = 0;
+
+        if (uwOffset >= s_ulCodeSize || !s_instructionStarts.test(uwOffset))
+        {
+            if (uwOffset != SCRIPT_NONE)
+            {
+                logWrite("scriptStart: No script at offset %u", uwOffset);
+            }
+            return 0;
+        }
+
+        pVm->uwPc    = uwOffset;
+        pVm->eStatus = ScriptStatus::RUNNING;
+        return 1;
+    }
+
+    ScriptStatus scriptRun(ScriptVm *pVm, UWORD uwBudget)
+    {
+        if (pVm->eStatus == ScriptStatus::IDLE || pVm->eStatus == ScriptStatus::FAILED)
+        {
+            return pVm->eStatus;
+        }
+
+        // Work on locals, the state is written back once on the way out
+        UWORD const *puwPc     = s_puwCode + pVm->uwPc;
+        UWORD const *puwOp     = puwPc;
+        UWORD *puwTop          = pVm->uwStack + pVm->ubStackSize;
+        UWORD *const puwBottom = pVm->uwStack;
+        UWORD *const puwLimit  = pVm->uwStack + SCRIPT_STACK_SIZE;
+        ScriptStatus eStatus   = ScriptStatus::RUNNING;
+        UWORD uwLeft           = uwBudget;
+        UWORD uwOperands;
+        UBYTE ubContinue;
+
+        // scriptLoad() checked every instruction and jump, so operands are
+        // read without bounds checks. Only the stack depth depends on the
+        // path taken and is checked here.
+        while (uwLeft)
+        {
+            --uwLeft;
+            puwOp      = puwPc;
+            UWORD uwOp = *puwPc++;
+
+            switch (static_cast<ScriptOp>(uwOp))
+            {
+                case ScriptOp::CLEAR:
+                    gameFlagClear(puwPc[1]);
+                    puwPc += 2;
+                    break;
+
+                case ScriptOp::SET:
+                    gameFlagSet(puwPc[1]);
+                    puwPc += 2;
+                    break;
+
+                case ScriptOp::PUSH_FLAG:
+                    if (puwTop == puwLimit) goto overflow;
+                    *puwTop++ = gameFlagIsSet(*puwPc++);
+                    break;
+
+                case ScriptOp::AND_FLAG:
+                    if (puwTop == puwBottom) goto underflow;
+                    puwTop[-1] = puwTop[-1] && gameFlagIsSet(*puwPc);
+                    ++puwPc;
+                    break;
+
+                case ScriptOp::OR_FLAG:
+                    if (puwTop == puwBottom) goto underflow;
+                    puwTop[-1] = puwTop[-1] || gameFlagIsSet(*puwPc);
+                    ++puwPc;
+                    break;
+
+                case ScriptOp::NOT:
+                    if (puwTop == puwBottom) goto underflow;
+                    puwTop[-1] = !puwTop[-1];
+                    break;
+
+                case ScriptOp::JUMP: puwPc = puwOp + (WORD)*puwPc; break;
+
+                case ScriptOp::JUMP_IF_TRUE:
+                    if (puwTop == puwBottom) goto underflow;
+                    puwPc = *--puwTop ? puwOp + (WORD)*puwPc : puwPc + 1;
+                    break;
+
+                case ScriptOp::JUMP_IF_FALSE:
+                    if (puwTop == puwBottom) goto underflow;
+                    puwPc = *--puwTop ? puwPc + 1 : puwOp + (WORD)*puwPc;
+                    break;
+
+                case ScriptOp::END:
+                    eStatus = ScriptStatus::IDLE;
+                    puwTop  = puwBottom;
+                    goto done;
+
+                case ScriptOp::COMMAND_140:
+                case ScriptOp::COMMAND_141:
+                case ScriptOp::COMMAND_142:
+                case ScriptOp::MENU_COLUMN: uwOperands = 0; goto command;
+
+                case ScriptOp::SET_SPEAKER:
+                case ScriptOp::START_DIALOGUE:
+                case ScriptOp::GOTO_SCENE:
+                case ScriptOp::SAY:
+                case ScriptOp::MENU_BEGIN: uwOperands = 1; goto command;
+
+                case ScriptOp::PLAY_SOUND:
+                case ScriptOp::GOTO_LOCATION:
+                case ScriptOp::MENU_ITEM: uwOperands = 2; goto command;
+
+                case ScriptOp::MENU_SHOW:
+                    uwOperands = 3;
+                command:
+                    ubContinue = pVm->cbCommand(static_cast<ScriptOp>(uwOp), puwPc, pVm->pUserData);
+                    puwPc += uwOperands;
+                    if (!ubContinue)
+                    {
+                        eStatus = ScriptStatus::WAITING;
+                        goto done;
+                    }
+                    break;
+
+                default:
+                    logWrite("scriptRun: Invalid instruction %u at %ld",
+                             uwOp,
+                             (LONG)(puwOp - s_puwCode));
+                    goto failed;
+            }
+        }
+        goto done;
+
+    overflow:
+        logWrite("scriptRun: Stack overflow at %ld", (LONG)(puwOp - s_puwCode));
+        goto failed;
+
+    underflow:
+        logWrite("scriptRun: Stack underflow at %ld", (LONG)(puwOp - s_puwCode));
+
+    failed:
+        eStatus = ScriptStatus::FAILED;
+        puwTop  = puwBottom;
+
+    done:
+        pVm->ulInstructionCount += uwBudget - uwLeft;
+        pVm->uwPc        = (UWORD)(puwPc - s_puwCode);
+        pVm->ubStackSize = (UBYTE)(puwTop - puwBottom);
+        pVm->eStatus     = eStatus;
+        return eStatus;
+    }
+}  // namespace NEONengine
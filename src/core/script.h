@@ -0,0 +1,157 @@
+#ifndef __SCRIPT_H__INCLUDED__
+#define __SCRIPT_H__INCLUDED__
+
+#include <ace/types.h>
+
+namespace NEONengine
+{
+    /**
+     * @brief Script offset meaning "no script", as stored in the .neon data.
+     */
+    #define SCRIPT_NONE 0xFFFF
+
+    /**
+     * @brief Number of values a running script can have on its stack.
+     */
+    #define SCRIPT_STACK_SIZE 16
+
+    /**
+     * @brief Instructions a script may run per frame before it is paused
+     * until the next one.
+     */
+    #define SCRIPT_FRAME_BUDGET 256
+
+    /**
+     * @brief Flag store operand of ScriptOp::SET and ScriptOp::CLEAR. It is
+     * the only store the data uses.
+     */
+    #define SCRIPT_STORE_FLAGS 4
+
+    /**
+     * @brief Script opcodes. Each opcode is one UWORD followed by its
+     * operands, one UWORD each. Jump offsets are signed and relative to the
+     * jump's own opcode.
+     *
+     * The VM runs the flag, logic and jump opcodes itself and hands every
+     * command to the command callback.
+     */
+    enum class ScriptOp : UWORD
+    {
+        CLEAR         = 1,    ///< store, flag: clears a flag
+        SET           = 2,    ///< store, flag: sets a flag
+        PUSH_FLAG     = 3,    ///< flag: pushes 1 if set, 0 if not
+        AND_FLAG      = 16,   ///< flag: top = top && flag
+        OR_FLAG       = 17,   ///< flag: top = top || flag
+        NOT           = 18,   ///< top = !top
+        JUMP          = 32,   ///< offset
+        JUMP_IF_TRUE  = 33,   ///< offset: pops, jumps if not 0
+        JUMP_IF_FALSE = 34,   ///< offset: pops, jumps if 0
+        END           = 47,   ///< ends the script
+
+        // Commands
+        SET_SPEAKER    = 48,   ///< speaker slot of the current location
+        START_DIALOGUE = 80,   ///< dialogue
+        PLAY_SOUND     = 112,  ///< sound, unknown
+        GOTO_SCENE     = 128,  ///< scene of the current location
+        GOTO_LOCATION  = 131,  ///< location, scene
+        COMMAND_140    = 140,  ///< meaning unknown
+        COMMAND_141    = 141,  ///< meaning unknown
+        COMMAND_142    = 142,  ///< meaning unknown
+        SAY            = 144,  ///< text
+        MENU_BEGIN     = 145,  ///< flag
+        MENU_SHOW      = 146,  ///< x, y, flag
+        MENU_ITEM      = 147,  ///< text, width
+        MENU_COLUMN    = 148,  ///< starts a new column of items
+    };
+
+    /**
+     * @brief Handles a command.
+     *
+     * @param eOp The command.
+     * @param puwArgs Its operands, see ScriptOp.
+     * @param pUserData Pointer given to scriptVmInit().
+     * @return UBYTE 1 to carry on, 0 to pause the script until the next
+     * scriptRun(), e.g. while a line of text waits for a click.
+     */
+    typedef UBYTE (*tScriptCommandCb)(ScriptOp eOp, UWORD const *puwArgs, void *pUserData);
+
+    /**
+     * @brief Result of scriptRun().
+     */
+    enum class ScriptStatus : UBYTE
+    {
+        IDLE,      ///< No script, or the script ended
+        RUNNING,   ///< Ran out of budget, call scriptRun() again next frame
+        WAITING,   ///< Paused by the command callback
+        FAILED,    ///< Stack overflow or underflow, the script was stopped
+    };
+
+    /**
+     * @brief State of one running script. Holds everything a script needs,
+     * so running one never allocates.
+     */
+    struct ScriptVm
+    {
+        tScriptCommandCb cbCommand;
+        void *pUserData;
+        ULONG ulInstructionCount;  ///< Instructions run since scriptVmInit()
+        UWORD uwPc;
+        UBYTE ubStackSize;
+        ScriptStatus eStatus;
+        UWORD uwStack[SCRIPT_STACK_SIZE];
+    };
+
+    /**
+     * @brief Number of operands of an opcode.
+     *
+     * @return WORD The count, or -1 if the opcode is unknown.
+     */
+    WORD scriptOperandCount(UWORD uwOp);
+
+    /**
+     * @brief Checks the bytecode and makes it the code scripts run from.
+     * Every instruction must be known, have all its operands and jump to the
+     * start of an instruction, and the code must not run off its end.
+     * Called by gameDataLoad().
+     *
+     * @param puwCode The bytecode, kept by reference.
+     * @param ulWordCount Number of words.
+     * @param pulFlagCount If not NULL, receives the number of flags needed
+     * to cover every flag the code sets, clears or tests.
+     * @return UBYTE 1 on success, 0 if the code is invalid or out of memory.
+     *
+     * @see scriptUnload()
+     */
+    UBYTE scriptLoad(UWORD const *puwCode, ULONG ulWordCount, ULONG *pulFlagCount = nullptr);
+
+    /**
+     * @brief Forgets the bytecode. Scripts must not be run afterwards.
+     */
+    void scriptUnload(void);
+
+    /**
+     * @brief Prepares a VM with no script.
+     */
+    void scriptVmInit(ScriptVm *pVm, tScriptCommandCb cbCommand, void *pUserData);
+
+    /**
+     * @brief Starts a script, dropping the one the VM was running.
+     *
+     * @param uwOffset Offset of the script, e.g. Interaction::uwScriptOffset.
+     * @return UBYTE 1 if started, 0 for SCRIPT_NONE or an offset that is not
+     * the start of an instruction.
+     */
+    UBYTE scriptStart(ScriptVm *pVm, UWORD uwOffset);
+
+    /**
+     * @brief Runs the script until it ends, waits, or has run uwBudget
+     * instructions.
+     *
+     * @param uwBudget Maximum number of instructions, SCRIPT_FRAME_BUDGET
+     * once per frame.
+     * @return ScriptStatus State of the script afterwards.
+     */
+    ScriptStatus scriptRun(ScriptVm *pVm, UWORD uwBudget);
+}
+
+#endif // __SCRIPT_H__INCLUDED__
@@ -2,12 +2,15 @@
 
 #include "neonengine.h"
 
-#include <ace/utils/disk_file.h>
+#include <ace/utils/file.h>
 
 #include <ace++/log.h>
 
+#include <mtl/alloc_stats.h>
 #include <mtl/utility.h>
 
+#include "core/vfs.h"
+
 namespace NEONengine
 {
     using namespace mtl;
@@ -32,36 +35,155 @@ namespace NEONengine
     {
         uint32_t chunkName;
         uint32_t stringCount;
-        size_t dataSize;
+        uint32_t dataSize;
+    };
+
+    // Follows the string chunk header from version 3 on
+    struct string_index_header
+    {
+        uint16_t offsetBytes;  // 2 for group relative offsets, 3 for absolute ones
+        uint16_t encoding;     // One of the STRING_ENCODING values
+    };
+
+    // Follows the index header of compressed tables, then the literals and pairs
+    struct string_dictionary_header
+    {
+        uint16_t literalCount;
+        uint16_t pairCount;
+        uint16_t maxLength;
+        uint16_t reserved;
     };
 
     constexpr char MAGIC[4]        = { 'N', 'O', 'I', 'R' };
     constexpr char STRING_CHUNK[4] = { 'S', 'T', 'R', 'G' };
 
-    constexpr uint16_t SUPPORTED_VERSION = 2;
+    constexpr uint16_t SUPPORTED_VERSION = 3;
+    constexpr uint16_t INDEX_VERSION     = 3;
+
+    constexpr uint16_t STRING_ENCODING_PLAIN = 0;  // Length then characters
+    constexpr uint16_t STRING_ENCODING_PAIRS = 1;  // Codes, up to the offset of the next string
+
+    /**
+     * @brief Bytes of an index, padded so the strings stay long aligned.
+     */
+    constexpr uint32_t index_size(uint32_t count, uint16_t offsetBytes)
+    {
+        uint32_t size = offsetBytes == 2
+                            ? (count + STRING_GROUP_SIZE - 1) / STRING_GROUP_SIZE * 4 + count * 2
+                            : count * 3;
+        return to<uint32_t>(round_up<4>(size));
+    }
 
     string_table::~string_table()
     {
-        delete[] _pData;
+        if (!_pArena) { mtl::sized_free(_pBlock, _blockSize); }
+    }
+
+    void string_table_delete(string_table* pTable)
+    {
+        if (pTable->_pArena) { mtl::destroy_in_place(pTable); }
+        else { mtl::sized_delete(pTable); }
+    }
+
+    uint32_t string_table::offset_of(uint32_t id) const
+    {
+        if (_pGroupBases)
+        {
+            return _pGroupBases[id / STRING_GROUP_SIZE]
+                   + reinterpret_cast<uint16_t const*>(_pOffsets)[id];
+        }
+
+        uint8_t const* pOffset = _pOffsets + id * 3;
+        return to<uint32_t>(pOffset[0]) << 16 | to<uint32_t>(pOffset[1]) << 8 | pOffset[2];
+    }
+
+    uint32_t string_table::decode(uint32_t id, char* pDest, uint32_t destSize) const
+    {
+        uint8_t const* pCode = _pStrings + offset_of(id);
+        uint8_t const* pEnd  = _pStrings + (id + 1 < _count ? offset_of(id + 1) : _dataSize);
+
+        // A pair is replaced by its two codes, the first on top, until only characters are left
+        uint8_t stack[STRING_PAIR_DEPTH + 1];
+        uint32_t length = 0;
+        for (; pCode < pEnd; ++pCode)
+        {
+            uint32_t top = 0;
+            stack[top++] = *pCode;
+            while (top)
+            {
+                uint8_t code = stack[--top];
+                if (code < _literalCount)
+                {
+                    if (length == destSize) return length;
+                    pDest[length++] = to<char>(_pLiterals[code]);
+                }
+                else
+                {
+                    uint8_t const* pPair = _pPairs + (code - _literalCount) * 2;
+                    stack[top++]         = pPair[1];
+                    stack[top++]         = pPair[0];
+                }
+            }
+        }
+        return length;
     }
 
     bstr_view const string_table::get_string(uint32_t id) const
     {
-        if (id >= _offsets.size()) return bstr_view();
+        if (id >= _count) return bstr_view();
+        if (!_pPairs) return bstr_view::from_bstr(_pStrings + offset_of(id));
 
-        return bstr_view::from_bstr(_offsets[id]);
+        cache_slot* pSlot = &_slots[0];
+        for (auto& slot : _slots)
+        {
+            if (slot.lastUse && slot.id == id)
+            {
+                slot.lastUse = ++_clock;
+                return bstr_view(_pCache + (&slot - _slots) * _maxLength, slot.length);
+            }
+            if (slot.lastUse < pSlot->lastUse) pSlot = &slot;
+        }
+
+        char* pText    = _pCache + (pSlot - _slots) * _maxLength;
+        pSlot->id      = id;
+        pSlot->length  = decode(id, pText, _maxLength);
+        pSlot->lastUse = ++_clock;
+        return bstr_view(pText, pSlot->length);
     }
 
-    string_table::result string_table::create_from_file(char const* szFilePath)
+    bstr_view const string_table::get_string(uint32_t id, char* pBuffer, uint32_t bufferSize) const
     {
-        return create_from_fd(diskFileOpen(szFilePath, DISK_FILE_MODE_READ, 1));
+        if (id >= _count) return bstr_view();
+        if (!_pPairs) return bstr_view::from_bstr(_pStrings + offset_of(id));
+
+        return bstr_view(pBuffer, decode(id, pBuffer, bufferSize));
     }
 
-    string_table::result string_table::create_from_fd(tFile* pFile)
+    string_table::result string_table::create_from_file(char const* szFilePath, mtl::arena* pArena)
+    {
+        tFile* pFile = vfsOpen(szFilePath);
+        if (!pFile)
+        {
+            NE_LOG("Could not open '%s'", szFilePath);
+            return mtl::make_error<string_table_ptr, error_code>(error_code::MISSING_HEADER);
+        }
+
+        auto result = create_from_fd(pFile, pArena);
+        fileClose(pFile);
+        return result;
+    }
+
+    string_table::result string_table::create_from_fd(tFile* pFile, mtl::arena* pArena)
     {
         ACE_LOG_BLOCK("NEONengine::string_table::create_from_fd");
+        auto tag = alloc_tag_scope(alloc_tag::Text);
 
-        auto pTable = string_table_ptr(new (MemF::Fast) string_table());
+        auto pTable = string_table_ptr(pArena ? new (*pArena) string_table(pArena)
+                                              : mtl::make_unique<string_table>().release());
+        if (!pTable)
+        {
+            return mtl::make_error<string_table_ptr, error_code>(error_code::OUT_OF_MEMORY);
+        }
 
         noir_header header;
         fileRead(pFile, &header, sizeof(noir_header));
@@ -105,17 +227,117 @@ namespace NEONengine
                 string_table::error_code::MISSING_STRING_HEADER);
         }
 
-        pTable->_offsets.reserve(string_header.stringCount);
-        pTable->_pData = new (mtl::MemF::Fast) uint8_t[string_header.dataSize];
-        fileRead(pFile, pTable->_pData, string_header.dataSize);
+        // Version 2 files have no index, one of absolute offsets is built for them
+        string_index_header index_header = { 3, STRING_ENCODING_PLAIN };
+        if (header.version >= INDEX_VERSION)
+        {
+            fileRead(pFile, &index_header, sizeof(string_index_header));
+            if (index_header.offsetBytes != 2 && index_header.offsetBytes != 3)
+            {
+                NE_LOG("Unsupported string offsets of %u bytes", index_header.offsetBytes);
+                return mtl::make_error<string_table_ptr, error_code>(error_code::INVALID_INDEX);
+            }
+        }
 
-        auto pCurrent = mtl::force_to<char*>(pTable->_pData);
+        string_dictionary_header dictionary_header = { 0, 0, 0, 0 };
+        if (index_header.encoding == STRING_ENCODING_PAIRS)
+        {
+            fileRead(pFile, &dictionary_header, sizeof(string_dictionary_header));
+            if (!dictionary_header.pairCount
+                || dictionary_header.literalCount + dictionary_header.pairCount > 256)
+            {
+                NE_LOG("Invalid dictionary of %u codes",
+                       dictionary_header.literalCount + dictionary_header.pairCount);
+                return mtl::make_error<string_table_ptr, error_code>(error_code::INVALID_INDEX);
+            }
+        }
+        else if (index_header.encoding != STRING_ENCODING_PLAIN)
+        {
+            NE_LOG("Unsupported string encoding %u", index_header.encoding);
+            return mtl::make_error<string_table_ptr, error_code>(error_code::INVALID_INDEX);
+        }
 
-        for (size_t index = 0; index < string_header.stringCount; ++index)
+        uint32_t dictionarySize = to<uint32_t>(
+            round_up<4>(dictionary_header.literalCount + dictionary_header.pairCount * 2));
+        uint32_t indexSize = index_size(string_header.stringCount, index_header.offsetBytes);
+        uint32_t cacheSize = dictionary_header.pairCount
+                                 ? STRING_CACHE_SLOTS * dictionary_header.maxLength
+                                 : 0;
+        pTable->_count     = string_header.stringCount;
+        pTable->_dataSize  = string_header.dataSize;
+        pTable->_blockSize = dictionarySize + indexSize + string_header.dataSize + cacheSize;
+        pTable->_pBlock    = static_cast<uint8_t*>(
+            pArena ? pArena->allocate(pTable->_blockSize)
+                   : mtl::sized_alloc(pTable->_blockSize, MEMF_FAST));
+        if (!pTable->_pBlock)
         {
-            pTable->_offsets.push_back(pCurrent);
-            auto string = bstr_view::from_bstr(mtl::force_to<void*>(pCurrent));
-            pCurrent += (sizeof(uint32_t) + string.length());
+            pTable->_blockSize = 0;
+            return mtl::make_error<string_table_ptr, error_code>(error_code::OUT_OF_MEMORY);
+        }
+
+        uint8_t* pIndex   = pTable->_pBlock + dictionarySize;
+        pTable->_pOffsets = pIndex;
+        pTable->_pStrings = pIndex + indexSize;
+        if (index_header.offsetBytes == 2)
+        {
+            uint32_t basesSize
+                = (string_header.stringCount + STRING_GROUP_SIZE - 1) / STRING_GROUP_SIZE * 4;
+            pTable->_pGroupBases = mtl::force_to<uint32_t const*>(pIndex);
+            pTable->_pOffsets    = pIndex + basesSize;
+        }
+
+        if (header.version >= INDEX_VERSION)
+        {
+            fileRead(pFile, pTable->_pBlock, pTable->_blockSize - cacheSize);
+        }
+        else
+        {
+            uint8_t* pStrings = pIndex + indexSize;
+            fileRead(pFile, pStrings, string_header.dataSize);
+
+            uint32_t offset = 0;
+            for (uint32_t index = 0; index < string_header.stringCount; ++index)
+            {
+                uint8_t* pOffset = pTable->_pBlock + index * 3;
+                pOffset[0]       = to<uint8_t>(offset >> 16);
+                pOffset[1]       = to<uint8_t>(offset >> 8);
+                pOffset[2]       = to<uint8_t>(offset);
+                offset += sizeof(uint32_t) + bstr_view::from_bstr(pStrings + offset).length();
+            }
+        }
+
+        if (dictionary_header.pairCount)
+        {
+            // Codes only pair up earlier ones, so the depth of each is known by the time it is met
+            uint8_t const* pPairs = pTable->_pBlock + dictionary_header.literalCount;
+            uint8_t depths[256];
+            for (uint32_t pair = 0; pair < dictionary_header.pairCount; ++pair)
+            {
+                uint32_t code   = dictionary_header.literalCount + pair;
+                uint32_t first  = pPairs[pair * 2];
+                uint32_t second = pPairs[pair * 2 + 1];
+                if (first >= code || second >= code)
+                {
+                    NE_LOG("Invalid pair of codes %u", code);
+                    return mtl::make_error<string_table_ptr, error_code>(error_code::INVALID_INDEX);
+                }
+
+                uint8_t depthFirst  = first < dictionary_header.literalCount ? 0 : depths[first];
+                uint8_t depthSecond = second < dictionary_header.literalCount ? 0 : depths[second];
+                depths[code]        = 1 + (depthFirst > depthSecond ? depthFirst : depthSecond);
+                if (depths[code] > STRING_PAIR_DEPTH)
+                {
+                    NE_LOG("Pairs of codes nested deeper than %u", STRING_PAIR_DEPTH);
+                    return mtl::make_error<string_table_ptr, error_code>(error_code::INVALID_INDEX);
+                }
+            }
+
+            pTable->_pLiterals    = pTable->_pBlock;
+            pTable->_pPairs       = pPairs;
+            pTable->_literalCount = dictionary_header.literalCount;
+            pTable->_maxLength    = dictionary_header.maxLength;
+            pTable->_pCache
+                = reinterpret_cast<char*>(pTable->_pBlock + pTable->_blockSize - cacheSize);
         }
 
         return mtl::make_success<string_table_ptr, error_code>(mtl::move(pTable));
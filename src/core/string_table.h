@@ -4,6 +4,16 @@
  *
  * Provides a container for loading and accessing localized strings from a file or file descriptor.
  * Uses bstr_view for efficient string access and mtl::expected for error handling.
+ *
+ * Version 3 .noir files, as written by tools/noir/noirpack, carry an index of 16 bit offsets
+ * relative to a base every STRING_GROUP_SIZE strings, or of 24 bit offsets when the strings of a
+ * group span 64 KB or more. The index and the strings are read in one go and looked up as they
+ * are. Version 2 files have no index, so one of 24 bit offsets is built while loading them.
+ *
+ * Version 3 files can also be compressed, with each string a sequence of byte codes that are
+ * either a character or a pair of codes, see tools/noir/noirpack.cpp. Those stay compressed in
+ * memory, and a string is decoded when it is asked for, into a buffer of the caller or into one
+ * of the STRING_CACHE_SLOTS the table keeps of the strings it decoded last.
  */
 
 #ifndef __STRING_TABLE__INCLUDED__
@@ -13,14 +23,39 @@
 
 #include <ace/utils/file.h>
 
+#include <mtl/arena.h>
 #include <mtl/expected.h>
 #include <mtl/memory.h>
-#include <mtl/vector.h>
 
 #include "utils/bstr_view.h"
 
 namespace NEONengine
 {
+    /**
+     * @brief Strings sharing a base offset in a version 3 index.
+     */
+    constexpr uint32_t STRING_GROUP_SIZE = 64;
+
+    /**
+     * @brief Most recently decoded strings a compressed table keeps.
+     */
+    constexpr uint32_t STRING_CACHE_SLOTS = 8;
+
+    /**
+     * @brief Deepest nesting of pairs in a compressed table, which sizes the decoder's stack.
+     */
+    constexpr uint32_t STRING_PAIR_DEPTH = 24;
+
+    class string_table;
+
+    /**
+     * @brief Deleter of string_table_ptr. Destroys the table, and frees it unless it lives in an
+     * arena, whose memory is left to the arena.
+     */
+    void string_table_delete(string_table* pTable);
+
+    using string_table_ptr = mtl::unique_ptr<string_table, string_table_delete>;
+
     /**
      * @class string_table
      * @brief Table of localized strings loaded from file.
@@ -31,9 +66,6 @@ namespace NEONengine
      * if (result) { auto str = result.value()->get_string(42); }
      * @endcode
      */
-    class string_table;
-    using string_table_ptr = mtl::unique_ptr<string_table>;
-
     class string_table
     {
         public:  ///////////////////////////////////////////////////////////////////////////////////
@@ -46,6 +78,8 @@ namespace NEONengine
             VERSION_NOT_SUPPORTED,
             UNSUPPORTED_LANGUAGE,
             MISSING_STRING_HEADER,
+            INVALID_INDEX,
+            OUT_OF_MEMORY,
         };
 
         /**
@@ -67,41 +101,153 @@ namespace NEONengine
          */
         string_table() = default;
 
+        /**
+         * @brief Constructor for a table whose storage lives in an arena.
+         * @param pArena Arena holding the strings and their index.
+         */
+        explicit string_table(mtl::arena* pArena)
+            : _pArena(pArena)
+        {}
+
         ~string_table();
 
         NO_COPY(string_table)
         USE_DEFAULT_MOVE(string_table)
 
+        friend void string_table_delete(string_table* pTable);
+
         /**
          * @brief Get a string by its ID.
+         *
+         * Strings of a compressed table are decoded into the least recently used of the
+         * table's cache slots, so the view only stays valid until STRING_CACHE_SLOTS other
+         * strings have been decoded. Use the other overload to keep a string longer.
+         *
          * @param id String identifier.
          * @return bstr_view of the string, or empty if not found.
          */
         bstr_view const get_string(uint32_t id) const;
 
+        /**
+         * @brief Get a string by its ID, decoding it into a buffer of the caller.
+         * @param id String identifier.
+         * @param pBuffer Where to decode the string, of max_length() bytes to hold any. Not
+         * used by tables that are not compressed, the view is then of the table.
+         * @param bufferSize Size of the buffer, longer strings are cut short.
+         * @return bstr_view of the string, or empty if not found.
+         */
+        bstr_view const get_string(uint32_t id, char* pBuffer, uint32_t bufferSize) const;
+
+        /**
+         * @brief Length of the longest string of a compressed table, 0 for the others.
+         */
+        uint32_t max_length() const { return _maxLength; }
+
+        /**
+         * @brief Whether the strings are compressed, and decoded when asked for.
+         */
+        bool is_compressed() const { return _pPairs != nullptr; }
+
         /**
          * @brief Create a string_table from a file path.
-         * @param szFilePath Path to the file.
+         * @param szFilePath Path to the file, opened with vfsOpen().
+         * @param pArena Arena to place the table in, or nullptr to use the heap.
          * @return result (success: string_table_ptr, error: error_code)
          */
-        static result create_from_file(char const* szFilePath);
+        static result create_from_file(char const* szFilePath, mtl::arena* pArena = nullptr);
 
         /**
          * @brief Create a string_table from a file descriptor.
-         * @param pFile Pointer to tFile.
+         * @param pFile Pointer to tFile, which is left open.
+         * @param pArena Arena to place the table in, or nullptr to use the heap.
          * @return result (success: string_table_ptr, error: error_code)
          */
-        static result create_from_fd(tFile* pFile);
+        static result create_from_fd(tFile* pFile, mtl::arena* pArena = nullptr);
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief A string decoded into the cache.
+         */
+        struct cache_slot
+        {
+            uint32_t id;
+            uint32_t length;
+            uint32_t lastUse;
+        };
+
+        /**
+         * @brief Offset of a string from _pStrings.
+         */
+        uint32_t offset_of(uint32_t id) const;
+
+        /**
+         * @brief Decodes a compressed string.
+         * @return Number of characters written, at most destSize.
+         */
+        uint32_t decode(uint32_t id, char* pDest, uint32_t destSize) const;
 
         private:  //////////////////////////////////////////////////////////////////////////////////
         /**
-         * @brief Offsets to each string in the data block.
+         * @brief The dictionary, index, strings and cache, in one allocation.
+         */
+        uint8_t* _pBlock{ nullptr };
+        /**
+         * @brief Size of the block in bytes.
+         */
+        uint32_t _blockSize{ 0 };
+        /**
+         * @brief Base offset of each group of strings, nullptr for 24 bit offsets.
+         */
+        uint32_t const* _pGroupBases{ nullptr };
+        /**
+         * @brief Offset of each string, 16 bit from its group base, or 24 bit.
+         */
+        uint8_t const* _pOffsets{ nullptr };
+        /**
+         * @brief The strings the offsets are from.
+         */
+        uint8_t const* _pStrings{ nullptr };
+        /**
+         * @brief Number of strings.
+         */
+        uint32_t _count{ 0 };
+        /**
+         * @brief Size of the strings, which is where the last one ends.
+         */
+        uint32_t _dataSize{ 0 };
+        /**
+         * @brief Character of each code below _literalCount, of a compressed table.
+         */
+        uint8_t const* _pLiterals{ nullptr };
+        /**
+         * @brief The two codes each code from _literalCount on stands for, nullptr unless
+         * compressed.
+         */
+        uint8_t const* _pPairs{ nullptr };
+        /**
+         * @brief Number of codes that are characters.
+         */
+        uint32_t _literalCount{ 0 };
+        /**
+         * @brief Length of the longest string, and of each cache slot.
+         */
+        uint32_t _maxLength{ 0 };
+        /**
+         * @brief STRING_CACHE_SLOTS buffers of _maxLength characters.
+         */
+        char* _pCache{ nullptr };
+        /**
+         * @brief What each buffer of the cache holds.
+         */
+        mutable cache_slot _slots[STRING_CACHE_SLOTS]{};
+        /**
+         * @brief Counts the lookups, to find the least recently used slot.
          */
-        mtl::vector<void*> _offsets;
+        mutable uint32_t _clock{ 0 };
         /**
-         * @brief Raw data block containing all strings.
+         * @brief Arena owning the table's memory, if any.
          */
-        uint8_t* _pData{ nullptr };
+        mtl::arena* _pArena{ nullptr };
     };
 }  // namespace NEONengine
 
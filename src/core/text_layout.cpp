@@ -0,0 +1,103 @@
+#include "text_layout.h"
+
+#include <mtl/utility.h>
+
+namespace NEONengine
+{
+    using namespace mtl;
+
+    bool text_break_line(bstr_view const& text,
+                         uint32_t* pStartIndex,
+                         uint32_t maxWidth,
+                         uint16_t const* pGlyphWidths,
+                         text_line* pOutLine)
+    {
+        uint32_t endOfLine    = 0u;
+        uint32_t lineWidth    = 0u;
+        uint32_t offset       = 1u;
+        uint32_t lastSpacePos = 0u;
+
+        if (text.is_empty() || *pStartIndex >= text.length()) { return false; }
+
+        auto textLength     = text.length();
+        auto const textData = text.data();
+
+        // Early exit for newline-only cases
+        if (textData[*pStartIndex] == '\n')
+        {
+            pOutLine->start = *pStartIndex;
+            pOutLine->end   = *pStartIndex;
+            *pStartIndex += 1;
+            return *pStartIndex <= textLength;
+        }
+
+        // NOTE: We go one character beyond the string length to catch the null terminator
+        for (uint32_t idx = *pStartIndex; idx <= textLength; ++idx)
+        {
+            char c = (idx < textLength) ? textData[idx] : '\0';
+
+            if (c == ' ')
+            {
+                lastSpacePos = idx;
+                endOfLine    = idx;
+            }
+            else if (c == '\n' || c == '\0')
+            {
+                endOfLine = idx;
+                break;
+            }
+
+            if (c >= ' ')
+            {
+                uint16_t glyphWidth = pGlyphWidths[to<uint8_t>(c)];
+
+                lineWidth += glyphWidth + 1;  // +1 for spacing
+
+                if (maxWidth > 0 && lineWidth > maxWidth)
+                {
+                    // Prefer breaking at last space, otherwise break at current position
+                    endOfLine = (lastSpacePos > *pStartIndex) ? lastSpacePos : idx;
+                    offset    = (endOfLine == lastSpacePos) ? 1 : 0;
+                    break;
+                }
+            }
+        }
+
+        if (endOfLine == 0) { endOfLine = textLength; }
+
+        pOutLine->start = *pStartIndex;
+        pOutLine->end   = endOfLine;
+        *pStartIndex    = endOfLine + offset;
+        return true;
+    }
+
+    uint16_t text_line_width(bstr_view const& text,
+                             text_line const& line,
+                             uint16_t const* pGlyphWidths)
+    {
+        uint16_t width = 0;
+        for (uint32_t idx = line.start; idx < line.end; ++idx)
+        {
+            width += pGlyphWidths[to<uint8_t>(text.data()[idx])] + 1;
+        }
+        return width;
+    }
+
+    uint16_t text_justify_line(uint16_t lineWidth, uint16_t maxWidth, text_justify justification)
+    {
+        // A line that does not fit starts at the left, whatever the justification
+        if (lineWidth >= maxWidth) { return 0; }
+
+        switch (justification)
+        {
+            case text_justify::RIGHT:  //
+                return maxWidth - lineWidth;
+
+            case text_justify::CENTER:  //
+                return (maxWidth - lineWidth) >> 1;
+
+            case text_justify::LEFT:  // fallthrough
+            default: return 0;
+        }
+    }
+}  // namespace NEONengine
@@ -0,0 +1,83 @@
+/**
+ * @file text_layout.h
+ * @brief Line breaking and justification of text.
+ *
+ * Used by text_renderer to lay out text as it renders it, and by tools/noir/noirpack to lay out
+ * the text of every text region at build time, see text_layout_table.h. Both go through these
+ * functions, so the lines come out the same. Nothing here depends on ACE.
+ */
+#ifndef __TEXT_LAYOUT__INCLUDED_H__
+#define __TEXT_LAYOUT__INCLUDED_H__
+
+#include <stdint.h>
+
+#include "utils/bstr_view.h"
+
+namespace NEONengine
+{
+    /**
+     * @enum text_justify
+     * @brief Defines how the text should be justified horizontally.
+     */
+    enum class text_justify
+    {
+        LEFT,
+        RIGHT,
+        CENTER,
+    };
+
+    /**
+     * @brief A line of a text, as the range of its characters and where it starts.
+     */
+    struct text_line
+    {
+        uint16_t start;
+        uint16_t end;
+        uint16_t x;  ///< From the left of the text, once justified
+
+        /**
+         * @brief Get the length of the line.
+         * @return Number of characters in the line.
+         */
+        size_t length() const { return end - start; }
+    };
+
+    /**
+     * @brief The lines of a text, as laid out for a text region, see text_layout_table.h.
+     */
+    struct text_layout
+    {
+        text_line const* pLines;
+        uint16_t lineCount;  ///< 0 if the text was not laid out
+    };
+
+    /**
+     * @brief Finds the next line of a text, breaking at the last space that fits, or in the
+     * middle of a word that does not fit on a line of its own.
+     * @param text The text.
+     * @param pStartIndex Where the line starts, moved past it and the space it broke at.
+     * @param maxWidth Widest the line can be, 0 for no limit.
+     * @param pGlyphWidths Width of each of the 256 characters, as fontGlyphWidth() returns.
+     * @param pOutLine Receives the range of the line, its x is left alone.
+     * @return false once the text is done.
+     */
+    bool text_break_line(bstr_view const& text,
+                         uint32_t* pStartIndex,
+                         uint32_t maxWidth,
+                         uint16_t const* pGlyphWidths,
+                         text_line* pOutLine);
+
+    /**
+     * @brief Width of a line as fontFillTextBitMap() measures it, a pixel after each glyph.
+     */
+    uint16_t text_line_width(bstr_view const& text,
+                             text_line const& line,
+                             uint16_t const* pGlyphWidths);
+
+    /**
+     * @brief Where a line of the given width starts within maxWidth, 0 if it is as wide or wider.
+     */
+    uint16_t text_justify_line(uint16_t lineWidth, uint16_t maxWidth, text_justify justification);
+}  // namespace NEONengine
+
+#endif  // __TEXT_LAYOUT__INCLUDED_H__
@@ -0,0 +1,124 @@
+#include "text_layout_table.h"
+
+#include "neonengine.h"
+
+#include <ace/utils/file.h>
+
+#include <ace++/log.h>
+
+#include <mtl/alloc_stats.h>
+#include <mtl/utility.h>
+
+namespace NEONengine
+{
+    using namespace mtl;
+
+    struct layout_chunk_header
+    {
+        uint32_t chunkName;
+        uint32_t entryCount;
+        uint32_t lineCount;
+    };
+
+    constexpr uint32_t LAYOUT_CHUNK = 0x4C415954;  // 'LAYT'
+
+    bool text_layout_table::precedes(entry const& lhs, entry const& rhs)
+    {
+        if (lhs.textId != rhs.textId) { return lhs.textId < rhs.textId; }
+        if (lhs.width != rhs.width) { return lhs.width < rhs.width; }
+        return lhs.justification < rhs.justification;
+    }
+
+    text_layout_table::~text_layout_table()
+    {
+        if (!_pArena) { mtl::sized_free(_pBlock, _blockSize); }
+    }
+
+    void text_layout_table_delete(text_layout_table* pTable)
+    {
+        if (pTable->_pArena) { mtl::destroy_in_place(pTable); }
+        else { mtl::sized_delete(pTable); }
+    }
+
+    text_layout text_layout_table::find(uint16_t textId,
+                                        uint16_t width,
+                                        text_justify justification) const
+    {
+        entry const key = { textId, width, to<uint8_t>(justification), 0, 0 };
+
+        uint32_t low  = 0;
+        uint32_t high = _entryCount;
+        while (low < high)
+        {
+            uint32_t mid       = (low + high) >> 1;
+            entry const& found = _pEntries[mid];
+
+            if (found.textId == key.textId && found.width == key.width
+                && found.justification == key.justification)
+            {
+                return { _pLines + found.firstLine, found.lineCount };
+            }
+            if (precedes(found, key)) { low = mid + 1; }
+            else { high = mid; }
+        }
+
+        return { nullptr, 0 };
+    }
+
+    text_layout_table::result text_layout_table::create_from_fd(tFile* pFile, mtl::arena* pArena)
+    {
+        ACE_LOG_BLOCK("NEONengine::text_layout_table::create_from_fd");
+        auto tag = alloc_tag_scope(alloc_tag::Text);
+
+        layout_chunk_header header;
+        if (fileRead(pFile, &header, sizeof(layout_chunk_header)) != sizeof(layout_chunk_header)
+            || header.chunkName != LAYOUT_CHUNK)
+        {
+            NE_LOG("No text layouts after the strings");
+            return mtl::make_error<text_layout_table_ptr, error_code>(error_code::MISSING_HEADER);
+        }
+
+        auto pTable = text_layout_table_ptr(
+            pArena ? new (*pArena) text_layout_table(pArena)
+                   : mtl::make_unique<text_layout_table>().release());
+        if (!pTable)
+        {
+            return mtl::make_error<text_layout_table_ptr, error_code>(error_code::OUT_OF_MEMORY);
+        }
+
+        uint32_t entriesSize = header.entryCount * sizeof(entry);
+        pTable->_entryCount  = header.entryCount;
+        pTable->_blockSize   = entriesSize + header.lineCount * sizeof(text_line);
+        pTable->_pBlock      = static_cast<uint8_t*>(
+            pArena ? pArena->allocate(pTable->_blockSize)
+                        : mtl::sized_alloc(pTable->_blockSize, MEMF_FAST));
+        if (!pTable->_pBlock)
+        {
+            pTable->_blockSize = 0;
+            return mtl::make_error<text_layout_table_ptr, error_code>(error_code::OUT_OF_MEMORY);
+        }
+
+        // Entries then lines, read as they are looked up
+        if (fileRead(pFile, pTable->_pBlock, pTable->_blockSize) != pTable->_blockSize)
+        {
+            NE_LOG("Text layouts end before their %lu lines", header.lineCount);
+            return mtl::make_error<text_layout_table_ptr, error_code>(error_code::CORRUPTED);
+        }
+        pTable->_pEntries = mtl::force_to<entry const*>(pTable->_pBlock);
+        pTable->_pLines   = mtl::force_to<text_line const*>(pTable->_pBlock + entriesSize);
+
+        for (uint32_t index = 0; index < header.entryCount; ++index)
+        {
+            entry const& layout = pTable->_pEntries[index];
+            if (layout.firstLine + layout.lineCount > header.lineCount
+                || (index && !precedes(pTable->_pEntries[index - 1], layout)))
+            {
+                NE_LOG("Text layout %lu is out of order or its lines out of range", index);
+                return mtl::make_error<text_layout_table_ptr, error_code>(error_code::CORRUPTED);
+            }
+        }
+
+        NE_LOG("Text layouts: %lu texts, %lu lines", header.entryCount, header.lineCount);
+        return mtl::make_success<text_layout_table_ptr, error_code>(mtl::move(pTable));
+    }
+}  // namespace NEONengine
@@ -0,0 +1,147 @@
+/**
+ * @file text_layout_table.h
+ * @brief Lines of the text of every text region, laid out at build time.
+ *
+ * A text region fixes the width and justification of its text, and the font is fixed too, so
+ * tools/noir/noirpack lays the text of each one out when it builds the string table of a
+ * language, and writes the lines and where each starts after the strings. The table is read
+ * from the same file right after the strings, see core/language.h, and
+ * text_renderer::create_text() renders from it without breaking or measuring anything.
+ */
+
+#ifndef __TEXT_LAYOUT_TABLE__INCLUDED__
+#define __TEXT_LAYOUT_TABLE__INCLUDED__
+
+#include <stdint.h>
+
+#include <ace/utils/file.h>
+
+#include <mtl/arena.h>
+#include <mtl/expected.h>
+#include <mtl/memory.h>
+
+#include "core/text_layout.h"
+
+namespace NEONengine
+{
+    class text_layout_table;
+
+    /**
+     * @brief Deleter of text_layout_table_ptr. Destroys the table, and frees it unless it lives in
+     * an arena, whose memory is left to the arena.
+     */
+    void text_layout_table_delete(text_layout_table* pTable);
+
+    using text_layout_table_ptr = mtl::unique_ptr<text_layout_table, text_layout_table_delete>;
+
+    /**
+     * @class text_layout_table
+     * @brief The lines of each text, looked up by its id and the width and justification of the
+     * region it is shown in.
+     *
+     * Usage:
+     * @code
+     * auto layout = languageGetLayouts()->find(pRegion->uwTextId, pRegion->uwWidth, justify);
+     * if (layout.lineCount) { auto bmp = pRenderer->create_text(text, layout, pRegion->uwWidth); }
+     * @endcode
+     */
+    class text_layout_table
+    {
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief Error codes for text_layout_table operations.
+         */
+        enum class error_code
+        {
+            MISSING_HEADER,
+            OUT_OF_MEMORY,
+            CORRUPTED,
+        };
+
+        using result = mtl::expected<text_layout_table_ptr, error_code>;
+
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief Default constructor.
+         */
+        text_layout_table() = default;
+
+        /**
+         * @brief Constructor for a table whose storage lives in an arena.
+         * @param pArena Arena holding the entries and lines.
+         */
+        explicit text_layout_table(mtl::arena* pArena)
+            : _pArena(pArena)
+        {}
+
+        ~text_layout_table();
+
+        NO_COPY(text_layout_table)
+        USE_DEFAULT_MOVE(text_layout_table)
+
+        friend void text_layout_table_delete(text_layout_table* pTable);
+
+        /**
+         * @brief Finds the lines of a text as laid out for a region.
+         * @param textId Id of the text in the string table.
+         * @param width Width of the region.
+         * @param justification Justification of the region.
+         * @return The lines, none if the text was not laid out for such a region.
+         */
+        text_layout find(uint16_t textId, uint16_t width, text_justify justification) const;
+
+        /**
+         * @brief Create a text_layout_table from a file descriptor, where a string table ends.
+         * @param pFile Pointer to tFile, which is left open.
+         * @param pArena Arena to place the table in, or nullptr to use the heap.
+         * @return result (success: text_layout_table_ptr, error: error_code)
+         */
+        static result create_from_fd(tFile* pFile, mtl::arena* pArena = nullptr);
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief A text laid out for a region, as stored in the file.
+         */
+        struct entry
+        {
+            uint16_t textId;
+            uint16_t width;
+            uint8_t justification;
+            uint8_t lineCount;
+            uint16_t firstLine;
+        };
+
+        /**
+         * @brief Whether an entry comes before another in the table.
+         */
+        static bool precedes(entry const& lhs, entry const& rhs);
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief The entries then the lines, in one allocation.
+         */
+        uint8_t* _pBlock{ nullptr };
+        /**
+         * @brief Size of the block in bytes.
+         */
+        uint32_t _blockSize{ 0 };
+        /**
+         * @brief Sorted by text id, width, then justification.
+         */
+        entry const* _pEntries{ nullptr };
+        /**
+         * @brief Number of entries.
+         */
+        uint32_t _entryCount{ 0 };
+        /**
+         * @brief The lines of every entry.
+         */
+        text_line const* _pLines{ nullptr };
+        /**
+         * @brief Arena owning the table's memory, if any.
+         */
+        mtl::arena* _pArena{ nullptr };
+    };
+}  // namespace NEONengine
+
+#endif  // __TEXT_LAYOUT_TABLE__INCLUDED__
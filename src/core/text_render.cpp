@@ -2,86 +2,22 @@
 
 #include "neonengine.h"
 
+#include <ace/managers/blit.h>
 #include <ace/managers/system.h>
+#include <ace/utils/bitmap.h>
 
 #include <ace++/font.h>
 #include <ace++/log.h>
 
+#include <mtl/alloc_stats.h>
 #include <mtl/utility.h>
 
 namespace NEONengine
 {
     using namespace mtl;
 
-    // Configuration constants
-    constexpr size_t INITIAL_LINE_CAPACITY    = 16;
-    constexpr size_t DEFAULT_SCRATCH_CAPACITY = 256;
-
-    bool text_renderer::break_text_into_lines(bstr_view const& text,
-                                              uint32_t* pStartIndex,
-                                              uint32_t maxWidth,
-                                              line_data* pOutData)
-    {
-        uint32_t endOfLine    = 0u;
-        uint32_t lineWidth    = 0u;
-        uint32_t offset       = 1u;
-        uint32_t lastSpacePos = 0u;
-
-        if (text.is_empty() || *pStartIndex >= text.length()) { return false; }
-
-        auto textLength     = text.length();
-        auto const textData = text.data();
-
-        // Early exit for newline-only cases
-        if (textData[*pStartIndex] == '\n')
-        {
-            pOutData->start = *pStartIndex;
-            pOutData->end   = *pStartIndex;
-            *pStartIndex += 1;
-            return *pStartIndex <= textLength;
-        }
-
-        // NOTE: We go one character beyond the string length to catch the null terminator
-        for (uint32_t idx = *pStartIndex; idx <= textLength; ++idx)
-        {
-            char c = (idx < textLength) ? textData[idx] : '\0';
-
-            if (c == ' ')
-            {
-                lastSpacePos = idx;
-                endOfLine    = idx;
-            }
-            else if (c == '\n' || c == '\0')
-            {
-                endOfLine = idx;
-                break;
-            }
-
-            if (c >= ' ')
-            {
-                uint16_t glyphWidth = _glyphCache[to<uint8_t>(c)];
-
-                lineWidth += glyphWidth + 1;  // +1 for spacing
-
-                if (maxWidth > 0 && lineWidth > maxWidth)
-                {
-                    // Prefer breaking at last space, otherwise break at current position
-                    endOfLine = (lastSpacePos > *pStartIndex) ? lastSpacePos : idx;
-                    offset    = (endOfLine == lastSpacePos) ? 1 : 0;
-                    break;
-                }
-            }
-        }
-
-        if (endOfLine == 0) { endOfLine = textLength; }
-
-        pOutData->start = *pStartIndex;
-        pOutData->end   = endOfLine;
-        *pStartIndex    = endOfLine + offset;
-        return true;
-    }
-
-    text_renderer::text_renderer(tFont* pFont) : _pFont(pFont)
+    text_renderer::text_renderer(tFont* pFont)
+        : _pFont(pFont)
     {
         ACE_LOG_BLOCK("NEONengine::text_renderer::text_renderer");
 
@@ -95,11 +31,9 @@ namespace NEONengine
         {
             _glyphCache[glyph] = fontGlyphWidth(_pFont, (char)glyph);
         }
-
-        _scratchArea.resize(DEFAULT_SCRATCH_CAPACITY);
     }
 
-    text_renderer::result text_renderer::create(tFont* pFont)
+    text_renderer::result text_renderer::create(tFont* pFont, mtl::arena* pArena)
     {
         if (!pFont)
         {
@@ -109,13 +43,35 @@ namespace NEONengine
                 text_renderer::error_code::INVALID_FONT_POINTER);
         }
 
-        return mtl::make_success<text_renderer_ptr, error_code>(
-            text_renderer_ptr(new (MemF::Fast) text_renderer(pFont)));
+        auto tag       = alloc_tag_scope(alloc_tag::Text);
+        auto pRenderer = pArena ? new (*pArena) text_renderer(pFont)
+                                : new (MemF::Fast) text_renderer(pFont);
+
+        return mtl::make_success<text_renderer_ptr, error_code>(text_renderer_ptr(pRenderer));
     }
 
     ace::text_bitmap_ptr text_renderer::create_text(bstr_view const& text,
                                                     uint16_t maxWidth,
                                                     text_justify justification)
+    {
+        uint32_t startIndex = 0;
+
+        // Laid out here the way noirpack lays out a text region, then rendered the same way
+        auto lines = small_vector<text_line, INLINE_LINE_CAPACITY>();
+        text_line line{};
+        while (text_break_line(text, &startIndex, maxWidth, _glyphCache.begin(), &line))
+        {
+            uint16_t width = text_line_width(text, line, _glyphCache.begin());
+            line.x         = text_justify_line(width, maxWidth, justification);
+            lines.push_back(line);
+        }
+
+        return create_text(text, { lines.data(), to<uint16_t>(lines.size()) }, maxWidth);
+    }
+
+    ace::text_bitmap_ptr text_renderer::create_text(bstr_view const& text,
+                                                    text_layout const& layout,
+                                                    uint16_t maxWidth)
     {
         if (text.is_empty())
         {
@@ -129,35 +85,24 @@ namespace NEONengine
             return ace::text_bitmap_ptr(nullptr);
         }
 
-        uint32_t startIndex = 0;
-
         systemUse();
-        auto lines       = mtl::array<line_data, INITIAL_LINE_CAPACITY>();
         auto pLineBitmap = ace::fontCreateTextBitMap(320, mtl::round_up<16>(_pFont->uwHeight));
         systemUnuse();
 
-        // Create the individual line bitmaps
-        line_data line{};
-        uint32_t lineCount = 0;
-        while ((break_text_into_lines(text, &startIndex, maxWidth, &line)))
-        {
-            lines[lineCount++] = line;
-        }
-
-        // ... and stitch them all together
-        uint16_t height = _pFont->uwHeight * lineCount;
+        // Stitch the lines together
+        uint16_t height = _pFont->uwHeight * layout.lineCount;
         auto pResult    = ace::fontCreateTextBitMap(mtl::round_up<16>(maxWidth), mtl::round_up<16>(height));
 
         pResult->uwActualWidth  = maxWidth;
         pResult->uwActualHeight = height;
 
-        for (auto idx = 0u; idx < lineCount; ++idx)
+        for (auto idx = 0u; idx < layout.lineCount; ++idx)
         {
-            line            = lines[idx];
-            auto lineLength = line.length();
+            text_line const& line = layout.pLines[idx];
+            auto lineLength       = line.length();
             if (lineLength == 0) continue;
 
-            // Resize to exact needed size + null terminator
+            // Lines up to INLINE_SCRATCH_CAPACITY fit the inline storage
             if (_scratchArea.size() < lineLength + 1) { _scratchArea.resize(lineLength + 1); }
 
             // Use memcpy for bulk character copying instead of loop
@@ -168,25 +113,134 @@ namespace NEONengine
             fontFillTextBitMap(_pFont, pLineBitmap.get(), _scratchArea.data());
             logWrite(" -> %s*", _scratchArea.data());
 
-            uint16_t x = 0;
-            switch (justification)
+            fontDrawTextBitMap(
+                pResult->pBitMap, pLineBitmap.get(), line.x, idx * _pFont->uwHeight, 1, 0);
+        }
+
+        return pResult;
+    }
+
+    text_renderer::clip_rect text_renderer::clip_to(tBitMap const* pDest,
+                                                    uint16_t x,
+                                                    uint16_t y,
+                                                    uint16_t maxWidth)
+    {
+        int32_t destWidth = bitmapGetByteWidth(pDest) << 3;
+        return { x, y, MIN(x + maxWidth, destWidth), pDest->Rows };
+    }
+
+    void text_renderer::draw_glyph(tBitMap* pDest,
+                                   uint8_t glyph,
+                                   int32_t x,
+                                   int32_t y,
+                                   clip_rect const& clip,
+                                   uint8_t colorIdx)
+    {
+        int32_t top    = MAX(y, clip.top);
+        int32_t bottom = MIN(y + _pFont->uwHeight, clip.bottom);
+        int32_t left   = MAX(x, clip.left);
+        int32_t right  = MIN(x + _glyphCache[glyph], clip.right);
+        if (top >= bottom || left >= right) { return; }
+
+        tBitMap const* pGlyphs = _pFont->pRawData;
+        uint16_t srcRowBytes   = pGlyphs->BytesPerRow;
+        uint16_t destRowBytes  = pDest->BytesPerRow;
+
+        // At most 16 pixels at a time, so a row of the glyph spans 3 bytes in either bitmap
+        for (int32_t column = left; column < right; column += 16)
+        {
+            uint32_t width    = MIN(right - column, 16);
+            uint32_t srcX     = _pFont->pCharOffsets[glyph] + (column - x);
+            uint32_t srcShift = srcX & 7;
+            uint32_t srcBytes = MIN(srcRowBytes - (srcX >> 3), 3u);
+            uint32_t mask     = 0xFFFFFFFFu << (32 - width);
+            uint32_t dstShift = column & 7;
+            uint32_t dstBytes = (dstShift + width + 7) >> 3;
+
+            UBYTE const* pSrc = pGlyphs->Planes[0] + (top - y) * srcRowBytes + (srcX >> 3);
+            ULONG ulDestOffset = top * destRowBytes + (column >> 3);
+            for (int32_t row = top; row < bottom; ++row)
             {
-                case text_justify::RIGHT:  //
-                    x = maxWidth - pLineBitmap->uwActualWidth;
-                    break;
+                uint32_t bits = 0;
+                for (uint32_t i = 0; i < srcBytes; ++i)
+                {
+                    bits |= to<uint32_t>(pSrc[i]) << (24 - i * 8);
+                }
+                bits = ((bits << srcShift) & mask) >> dstShift;
+
+                // Bytes only, as words may not be aligned
+                for (uint8_t plane = 0; bits && plane < pDest->Depth; ++plane)
+                {
+                    UBYTE* pPlane = pDest->Planes[plane] + ulDestOffset;
+                    bool bSet     = colorIdx & (1 << plane);
+                    for (uint32_t i = 0; i < dstBytes; ++i)
+                    {
+                        UBYTE ubBits = to<UBYTE>(bits >> (24 - i * 8));
+                        pPlane[i]    = bSet ? (pPlane[i] | ubBits) : (pPlane[i] & ~ubBits);
+                    }
+                }
+
+                pSrc += srcRowBytes;
+                ulDestOffset += destRowBytes;
+            }
+        }
+    }
+
+    void text_renderer::draw_text(tBitMap* pDest,
+                                  bstr_view const& text,
+                                  uint16_t x,
+                                  uint16_t y,
+                                  uint16_t maxWidth,
+                                  uint8_t colorIdx,
+                                  text_justify justification)
+    {
+        if (text.is_empty() || !_pFont) { return; }
 
-                case text_justify::CENTER:  //
-                    x = (maxWidth - pLineBitmap->uwActualWidth) >> 1;
-                    break;
+        auto clip = clip_to(pDest, x, y, maxWidth);
 
-                case text_justify::LEFT:  // fallthrough
-                default: x = 0; break;
+        // A line at a time, laid out as it is drawn so nothing is kept
+        uint32_t startIndex = 0;
+        text_line line{};
+        for (int32_t lineY = y; lineY < clip.bottom; lineY += _pFont->uwHeight)
+        {
+            if (!text_break_line(text, &startIndex, maxWidth, _glyphCache.begin(), &line))
+            {
+                break;
             }
 
-            fontDrawTextBitMap(
-                pResult->pBitMap, pLineBitmap.get(), x, idx * _pFont->uwHeight, 1, 0);
+            uint16_t width = text_line_width(text, line, _glyphCache.begin());
+            line.x         = text_justify_line(width, maxWidth, justification);
+            draw_text(pDest, text, { &line, 1 }, x, to<uint16_t>(lineY), maxWidth, colorIdx);
         }
+    }
 
-        return pResult;
+    void text_renderer::draw_text(tBitMap* pDest,
+                                  bstr_view const& text,
+                                  text_layout const& layout,
+                                  uint16_t x,
+                                  uint16_t y,
+                                  uint16_t maxWidth,
+                                  uint8_t colorIdx)
+    {
+        if (text.is_empty() || !_pFont) { return; }
+
+        auto clip = clip_to(pDest, x, y, maxWidth);
+
+        // The blitter may still be drawing into the bitmap, e.g. clearing it
+        blitWait();
+
+        int32_t lineY = y;
+        for (uint32_t lineIdx = 0; lineIdx < layout.lineCount && lineY < clip.bottom; ++lineIdx)
+        {
+            text_line const& line = layout.pLines[lineIdx];
+            int32_t glyphX         = x + line.x;
+            for (uint32_t idx = line.start; idx < line.end; ++idx)
+            {
+                uint8_t glyph = to<uint8_t>(text.data()[idx]);
+                draw_glyph(pDest, glyph, glyphX, lineY, clip, colorIdx);
+                glyphX += _glyphCache[glyph] + 1;
+            }
+            lineY += _pFont->uwHeight;
+        }
     }
-}  // namespace NEONengine
\ No newline at end of file
+}  // namespace NEONengine
@@ -11,26 +11,17 @@
 
 #include <ace++/font.h>
 
+#include <mtl/arena.h>
 #include <mtl/array.h>
 #include <mtl/expected.h>
 #include <mtl/memory.h>
-#include <mtl/vector.h>
+#include <mtl/small_vector.h>
 
+#include "core/text_layout.h"
 #include "utils/bstr_view.h"
 
 namespace NEONengine
 {
-    /**
-     * @enum text_justify
-     * @brief Defines how the text should be justified horizontally.
-     */
-    enum class text_justify
-    {
-        LEFT,
-        RIGHT,
-        CENTER,
-    };
-
     /**
      * @class text_renderer
      * @brief Renders text using ace++ font and provides line breaking and justification.
@@ -66,7 +57,8 @@ namespace NEONengine
 
         public:  ///////////////////////////////////////////////////////////////////////////////////
         /**
-         * @brief Render text to a bitmap with justification and max width.
+         * @brief Render text to a bitmap with justification and max width. The text is laid out
+         * like noirpack lays out a text region, then rendered from its lines like a layout is.
          * @param text The text to render.
          * @param maxWidth Maximum width of the rendered text.
          * @param justification Horizontal justification.
@@ -76,40 +68,107 @@ namespace NEONengine
                                          uint16_t maxWidth,
                                          text_justify justification);
 
+        /**
+         * @brief Render text that was laid out at build time, without breaking or measuring it.
+         * @param text The text to render, the one the layout was made from.
+         * @param layout Its lines, from text_layout_table::find().
+         * @param maxWidth Width of the region it was laid out for.
+         * @return Pointer to rendered text bitmap.
+         */
+        ace::text_bitmap_ptr create_text(bstr_view const& text,
+                                         text_layout const& layout,
+                                         uint16_t maxWidth);
+
+        /**
+         * @brief Draw text straight into a bitmap, a glyph at a time, without allocating or
+         * blitting anything. Only the pixels of the glyphs change, like FONT_COOKIE.
+         * @param pDest Bitmap to draw into.
+         * @param text The text to draw.
+         * @param x Left of the region the text is justified in.
+         * @param y Top of the first line.
+         * @param maxWidth Width of the region, nothing is drawn outside of it or of pDest.
+         * @param colorIdx Color of the glyphs.
+         * @param justification Horizontal justification.
+         * @see draw_text() taking a layout, which each line is drawn with.
+         */
+        void draw_text(tBitMap* pDest,
+                       bstr_view const& text,
+                       uint16_t x,
+                       uint16_t y,
+                       uint16_t maxWidth,
+                       uint8_t colorIdx,
+                       text_justify justification);
+
+        /**
+         * @brief Draw text that was laid out at build time straight into a bitmap.
+         * @param layout Its lines, from text_layout_table::find().
+         * @see draw_text()
+         */
+        void draw_text(tBitMap* pDest,
+                       bstr_view const& text,
+                       text_layout const& layout,
+                       uint16_t x,
+                       uint16_t y,
+                       uint16_t maxWidth,
+                       uint8_t colorIdx);
+
         /**
          * @brief Create a text_renderer from a font pointer.
          * @param pFont Pointer to .
+         * @param pArena Arena to place the renderer in, or nullptr to use the heap.
          * @return result (success: text_renderer_ptr, error: error_code)
          */
-        static result create(tFont* pFont);
+        static result create(tFont* pFont, mtl::arena* pArena = nullptr);
 
         private:  //////////////////////////////////////////////////////////////////////////////////
-        struct line_data
-        {
-            uint16_t start;
-            uint16_t end;
-
-            /**
-             * @brief Get the length of the line.
-             * @return Number of characters in the line.
-             */
-            size_t length() { return end - start; }
-        };
+        /**
+         * @brief Lines kept inline while laying out a string; longer texts spill to the heap.
+         */
+        static constexpr size_t INLINE_LINE_CAPACITY = 16;
+
+        /**
+         * @brief Longest line that is copied out without allocating.
+         */
+        static constexpr size_t INLINE_SCRATCH_CAPACITY = 256;
 
         /**
          * @brief Construct a text_renderer from a font pointer.
          * @param pFont Pointer to ace font.
          */
-        text_renderer(tFont* pFont);
+        explicit text_renderer(tFont* pFont);
 
-        bool break_text_into_lines(bstr_view const& text,
-                                   uint32_t* pStartIndex,
-                                   uint32_t maxWidth,
-                                   line_data* pOutData);
+        /**
+         * @brief Area draw_text() draws in, right and bottom excluded.
+         */
+        struct clip_rect
+        {
+            int32_t left;
+            int32_t top;
+            int32_t right;
+            int32_t bottom;
+        };
+
+        /**
+         * @brief Where draw_text() draws in a bitmap, the region clipped to the bitmap.
+         */
+        static clip_rect clip_to(tBitMap const* pDest, uint16_t x, uint16_t y, uint16_t maxWidth);
+
+        /**
+         * @brief Copies the set pixels of a glyph into each plane of a bitmap.
+         * @param glyph Character whose glyph it is.
+         * @param x Left of the glyph, may be outside of the clip.
+         * @param y Top of the glyph, may be outside of the clip.
+         */
+        void draw_glyph(tBitMap* pDest,
+                        uint8_t glyph,
+                        int32_t x,
+                        int32_t y,
+                        clip_rect const& clip,
+                        uint8_t colorIdx);
 
         private:  //////////////////////////////////////////////////////////////////////////////////
         tFont* _pFont;
-        mtl::vector<char> _scratchArea;
+        mtl::small_vector<char, INLINE_SCRATCH_CAPACITY> _scratchArea;
         mtl::array<uint16_t, 256> _glyphCache;
     };
 
@@ -0,0 +1,327 @@
+#include "vfs.h"
+
+#include "neonengine.h"
+
+#include <ace/managers/log.h>
+#include <ace/managers/memory.h>
+#include <ace/utils/disk_file.h>
+#include <ace/utils/palette.h>
+
+#include <string.h>
+
+#include <mtl/hash.h>
+
+namespace NEONengine
+{
+#define VFS_MAGIC      0x4E50414B  // 'NPAK'
+#define VFS_VERSION    0x00020000
+#define VFS_CHECK_SEED 0x4E454F4E  // 'NEON', must match CHECK_SEED in datapack.cpp
+#define VFS_NONE       0xFFFFFFFF
+
+    struct VfsHeader
+    {
+        ULONG ulMagic;
+        ULONG ulVersion;
+        ULONG ulEntryCount;
+    };
+
+    // As stored in the pack, sorted by hash
+    struct VfsEntry
+    {
+        ULONG ulHash;
+        ULONG ulCheck;   // Hash of the path with VFS_CHECK_SEED
+        ULONG ulOffset;  // From the start of the pack, a multiple of VFS_SECTOR_SIZE
+        ULONG ulSize;
+    };
+
+    // A file open in the pack
+    struct VfsFile
+    {
+        ULONG ulOffset;
+        ULONG ulSize;
+        ULONG ulPos;
+    };
+
+    static tFile *s_pPack;
+    static VfsEntry *s_pEntries;
+    static ULONG s_ulEntryCount;
+    static ULONG s_ulPackPos;      // Where the pack handle is, to skip needless seeks
+    static UBYTE *s_pSector;       // The last sector read for a partial read
+    static ULONG s_ulSectorStart;  // VFS_NONE if s_pSector holds nothing
+
+#ifdef VFS_TRACE
+    static tFile *s_pTrace;
+
+    /* Internal function. Adds a line to the trace. */
+    static void vfsTrace(char const *szPath)
+    {
+        if (!s_pTrace) { return; }
+
+        fileWrite(s_pTrace, szPath, strlen(szPath));
+        fileWrite(s_pTrace, "\n", 1);
+    }
+#endif
+
+    /* Internal function. Reads from the pack handle, seeking only when needed. */
+    static UBYTE vfsPackRead(ULONG ulOffset, void *pDest, ULONG ulSize)
+    {
+        if (ulOffset != s_ulPackPos)
+        {
+            fileSeek(s_pPack, ulOffset, FILE_SEEK_SET);
+            s_ulPackPos = ulOffset;
+        }
+
+        ULONG ulRead = fileRead(s_pPack, pDest, ulSize);
+        s_ulPackPos += ulRead;
+        return ulRead == ulSize;
+    }
+
+    /*
+     * Internal function. Reads a span of the pack in whole sectors: those
+     * fully covered go straight to the destination, the partial ones at
+     * either end through s_pSector, which keeps the last one for the next
+     * read. Returns how many bytes were read.
+     */
+    static ULONG vfsReadSpan(ULONG ulOffset, UBYTE *pDest, ULONG ulSize)
+    {
+        ULONG ulDone = 0;
+        while (ulDone < ulSize)
+        {
+            ULONG ulPos      = ulOffset + ulDone;
+            ULONG ulSector   = ulPos & ~(VFS_SECTOR_SIZE - 1);
+            ULONG ulInSector = ulPos - ulSector;
+            ULONG ulLeft     = ulSize - ulDone;
+
+            if (!ulInSector && ulLeft >= VFS_SECTOR_SIZE)
+            {
+                ULONG ulWhole = ulLeft & ~(VFS_SECTOR_SIZE - 1);
+                if (!vfsPackRead(ulPos, pDest + ulDone, ulWhole)) { break; }
+                ulDone += ulWhole;
+                continue;
+            }
+
+            if (ulSector != s_ulSectorStart)
+            {
+                s_ulSectorStart = VFS_NONE;
+                if (!vfsPackRead(ulSector, s_pSector, VFS_SECTOR_SIZE)) { break; }
+                s_ulSectorStart = ulSector;
+            }
+
+            ULONG ulCopy = VFS_SECTOR_SIZE - ulInSector;
+            if (ulCopy > ulLeft) { ulCopy = ulLeft; }
+            memcpy(pDest + ulDone, s_pSector + ulInSector, ulCopy);
+            ulDone += ulCopy;
+        }
+        return ulDone;
+    }
+
+    /* Internal function. fileClose() frees the tFile, this the rest. */
+    static void vfsFileClose(void *pData)
+    {
+        memFree(pData, sizeof(VfsFile));
+    }
+
+    /* Internal function. */
+    static ULONG vfsFileRead(void *pData, void *pDest, ULONG ulSize)
+    {
+        VfsFile *pFile = (VfsFile *)pData;
+        ULONG ulLeft   = pFile->ulSize - pFile->ulPos;
+        if (ulSize > ulLeft) { ulSize = ulLeft; }
+
+        ULONG ulRead = vfsReadSpan(pFile->ulOffset + pFile->ulPos, (UBYTE *)pDest, ulSize);
+        pFile->ulPos += ulRead;
+        return ulRead;
+    }
+
+    /* Internal function. The pack is read only. */
+    static ULONG vfsFileWrite(void *, void const *, ULONG)
+    {
+        return 0;
+    }
+
+    /* Internal function. Positions outside of the file are refused. */
+    static ULONG vfsFileSeek(void *pData, LONG lPos, WORD wMode)
+    {
+        VfsFile *pFile = (VfsFile *)pData;
+        LONG lBase     = 0;
+        if (wMode == FILE_SEEK_CURRENT) { lBase = pFile->ulPos; }
+        else if (wMode == FILE_SEEK_END) { lBase = pFile->ulSize; }
+
+        LONG lNewPos = lBase + lPos;
+        if (lNewPos < 0 || (ULONG)lNewPos > pFile->ulSize) { return 0; }
+
+        pFile->ulPos = lNewPos;
+        return 1;
+    }
+
+    /* Internal function. */
+    static ULONG vfsFileGetPos(void *pData)
+    {
+        return ((VfsFile *)pData)->ulPos;
+    }
+
+    /* Internal function. */
+    static UBYTE vfsFileIsEof(void *pData)
+    {
+        VfsFile *pFile = (VfsFile *)pData;
+        return pFile->ulPos >= pFile->ulSize;
+    }
+
+    /* Internal function. */
+    static void vfsFileFlush(void *) {}
+
+    static tFileCallbacks const s_packCallbacks = {
+        .cbFileClose  = vfsFileClose,
+        .cbFileRead   = vfsFileRead,
+        .cbFileWrite  = vfsFileWrite,
+        .cbFileSeek   = vfsFileSeek,
+        .cbFileGetPos = vfsFileGetPos,
+        .cbFileIsEof  = vfsFileIsEof,
+        .cbFileFlush  = vfsFileFlush,
+    };
+
+    /*
+     * Internal function. Binary search of the table of contents, NULL if not
+     * packed. The packed paths have unique hashes, but a path that was not
+     * packed may share one, so the second hash has to match too.
+     */
+    static VfsEntry const *vfsFind(char const *szPath)
+    {
+        ULONG ulLength = strlen(szPath);
+        ULONG ulHash   = mtl::hash_bytes(szPath, ulLength);
+        ULONG ulLow    = 0;
+        ULONG ulHigh   = s_ulEntryCount;
+        while (ulLow < ulHigh)
+        {
+            ULONG ulMid = (ulLow + ulHigh) / 2;
+            if (s_pEntries[ulMid].ulHash < ulHash) { ulLow = ulMid + 1; }
+            else { ulHigh = ulMid; }
+        }
+
+        if (ulLow == s_ulEntryCount || s_pEntries[ulLow].ulHash != ulHash) { return NULL; }
+
+        VfsEntry const *pEntry = &s_pEntries[ulLow];
+        return pEntry->ulCheck == mtl::hash_bytes(szPath, ulLength, VFS_CHECK_SEED) ? pEntry : NULL;
+    }
+
+    UBYTE vfsCreate(char const *szPackPath)
+    {
+        vfsDestroy();
+#ifdef VFS_TRACE
+        if (!s_pTrace) { s_pTrace = diskFileOpen(VFS_TRACE_PATH, DISK_FILE_MODE_WRITE, 1); }
+#endif
+
+        tFile *pPack = diskFileOpen(szPackPath, DISK_FILE_MODE_READ, 1);
+        if (!pPack)
+        {
+            NE_LOG("VFS: no '%s', loading loose files", szPackPath);
+            return 0;
+        }
+
+        VfsHeader header;
+        if (fileRead(pPack, &header, sizeof(header)) != sizeof(header)
+            || header.ulMagic != VFS_MAGIC || header.ulVersion != VFS_VERSION)
+        {
+            NE_LOG("VFS: '%s' is not a pack, loading loose files", szPackPath);
+            fileClose(pPack);
+            return 0;
+        }
+
+        ULONG ulTocSize = header.ulEntryCount * sizeof(VfsEntry);
+        s_pEntries      = ulTocSize ? (VfsEntry *)memAllocFast(ulTocSize) : NULL;
+        s_pSector       = (UBYTE *)memAllocFast(VFS_SECTOR_SIZE);
+        if (!s_pSector || (ulTocSize && !s_pEntries)
+            || fileRead(pPack, s_pEntries, ulTocSize) != ulTocSize)
+        {
+            NE_LOG("VFS: could not read the contents of '%s'", szPackPath);
+            if (s_pEntries) { memFree(s_pEntries, ulTocSize); }
+            if (s_pSector) { memFree(s_pSector, VFS_SECTOR_SIZE); }
+            s_pEntries = NULL;
+            s_pSector  = NULL;
+            fileClose(pPack);
+            return 0;
+        }
+
+        s_pPack         = pPack;
+        s_ulEntryCount  = header.ulEntryCount;
+        s_ulPackPos     = sizeof(header) + ulTocSize;
+        s_ulSectorStart = VFS_NONE;
+#ifdef VFS_TRACE
+        vfsTrace(szPackPath);
+#endif
+        NE_LOG("VFS: %lu files in '%s'", s_ulEntryCount, szPackPath);
+        return 1;
+    }
+
+    void vfsDestroy(void)
+    {
+#ifdef VFS_TRACE
+        if (s_pTrace)
+        {
+            fileClose(s_pTrace);
+            s_pTrace = NULL;
+        }
+#endif
+        if (!s_pPack) { return; }
+
+        fileClose(s_pPack);
+        if (s_pEntries) { memFree(s_pEntries, s_ulEntryCount * sizeof(VfsEntry)); }
+        memFree(s_pSector, VFS_SECTOR_SIZE);
+        s_pPack        = NULL;
+        s_pEntries     = NULL;
+        s_pSector      = NULL;
+        s_ulEntryCount = 0;
+    }
+
+    tFile *vfsOpen(char const *szPath)
+    {
+#ifdef VFS_TRACE
+        vfsTrace(szPath);
+#endif
+        VfsEntry const *pEntry = s_pPack ? vfsFind(szPath) : NULL;
+        if (!pEntry) { return diskFileOpen(szPath, DISK_FILE_MODE_READ, 1); }
+
+        tFile *pFile   = (tFile *)memAllocFast(sizeof(tFile));
+        VfsFile *pData = (VfsFile *)memAllocFast(sizeof(VfsFile));
+        if (!pFile || !pData)
+        {
+            if (pFile) { memFree(pFile, sizeof(tFile)); }
+            if (pData) { memFree(pData, sizeof(VfsFile)); }
+            return NULL;
+        }
+
+        pData->ulOffset   = pEntry->ulOffset;
+        pData->ulSize     = pEntry->ulSize;
+        pData->ulPos      = 0;
+        pFile->pData      = pData;
+        pFile->pCallbacks = &s_packCallbacks;
+        return pFile;
+    }
+
+    tBitMap *vfsBitmapCreate(char const *szPath, UBYTE ubFlags)
+    {
+        tFile *pFile = vfsOpen(szPath);
+        return pFile ? bitmapCreateFromFd(pFile, ubFlags) : NULL;
+    }
+
+    tFont *vfsFontCreate(char const *szPath)
+    {
+        tFile *pFile = vfsOpen(szPath);
+        return pFile ? fontCreateFromFd(pFile) : NULL;
+    }
+
+    UBYTE vfsPaletteLoad(char const *szPath, UWORD *pPalette, UBYTE ubMaxLength)
+    {
+        tFile *pFile = vfsOpen(szPath);
+        if (!pFile) { return 0; }
+
+        paletteLoadFromFd(pFile, pPalette, ubMaxLength);
+        return 1;
+    }
+
+    tPtplayerMod *vfsModCreate(char const *szPath)
+    {
+        tFile *pFile = vfsOpen(szPath);
+        return pFile ? ptplayerModCreateFromFd(pFile) : NULL;
+    }
+}  // namespace NEONengine
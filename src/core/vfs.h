@@ -0,0 +1,69 @@
+#ifndef __VFS_H__INCLUDED__
+#define __VFS_H__INCLUDED__
+
+#include <ace/managers/ptplayer.h>
+#include <ace/utils/bitmap.h>
+#include <ace/utils/file.h>
+#include <ace/utils/font.h>
+
+namespace NEONengine
+{
+    /**
+     * @brief The pack the build makes of the converted data files, next to
+     * the executable. See tools/pack/datapack.cpp for its layout.
+     */
+#define VFS_PACK_PATH "data.pak"
+
+    /**
+     * @brief Every file in the pack starts on a sector boundary, and the pack
+     * is read a whole sector at a time.
+     */
+#define VFS_SECTOR_SIZE 512
+
+    /**
+     * @brief Where builds with VFS_TRACE defined list every path opened, in
+     * order, for tools/adf/adflayout.cpp to lay the floppy out by.
+     */
+#define VFS_TRACE_PATH "vfs.trace"
+
+    /**
+     * @brief Opens the pack and reads its table of contents into memory. The
+     * pack stays open, all the files in it are read through that one handle.
+     *
+     * @return UBYTE 1 if the pack was opened, 0 if there is none, and every
+     * file is opened from disk, as in development builds.
+     *
+     * @see vfsDestroy()
+     */
+    UBYTE vfsCreate(char const *szPackPath = VFS_PACK_PATH);
+
+    /**
+     * @brief Closes the pack. Files opened from it must be closed first.
+     *
+     * @see vfsCreate()
+     */
+    void vfsDestroy(void);
+
+    /**
+     * @brief Opens a file for reading, from the pack if it is in it, from
+     * disk otherwise. Files are looked up by the hash of their path, which
+     * the packer checks is unique, and a second hash of it tells a path that
+     * was not packed from one that was with the same hash.
+     *
+     * @param szPath The path the file was packed as, e.g. "data/mpg.bm".
+     * @return tFile* The file, to be closed with fileClose(), or NULL if it
+     * does not exist.
+     */
+    tFile *vfsOpen(char const *szPath);
+
+    /**
+     * @brief Same as the ACE *CreateFromPath() and *LoadFromPath() functions,
+     * with the file opened by vfsOpen().
+     */
+    tBitMap *vfsBitmapCreate(char const *szPath, UBYTE ubFlags);
+    tFont *vfsFontCreate(char const *szPath);
+    UBYTE vfsPaletteLoad(char const *szPath, UWORD *pPalette, UBYTE ubMaxLength);
+    tPtplayerMod *vfsModCreate(char const *szPath);
+}  // namespace NEONengine
+
+#endif  //__VFS_H__INCLUDED__
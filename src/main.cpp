@@ -6,9 +6,15 @@
 #include <ace/managers/ptplayer.h>
 #include <ace/managers/state.h>
 
+#include <mtl/slab.h>
+
 #include "build_number.h"
+#include "core/assets.h"
 #include "core/game_data.h"
+#include "core/language.h"
+#include "core/loader.h"
 #include "core/music.h"
+#include "core/vfs.h"
 #include "test.h"
 
 using namespace NEONengine;
@@ -23,6 +29,10 @@ void genericCreate(void)
     mouseCreate(MOUSE_PORT_1);
     ptplayerCreate(systemIsPal());
 
+    vfsCreate();
+    assetsCreate();
+    languageCreate(Language::EN);
+
     g_gameStateManager = stateManagerCreate();
     g_mainScreen       = screenCreate();
 
@@ -50,6 +60,7 @@ void genericProcess(void)
     mouseProcess();
     ptplayerProcess();
     stateProcess(g_gameStateManager);
+    loaderProcess();
     screenProcess(NEONengine::g_mainScreen);
 
     if (keyUse(KEY_F1))
@@ -66,6 +77,9 @@ void genericDestroy(void)
     screenDestroy(NEONengine::g_mainScreen);
     musicFree();
     stateManagerDestroy(g_gameStateManager);
+    languageDestroy();
+    assetsDestroy();
+    vfsDestroy();
     ptplayerDestroy();
     mouseDestroy();
     keyDestroy();
@@ -73,4 +87,7 @@ void genericDestroy(void)
 
     // Run global/static destructors that registered with __cxa_atexit
     __cxa_finalize(nullptr);
+
+    // Everything should be freed by now, hand the slab regions back to exec
+    mtl::slab_trim();
 }
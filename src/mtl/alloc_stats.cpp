@@ -0,0 +1,115 @@
+/**
+ * @file alloc_stats.cpp
+ * @brief Allocation statistics implementation.
+ *
+ * @see alloc_stats.h
+ */
+#include "alloc_stats.h"
+
+#include <ace/managers/memory.h>
+
+namespace mtl
+{
+    static alloc_stats s_stats{};
+    static alloc_tag s_currentTag = alloc_tag::Untagged;
+
+    static constexpr char const* TAG_NAMES[ALLOC_TAG_COUNT] = {
+        "untagged", "text", "gamedata", "ui", "audio", "script",
+    };
+
+    alloc_stats const& get_alloc_stats() noexcept
+    {
+        return s_stats;
+    }
+
+    static void resetPeak(alloc_counters& counters)
+    {
+        counters.peakBytes = counters.liveBytes;
+    }
+
+    void reset_alloc_peaks() noexcept
+    {
+        resetPeak(s_stats.total);
+        for (auto& counters : s_stats.byMem) { resetPeak(counters); }
+        for (auto& counters : s_stats.byTag) { resetPeak(counters); }
+        for (auto& row : s_stats.byTagMem)
+        {
+            for (auto& counters : row) { resetPeak(counters); }
+        }
+    }
+
+    char const* alloc_tag_name(alloc_tag tag) noexcept
+    {
+        return tag < alloc_tag::Count ? TAG_NAMES[static_cast<size_t>(tag)] : "?";
+    }
+
+    alloc_mem alloc_mem_from_flags(ULONG memFlags) noexcept
+    {
+        switch (memFlags & ~static_cast<ULONG>(MEMF_CLEAR | MEMF_PUBLIC))
+        {
+            case MEMF_CHIP: return alloc_mem::Chip;
+            case MEMF_FAST: return alloc_mem::Fast;
+            case MEMF_ANY: return alloc_mem::Any;
+            default: return alloc_mem::Other;
+        }
+    }
+
+    alloc_tag current_alloc_tag() noexcept
+    {
+        return s_currentTag;
+    }
+
+    alloc_tag_scope::alloc_tag_scope(alloc_tag tag) noexcept : _previous(s_currentTag)
+    {
+        s_currentTag = tag;
+    }
+
+    alloc_tag_scope::~alloc_tag_scope() noexcept
+    {
+        s_currentTag = _previous;
+    }
+
+#ifdef MTL_ALLOC_STATS
+    static void countAlloc(alloc_counters& counters, uint32_t blockSize)
+    {
+        counters.liveBytes += blockSize;
+        ++counters.allocCount;
+        if (counters.liveBytes > counters.peakBytes) { counters.peakBytes = counters.liveBytes; }
+    }
+
+    static void countFree(alloc_counters& counters, uint32_t blockSize)
+    {
+        counters.liveBytes -= blockSize;
+        ++counters.freeCount;
+    }
+
+    void record_alloc(uint32_t blockSize, uint32_t requested, alloc_mem mem, alloc_tag tag) noexcept
+    {
+        auto memIndex = static_cast<size_t>(mem);
+        auto tagIndex = static_cast<size_t>(tag);
+
+        countAlloc(s_stats.total, blockSize);
+        countAlloc(s_stats.byMem[memIndex], blockSize);
+        countAlloc(s_stats.byTag[tagIndex], blockSize);
+        countAlloc(s_stats.byTagMem[tagIndex][memIndex], blockSize);
+
+        size_t bin = 0;
+        while (requested > ALLOC_HISTOGRAM_LIMITS[bin]) { ++bin; }
+        ++s_stats.histogram[bin];
+    }
+
+    void record_free(uint32_t blockSize, alloc_mem mem, alloc_tag tag) noexcept
+    {
+        auto memIndex = static_cast<size_t>(mem);
+        auto tagIndex = static_cast<size_t>(tag);
+
+        countFree(s_stats.total, blockSize);
+        countFree(s_stats.byMem[memIndex], blockSize);
+        countFree(s_stats.byTag[tagIndex], blockSize);
+        countFree(s_stats.byTagMem[tagIndex][memIndex], blockSize);
+    }
+#else
+    void record_alloc(uint32_t, uint32_t, alloc_mem, alloc_tag) noexcept {}
+    void record_free(uint32_t, alloc_mem, alloc_tag) noexcept {}
+#endif
+}  // namespace mtl
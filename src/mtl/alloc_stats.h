@@ -0,0 +1,158 @@
+/**
+ * @file alloc_stats.h
+ * @brief Allocation statistics for the mtl allocators.
+ *
+ * Every block handed out by the global operator new (and its MemF variants)
+ * and every arena block is counted: live and peak bytes plus allocation and
+ * free counts, broken down per memory type and per caller tag, and a
+ * histogram of requested sizes.
+ *
+ * Tags are set for a scope and apply to everything allocated inside it,
+ * containers included:
+ * @code
+ * {
+ *     auto tag = mtl::alloc_tag_scope(mtl::alloc_tag::Text);
+ *     auto pRenderer = text_renderer::create(pFont);
+ * }
+ * auto const& text = mtl::get_alloc_stats().byTagMem[mtl::to<size_t>(mtl::alloc_tag::Text)];
+ * logWrite("Text uses %lu bytes of Chip", text[mtl::to<size_t>(mtl::alloc_mem::Chip)].liveBytes);
+ * @endcode
+ *
+ * Limitations / Notes:
+ *  - Memory obtained by calling memAlloc directly is not seen.
+ *  - Byte counts are block sizes, i.e. slab blocks count as their size class.
+ *  - When enabled, each block carries two extra bytes recording its memory
+ *    type and tag so frees are attributed correctly.
+ */
+
+#ifndef __MTL__ALLOC_STATS__INCLUDED__
+#define __MTL__ALLOC_STATS__INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <exec/types.h>
+
+/**
+ * @def MTL_ALLOC_STATS
+ * @brief Enables allocation statistics. On by default in debug builds, in
+ * release builds the API is still available but reports nothing.
+ */
+#if !defined(MTL_ALLOC_STATS) && defined(ACE_DEBUG)
+#define MTL_ALLOC_STATS
+#endif
+
+namespace mtl
+{
+    /**
+     * Subsystem an allocation is attributed to.
+     */
+    enum class alloc_tag : uint8_t
+    {
+        Untagged,
+        Text,
+        GameData,
+        Ui,
+        Audio,
+        Script,
+
+        Count
+    };
+
+    /**
+     * Memory type buckets. Anything that is not plain Chip, Fast or Any
+     * memory (e.g. 24-bit DMA) is counted as Other.
+     */
+    enum class alloc_mem : uint8_t
+    {
+        Chip,
+        Fast,
+        Any,
+        Other,
+
+        Count
+    };
+
+    constexpr size_t ALLOC_TAG_COUNT = static_cast<size_t>(alloc_tag::Count);
+    constexpr size_t ALLOC_MEM_COUNT = static_cast<size_t>(alloc_mem::Count);
+
+    /**
+     * @brief Upper bound, in bytes, of every histogram bin. The first bins
+     * match the slab size classes.
+     */
+    constexpr uint32_t ALLOC_HISTOGRAM_LIMITS[]
+        = { 8, 16, 24, 32, 48, 64, 96, 128, 256, 1024, 4096, 16384, 0xFFFFFFFF };
+
+    constexpr size_t ALLOC_HISTOGRAM_BINS
+        = sizeof(ALLOC_HISTOGRAM_LIMITS) / sizeof(ALLOC_HISTOGRAM_LIMITS[0]);
+
+    struct alloc_counters
+    {
+        uint32_t liveBytes;   ///< Bytes currently allocated
+        uint32_t peakBytes;   ///< Highest liveBytes seen
+        uint32_t allocCount;  ///< Number of allocations
+        uint32_t freeCount;   ///< Number of frees
+    };
+
+    struct alloc_stats
+    {
+        alloc_counters total;
+        alloc_counters byMem[ALLOC_MEM_COUNT];
+        alloc_counters byTag[ALLOC_TAG_COUNT];
+        alloc_counters byTagMem[ALLOC_TAG_COUNT][ALLOC_MEM_COUNT];
+        uint32_t histogram[ALLOC_HISTOGRAM_BINS];  ///< Allocations per requested size
+    };
+
+    /**
+     * @brief Current statistics. All zero if MTL_ALLOC_STATS is disabled.
+     */
+    alloc_stats const& get_alloc_stats() noexcept;
+
+    /**
+     * @brief Lowers every peak to the current live value, e.g. when entering
+     * a new location.
+     */
+    void reset_alloc_peaks() noexcept;
+
+    /**
+     * @brief Printable name of a tag.
+     */
+    char const* alloc_tag_name(alloc_tag tag) noexcept;
+
+    /**
+     * @brief Maps exec memory flags to a statistics bucket.
+     */
+    alloc_mem alloc_mem_from_flags(ULONG memFlags) noexcept;
+
+    /**
+     * @brief Tag applied to allocations made right now.
+     */
+    alloc_tag current_alloc_tag() noexcept;
+
+    /**
+     * @brief Attributes every allocation made during its lifetime to a tag.
+     * Scopes nest; the previous tag is restored on destruction.
+     */
+    class alloc_tag_scope
+    {
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        explicit alloc_tag_scope(alloc_tag tag) noexcept;
+        ~alloc_tag_scope() noexcept;
+
+        alloc_tag_scope(alloc_tag_scope const&)            = delete;
+        alloc_tag_scope& operator=(alloc_tag_scope const&) = delete;
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        alloc_tag _previous;
+    };
+
+    /**
+     * @name Allocator hooks
+     * Called by the allocators themselves; no-ops if MTL_ALLOC_STATS is off.
+     * @{ */
+    void record_alloc(uint32_t blockSize, uint32_t requested, alloc_mem mem, alloc_tag tag) noexcept;
+    void record_free(uint32_t blockSize, alloc_mem mem, alloc_tag tag) noexcept;
+    /** @} */
+}  // namespace mtl
+
+#endif  // __MTL__ALLOC_STATS__INCLUDED__
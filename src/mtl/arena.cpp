@@ -0,0 +1,137 @@
+/**
+ * @file arena.cpp
+ * @brief Bump allocator implementation.
+ *
+ * @see arena.h
+ */
+#include "arena.h"
+
+#include <ace/managers/log.h>
+
+namespace mtl
+{
+    void* arena::allocate(size_t size, size_t alignment) noexcept
+    {
+        auto align = [alignment](uint8_t* ptr)
+        {
+            return reinterpret_cast<uint8_t*>((reinterpret_cast<uintptr_t>(ptr) + alignment - 1)
+                                              & ~(alignment - 1));
+        };
+
+        uint8_t* pStart = align(_pCurrent);
+        if (!_pCurrent || pStart + size > _pEnd)
+        {
+            if (!grow(size + alignment)) return nullptr;
+            pStart = align(_pCurrent);
+        }
+
+        _usedBytes += (pStart + size) - _pCurrent;
+        _pCurrent = pStart + size;
+        return pStart;
+    }
+
+    void arena::reset() noexcept
+    {
+        run_finalizers();
+
+        if (!_pBlocks) return;
+
+        // Keep the oldest block, which is the one sized for the expected load
+        while (_pBlocks->pNext)
+        {
+            block* pOverflow = _pBlocks;
+            _pBlocks         = pOverflow->pNext;
+            free_block(pOverflow);
+        }
+
+        _pCurrent  = _pBlocks->data();
+        _pEnd      = reinterpret_cast<uint8_t*>(_pBlocks) + _pBlocks->size;
+        _usedBytes = 0;
+    }
+
+    void arena::release() noexcept
+    {
+        reset();
+
+        if (_pBlocks) { free_block(_pBlocks); }
+
+        _pBlocks  = nullptr;
+        _pCurrent = nullptr;
+        _pEnd     = nullptr;
+    }
+
+    bool arena::owns(void const* ptr) const noexcept
+    {
+        auto pByte = static_cast<uint8_t const*>(ptr);
+        for (block* pBlock = _pBlocks; pBlock; pBlock = pBlock->pNext)
+        {
+            if (pByte >= pBlock->data() && pByte < reinterpret_cast<uint8_t*>(pBlock) + pBlock->size)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool arena::grow(size_t minimumSize) noexcept
+    {
+        size_t size = sizeof(block) + (minimumSize > _blockSize ? minimumSize : _blockSize);
+
+        auto pBlock = static_cast<block*>(memAlloc(size, to<ULONG>(_memFlags)));
+        if (!pBlock)
+        {
+            logWrite("Arena: could not reserve %lu bytes block", static_cast<unsigned long>(size));
+            return false;
+        }
+
+        if (_pBlocks)
+        {
+            logWrite("Arena: %lu bytes block is full, chaining another",
+                     static_cast<unsigned long>(_blockSize));
+        }
+
+        // The unused tail of the previous block is not revisited
+        if (_pCurrent) { _usedBytes += _pEnd - _pCurrent; }
+
+        pBlock->pNext = _pBlocks;
+        pBlock->size  = size;
+        pBlock->tag   = current_alloc_tag();
+        _pBlocks      = pBlock;
+
+        record_alloc(size, size, alloc_mem_from_flags(to<ULONG>(_memFlags)), pBlock->tag);
+        _pCurrent     = pBlock->data();
+        _pEnd         = reinterpret_cast<uint8_t*>(pBlock) + size;
+        return true;
+    }
+
+    void arena::free_block(block* pBlock) noexcept
+    {
+        record_free(pBlock->size, alloc_mem_from_flags(to<ULONG>(_memFlags)), pBlock->tag);
+        memFree(pBlock, pBlock->size);
+    }
+
+    void arena::run_finalizers() noexcept
+    {
+        while (_pFinalizers)
+        {
+            finalizer* pFinalizer = _pFinalizers;
+            _pFinalizers          = pFinalizer->pNext;
+            pFinalizer->destroy(pFinalizer->pObject);
+        }
+    }
+}  // namespace mtl
+
+void* operator new(decltype(sizeof(int)) size, mtl::arena& memory) noexcept
+{
+    return memory.allocate(size);
+}
+
+void* operator new[](decltype(sizeof(int)) size, mtl::arena& memory) noexcept
+{
+    return memory.allocate(size);
+}
+
+void operator delete(void*, mtl::arena&) noexcept {}
+
+void operator delete[](void*, mtl::arena&) noexcept {}
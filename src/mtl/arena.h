@@ -0,0 +1,238 @@
+/**
+ * @file arena.h
+ * @brief Bump allocator for allocations that share a single lifetime.
+ *
+ * An arena hands out memory by moving a pointer forward through one large
+ * memAlloc block. Individual allocations are never freed: everything is given
+ * back at once by reset() or release(), which makes it a good fit for data
+ * that lives exactly as long as a game state (string tables, renderers,
+ * scratch buffers) and avoids fragmenting exec's free lists with many short
+ * lived blocks.
+ *
+ * Objects can be placed in an arena in three ways:
+ * @code
+ * mtl::arena arena(4096, mtl::MemF::Fast);
+ *
+ * auto pRaw  = new (arena) Foo(1, 2);                  // destructor is never run
+ * auto pFoo  = arena.create<Foo>(1, 2);                // destructor runs on reset()
+ * auto pBar  = mtl::make_unique<Foo>(arena, 1, 2);     // destructor runs with the pointer
+ * auto items = mtl::arena_vector<int>(mtl::arena_allocator(&arena));
+ * @endcode
+ *
+ * Limitations / Notes:
+ *  - Thread safety is not provided (single-threaded target).
+ *  - When the first block is full, overflow blocks are chained on so an
+ *    under-sized arena keeps working; they are freed again by reset().
+ *  - Memory released by a container growing inside an arena is only
+ *    reclaimed by reset(), so reserve() up front where possible.
+ */
+
+#ifndef __MTL__ARENA__INCLUDED__
+#define __MTL__ARENA__INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "alloc_stats.h"
+#include "memory.h"
+#include "utility.h"
+#include "vector.h"
+
+namespace mtl
+{
+    /**
+     * @brief Alignment used when the caller does not ask for one. Never less
+     * than a longword so ULONG accesses stay fast on the 68020+.
+     */
+    constexpr size_t ARENA_DEFAULT_ALIGNMENT = alignof(max_align_t) < 4 ? 4 : alignof(max_align_t);
+
+    class arena
+    {
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief Constructor. No memory is reserved until the first allocation,
+         * so arenas can safely be declared as file statics.
+         *
+         * @param blockSize Size in bytes of the block reserved on first use.
+         * @param memFlags  Type of memory the arena hands out.
+         */
+        constexpr explicit arena(size_t blockSize, MemF memFlags = MemF::Fast) noexcept
+            : _blockSize(blockSize)
+            , _memFlags(memFlags)
+        {}
+
+        ~arena() noexcept { release(); }
+
+        NO_COPY(arena)
+        NO_MOVE(arena)
+
+        /**
+         * @brief Allocates @p size bytes.
+         *
+         * @param size      Number of bytes requested.
+         * @param alignment Required alignment, must be a power of two.
+         * @return Pointer to the memory or nullptr if no memory is left.
+         */
+        void* allocate(size_t size, size_t alignment = ARENA_DEFAULT_ALIGNMENT) noexcept;
+
+        /**
+         * @brief Constructs a T in the arena. Its destructor will be called
+         * by reset() or release(), in reverse order of creation.
+         *
+         * @return Pointer to the new object or nullptr if no memory is left.
+         */
+        template<class T, typename... Args>
+        T* create(Args&&... args) noexcept
+        {
+            if constexpr (__has_trivial_destructor(T))
+            {
+                void* ptr = allocate(sizeof(T), alignof(T));
+                return ptr ? new (ptr) T(forward<Args>(args)...) : nullptr;
+            }
+            else
+            {
+                auto pFinalizer = static_cast<finalizer*>(allocate(sizeof(finalizer)));
+                void* ptr       = pFinalizer ? allocate(sizeof(T), alignof(T)) : nullptr;
+                if (!ptr) return nullptr;
+
+                T* pObject          = new (ptr) T(forward<Args>(args)...);
+                pFinalizer->pObject = pObject;
+                pFinalizer->destroy = [](void* pDead) { static_cast<T*>(pDead)->~T(); };
+                pFinalizer->pNext   = _pFinalizers;
+                _pFinalizers        = pFinalizer;
+                return pObject;
+            }
+        }
+
+        /**
+         * @brief Destroys every object made with create() and makes all of the
+         * arena's memory available again. The first block is kept.
+         */
+        void reset() noexcept;
+
+        /**
+         * @brief Same as reset(), but also returns the first block to the system.
+         */
+        void release() noexcept;
+
+        /**
+         * @brief Checks if a pointer was handed out by this arena.
+         */
+        bool owns(void const* ptr) const noexcept;
+
+        /**
+         * @brief Number of bytes handed out since the last reset, including
+         * alignment padding.
+         */
+        size_t used() const noexcept { return _usedBytes; }
+
+        /**
+         * @brief Memory type of this arena.
+         */
+        constexpr MemF mem_flags() const noexcept { return _memFlags; }
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        struct block
+        {
+            block* pNext;   ///< Previously filled block
+            size_t size;    ///< Size of the whole memAlloc block, header included
+            alloc_tag tag;  ///< Allocation tag active when the block was reserved
+            uint8_t* data() noexcept { return reinterpret_cast<uint8_t*>(this + 1); }
+        };
+
+        struct finalizer
+        {
+            finalizer* pNext;
+            void* pObject;
+            void (*destroy)(void*);
+        };
+
+        bool grow(size_t minimumSize) noexcept;
+        void free_block(block* pBlock) noexcept;
+        void run_finalizers() noexcept;
+
+        size_t _blockSize;
+        MemF _memFlags;
+        block* _pBlocks{ nullptr };  ///< Current block, older ones are chained behind it
+        uint8_t* _pCurrent{ nullptr };
+        uint8_t* _pEnd{ nullptr };
+        size_t _usedBytes{ 0 };
+        finalizer* _pFinalizers{ nullptr };
+    };
+
+    /**
+     * @brief Calls the destructor without freeing the memory. Used as the
+     * deleter of objects whose memory belongs to an arena.
+     */
+    template<class T>
+    void destroy_in_place(T* ptr)
+    {
+        ptr->~T();
+    }
+
+    /**
+     * @brief Owning pointer to an object living in an arena. Destroys the
+     * object but leaves the memory to the arena.
+     */
+    template<class T>
+    using arena_ptr = unique_ptr<T, destroy_in_place<T>>;
+
+    /**
+     * @brief Constructs a T inside an arena.
+     */
+    template<typename T, typename... Args>
+    arena_ptr<T> make_unique(arena& memory, Args&&... args)
+    {
+        void* ptr = memory.allocate(sizeof(T), alignof(T));
+        return arena_ptr<T>(ptr ? new (ptr) T(forward<Args>(args)...) : nullptr);
+    }
+
+    /**
+     * @brief Container allocator that draws from an arena, or from the heap
+     * when it is not bound to one. The latter lets a class hold arena-capable
+     * containers while only some of its instances live in an arena.
+     *
+     * @tparam MemFlags Memory type used for heap allocations.
+     */
+    template<MemF MemFlags = MemF::Fast>
+    class arena_allocator
+    {
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        constexpr arena_allocator() noexcept = default;
+        constexpr explicit arena_allocator(arena* pArena) noexcept : _pArena(pArena) {}
+
+        void* allocate(size_t bytes, size_t alignment) noexcept
+        {
+            if (_pArena) return _pArena->allocate(bytes, alignment);
+            return _heap.allocate(bytes, alignment);
+        }
+
+        void deallocate(void* ptr, size_t bytes) noexcept
+        {
+            // Arena memory is reclaimed in bulk by arena::reset()
+            if (!_pArena) _heap.deallocate(ptr, bytes);
+        }
+
+        constexpr arena* get_arena() const noexcept { return _pArena; }
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        arena* _pArena{ nullptr };
+        [[no_unique_address]] heap_allocator<MemFlags> _heap;
+    };
+
+    /**
+     * @brief Vector whose storage can come from an arena.
+     */
+    template<class T, MemF MemFlags = MemF::Fast>
+    using arena_vector = vector<T, MemFlags, arena_allocator<MemFlags>>;
+}  // namespace mtl
+
+// Placement new into an arena. The object's destructor is not tracked.
+void* operator new(decltype(sizeof(int)) size, mtl::arena& memory) noexcept;
+void* operator new[](decltype(sizeof(int)) size, mtl::arena& memory) noexcept;
+
+// Only called if a constructor throws; arena memory is reclaimed by reset()
+void operator delete(void* ptr, mtl::arena& memory) noexcept;
+void operator delete[](void* ptr, mtl::arena& memory) noexcept;
+
+#endif  // __MTL__ARENA__INCLUDED__
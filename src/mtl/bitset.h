@@ -0,0 +1,372 @@
+/**
+ * @file bitset.h
+ * @brief Fixed and runtime sized bit sets.
+ *
+ * Bits are packed into 32-bit words, so testing, setting or clearing a single
+ * bit is one shift and one mask on one word, with no branches. Bulk checks
+ * (any, all, none) and counting walk whole words.
+ *
+ * @code
+ * mtl::bitset<256> visited;             // 32 bytes, no allocation
+ * mtl::dynamic_bitset<> flags(1200);    // 152 bytes of Fast RAM
+ * flags.set(42);
+ * if (flags.test(42) && !visited.any()) { ... }
+ *
+ * auto pSave = new uint8_t[flags.snapshot_size()];
+ * flags.snapshot(pSave);
+ * flags.restore(pSave, flags.snapshot_size());
+ * @endcode
+ *
+ * Limitations / Notes:
+ *  - Bit indices are not checked, callers validate ids once up front.
+ *  - Snapshots are the raw words in native byte order, so they are only
+ *    meant to be read back on the same platform.
+ */
+
+#ifndef __MTL__BITSET__INCLUDED__
+#define __MTL__BITSET__INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "memory.h"
+#include "utility.h"
+
+namespace mtl
+{
+    constexpr size_t BITSET_WORD_BITS = 32;
+
+    /**
+     * @brief Number of words needed to hold @p bits bits.
+     */
+    constexpr size_t bitset_words(size_t bits) noexcept
+    {
+        return (bits + BITSET_WORD_BITS - 1) / BITSET_WORD_BITS;
+    }
+
+    /**
+     * @brief Number of set bits in a word. Branch free and without a table,
+     * the 68k has no population count instruction.
+     */
+    constexpr uint32_t popcount(uint32_t value) noexcept
+    {
+        value = value - ((value >> 1) & 0x55555555u);
+        value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+        value = (value + (value >> 4)) & 0x0F0F0F0Fu;
+        value = value + (value >> 8);
+        value = value + (value >> 16);
+        return value & 0x3Fu;
+    }
+
+    /**
+     * @brief Operations shared by bitset and dynamic_bitset. The derived class
+     * provides data() and size().
+     */
+    template<class Derived>
+    class bitset_ops
+    {
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        constexpr bool test(size_t index) const noexcept
+        {
+            return (words()[index / BITSET_WORD_BITS] >> (index % BITSET_WORD_BITS)) & 1u;
+        }
+
+        constexpr void set(size_t index) noexcept
+        {
+            words()[index / BITSET_WORD_BITS] |= mask(index);
+        }
+
+        constexpr void clear(size_t index) noexcept
+        {
+            words()[index / BITSET_WORD_BITS] &= ~mask(index);
+        }
+
+        constexpr void flip(size_t index) noexcept
+        {
+            words()[index / BITSET_WORD_BITS] ^= mask(index);
+        }
+
+        /**
+         * @brief Sets or clears a bit without branching on @p value.
+         */
+        constexpr void assign(size_t index, bool value) noexcept
+        {
+            uint32_t& word = words()[index / BITSET_WORD_BITS];
+            word           = (word & ~mask(index)) | (-static_cast<uint32_t>(value) & mask(index));
+        }
+
+        constexpr void set_all() noexcept
+        {
+            size_t count = word_count();
+            for (size_t i = 0; i < count; ++i) { words()[i] = 0xFFFFFFFFu; }
+            trim();
+        }
+
+        constexpr void clear_all() noexcept
+        {
+            size_t count = word_count();
+            for (size_t i = 0; i < count; ++i) { words()[i] = 0; }
+        }
+
+        /**
+         * @brief true if at least one bit is set.
+         */
+        constexpr bool any() const noexcept
+        {
+            uint32_t merged = 0;
+            size_t count    = word_count();
+            for (size_t i = 0; i < count; ++i) { merged |= words()[i]; }
+            return merged != 0;
+        }
+
+        /**
+         * @brief true if no bit is set.
+         */
+        constexpr bool none() const noexcept { return !any(); }
+
+        /**
+         * @brief true if every bit is set. An empty set counts as all set.
+         */
+        constexpr bool all() const noexcept
+        {
+            size_t count = word_count();
+            if (count == 0) return true;
+
+            uint32_t merged = 0xFFFFFFFFu;
+            for (size_t i = 0; i + 1 < count; ++i) { merged &= words()[i]; }
+            return merged == 0xFFFFFFFFu && words()[count - 1] == tail_mask();
+        }
+
+        /**
+         * @brief Number of set bits.
+         */
+        constexpr size_t count() const noexcept
+        {
+            size_t total = 0;
+            size_t count = word_count();
+            for (size_t i = 0; i < count; ++i) { total += popcount(words()[i]); }
+            return total;
+        }
+
+        constexpr size_t word_count() const noexcept { return bitset_words(derived().size()); }
+
+        /**
+         * @brief Word @p index, bits index * 32 to index * 32 + 31.
+         */
+        constexpr uint32_t word(size_t index) const noexcept { return words()[index]; }
+
+        /**
+         * @brief Bytes needed by snapshot().
+         */
+        constexpr size_t snapshot_size() const noexcept { return word_count() * sizeof(uint32_t); }
+
+        /**
+         * @brief Copies the bits to @p pDest, which must hold snapshot_size() bytes.
+         */
+        void snapshot(void* pDest) const noexcept
+        {
+            __builtin_memcpy(pDest, words(), snapshot_size());
+        }
+
+        /**
+         * @brief Loads bits saved by snapshot(). A snapshot of a different size,
+         * e.g. from an older build with fewer flags, is loaded as far as it
+         * goes and the remaining bits are cleared.
+         *
+         * @return true if the snapshot size matched exactly.
+         */
+        bool restore(void const* pSrc, size_t size) noexcept
+        {
+            size_t ownSize = snapshot_size();
+            size_t copied  = size < ownSize ? size : ownSize;
+
+            clear_all();
+            __builtin_memcpy(words(), pSrc, copied);
+            trim();
+            return size == ownSize;
+        }
+
+        protected:  ////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief Clears the unused bits of the last word so count() and all()
+         * need not mask them.
+         */
+        constexpr void trim() noexcept
+        {
+            size_t count = word_count();
+            if (count) words()[count - 1] &= tail_mask();
+        }
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        static constexpr uint32_t mask(size_t index) noexcept
+        {
+            return 1u << (index % BITSET_WORD_BITS);
+        }
+
+        constexpr uint32_t tail_mask() const noexcept
+        {
+            size_t used = derived().size() % BITSET_WORD_BITS;
+            return used ? (1u << used) - 1 : 0xFFFFFFFFu;
+        }
+
+        constexpr Derived const& derived() const noexcept
+        {
+            return static_cast<Derived const&>(*this);
+        }
+
+        constexpr uint32_t* words() noexcept { return static_cast<Derived&>(*this).data(); }
+        constexpr uint32_t const* words() const noexcept { return derived().data(); }
+    };
+
+    /**
+     * @brief Bit set of a size known at compile time, stored inline.
+     *
+     * @tparam N Number of bits.
+     */
+    template<size_t N>
+    class bitset : public bitset_ops<bitset<N>>
+    {
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief Creates a set with every bit cleared.
+         */
+        constexpr bitset() noexcept = default;
+
+        constexpr size_t size() const noexcept { return N; }
+
+        constexpr uint32_t* data() noexcept { return _words; }
+        constexpr uint32_t const* data() const noexcept { return _words; }
+
+        constexpr bool operator==(bitset const& other) const noexcept
+        {
+            for (size_t i = 0; i < bitset_words(N); ++i)
+            {
+                if (_words[i] != other._words[i]) return false;
+            }
+            return true;
+        }
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        uint32_t _words[bitset_words(N) ? bitset_words(N) : 1] = {};
+    };
+
+    /**
+     * @brief Bit set sized at runtime, its words allocated with @p MemFlags.
+     */
+    template<MemF MemFlags = MemF::Fast>
+    class dynamic_bitset : public bitset_ops<dynamic_bitset<MemFlags>>
+    {
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief Creates an empty set. Nothing is allocated, so it can be a
+         * file static.
+         */
+        constexpr dynamic_bitset() noexcept = default;
+
+        /**
+         * @brief Creates a set of @p bits cleared bits.
+         */
+        explicit dynamic_bitset(size_t bits) noexcept { resize(bits); }
+
+        dynamic_bitset(dynamic_bitset const& other) noexcept
+        {
+            if (resize(other._size) && _pWords)
+            {
+                __builtin_memcpy(_pWords, other._pWords, other.snapshot_size());
+            }
+        }
+
+        dynamic_bitset(dynamic_bitset&& other) noexcept
+            : _pWords(other._pWords)
+            , _size(other._size)
+        {
+            other._pWords = nullptr;
+            other._size   = 0;
+        }
+
+        ~dynamic_bitset() noexcept { release(); }
+
+        dynamic_bitset& operator=(dynamic_bitset const& other) noexcept
+        {
+            if (this != &other && resize(other._size) && _pWords)
+            {
+                __builtin_memcpy(_pWords, other._pWords, other.snapshot_size());
+            }
+            return *this;
+        }
+
+        dynamic_bitset& operator=(dynamic_bitset&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                _pWords       = other._pWords;
+                _size         = other._size;
+                other._pWords = nullptr;
+                other._size   = 0;
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Changes the number of bits. Existing bits are kept, new ones
+         * are cleared.
+         *
+         * @return false if out of memory, the set is left unchanged.
+         */
+        bool resize(size_t bits) noexcept
+        {
+            size_t oldWords = bitset_words(_size);
+            size_t newWords = bitset_words(bits);
+            if (newWords != oldWords)
+            {
+                uint32_t* pWords = nullptr;
+                if (newWords)
+                {
+                    pWords = static_cast<uint32_t*>(
+                        sized_alloc(newWords * sizeof(uint32_t), static_cast<ULONG>(MemFlags)));
+                    if (!pWords) return false;
+
+                    size_t kept = oldWords < newWords ? oldWords : newWords;
+                    for (size_t i = 0; i < newWords; ++i) { pWords[i] = i < kept ? _pWords[i] : 0; }
+                }
+
+                if (_pWords) sized_free(_pWords, oldWords * sizeof(uint32_t));
+                _pWords = pWords;
+            }
+
+            // Bits past the old size were kept clear, so growing within the
+            // last word needs no work and shrinking clears the dropped ones
+            _size = bits;
+            this->trim();
+            return true;
+        }
+
+        /**
+         * @brief Frees the words, leaving an empty set.
+         */
+        void release() noexcept
+        {
+            if (_pWords) sized_free(_pWords, this->snapshot_size());
+            _pWords = nullptr;
+            _size   = 0;
+        }
+
+        constexpr size_t size() const noexcept { return _size; }
+
+        constexpr uint32_t* data() noexcept { return _pWords; }
+        constexpr uint32_t const* data() const noexcept { return _pWords; }
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        uint32_t* _pWords = nullptr;
+        size_t _size      = 0;
+    };
+
+    template<MemF MemFlags>
+    struct is_trivially_relocatable<dynamic_bitset<MemFlags>>
+    {
+        static constexpr bool value = true;
+    };
+}  // namespace mtl
+
+#endif  // __MTL__BITSET__INCLUDED__
@@ -0,0 +1,442 @@
+/**
+ * @file flat_hash_map.h
+ * @brief Open-addressing hash map for id and key lookups.
+ *
+ * All entries live in one flat array whose size is a power of two. Collisions
+ * are resolved with Robin Hood linear probing: an entry that has travelled
+ * further from its home bucket takes the slot of one that has travelled
+ * less, which keeps probe sequences short and lets a lookup stop early.
+ * Deleting shifts the following entries back instead of leaving tombstones,
+ * so the table never degrades after many erases.
+ *
+ * @code
+ * mtl::flat_hash_map<HotspotId, Hotspot*> hotspots;
+ * hotspots.insert(id, pHotspot);
+ * if (auto ppHotspot = hotspots.find(id)) { use(*ppHotspot); }
+ * hotspots.erase(id);
+ * @endcode
+ *
+ * Limitations / Notes:
+ *  - Inserting or erasing invalidates pointers to values and iterators.
+ *  - Keys need operator== and an mtl::hash specialisation, see hash.h.
+ *  - Each slot costs one byte of probe distance on top of the entry.
+ */
+
+#ifndef __MTL__FLAT_HASH_MAP__INCLUDED__
+#define __MTL__FLAT_HASH_MAP__INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hash.h"
+#include "memory.h"
+#include "utility.h"
+
+namespace mtl
+{
+    template<class K, class V, MemF MemFlags = MemF::Fast, class Hash = hash<K>>
+    class flat_hash_map
+    {
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        struct entry
+        {
+            K key;
+            V value;
+        };
+
+        /**
+         * @brief Walks the occupied slots in table order.
+         */
+        template<class Entry>
+        class basic_iterator
+        {
+            public:  ///////////////////////////////////////////////////////////////////////////////
+            constexpr basic_iterator(Entry* pEntry, uint8_t const* pDistance) noexcept
+                : _pEntry(pEntry)
+                , _pDistance(pDistance)
+            {
+                skip_empty();
+            }
+
+            constexpr Entry& operator*() const noexcept { return *_pEntry; }
+            constexpr Entry* operator->() const noexcept { return _pEntry; }
+
+            constexpr basic_iterator& operator++() noexcept
+            {
+                ++_pEntry;
+                ++_pDistance;
+                skip_empty();
+                return *this;
+            }
+
+            constexpr bool operator==(basic_iterator const& other) const noexcept
+            {
+                return _pEntry == other._pEntry;
+            }
+
+            constexpr bool operator!=(basic_iterator const& other) const noexcept
+            {
+                return _pEntry != other._pEntry;
+            }
+
+            private:  //////////////////////////////////////////////////////////////////////////////
+            // The distances end with a non-zero sentinel, so this stops at end()
+            constexpr void skip_empty() noexcept
+            {
+                while (_pDistance && *_pDistance == 0)
+                {
+                    ++_pEntry;
+                    ++_pDistance;
+                }
+            }
+
+            Entry* _pEntry;
+            uint8_t const* _pDistance;
+        };
+
+        using iterator       = basic_iterator<entry>;
+        using const_iterator = basic_iterator<entry const>;
+
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief Creates an empty map. Nothing is allocated until the first insert.
+         */
+        constexpr flat_hash_map() noexcept = default;
+
+        /**
+         * @brief Creates an empty map with room for @p count entries.
+         */
+        explicit flat_hash_map(size_t count) noexcept { reserve(count); }
+
+        flat_hash_map(flat_hash_map const& other) noexcept
+        {
+            reserve(other._size);
+            for (auto const& item : other) { place(entry{ item.key, item.value }); }
+        }
+
+        flat_hash_map(flat_hash_map&& other) noexcept { take(other); }
+
+        ~flat_hash_map() noexcept { release(); }
+
+        flat_hash_map& operator=(flat_hash_map const& other) noexcept
+        {
+            if (this != &other)
+            {
+                clear();
+                reserve(other._size);
+                for (auto const& item : other) { place(entry{ item.key, item.value }); }
+            }
+            return *this;
+        }
+
+        flat_hash_map& operator=(flat_hash_map&& other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                take(other);
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Looks up a key.
+         *
+         * @return Pointer to the value, or nullptr if the key is not in the map.
+         */
+        V* find(K const& key) noexcept
+        {
+            entry* pEntry = find_entry(key);
+            return pEntry ? &pEntry->value : nullptr;
+        }
+
+        V const* find(K const& key) const noexcept
+        {
+            entry const* pEntry = const_cast<flat_hash_map*>(this)->find_entry(key);
+            return pEntry ? &pEntry->value : nullptr;
+        }
+
+        bool contains(K const& key) const noexcept { return find(key) != nullptr; }
+
+        /**
+         * @brief Adds a key unless it is already present.
+         *
+         * @return true if the entry was added, false if the key existed. The
+         * existing value is left untouched.
+         */
+        bool insert(K const& key, V const& value) noexcept
+        {
+            if (find_entry(key)) return false;
+
+            grow_for_insert();
+            place(entry{ key, value });
+            return true;
+        }
+
+        /**
+         * @brief Adds a key, or overwrites the value of an existing one.
+         */
+        void insert_or_assign(K const& key, V const& value) noexcept
+        {
+            if (entry* pEntry = find_entry(key))
+            {
+                pEntry->value = value;
+                return;
+            }
+
+            grow_for_insert();
+            place(entry{ key, value });
+        }
+
+        /**
+         * @brief Value of a key, default constructed and added if missing.
+         */
+        V& operator[](K const& key) noexcept
+        {
+            if (entry* pEntry = find_entry(key)) return pEntry->value;
+
+            grow_for_insert();
+            place(entry{ key, V() });
+            return find_entry(key)->value;
+        }
+
+        /**
+         * @brief Removes a key. The entries that follow it in its probe
+         * sequence are shifted back one slot, so no tombstone is left.
+         *
+         * @return true if the key was found.
+         */
+        bool erase(K const& key) noexcept
+        {
+            entry* pEntry = find_entry(key);
+            if (!pEntry) return false;
+
+            size_t index = pEntry - _pEntries;
+            pEntry->~entry();
+
+            size_t next = (index + 1) & (_capacity - 1);
+            while (_pDistances[next] > 1)
+            {
+                relocate(&_pEntries[index], &_pEntries[next], 1);
+                _pDistances[index] = _pDistances[next] - 1;
+                index              = next;
+                next               = (next + 1) & (_capacity - 1);
+            }
+            _pDistances[index] = 0;
+            --_size;
+            return true;
+        }
+
+        /**
+         * @brief Removes every entry but keeps the storage.
+         */
+        void clear() noexcept
+        {
+            for (size_t i = 0; i < _capacity; ++i)
+            {
+                if (_pDistances[i])
+                {
+                    _pEntries[i].~entry();
+                    _pDistances[i] = 0;
+                }
+            }
+            _size = 0;
+        }
+
+        /**
+         * @brief Makes room for @p count entries without growing again.
+         */
+        void reserve(size_t count) noexcept
+        {
+            if (!count) return;
+
+            size_t capacity = _capacity ? _capacity : MIN_CAPACITY;
+            while (count * MAX_LOAD_DEN > capacity * MAX_LOAD_NUM) { capacity <<= 1; }
+            if (capacity > _capacity) rehash(capacity);
+        }
+
+        constexpr size_t size() const noexcept { return _size; }
+        constexpr bool empty() const noexcept { return _size == 0; }
+
+        /**
+         * @brief Number of slots, always a power of two (or zero).
+         */
+        constexpr size_t capacity() const noexcept { return _capacity; }
+
+        iterator begin() noexcept { return iterator(_pEntries, _pDistances); }
+        iterator end() noexcept { return iterator(_pEntries + _capacity, nullptr); }
+        const_iterator begin() const noexcept { return const_iterator(_pEntries, _pDistances); }
+        const_iterator end() const noexcept
+        {
+            return const_iterator(_pEntries + _capacity, nullptr);
+        }
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        static constexpr size_t MIN_CAPACITY = 8;
+
+        // Grow beyond 3/4 full, probe sequences get long quickly after that
+        static constexpr size_t MAX_LOAD_NUM = 3;
+        static constexpr size_t MAX_LOAD_DEN = 4;
+
+        // Probe distances are stored plus one so zero marks an empty slot
+        static constexpr uint8_t MAX_DISTANCE = 0xFF;
+
+        /**
+         * @brief Home slot of a key. Fibonacci hashing spreads the bits of
+         * weak hashes, such as consecutive ids, over the whole table.
+         */
+        size_t home(K const& key) const noexcept
+        {
+            return (Hash()(key) * 2654435769u) >> _shift;
+        }
+
+        entry* find_entry(K const& key) noexcept
+        {
+            if (!_size) return nullptr;
+
+            size_t index     = home(key);
+            uint8_t distance = 1;
+            while (true)
+            {
+                // Stop at an empty slot or one closer to home than we are,
+                // Robin Hood placement guarantees the key is not further on
+                uint8_t slotDistance = _pDistances[index];
+                if (slotDistance < distance) return nullptr;
+                if (slotDistance == distance && _pEntries[index].key == key)
+                {
+                    return &_pEntries[index];
+                }
+
+                index = (index + 1) & (_capacity - 1);
+                ++distance;
+            }
+        }
+
+        void grow_for_insert() noexcept
+        {
+            if (!_capacity) rehash(MIN_CAPACITY);
+            else if ((_size + 1) * MAX_LOAD_DEN > _capacity * MAX_LOAD_NUM) rehash(_capacity << 1);
+        }
+
+        /**
+         * @brief Puts an entry whose key is not in the map yet into the table,
+         * displacing entries that are closer to their home slot.
+         */
+        void place(entry&& item) noexcept
+        {
+            size_t index     = home(item.key);
+            uint8_t distance = 1;
+            while (true)
+            {
+                uint8_t& slotDistance = _pDistances[index];
+                if (slotDistance == 0)
+                {
+                    new (&_pEntries[index]) entry(move(item));
+                    slotDistance = distance;
+                    ++_size;
+                    return;
+                }
+
+                if (slotDistance < distance)
+                {
+                    swap(item, _pEntries[index]);
+                    swap(distance, slotDistance);
+                }
+
+                index = (index + 1) & (_capacity - 1);
+                if (++distance == MAX_DISTANCE)
+                {
+                    // Pathological clustering: spread the table out and retry
+                    // with the entry still in hand
+                    rehash(_capacity << 1);
+                    index    = home(item.key);
+                    distance = 1;
+                }
+            }
+        }
+
+        /**
+         * @brief Moves every entry into a table of @p capacity slots.
+         */
+        void rehash(size_t capacity) noexcept
+        {
+            entry* pOldEntries     = _pEntries;
+            uint8_t* pOldDistances = _pDistances;
+            size_t oldCapacity     = _capacity;
+
+            void* pStorage = sized_alloc(storage_size(capacity), static_cast<ULONG>(MemFlags));
+            if (!pStorage)
+            {
+                LOG_CRASH("flat_hash_map: out of memory");
+                return;
+            }
+
+            _pEntries   = static_cast<entry*>(pStorage);
+            _pDistances = reinterpret_cast<uint8_t*>(_pEntries + capacity);
+            _capacity   = capacity;
+            _shift      = 32;
+            _size       = 0;
+            for (size_t slots = capacity; slots > 1; slots >>= 1) { --_shift; }
+            __builtin_memset(_pDistances, 0, capacity);
+            _pDistances[capacity] = 1;  // Sentinel for the iterators
+
+            for (size_t i = 0; i < oldCapacity; ++i)
+            {
+                if (pOldDistances[i])
+                {
+                    place(move(pOldEntries[i]));
+                    pOldEntries[i].~entry();
+                }
+            }
+
+            if (pOldEntries) sized_free(pOldEntries, storage_size(oldCapacity));
+        }
+
+        /**
+         * @brief Entries followed by one distance byte per slot and the sentinel.
+         */
+        static constexpr size_t storage_size(size_t capacity) noexcept
+        {
+            return capacity * sizeof(entry) + capacity + 1;
+        }
+
+        void take(flat_hash_map& other) noexcept
+        {
+            _pEntries         = other._pEntries;
+            _pDistances       = other._pDistances;
+            _capacity         = other._capacity;
+            _size             = other._size;
+            _shift            = other._shift;
+            other._pEntries   = nullptr;
+            other._pDistances = nullptr;
+            other._capacity   = 0;
+            other._size       = 0;
+        }
+
+        void release() noexcept
+        {
+            if (!_pEntries) return;
+
+            clear();
+            sized_free(_pEntries, storage_size(_capacity));
+            _pEntries   = nullptr;
+            _pDistances = nullptr;
+            _capacity   = 0;
+        }
+
+        entry* _pEntries     = nullptr;
+        uint8_t* _pDistances = nullptr;  ///< Probe distance + 1 per slot, 0 if empty
+        size_t _capacity     = 0;
+        size_t _size         = 0;
+        uint8_t _shift       = 32;  ///< 32 - log2(_capacity), turns a hash into a slot
+    };
+
+    // Only pointers to the table are held
+    template<class K, class V, MemF MemFlags, class Hash>
+    struct is_trivially_relocatable<flat_hash_map<K, V, MemFlags, Hash>>
+    {
+        static constexpr bool value = true;
+    };
+}  // namespace mtl
+
+#endif  // __MTL__FLAT_HASH_MAP__INCLUDED__
@@ -0,0 +1,66 @@
+/**
+ * @file hash.h
+ * @brief Hash functions for the mtl associative containers.
+ *
+ * mtl::hash<T> turns a key into 32 bits. Integers, enums and pointers are
+ * supported out of the box; other key types provide a specialisation, e.g.
+ * bstr_view hashes its characters with hash_bytes().
+ *
+ * The hashes are deliberately cheap: integers hash to themselves and the
+ * containers scramble the bits when picking a bucket, so a weak hash is fine.
+ */
+
+#ifndef __MTL__HASH__INCLUDED__
+#define __MTL__HASH__INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace mtl
+{
+    /**
+     * @brief FNV-1a hash of a byte string.
+     *
+     * @param pData  Bytes to hash.
+     * @param length Number of bytes.
+     * @param seed   Value the hash starts from. Another seed gives a second
+     *               hash of the same bytes, which rarely collides when the
+     *               first one does.
+     * @return 32-bit hash.
+     */
+    constexpr uint32_t hash_bytes(char const* pData,
+                                  size_t length,
+                                  uint32_t seed = 2166136261u) noexcept
+    {
+        uint32_t hash = seed;
+        for (size_t i = 0; i < length; ++i)
+        {
+            hash ^= static_cast<uint8_t>(pData[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Hash of integer and enum keys: the value itself.
+     */
+    template<class T>
+    struct hash
+    {
+        constexpr uint32_t operator()(T value) const noexcept
+        {
+            return static_cast<uint32_t>(value);
+        }
+    };
+
+    template<class T>
+    struct hash<T*>
+    {
+        uint32_t operator()(T const* ptr) const noexcept
+        {
+            return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(ptr));
+        }
+    };
+}  // namespace mtl
+
+#endif  // __MTL__HASH__INCLUDED__
@@ -2,15 +2,25 @@
  * @file memory.cpp
  * @brief Global / flagged allocation utilities and operator new/delete overrides.
  *
- * Implements sized allocation tracking used by all dynamic memory in the
- * engine. A 4-byte size header (rounded up to max alignment) is stored in
- * front of the returned user pointer so deallocation does not need the
- * original allocation size. (This mimics the behaviour of sized delete in
- * modern C++ but in a portable, freestanding way.)
+ * Small blocks (up to SLAB_MAX_BLOCK_SIZE bytes) are served by the size-class
+ * slab allocator (see slab.h) which needs no per-block header. Containers and
+ * other callers that know their block size use sized_alloc()/sized_free()
+ * and never pay for a header. Everything else goes through sized allocation
+ * tracking: a 4-byte size header (rounded
+ * up to max alignment) is stored in front of the returned user pointer so
+ * deallocation does not need the original allocation size. (This mimics the
+ * behaviour of sized delete in modern C++ but in a portable, freestanding way.)
  *
  * Optional overwrite detection can be enabled with the debug canary macro
  * (MTL_DEBUG_CANARY) which places a 32-bit sentinel immediately after the
- * user block. A mismatch on free logs a corruption warning.
+ * user block. A mismatch on free logs a corruption warning. Slab blocks are
+ * not covered by the canary.
+ *
+ * With MTL_ALLOC_STATS (see alloc_stats.h) every block is counted, and two
+ * bytes at the very end of the block record its memory type and tag.
+ *
+ * When exec is out of memory, the purgers registered with add_purger() free
+ * discardable data and the allocation is retried before it fails.
  *
  * Design goals:
  *  - No dependency on the standard library (freestanding / nostdlib build)
@@ -27,6 +37,8 @@
 
 #include <ace/managers/log.h>
 
+#include "alloc_stats.h"
+#include "slab.h"
 #include "utility.h"
 
 extern "C"
@@ -67,6 +79,69 @@ static constexpr size_t HEADER_SIZE
 static constexpr uint32_t CANARY_VALUE = 0xDEADBEEF;
 #endif
 
+/**
+ * @section MemoryPressure Memory Pressure
+ * Purgers are kept sorted by priority. While they run, allocation failures
+ * don't purge again, so a purger can't end up calling itself.
+ */
+struct purger
+{
+    purge_fn fn;
+    uint8_t priority;
+};
+
+static purger s_purgers[MTL_MAX_PURGERS];
+static size_t s_purgerCount;
+static bool s_purging;
+
+bool mtl::add_purger(purge_fn fn, uint8_t priority) noexcept
+{
+    if (s_purgerCount == MTL_MAX_PURGERS) return false;
+
+    size_t index = s_purgerCount++;
+    for (; index > 0 && s_purgers[index - 1].priority > priority; --index)
+    {
+        s_purgers[index] = s_purgers[index - 1];
+    }
+    s_purgers[index] = { fn, priority };
+    return true;
+}
+
+void mtl::remove_purger(purge_fn fn) noexcept
+{
+    for (size_t i = 0; i < s_purgerCount; ++i)
+    {
+        if (s_purgers[i].fn != fn) continue;
+
+        for (--s_purgerCount; i < s_purgerCount; ++i) { s_purgers[i] = s_purgers[i + 1]; }
+        return;
+    }
+}
+
+size_t mtl::purge_memory(size_t bytes, ULONG memFlags) noexcept
+{
+    if (s_purging) return 0;
+
+    s_purging    = true;
+    size_t freed = 0;
+    for (size_t i = 0; i < s_purgerCount && freed < bytes; ++i)
+    {
+        freed += s_purgers[i].fn(bytes - freed, memFlags);
+    }
+    s_purging = false;
+    return freed;
+}
+
+/**
+ * @brief memAlloc, purging discardable memory and retrying on failure.
+ */
+static void* allocOrPurge(size_t size, ULONG memFlags)
+{
+    void* ptr = memAlloc(size, memFlags);
+    while (!ptr && purge_memory(size, memFlags)) { ptr = memAlloc(size, memFlags); }
+    return ptr;
+}
+
 /**
  * @brief Allocate a block with size tracking (and optional canary).
  *
@@ -82,7 +157,7 @@ static void* allocWithSizeTracking(size_t size, ULONG memFlags, char const* erro
     totalSize += sizeof(uint32_t);  // space for trailing canary
 #endif
 
-    uint8_t* raw = static_cast<uint8_t*>(memAlloc(totalSize, memFlags));
+    uint8_t* raw = static_cast<uint8_t*>(allocOrPurge(totalSize, memFlags));
     if (!raw)
     {
         logWrite("%s", errorMsg);
@@ -135,21 +210,112 @@ static void deallocWithSizeTracking(void* ptr)
     memFree(raw, totalSize);
 }
 
+/**
+ * @brief Allocate a block, preferring the slab allocator for small sizes.
+ *
+ * Falls back to allocWithSizeTracking for large blocks, for memory flags the
+ * slabs do not handle and when the matching slab pool is exhausted.
+ */
+static void* allocPooled(size_t size, ULONG memFlags, char const* errorMsg)
+{
+    if (void* ptr = slab_alloc(size, memFlags)) { return ptr; }
+
+    return allocWithSizeTracking(size, memFlags, errorMsg);
+}
+
+/**
+ * @brief Free a block returned by allocPooled.
+ */
+static void deallocPooled(void* ptr)
+{
+    if (!ptr || slab_free(ptr)) return;
+
+    deallocWithSizeTracking(ptr);
+}
+
+#ifdef MTL_ALLOC_STATS
+/**
+ * @brief Attribution stored in the last two bytes of every counted block.
+ */
+struct alloc_info
+{
+    uint8_t mem;
+    uint8_t tag;
+};
+
+/**
+ * @brief Usable size of a block returned by allocPooled.
+ */
+static size_t pooledBlockSize(void* ptr)
+{
+    if (size_t size = slab_block_size(ptr)) return size;
+
+    return *reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(ptr) - HEADER_SIZE);
+}
+
+static alloc_info* pooledBlockInfo(void* ptr, size_t blockSize)
+{
+    return reinterpret_cast<alloc_info*>(static_cast<uint8_t*>(ptr) + blockSize
+                                         - sizeof(alloc_info));
+}
+
+/**
+ * @brief Allocate a block through allocPooled and record it in the statistics.
+ */
+static void* allocCounted(size_t size, ULONG memFlags, char const* errorMsg)
+{
+    void* ptr = allocPooled(size + sizeof(alloc_info), memFlags, errorMsg);
+    if (!ptr) return nullptr;
+
+    size_t blockSize  = pooledBlockSize(ptr);
+    alloc_info* pInfo = pooledBlockInfo(ptr, blockSize);
+    pInfo->mem        = to<uint8_t>(alloc_mem_from_flags(memFlags));
+    pInfo->tag        = to<uint8_t>(current_alloc_tag());
+
+    record_alloc(blockSize, size, to<alloc_mem>(pInfo->mem), to<alloc_tag>(pInfo->tag));
+    return ptr;
+}
+
+/**
+ * @brief Free a block returned by allocCounted.
+ */
+static void deallocCounted(void* ptr)
+{
+    if (!ptr) return;
+
+    size_t blockSize  = pooledBlockSize(ptr);
+    alloc_info* pInfo = pooledBlockInfo(ptr, blockSize);
+    record_free(blockSize, to<alloc_mem>(pInfo->mem), to<alloc_tag>(pInfo->tag));
+
+    deallocPooled(ptr);
+}
+#else
+static void* allocCounted(size_t size, ULONG memFlags, char const* errorMsg)
+{
+    return allocPooled(size, memFlags, errorMsg);
+}
+
+static void deallocCounted(void* ptr)
+{
+    deallocPooled(ptr);
+}
+#endif
+
 /**
  * @brief Global operator new override (FAST/CHIP decided at compile config).
  * @param size Number of bytes requested.
  */
 void* operator new(decltype(sizeof(int)) size) noexcept
 {
-    return allocWithSizeTracking(size, GLOBAL_MEM_FLAGS, "Global new failed: out of memory");
+    return allocCounted(size, GLOBAL_MEM_FLAGS, "Global new failed: out of memory");
 }
 
 /**
- * @brief Global operator delete override (size recovered from header).
+ * @brief Global operator delete override (slab lookup, else size recovered from header).
  */
 void operator delete(void* ptr) noexcept
 {
-    deallocWithSizeTracking(ptr);
+    deallocCounted(ptr);
 }
 
 /**
@@ -157,7 +323,7 @@ void operator delete(void* ptr) noexcept
  */
 void* operator new[](decltype(sizeof(int)) size) noexcept
 {
-    return allocWithSizeTracking(size, GLOBAL_MEM_FLAGS, "Global new[] failed: out of memory");
+    return allocCounted(size, GLOBAL_MEM_FLAGS, "Global new[] failed: out of memory");
 }
 
 /**
@@ -165,7 +331,7 @@ void* operator new[](decltype(sizeof(int)) size) noexcept
  */
 void operator delete[](void* ptr) noexcept
 {
-    deallocWithSizeTracking(ptr);
+    deallocCounted(ptr);
 }
 
 /**
@@ -190,8 +356,7 @@ void operator delete[](void* ptr, decltype(sizeof(int)) /*size*/) noexcept
  */
 void* operator new(decltype(sizeof(int)) size, mtl::MemF memFlags) noexcept
 {
-    return allocWithSizeTracking(
-        size, static_cast<ULONG>(memFlags), "Placement new failed: out of memory");
+    return allocCounted(size, static_cast<ULONG>(memFlags), "Placement new failed: out of memory");
 }
 
 /**
@@ -199,7 +364,7 @@ void* operator new(decltype(sizeof(int)) size, mtl::MemF memFlags) noexcept
  */
 void* operator new[](decltype(sizeof(int)) size, mtl::MemF memFlags) noexcept
 {
-    return allocWithSizeTracking(
+    return allocCounted(
         size, static_cast<ULONG>(memFlags), "Placement new[] failed: out of memory");
 }
 
@@ -214,3 +379,69 @@ void operator delete[](void* ptr, mtl::MemF /*memFlags*/) noexcept
 {
     operator delete[](ptr);
 }
+
+/**
+ * @section SizedAllocation Sized Allocation
+ * Callers that know the size of their block (containers, typed objects) skip
+ * the size header entirely: small blocks come straight from the slabs and
+ * the rest from memAlloc with the exact size, which memFree gets back on
+ * release.
+ *
+ * With MTL_ALLOC_STATS the attribution bytes are placed right after the
+ * caller's bytes, where sized_free can find them without a lookup.
+ */
+#ifdef MTL_ALLOC_STATS
+static constexpr size_t SIZED_EXTRA = sizeof(alloc_info);
+#else
+static constexpr size_t SIZED_EXTRA = 0;
+#endif
+
+void* mtl::sized_alloc(size_t size, ULONG memFlags) noexcept
+{
+    size_t totalSize = size + SIZED_EXTRA;
+
+    void* ptr = slab_alloc(totalSize, memFlags);
+    if (!ptr)
+    {
+        ptr = allocOrPurge(totalSize, memFlags);
+        if (!ptr)
+        {
+            logWrite("Sized allocation of %lu bytes failed: out of memory",
+                     static_cast<unsigned long>(size));
+            return nullptr;
+        }
+    }
+
+#ifdef MTL_ALLOC_STATS
+    auto pInfo = reinterpret_cast<alloc_info*>(static_cast<uint8_t*>(ptr) + size);
+    pInfo->mem = to<uint8_t>(alloc_mem_from_flags(memFlags));
+    pInfo->tag = to<uint8_t>(current_alloc_tag());
+
+    size_t blockSize = slab_block_size(ptr);
+    record_alloc(blockSize ? blockSize : totalSize,
+                 size,
+                 to<alloc_mem>(pInfo->mem),
+                 to<alloc_tag>(pInfo->tag));
+#endif
+
+    return ptr;
+}
+
+void mtl::sized_free(void* ptr, size_t size) noexcept
+{
+    if (!ptr) return;
+
+    size_t totalSize = size + SIZED_EXTRA;
+
+#ifdef MTL_ALLOC_STATS
+    auto pInfo       = reinterpret_cast<alloc_info*>(static_cast<uint8_t*>(ptr) + size);
+    size_t blockSize = slab_block_size(ptr);
+    record_free(
+        blockSize ? blockSize : totalSize, to<alloc_mem>(pInfo->mem), to<alloc_tag>(pInfo->tag));
+#endif
+
+    // Small blocks may still come from memAlloc if their slab pool was full
+    if (totalSize <= SLAB_MAX_BLOCK_SIZE && slab_free(ptr)) return;
+
+    memFree(ptr, totalSize);
+}
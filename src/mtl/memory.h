@@ -6,6 +6,8 @@
 
 #include <ace/managers/memory.h>
 
+#include "utility.h"
+
 // Placement new declaration (since we don't use std::new)
 inline void* operator new(decltype(sizeof(int)), void* ptr) noexcept
 {
@@ -174,11 +176,12 @@ namespace mtl
         T* _pointer;
     };
 
-    template<typename T, typename... Args>
-    unique_ptr<T> make_unique(Args&&... args)
+    // A unique_ptr is just the pointer, moving its bytes moves the ownership
+    template<class T, auto Deleter>
+    struct is_trivially_relocatable<unique_ptr<T, Deleter>>
     {
-        return unique_ptr<T>(new T(forward<Args>(args)...));
-    }
+        static constexpr bool value = true;
+    };
 }  // namespace mtl
 
 // Placement new operators that take MemF for memory type selection
@@ -190,4 +193,181 @@ void* operator new[](decltype(sizeof(int)) size, mtl::MemF memFlags) noexcept;
 void operator delete(void* ptr, mtl::MemF memFlags) noexcept;
 void operator delete[](void* ptr, mtl::MemF memFlags) noexcept;
 
+namespace mtl
+{
+    /**
+     * @brief Alignment of the blocks sized_alloc() returns: exec and the slab
+     * pools both hand out 8 byte aligned blocks.
+     */
+    constexpr size_t SIZED_ALLOC_ALIGNMENT = 8;
+
+    /**
+     * @brief Allocates a block whose size the caller will remember. Unlike
+     * operator new no size header is stored in front of the block.
+     *
+     * @param size     Number of bytes requested.
+     * @param memFlags exec memory flags.
+     * @return Pointer to the block or nullptr when out of memory.
+     */
+    void* sized_alloc(size_t size, ULONG memFlags) noexcept;
+
+    /**
+     * @brief Frees a block returned by sized_alloc().
+     *
+     * @param ptr  Pointer to free, may be nullptr.
+     * @param size The size that was passed to sized_alloc().
+     */
+    void sized_free(void* ptr, size_t size) noexcept;
+
+    /**
+     * @def MTL_MAX_PURGERS
+     * @brief Most purge callbacks that can be registered at once.
+     */
+#ifndef MTL_MAX_PURGERS
+#define MTL_MAX_PURGERS 8
+#endif
+
+    /**
+     * @brief Frees discardable memory when an allocation fails.
+     *
+     * @param bytes    Size of the allocation that failed.
+     * @param memFlags exec memory flags of the allocation, e.g. only Chip
+     *                 memory helps a MEMF_CHIP request.
+     * @return Number of bytes freed, 0 if there was nothing left to free.
+     */
+    using purge_fn = size_t (*)(size_t bytes, ULONG memFlags);
+
+    /**
+     * @brief Registers a subsystem holding data it can rebuild or reload.
+     * When an allocation fails the purgers run in priority order, the
+     * allocation being retried after each, before it is reported as failed.
+     *
+     * @param fn       The callback.
+     * @param priority Lower runs first: speculative data near 0, caches that
+     *                 are expensive to rebuild higher.
+     * @return false if MTL_MAX_PURGERS are registered already.
+     */
+    bool add_purger(purge_fn fn, uint8_t priority) noexcept;
+
+    /**
+     * @brief Unregisters a callback added with add_purger().
+     */
+    void remove_purger(purge_fn fn) noexcept;
+
+    /**
+     * @brief Runs the purgers in priority order until they have freed at
+     * least the given number of bytes. The allocators call this on failure,
+     * allocations done outside mtl can call it too. Does nothing when called
+     * from a purger.
+     *
+     * @return Number of bytes freed.
+     */
+    size_t purge_memory(size_t bytes, ULONG memFlags) noexcept;
+
+    /**
+     * Deleter for objects allocated with their exact size, see make_unique().
+     */
+    template<class T>
+    void sized_delete(T* ptr)
+    {
+        ptr->~T();
+        sized_free(ptr, sizeof(T));
+    }
+
+    /**
+     * Creates an object in Fast memory (or Chip, see USE_CHIP_MEMORY) that
+     * is destroyed and freed with its unique_ptr. The block is allocated
+     * with the object's exact size and carries no header.
+     */
+    template<typename T, typename... Args>
+    unique_ptr<T, sized_delete<T>> make_unique(Args&&... args)
+    {
+        void* ptr = sized_alloc(sizeof(T), GLOBAL_MEM_FLAGS);
+        return unique_ptr<T, sized_delete<T>>(ptr ? new (ptr) T(forward<Args>(args)...) : nullptr);
+    }
+
+    /**
+     * Default allocator of the mtl containers. Allocates the exact number of
+     * bytes with sized_alloc(), so container buffers carry no size header.
+     *
+     * Blocks are aligned to SIZED_ALLOC_ALIGNMENT, asking for more is fatal.
+     *
+     * A container allocator provides:
+     *  - void* allocate(size_t bytes, size_t alignment)
+     *  - void deallocate(void* ptr, size_t bytes)
+     */
+    template<MemF MemFlags = MemF::Fast>
+    class heap_allocator
+    {
+        public:
+        void* allocate(size_t bytes, size_t alignment) noexcept
+        {
+            // Nothing is padded for more, over-aligned types need an arena
+            if (alignment > SIZED_ALLOC_ALIGNMENT)
+            {
+                LOG_CRASH("heap_allocator: alignment above SIZED_ALLOC_ALIGNMENT requested");
+            }
+            return sized_alloc(bytes, static_cast<ULONG>(MemFlags));
+        }
+
+        void deallocate(void* ptr, size_t bytes) noexcept { sized_free(ptr, bytes); }
+    };
+
+    /**
+     * @brief Copy constructs count elements into uninitialised memory, with a
+     * single memcpy when T is trivially copyable.
+     *
+     * @param dst   Destination, must not overlap src.
+     * @param src   Elements to copy.
+     * @param count Number of elements.
+     */
+    template<class T>
+    void copy_construct(T* dst, T const* src, size_t count) noexcept
+    {
+        if constexpr (is_trivially_copyable_v<T>)
+        {
+            __builtin_memcpy(static_cast<void*>(dst), src, count * sizeof(T));
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i) { new (&dst[i]) T(src[i]); }
+        }
+    }
+
+    /**
+     * @brief Moves count elements to dst, leaving src uninitialised. A single
+     * memmove when T is trivially relocatable. The ranges may overlap.
+     *
+     * @param dst   Destination.
+     * @param src   Elements to move.
+     * @param count Number of elements.
+     */
+    template<class T>
+    void relocate(T* dst, T* src, size_t count) noexcept
+    {
+        if (count == 0 || dst == src) { return; }
+
+        if constexpr (is_trivially_relocatable_v<T>)
+        {
+            __builtin_memmove(static_cast<void*>(dst), src, count * sizeof(T));
+        }
+        else if (dst < src)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                new (&dst[i]) T(move(src[i]));
+                src[i].~T();
+            }
+        }
+        else
+        {
+            for (size_t i = count; i-- > 0;)
+            {
+                new (&dst[i]) T(move(src[i]));
+                src[i].~T();
+            }
+        }
+    }
+}  // namespace mtl
+
 #endif  //__MTL__MEMORY__INCLUDED__
\ No newline at end of file
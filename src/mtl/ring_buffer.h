@@ -0,0 +1,133 @@
+/**
+ * @file ring_buffer.h
+ * @brief Wait-free single-producer/single-consumer queue.
+ *
+ * Meant for handing events from an interrupt handler to the main loop: the
+ * interrupt pushes, the main loop pops, and neither ever waits for or locks
+ * out the other.
+ *
+ * The producer only writes the head and the consumer only writes the tail.
+ * Each side copies the element first and publishes the new index after it,
+ * so the other side never sees a half-written element.
+ *
+ * @code
+ * static mtl::ring_buffer<MusicEvent, 8> s_events;
+ *
+ * void onSongEnd(void) { s_events.push(MusicEvent::SONG_END); }   // interrupt
+ *
+ * MusicEvent event;
+ * while (s_events.pop(event)) { handle(event); }                  // main loop
+ * @endcode
+ *
+ * Limitations / Notes:
+ *  - Exactly one producer and one consumer. Two interrupts pushing into the
+ *    same buffer need a buffer each.
+ *  - A push into a full buffer fails instead of overwriting; size N for the
+ *    worst burst between two pops.
+ */
+
+#ifndef __MTL__RING_BUFFER__INCLUDED__
+#define __MTL__RING_BUFFER__INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utility.h"
+
+namespace mtl
+{
+    /**
+     * @tparam T Element type, copied in and out.
+     * @tparam N Capacity, must be a power of two.
+     */
+    template<class T, size_t N>
+    class ring_buffer
+    {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "ring_buffer capacity must be a power of two");
+        static_assert(N <= 0x80000000u, "ring_buffer capacity must fit the 32-bit counters");
+
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        constexpr ring_buffer() noexcept = default;
+
+        NO_COPY(ring_buffer)
+        NO_MOVE(ring_buffer)
+
+        /**
+         * @brief Adds an element. Producer side only.
+         *
+         * @return false if the buffer is full, the element is dropped.
+         */
+        bool push(T const& value) noexcept
+        {
+            uint32_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+            uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+            if (head - tail == N) return false;
+
+            _items[head & MASK] = value;
+            __atomic_store_n(&_head, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        /**
+         * @brief Takes the oldest element. Consumer side only.
+         *
+         * @param out Receives the element.
+         * @return false if the buffer is empty, @p out is untouched.
+         */
+        bool pop(T& out) noexcept
+        {
+            uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+            uint32_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+            if (head == tail) return false;
+
+            out = _items[tail & MASK];
+            __atomic_store_n(&_tail, tail + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        /**
+         * @brief Oldest element, without removing it. Consumer side only.
+         *
+         * @return Pointer to the element or nullptr if the buffer is empty.
+         * Valid until the next pop().
+         */
+        T const* peek() const noexcept
+        {
+            uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+            uint32_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+            return head == tail ? nullptr : &_items[tail & MASK];
+        }
+
+        /**
+         * @brief Drops every element. Consumer side only.
+         */
+        void clear() noexcept
+        {
+            __atomic_store_n(&_tail, __atomic_load_n(&_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+        }
+
+        /**
+         * @brief Number of elements. Only a snapshot while the other side runs.
+         */
+        size_t size() const noexcept
+        {
+            return __atomic_load_n(&_head, __ATOMIC_ACQUIRE)
+                   - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+        }
+
+        bool empty() const noexcept { return size() == 0; }
+        bool full() const noexcept { return size() == N; }
+        constexpr size_t capacity() const noexcept { return N; }
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        static constexpr uint32_t MASK = N - 1;
+
+        // Free running counters, masked on access. They wrap together, so
+        // head - tail is the fill level and all N slots can be used.
+        uint32_t _head = 0;  ///< Next slot to write, written by the producer only
+        uint32_t _tail = 0;  ///< Next slot to read, written by the consumer only
+        T _items[N]    = {};
+    };
+}  // namespace mtl
+
+#endif  // __MTL__RING_BUFFER__INCLUDED__
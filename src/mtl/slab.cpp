@@ -0,0 +1,283 @@
+/**
+ * @file slab.cpp
+ * @brief Size-class slab allocator implementation.
+ *
+ * @see slab.h for the region layout and the rationale.
+ */
+#include "slab.h"
+
+#include <ace/managers/log.h>
+
+namespace mtl
+{
+    /**
+     * @brief Maps (size + 7) / 8 to a size class index.
+     */
+    static constexpr uint8_t CLASS_LOOKUP[SLAB_MAX_BLOCK_SIZE / 8 + 1] = {
+        0,                       // 0 bytes
+        0,                       // 8
+        1,                       // 16
+        2,                       // 24
+        3,                       // 32
+        4, 4,                    // 40, 48
+        5, 5,                    // 56, 64
+        6, 6, 6, 6,              // 72 .. 96
+        7, 7, 7, 7,              // 104 .. 128
+    };
+
+    static_assert(SLAB_CLASS_SIZES[SLAB_CLASS_COUNT - 1] == SLAB_MAX_BLOCK_SIZE);
+    static_assert((MTL_SLAB_PAGE_SIZE & 7) == 0, "Slab pages must be 8 byte multiples");
+    static_assert(MTL_SLAB_PAGE_SIZE / 8 <= 0xFFFF, "Slab page too large for block counters");
+
+    /**
+     * @brief Number of blocks that fit in one page, per size class. Kept as a
+     * table so the hot paths never divide.
+     */
+    static constexpr uint16_t BLOCKS_PER_PAGE[SLAB_CLASS_COUNT] = {
+        MTL_SLAB_PAGE_SIZE / SLAB_CLASS_SIZES[0], MTL_SLAB_PAGE_SIZE / SLAB_CLASS_SIZES[1],
+        MTL_SLAB_PAGE_SIZE / SLAB_CLASS_SIZES[2], MTL_SLAB_PAGE_SIZE / SLAB_CLASS_SIZES[3],
+        MTL_SLAB_PAGE_SIZE / SLAB_CLASS_SIZES[4], MTL_SLAB_PAGE_SIZE / SLAB_CLASS_SIZES[5],
+        MTL_SLAB_PAGE_SIZE / SLAB_CLASS_SIZES[6], MTL_SLAB_PAGE_SIZE / SLAB_CLASS_SIZES[7],
+    };
+
+    /*
+     * One pool per memory type. Anything that is not plain Chip, Fast or Any
+     * memory (e.g. 24-bit DMA or reverse allocation) bypasses the slabs.
+     */
+    static slab_pool s_fastPool(MEMF_FAST, MTL_SLAB_FAST_REGION_PAGES);
+    static slab_pool s_chipPool(MEMF_CHIP, MTL_SLAB_CHIP_REGION_PAGES);
+    static slab_pool s_anyPool(MEMF_ANY, MTL_SLAB_ANY_REGION_PAGES);
+
+    static slab_pool* poolForFlags(ULONG memFlags)
+    {
+        switch (memFlags & ~static_cast<ULONG>(MEMF_CLEAR | MEMF_PUBLIC))
+        {
+            case MEMF_FAST: return &s_fastPool;
+            case MEMF_CHIP: return &s_chipPool;
+            case MEMF_ANY: return &s_anyPool;
+            default: return nullptr;
+        }
+    }
+
+    void* slab_pool::allocate(size_t size, bool clear) noexcept
+    {
+        uint8_t sizeClass = CLASS_LOOKUP[(size + 7) >> 3];
+
+        page* pPage = _partial[sizeClass];
+        if (!pPage)
+        {
+            pPage = acquire_page(sizeClass);
+            if (!pPage) return nullptr;
+        }
+
+        void* pBlock;
+        if (pPage->pFreeList)
+        {
+            pBlock           = pPage->pFreeList;
+            pPage->pFreeList = *static_cast<void**>(pBlock);
+        }
+        else
+        {
+            pBlock = pPage->pBump;
+            pPage->pBump += SLAB_CLASS_SIZES[sizeClass];
+        }
+
+        if (++pPage->usedCount == BLOCKS_PER_PAGE[sizeClass]) { unlink_partial(pPage); }
+
+        if (clear)
+        {
+            uint32_t* pWords = static_cast<uint32_t*>(pBlock);
+            for (uint16_t i = 0; i < (SLAB_CLASS_SIZES[sizeClass] >> 2); ++i) { pWords[i] = 0; }
+        }
+
+        return pBlock;
+    }
+
+    bool slab_pool::deallocate(void* ptr) noexcept
+    {
+        region* pRegion = find_region(ptr);
+        if (!pRegion) return false;
+
+        uint32_t pageIndex = (static_cast<uint8_t*>(ptr) - pRegion->pPages) / MTL_SLAB_PAGE_SIZE;
+        page* pPage        = &pRegion->descriptors()[pageIndex];
+
+        // A full page is not in the partial list; it will have room again.
+        if (pPage->usedCount == BLOCKS_PER_PAGE[pPage->sizeClass]) { link_partial(pPage); }
+
+        *static_cast<void**>(ptr) = pPage->pFreeList;
+        pPage->pFreeList          = ptr;
+
+        if (--pPage->usedCount == 0)
+        {
+            unlink_partial(pPage);
+            release_page(pRegion, pPage);
+        }
+
+        return true;
+    }
+
+    bool slab_pool::owns(void const* ptr) const noexcept
+    {
+        return find_region(ptr) != nullptr;
+    }
+
+    size_t slab_pool::block_size(void const* ptr) const noexcept
+    {
+        region* pRegion = find_region(ptr);
+        if (!pRegion) return 0;
+
+        uint32_t pageIndex = (static_cast<uint8_t const*>(ptr) - pRegion->pPages) / MTL_SLAB_PAGE_SIZE;
+        return SLAB_CLASS_SIZES[pRegion->descriptors()[pageIndex].sizeClass];
+    }
+
+    void slab_pool::trim() noexcept
+    {
+        uint16_t kept = 0;
+        for (uint16_t i = 0; i < _regionCount; ++i)
+        {
+            region* pRegion = _regions[i];
+            if (pRegion->usedPages == 0) { memFree(pRegion, pRegion->totalSize); }
+            else { _regions[kept++] = pRegion; }
+        }
+
+        for (uint16_t i = kept; i < _regionCount; ++i) { _regions[i] = nullptr; }
+        _regionCount = kept;
+    }
+
+    slab_pool::region* slab_pool::create_region() noexcept
+    {
+        if (_regionCount >= MTL_SLAB_MAX_REGIONS) return nullptr;
+
+        size_t headerSize = round_up<8>(sizeof(region) + sizeof(page) * _regionPages);
+        size_t totalSize  = headerSize + static_cast<size_t>(_regionPages) * MTL_SLAB_PAGE_SIZE;
+
+        auto pRaw = static_cast<uint8_t*>(memAlloc(totalSize, _memFlags));
+        if (!pRaw)
+        {
+            logWrite("Slab: could not reserve %lu bytes region", static_cast<unsigned long>(totalSize));
+            return nullptr;
+        }
+
+        region* pRegion    = reinterpret_cast<region*>(pRaw);
+        pRegion->pPages    = pRaw + headerSize;
+        pRegion->totalSize = totalSize;
+        pRegion->pageCount = _regionPages;
+        pRegion->usedPages = 0;
+
+        // Thread all pages into the region's free list, lowest address first.
+        page* pDescriptors  = pRegion->descriptors();
+        pRegion->pFreePages = nullptr;
+        for (uint16_t i = _regionPages; i-- > 0;)
+        {
+            pDescriptors[i].pNext = pRegion->pFreePages;
+            pRegion->pFreePages   = &pDescriptors[i];
+        }
+
+        _regions[_regionCount++] = pRegion;
+        return pRegion;
+    }
+
+    slab_pool::page* slab_pool::acquire_page(uint8_t sizeClass) noexcept
+    {
+        region* pRegion = nullptr;
+        for (uint16_t i = 0; i < _regionCount; ++i)
+        {
+            if (_regions[i]->pFreePages)
+            {
+                pRegion = _regions[i];
+                break;
+            }
+        }
+
+        if (!pRegion)
+        {
+            pRegion = create_region();
+            if (!pRegion) return nullptr;
+        }
+
+        page* pPage         = pRegion->pFreePages;
+        pRegion->pFreePages = pPage->pNext;
+        ++pRegion->usedPages;
+
+        uint32_t pageIndex = pPage - pRegion->descriptors();
+        pPage->pFreeList   = nullptr;
+        pPage->pBump       = pRegion->pPages + pageIndex * MTL_SLAB_PAGE_SIZE;
+        pPage->usedCount   = 0;
+        pPage->sizeClass   = sizeClass;
+
+        link_partial(pPage);
+        return pPage;
+    }
+
+    void slab_pool::release_page(region* pRegion, page* pPage) noexcept
+    {
+        pPage->pNext        = pRegion->pFreePages;
+        pRegion->pFreePages = pPage;
+        --pRegion->usedPages;
+    }
+
+    slab_pool::region* slab_pool::find_region(void const* ptr) const noexcept
+    {
+        auto pByte = static_cast<uint8_t const*>(ptr);
+        for (uint16_t i = 0; i < _regionCount; ++i)
+        {
+            region* pRegion = _regions[i];
+            if (pByte >= pRegion->pPages
+                && pByte < pRegion->pPages + pRegion->pageCount * MTL_SLAB_PAGE_SIZE)
+            {
+                return pRegion;
+            }
+        }
+
+        return nullptr;
+    }
+
+    void slab_pool::link_partial(page* pPage) noexcept
+    {
+        page*& pHead = _partial[pPage->sizeClass];
+        pPage->pPrev = nullptr;
+        pPage->pNext = pHead;
+        if (pHead) { pHead->pPrev = pPage; }
+        pHead = pPage;
+    }
+
+    void slab_pool::unlink_partial(page* pPage) noexcept
+    {
+        if (pPage->pPrev) { pPage->pPrev->pNext = pPage->pNext; }
+        else { _partial[pPage->sizeClass] = pPage->pNext; }
+
+        if (pPage->pNext) { pPage->pNext->pPrev = pPage->pPrev; }
+        pPage->pNext = nullptr;
+        pPage->pPrev = nullptr;
+    }
+
+    void* slab_alloc(size_t size, ULONG memFlags) noexcept
+    {
+        if (size > SLAB_MAX_BLOCK_SIZE) return nullptr;
+
+        slab_pool* pPool = poolForFlags(memFlags);
+        if (!pPool) return nullptr;
+
+        return pPool->allocate(size, (memFlags & MEMF_CLEAR) != 0);
+    }
+
+    bool slab_free(void* ptr) noexcept
+    {
+        return s_fastPool.deallocate(ptr) || s_chipPool.deallocate(ptr)
+               || s_anyPool.deallocate(ptr);
+    }
+
+    size_t slab_block_size(void const* ptr) noexcept
+    {
+        if (size_t size = s_fastPool.block_size(ptr)) return size;
+        if (size_t size = s_chipPool.block_size(ptr)) return size;
+        return s_anyPool.block_size(ptr);
+    }
+
+    void slab_trim() noexcept
+    {
+        s_fastPool.trim();
+        s_chipPool.trim();
+        s_anyPool.trim();
+    }
+}  // namespace mtl
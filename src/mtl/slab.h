@@ -0,0 +1,208 @@
+/**
+ * @file slab.h
+ * @brief Size-class slab allocator backing the global operator new.
+ *
+ * Small requests (up to SLAB_MAX_BLOCK_SIZE bytes) are served from fixed-size
+ * blocks carved out of large regions, with one set of regions per memory type
+ * (Fast, Chip and Any). Larger requests, or requests using memory flags the
+ * slabs do not handle, are rejected so the caller can fall back to memAlloc.
+ *
+ * Layout of a region (one memAlloc block):
+ * @code
+ * [ region header ][ page descriptors .. ][ page 0 ][ page 1 ] ... [ page N-1 ]
+ * @endcode
+ * Each page holds blocks of a single size class. Pooled blocks carry no
+ * header: the owning page is found from the block's address, so both
+ * allocation and deallocation are O(1).
+ *
+ * Limitations / Notes:
+ *  - Thread safety is not provided (single-threaded target).
+ *  - Regions are only returned to the system by slab_trim(), so short bursts
+ *    of allocations do not repeatedly hit exec.
+ */
+
+#ifndef __MTL__SLAB__INCLUDED__
+#define __MTL__SLAB__INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "memory.h"
+#include "utility.h"
+
+/**
+ * @def MTL_SLAB_PAGE_SIZE
+ * @brief Size in bytes of a single slab page. Must be a multiple of 8.
+ */
+#ifndef MTL_SLAB_PAGE_SIZE
+#define MTL_SLAB_PAGE_SIZE 1024
+#endif
+
+/**
+ * @def MTL_SLAB_MAX_REGIONS
+ * @brief Maximum number of regions a single pool can grow to.
+ */
+#ifndef MTL_SLAB_MAX_REGIONS
+#define MTL_SLAB_MAX_REGIONS 4
+#endif
+
+/**
+ * @name Region sizes
+ * Number of pages reserved each time a pool grows. Chip memory is precious,
+ * so its regions are kept small.
+ * @{ */
+#ifndef MTL_SLAB_FAST_REGION_PAGES
+#define MTL_SLAB_FAST_REGION_PAGES 32
+#endif
+
+#ifndef MTL_SLAB_CHIP_REGION_PAGES
+#define MTL_SLAB_CHIP_REGION_PAGES 8
+#endif
+
+#ifndef MTL_SLAB_ANY_REGION_PAGES
+#define MTL_SLAB_ANY_REGION_PAGES 16
+#endif
+/** @} */
+
+namespace mtl
+{
+    /**
+     * @brief Largest request, in bytes, that will be served from a slab.
+     */
+    constexpr size_t SLAB_MAX_BLOCK_SIZE = 128;
+
+    /**
+     * @brief Number of distinct block sizes.
+     */
+    constexpr size_t SLAB_CLASS_COUNT = 8;
+
+    /**
+     * @brief Block size, in bytes, of every size class.
+     */
+    constexpr uint16_t SLAB_CLASS_SIZES[SLAB_CLASS_COUNT] = { 8, 16, 24, 32, 48, 64, 96, 128 };
+
+    /**
+     * @brief A set of slab regions for one type of memory.
+     *
+     * The pool is constant-initialised (no constructor code runs) so it can
+     * safely be used by operator new before any static constructors.
+     */
+    class slab_pool
+    {
+        public:  ///////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief Constructor.
+         *
+         * @param memFlags    exec memory flags used when allocating regions.
+         * @param regionPages Number of pages reserved per region.
+         */
+        constexpr slab_pool(ULONG memFlags, uint16_t regionPages) noexcept
+            : _memFlags(memFlags)
+            , _regionPages(regionPages)
+        {}
+
+        NO_COPY(slab_pool)
+        NO_MOVE(slab_pool)
+
+        /**
+         * @brief Allocates a block of at least @p size bytes.
+         *
+         * @param size  Number of bytes requested (<= SLAB_MAX_BLOCK_SIZE).
+         * @param clear If true the block is zeroed.
+         * @return Pointer to the block or nullptr if the pool is exhausted.
+         */
+        void* allocate(size_t size, bool clear) noexcept;
+
+        /**
+         * @brief Returns a block to the pool.
+         *
+         * @param ptr Pointer previously returned by allocate().
+         * @return true if the block belonged to this pool, false otherwise.
+         */
+        bool deallocate(void* ptr) noexcept;
+
+        /**
+         * @brief Checks if a pointer lies inside one of this pool's regions.
+         */
+        bool owns(void const* ptr) const noexcept;
+
+        /**
+         * @brief Size class of the block holding @p ptr, or 0 if not owned.
+         */
+        size_t block_size(void const* ptr) const noexcept;
+
+        /**
+         * @brief Returns every completely empty region to the system.
+         */
+        void trim() noexcept;
+
+        private:  //////////////////////////////////////////////////////////////////////////////////
+        struct page
+        {
+            page* pNext;         ///< Next page in the free or partial list
+            page* pPrev;         ///< Previous page in the partial list
+            void* pFreeList;     ///< Blocks that have been freed
+            uint8_t* pBump;      ///< Next never-used block
+            uint16_t usedCount;  ///< Live blocks in this page
+            uint8_t sizeClass;   ///< Index into SLAB_CLASS_SIZES
+        };
+
+        struct region
+        {
+            uint8_t* pPages;     ///< First page
+            page* pFreePages;    ///< Pages not assigned to a size class
+            uint32_t totalSize;  ///< Size of the whole memAlloc block
+            uint16_t pageCount;  ///< Number of pages in the region
+            uint16_t usedPages;  ///< Pages assigned to a size class
+            page* descriptors() noexcept { return reinterpret_cast<page*>(this + 1); }
+        };
+
+        region* create_region() noexcept;
+        page* acquire_page(uint8_t sizeClass) noexcept;
+        void release_page(region* pRegion, page* pPage) noexcept;
+        region* find_region(void const* ptr) const noexcept;
+
+        void link_partial(page* pPage) noexcept;
+        void unlink_partial(page* pPage) noexcept;
+
+        ULONG _memFlags;
+        uint16_t _regionPages;
+        uint16_t _regionCount{ 0 };
+        region* _regions[MTL_SLAB_MAX_REGIONS]{};
+        page* _partial[SLAB_CLASS_COUNT]{};
+    };
+
+    /**
+     * @brief Allocates a small block from the slab matching the memory flags.
+     *
+     * @param size     Number of bytes requested.
+     * @param memFlags exec memory flags (MEMF_CLEAR is honoured).
+     * @return Pointer to the block, or nullptr if the request is too large,
+     * uses memory flags that are not pooled, or the pool is exhausted. Callers
+     * are expected to fall back to memAlloc in that case.
+     */
+    void* slab_alloc(size_t size, ULONG memFlags) noexcept;
+
+    /**
+     * @brief Frees a block previously returned by slab_alloc().
+     *
+     * @param ptr Pointer to free.
+     * @return true if the block was owned by a slab, false otherwise.
+     */
+    bool slab_free(void* ptr) noexcept;
+
+    /**
+     * @brief Usable size of a block returned by slab_alloc().
+     *
+     * @param ptr Pointer to query.
+     * @return The block's size class in bytes, or 0 if not owned by a slab.
+     */
+    size_t slab_block_size(void const* ptr) noexcept;
+
+    /**
+     * @brief Returns all empty slab regions to the system.
+     */
+    void slab_trim() noexcept;
+}  // namespace mtl
+
+#endif  // __MTL__SLAB__INCLUDED__
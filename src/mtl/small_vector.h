@@ -0,0 +1,756 @@
+/**
+ * @file small_vector.h
+ * @brief Dynamic array container with inline storage
+ *
+ * This file provides a vector that keeps its first N elements inside the
+ * object itself and only allocates once it grows beyond that. It has the
+ * same interface as mtl::vector.
+ */
+
+#ifndef __MTL_SMALL_VECTOR__INCLUDED__
+#define __MTL_SMALL_VECTOR__INCLUDED__
+
+#include <stddef.h>
+#include "cstdint.h"
+#include "memory.h"
+#include "utility.h"
+
+#ifdef AMIGA
+#include <proto/exec.h>
+#include <clib/exec_protos.h>
+#endif
+
+namespace mtl
+{
+    /**
+     * @brief Dynamic array container with N elements of inline storage
+     *
+     * Up to N elements live inside the object, so a small_vector on the
+     * stack or embedded in another object does not touch the allocator
+     * until it grows past N. Beyond that the elements spill to the heap,
+     * allocated with MemFlags, and behave like mtl::vector. Shrinking back
+     * with shrink_to_fit() returns them to the inline storage.
+     *
+     * Pointers and iterators are invalidated by moves as well as by growth,
+     * since inline elements move with the object.
+     *
+     * @tparam T The type of elements stored in the vector
+     * @tparam N Number of elements stored inline
+     * @tparam MemFlags The memory allocation flags used once spilled
+     *
+     * @example
+     * @code
+     * mtl::small_vector<line_data, 16> lines;
+     * while (next_line(&line)) {
+     *     lines.push_back(line); // Allocates only from the 17th line on
+     * }
+     * @endcode
+     *
+     * @see mtl::vector
+     */
+    template<class T, size_t N, MemF MemFlags = MemF::Fast>
+    class small_vector
+    {
+        static_assert(N > 0, "small_vector needs at least one inline element");
+
+    public:
+        /**
+         * @brief Default constructor
+         *
+         * Creates an empty vector using the inline storage.
+         */
+        small_vector() noexcept
+            : _data(inline_data()), _size(0), _capacity(N)
+        {
+        }
+
+        /**
+         * @brief Construct with initial capacity
+         *
+         * @param initial_capacity Initial capacity to reserve
+         */
+        explicit small_vector(size_t initial_capacity)
+            : small_vector()
+        {
+            reserve(initial_capacity);
+        }
+
+        /**
+         * @brief Construct with size and default value
+         *
+         * @param count Number of elements to create
+         * @param value Value to initialize elements with
+         */
+        small_vector(size_t count, const T& value)
+            : small_vector()
+        {
+            assign(count, value);
+        }
+
+        /**
+         * @brief Construct from C-style array
+         *
+         * @tparam M Size of the array
+         * @param initializer C-style array to initialize from
+         */
+        template<size_t M>
+        small_vector(const T (&initializer)[M])
+            : small_vector()
+        {
+            assign(M, initializer);
+        }
+
+        /**
+         * @brief Copy constructor
+         *
+         * @param other Vector to copy from
+         */
+        small_vector(const small_vector& other)
+            : small_vector()
+        {
+            reserve(other._size);
+            copy_construct(_data, other._data, other._size);
+            _size = other._size;
+        }
+
+        /**
+         * @brief Move constructor
+         *
+         * Takes over the heap buffer of a spilled vector, otherwise moves the
+         * inline elements across.
+         *
+         * @param other Vector to move from
+         */
+        small_vector(small_vector&& other) noexcept
+            : small_vector()
+        {
+            take(other);
+        }
+
+        /**
+         * @brief Destructor
+         *
+         * Destroys all elements and frees the heap buffer, if any.
+         */
+        ~small_vector() noexcept
+        {
+            clear();
+            deallocate(_data, _capacity);
+        }
+
+        /**
+         * @brief Copy assignment operator
+         *
+         * @param other Vector to copy from
+         * @return Reference to this vector
+         */
+        small_vector& operator=(const small_vector& other)
+        {
+            if (this != &other) {
+                clear();
+                reserve(other._size);
+                copy_construct(_data, other._data, other._size);
+                _size = other._size;
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Move assignment operator
+         *
+         * @param other Vector to move from
+         * @return Reference to this vector
+         */
+        small_vector& operator=(small_vector&& other) noexcept
+        {
+            if (this != &other) {
+                clear();
+                deallocate(_data, _capacity);
+                _data = inline_data();
+                _capacity = N;
+                take(other);
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Assign values to vector
+         *
+         * @param count Number of elements
+         * @param value Value to assign to all elements
+         */
+        void assign(size_t count, const T& value)
+        {
+            clear();
+            reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                construct_at(&_data[i], value);
+            }
+            _size = count;
+        }
+
+        /**
+         * @brief Assign values from C-style array
+         *
+         * @tparam M Size of the array
+         * @param array C-style array to copy from
+         */
+        template<size_t M>
+        void assign(size_t count, const T (&array)[M])
+        {
+            clear();
+            size_t elements_to_copy = (count < M) ? count : M;
+            reserve(elements_to_copy);
+            copy_construct(_data, array, elements_to_copy);
+            _size = elements_to_copy;
+        }
+
+        // Element access
+        /**
+         * @brief Access element by index (unchecked)
+         *
+         * @param index Zero-based index of the element
+         * @return Reference to the element at the specified index
+         *
+         * @warning No bounds checking is performed. Use at() for safe access.
+         */
+        constexpr T& operator[](size_t index) noexcept
+        {
+            return _data[index];
+        }
+
+        /**
+         * @brief Access element by index (unchecked, const version)
+         *
+         * @param index Zero-based index of the element
+         * @return Const reference to the element at the specified index
+         *
+         * @warning No bounds checking is performed. Use at() for safe access.
+         */
+        constexpr T const& operator[](size_t index) const noexcept
+        {
+            return _data[index];
+        }
+
+        /**
+         * @brief Access element with bounds checking
+         *
+         * @param index Zero-based index of the element
+         * @return Reference to the element at the specified index
+         */
+        constexpr T& at(size_t index)
+        {
+            if (index >= _size) {
+                LOG_CRASH("Small vector index out of bounds");
+                return _data[0]; // Return something to avoid warnings
+            }
+            return _data[index];
+        }
+
+        /**
+         * @brief Access element with bounds checking (const version)
+         *
+         * @param index Zero-based index of the element
+         * @return Const reference to the element at the specified index
+         */
+        constexpr T const& at(size_t index) const
+        {
+            if (index >= _size) {
+                LOG_CRASH("Small vector index out of bounds");
+                return _data[0]; // Return something to avoid warnings
+            }
+            return _data[index];
+        }
+
+        /**
+         * @brief Access first element
+         *
+         * @warning Undefined behavior if vector is empty
+         */
+        constexpr T& front() noexcept
+        {
+            return _data[0];
+        }
+
+        /**
+         * @brief Access first element (const version)
+         *
+         * @warning Undefined behavior if vector is empty
+         */
+        constexpr T const& front() const noexcept
+        {
+            return _data[0];
+        }
+
+        /**
+         * @brief Access last element
+         *
+         * @warning Undefined behavior if vector is empty
+         */
+        constexpr T& back() noexcept
+        {
+            return _data[_size - 1];
+        }
+
+        /**
+         * @brief Access last element (const version)
+         *
+         * @warning Undefined behavior if vector is empty
+         */
+        constexpr T const& back() const noexcept
+        {
+            return _data[_size - 1];
+        }
+
+        /**
+         * @brief Get pointer to underlying data
+         */
+        constexpr T* data() noexcept
+        {
+            return _data;
+        }
+
+        /**
+         * @brief Get pointer to underlying data (const version)
+         */
+        constexpr const T* data() const noexcept
+        {
+            return _data;
+        }
+
+        // Iterators
+        constexpr T* begin() noexcept { return _data; }
+        constexpr T const* begin() const noexcept { return _data; }
+        constexpr T const* cbegin() const noexcept { return _data; }
+        constexpr T* end() noexcept { return _data + _size; }
+        constexpr T const* end() const noexcept { return _data + _size; }
+        constexpr T const* cend() const noexcept { return _data + _size; }
+
+        // Capacity
+        /**
+         * @brief Check if vector is empty
+         *
+         * @return true if vector has no elements, false otherwise
+         */
+        constexpr bool empty() const noexcept
+        {
+            return _size == 0;
+        }
+
+        /**
+         * @brief Get the number of elements
+         *
+         * @return The number of elements in the vector
+         */
+        constexpr size_t size() const noexcept
+        {
+            return _size;
+        }
+
+        /**
+         * @brief Get the maximum possible number of elements
+         *
+         * @return The maximum number of elements the vector can hold based on available memory
+         */
+        constexpr size_t max_size() const noexcept
+        {
+            if (__builtin_is_constant_evaluated()) {
+                return static_cast<size_t>(-1) / sizeof(T);
+            } else {
+                ULONG available_bytes = AvailMem(static_cast<ULONG>(MemFlags));
+                return available_bytes / sizeof(T);
+            }
+        }
+
+        /**
+         * @brief Reserve storage for at least the specified number of elements
+         *
+         * @param new_capacity Minimum capacity to reserve
+         */
+        void reserve(size_t new_capacity)
+        {
+            if (new_capacity > _capacity) {
+                reallocate(new_capacity);
+            }
+        }
+
+        /**
+         * @brief Get the current capacity
+         *
+         * @return The number of elements that can be stored without
+         * reallocation, at least N
+         */
+        constexpr size_t capacity() const noexcept
+        {
+            return _capacity;
+        }
+
+        /**
+         * @brief Check whether the elements live in the inline storage
+         *
+         * @return true until the vector has spilled to the heap
+         */
+        constexpr bool is_inline() const noexcept
+        {
+            return _data == inline_data();
+        }
+
+        /**
+         * @brief Reduce capacity to fit the current size
+         *
+         * Moves the elements back inline when they fit.
+         */
+        void shrink_to_fit()
+        {
+            if (_capacity > _size && !is_inline()) {
+                reallocate(_size);
+            }
+        }
+
+        // Modifiers
+        /**
+         * @brief Remove all elements
+         *
+         * Keeps the heap buffer, if any; see shrink_to_fit().
+         */
+        void clear() noexcept
+        {
+            for (size_t i = 0; i < _size; ++i) {
+                destroy_at(&_data[i]);
+            }
+            _size = 0;
+        }
+
+        /**
+         * @brief Add element to the end
+         *
+         * @param value Element to add
+         */
+        void push_back(const T& value)
+        {
+            if (_size >= _capacity) {
+                reallocate(_capacity * GROWTH_FACTOR);
+            }
+            construct_at(&_data[_size], value);
+            ++_size;
+        }
+
+        /**
+         * @brief Add element to the end (move version)
+         *
+         * @param value Element to move
+         */
+        void push_back(T&& value)
+        {
+            if (_size >= _capacity) {
+                reallocate(_capacity * GROWTH_FACTOR);
+            }
+            construct_at(&_data[_size], move(value));
+            ++_size;
+        }
+
+        /**
+         * @brief Construct element in-place at the end
+         *
+         * @tparam Args Types of arguments to forward
+         * @param args Arguments to forward to constructor
+         * @return Reference to the newly constructed element
+         */
+        template<typename... Args>
+        T & emplace_back(Args&&... args)
+        {
+            if (_size >= _capacity) {
+                reallocate(_capacity * GROWTH_FACTOR);
+            }
+            construct_at(&_data[_size], forward<Args>(args)...);
+            ++_size;
+            return _data[_size - 1];
+        }
+
+        /**
+         * @brief Remove the last element
+         *
+         * @warning Undefined behavior if vector is empty
+         */
+        void pop_back()
+        {
+            if (_size > 0) {
+                --_size;
+                destroy_at(&_data[_size]);
+            }
+        }
+
+        /**
+         * @brief Resize the vector to contain count elements
+         *
+         * @param count New size of the vector
+         */
+        void resize(size_t count)
+        {
+            if (count > _size) {
+                reserve(count);
+                for (size_t i = _size; i < count; ++i) {
+                    construct_at(&_data[i]);
+                }
+            } else {
+                for (size_t i = count; i < _size; ++i) {
+                    destroy_at(&_data[i]);
+                }
+            }
+            _size = count;
+        }
+
+        /**
+         * @brief Resize the vector to contain count elements
+         *
+         * @param count New size of the vector
+         * @param value Value to initialize new elements with
+         */
+        void resize(size_t count, const T& value)
+        {
+            if (count > _size) {
+                reserve(count);
+                for (size_t i = _size; i < count; ++i) {
+                    construct_at(&_data[i], value);
+                }
+            } else {
+                for (size_t i = count; i < _size; ++i) {
+                    destroy_at(&_data[i]);
+                }
+            }
+            _size = count;
+        }
+
+        /**
+         * @brief Insert a copy of an element before pos
+         *
+         * @param pos Position to insert before, between begin() and end()
+         * @param value Element to insert, which may be an element of this vector
+         * @return Pointer to the inserted element
+         */
+        T* insert(T const* pos, const T& value)
+        {
+            // Copied first, spilling or shifting would move an element of this vector
+            T copy(value);
+            return insert(pos, &copy, &copy + 1);
+        }
+
+        /**
+         * @brief Insert copies of the range [first, last) before pos
+         *
+         * @param pos Position to insert before, between begin() and end()
+         * @param first Start of the range to copy
+         * @param last End of the range to copy
+         * @return Pointer to the first inserted element
+         *
+         * @warning The range must not point into this vector.
+         */
+        T* insert(T const* pos, T const* first, T const* last)
+        {
+            size_t index = pos - _data;
+            size_t count = last - first;
+            if (count == 0) {
+                return _data + index;
+            }
+
+            if (_size + count > _capacity) {
+                size_t grown = _capacity * GROWTH_FACTOR;
+                reallocate(grown > _size + count ? grown : _size + count);
+            }
+
+            relocate(_data + index + count, _data + index, _size - index);
+            copy_construct(_data + index, first, count);
+            _size += count;
+            return _data + index;
+        }
+
+        /**
+         * @brief Remove the element at pos
+         *
+         * @param pos Element to remove
+         * @return Pointer to the element that followed the removed one
+         */
+        T* erase(T const* pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        /**
+         * @brief Remove the elements in [first, last)
+         *
+         * @param first Start of the range to remove
+         * @param last End of the range to remove
+         * @return Pointer to the element that followed the removed range
+         */
+        T* erase(T const* first, T const* last)
+        {
+            size_t index = first - _data;
+            size_t count = last - first;
+            if (count == 0) {
+                return _data + index;
+            }
+
+            for (size_t i = index; i < index + count; ++i) {
+                destroy_at(&_data[i]);
+            }
+            relocate(_data + index, _data + index + count, _size - index - count);
+            _size -= count;
+            return _data + index;
+        }
+
+        /**
+         * @brief Swap contents with another vector
+         *
+         * Unlike mtl::vector this moves the inline elements, so it is not
+         * constant time.
+         *
+         * @param other The other vector to swap with
+         */
+        void swap(small_vector& other) noexcept
+        {
+            small_vector temp(move(other));
+            other = move(*this);
+            *this = move(temp);
+        }
+
+        // Comparison operators
+        /**
+         * @brief Compare two vectors for equality
+         *
+         * @param other The vector to compare with
+         * @return true if all elements are equal, false otherwise
+         */
+        constexpr bool operator==(const small_vector& other) const
+        {
+            if (_size != other._size) {
+                return false;
+            }
+            for (size_t i = 0; i < _size; ++i) {
+                if (_data[i] != other._data[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Compare two vectors for inequality
+         *
+         * @param other The vector to compare with
+         * @return true if vectors are not equal, false otherwise
+         */
+        constexpr bool operator!=(const small_vector& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        T* _data;           ///< Inline storage or the heap buffer
+        size_t _size;       ///< Current number of elements
+        size_t _capacity;   ///< N while inline, the heap buffer size after
+        alignas(T) unsigned char _inline[N * sizeof(T)]; ///< Storage for the first N elements
+
+        /**
+         * @brief Growth factor for capacity expansion (multiplier)
+         */
+        static constexpr size_t GROWTH_FACTOR = 2;
+
+        constexpr T* inline_data() noexcept
+        {
+            return reinterpret_cast<T*>(_inline);
+        }
+
+        constexpr T const* inline_data() const noexcept
+        {
+            return reinterpret_cast<T const*>(_inline);
+        }
+
+        /**
+         * @brief Allocate a heap buffer for n elements
+         *
+         * @param n Number of elements to allocate for
+         * @return Pointer to allocated memory, or nullptr on failure
+         */
+        static T* allocate(size_t n) noexcept
+        {
+            return static_cast<T*>(sized_alloc(n * sizeof(T), static_cast<ULONG>(MemFlags)));
+        }
+
+        /**
+         * @brief Free the storage if it is a heap buffer
+         *
+         * @param ptr Storage to free
+         * @param n Capacity of the storage in elements
+         */
+        void deallocate(T* ptr, size_t n) noexcept
+        {
+            if (ptr != inline_data()) {
+                sized_free(ptr, n * sizeof(T));
+            }
+        }
+
+        template<typename... Args>
+        void construct_at(T* ptr, Args&&... args) noexcept
+        {
+            new(ptr) T(forward<Args>(args)...);
+        }
+
+        void destroy_at(T* ptr) noexcept
+        {
+            ptr->~T();
+        }
+
+        /**
+         * @brief Take over the contents of other, leaving it empty and inline
+         *
+         * This vector must be empty and inline.
+         *
+         * @param other Vector to take the elements from
+         */
+        void take(small_vector& other) noexcept
+        {
+            if (other.is_inline()) {
+                relocate(_data, other._data, other._size);
+            } else {
+                _data = other._data;
+                _capacity = other._capacity;
+                other._data = other.inline_data();
+                other._capacity = N;
+            }
+            _size = other._size;
+            other._size = 0;
+        }
+
+        /**
+         * @brief Move the elements to storage of the new capacity
+         *
+         * Capacities up to N use the inline storage.
+         *
+         * @param new_capacity The new capacity, at least size()
+         */
+        void reallocate(size_t new_capacity)
+        {
+            T* new_data = inline_data();
+            if (new_capacity <= N) {
+                if (is_inline()) {
+                    return;
+                }
+                new_capacity = N;
+            } else {
+                new_data = allocate(new_capacity);
+                if (!new_data) {
+                    LOG_CRASH("Small vector reallocation failed: out of memory");
+                    return;
+                }
+            }
+
+            relocate(new_data, _data, _size);
+
+            deallocate(_data, _capacity);
+            _data = new_data;
+            _capacity = new_capacity;
+        }
+    };
+}
+
+#endif // __MTL_SMALL_VECTOR__INCLUDED__
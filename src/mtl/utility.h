@@ -129,12 +129,50 @@ namespace mtl
         return (value + (Size - 1)) & ~(Size - 1);
     }
 
+    /**
+     * @brief True if T can be copied with a plain byte copy.
+     */
+    template<typename T>
+    constexpr bool is_trivially_copyable_v = __is_trivially_copyable(T);
+
+    /**
+     * @brief Types whose objects can be moved to a new address with a byte
+     * copy, after which the old bytes are simply forgotten (no destructor
+     * call). Containers use this to move elements in bulk.
+     *
+     * Trivially copyable types qualify automatically. Types that own a
+     * resource through a plain pointer (e.g. mtl::vector, mtl::unique_ptr)
+     * qualify too but have to opt in, see MTL_TRIVIALLY_RELOCATABLE.
+     */
+    template<typename T>
+    struct is_trivially_relocatable
+    {
+        static constexpr bool value = is_trivially_copyable_v<T>;
+    };
+
+    template<typename T>
+    constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+/**
+ * Marks a type as trivially relocatable. Use at global scope, after the
+ * type has been declared.
+ *
+ * @example
+ * MTL_TRIVIALLY_RELOCATABLE(NEONengine::text_renderer)
+ */
+#define MTL_TRIVIALLY_RELOCATABLE(type)                \
+    template<>                                         \
+    struct mtl::is_trivially_relocatable<type>         \
+    {                                                  \
+        static constexpr bool value = true;            \
+    };
+
     template<typename T>
     constexpr void swap(T& a, T& b)
     {
-        T tmp = to<T&&>(a);
-        a     = to<T&&>(b);
-        b     = to<T&&>(tmp);
+        T tmp = move(a);
+        a     = move(b);
+        b     = move(tmp);
     }
 }  // namespace mtl
 
@@ -31,6 +31,7 @@ namespace mtl
      * 
      * @tparam T The type of elements stored in the vector
      * @tparam MemFlags The memory allocation flags (MemF enum)
+     * @tparam Allocator Where the storage comes from, see mtl::heap_allocator
      * 
      * @example
      * @code
@@ -44,8 +45,9 @@ namespace mtl
      * @endcode
      * 
      * @see mtl::MemF
+     * @see mtl::arena_allocator
      */
-    template<class T, MemF MemFlags = MemF::Fast>
+    template<class T, MemF MemFlags = MemF::Fast, class Allocator = heap_allocator<MemFlags>>
     class vector
     {
     public:
@@ -59,6 +61,16 @@ namespace mtl
         {
         }
 
+        /**
+         * @brief Construct an empty vector using the given allocator
+         * 
+         * @param allocator Allocator to draw storage from
+         */
+        constexpr explicit vector(const Allocator& allocator) noexcept
+            : _data(nullptr), _size(0), _capacity(0), _allocator(allocator)
+        {
+        }
+
         /**
          * @brief Construct with initial capacity
          * 
@@ -103,13 +115,12 @@ namespace mtl
          * @param other Vector to copy from
          */
         vector(const vector& other)
-            : vector()
+            : vector(other._allocator)
         {
             if (other._size > 0) {
                 reserve(other._size);
-                for (size_t i = 0; i < other._size; ++i) {
-                    push_back(other._data[i]);
-                }
+                copy_construct(_data, other._data, other._size);
+                _size = other._size;
             }
         }
 
@@ -119,7 +130,8 @@ namespace mtl
          * @param other Vector to move from
          */
         vector(vector&& other) noexcept
-            : _data(other._data), _size(other._size), _capacity(other._capacity)
+            : _data(other._data), _size(other._size), _capacity(other._capacity),
+              _allocator(other._allocator)
         {
             other._data = nullptr;
             other._size = 0;
@@ -149,9 +161,8 @@ namespace mtl
                 clear();
                 if (other._size > 0) {
                     reserve(other._size);
-                    for (size_t i = 0; i < other._size; ++i) {
-                        push_back(other._data[i]);
-                    }
+                    copy_construct(_data, other._data, other._size);
+                    _size = other._size;
                 }
             }
             return *this;
@@ -172,6 +183,7 @@ namespace mtl
                 _data = other._data;
                 _size = other._size;
                 _capacity = other._capacity;
+                _allocator = other._allocator;
                 
                 other._data = nullptr;
                 other._size = 0;
@@ -192,8 +204,9 @@ namespace mtl
             if (count > 0) {
                 reserve(count);
                 for (size_t i = 0; i < count; ++i) {
-                    push_back(value);
+                    construct_at(&_data[i], value);
                 }
+                _size = count;
             }
         }
 
@@ -210,9 +223,8 @@ namespace mtl
             size_t elements_to_copy = (count < N) ? count : N;
             if (elements_to_copy > 0) {
                 reserve(elements_to_copy);
-                for (size_t i = 0; i < elements_to_copy; ++i) {
-                    push_back(array[i]);
-                }
+                copy_construct(_data, array, elements_to_copy);
+                _size = elements_to_copy;
             }
         }
 
@@ -597,6 +609,89 @@ namespace mtl
             _size = count;
         }
 
+        /**
+         * @brief Insert a copy of an element before pos
+         * 
+         * @param pos Position to insert before, between begin() and end()
+         * @param value Element to insert, which may be an element of this vector
+         * @return Pointer to the inserted element
+         */
+        T* insert(T const* pos, const T& value)
+        {
+            // Copied first, growing or shifting would move an element of this vector
+            T copy(value);
+            return insert(pos, &copy, &copy + 1);
+        }
+
+        /**
+         * @brief Insert copies of the range [first, last) before pos
+         * 
+         * Elements after pos are shifted up with a single bulk move when T
+         * is trivially relocatable.
+         * 
+         * @param pos Position to insert before, between begin() and end()
+         * @param first Start of the range to copy
+         * @param last End of the range to copy
+         * @return Pointer to the first inserted element
+         * 
+         * @warning The range must not point into this vector.
+         */
+        T* insert(T const* pos, T const* first, T const* last)
+        {
+            size_t index = pos - _data;
+            size_t count = last - first;
+            if (count == 0) {
+                return _data + index;
+            }
+
+            if (_size + count > _capacity) {
+                size_t grown = _capacity == 0 ? DEFAULT_CAPACITY : _capacity * GROWTH_FACTOR;
+                reallocate(grown > _size + count ? grown : _size + count);
+            }
+
+            relocate(_data + index + count, _data + index, _size - index);
+            copy_construct(_data + index, first, count);
+            _size += count;
+            return _data + index;
+        }
+
+        /**
+         * @brief Remove the element at pos
+         * 
+         * @param pos Element to remove
+         * @return Pointer to the element that followed the removed one
+         */
+        T* erase(T const* pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        /**
+         * @brief Remove the elements in [first, last)
+         * 
+         * Elements after the range are shifted down with a single bulk move
+         * when T is trivially relocatable.
+         * 
+         * @param first Start of the range to remove
+         * @param last End of the range to remove
+         * @return Pointer to the element that followed the removed range
+         */
+        T* erase(T const* first, T const* last)
+        {
+            size_t index = first - _data;
+            size_t count = last - first;
+            if (count == 0) {
+                return _data + index;
+            }
+
+            for (size_t i = index; i < index + count; ++i) {
+                destroy_at(&_data[i]);
+            }
+            relocate(_data + index, _data + index + count, _size - index - count);
+            _size -= count;
+            return _data + index;
+        }
+
         /**
          * @brief Swap contents with another vector
          * 
@@ -615,6 +710,10 @@ namespace mtl
             other._data = temp_data;
             other._size = temp_size;
             other._capacity = temp_capacity;
+
+            Allocator temp_allocator = _allocator;
+            _allocator = other._allocator;
+            other._allocator = temp_allocator;
         }
 
         // Comparison operators
@@ -652,6 +751,7 @@ namespace mtl
         T* _data;           ///< Pointer to the allocated data
         size_t _size;       ///< Current number of elements
         size_t _capacity;   ///< Current allocated capacity
+        [[no_unique_address]] Allocator _allocator; ///< Source of the storage
 
         /**
          * @brief Initial capacity for new vectors
@@ -672,10 +772,7 @@ namespace mtl
         T* allocate(size_t n) noexcept
         {
             if (n == 0) return nullptr;
-            // Always route through our custom operator new that handles
-            // size tracking. This keeps allocation/deallocation symmetric
-            // and avoids mismatches with memFree sizing.
-            return static_cast<T*>(::operator new(n * sizeof(T), MemFlags));
+            return static_cast<T*>(_allocator.allocate(n * sizeof(T), alignof(T)));
         }
 
         /**
@@ -684,10 +781,10 @@ namespace mtl
          * @param ptr Pointer to memory to deallocate
          * @param n Number of elements (may be unused depending on allocator)
          */
-        void deallocate(T* ptr, size_t /*n*/) noexcept
+        void deallocate(T* ptr, size_t n) noexcept
         {
             if (ptr) {
-                ::operator delete(ptr); // Our global delete uses stored size
+                _allocator.deallocate(ptr, n * sizeof(T));
             }
         }
 
@@ -732,21 +829,21 @@ namespace mtl
                 return;
             }
 
-            // Move/copy existing elements
-            for (size_t i = 0; i < _size; ++i) {
-                if constexpr (requires { move(_data[i]); }) {
-                    construct_at(&new_data[i], move(_data[i]));
-                } else {
-                    construct_at(&new_data[i], _data[i]);
-                }
-                destroy_at(&_data[i]);
-            }
+            relocate(new_data, _data, _size);
 
             deallocate(_data, _capacity);
             _data = new_data;
             _capacity = new_capacity;
         }
     };
+
+    // The vector only holds a pointer to its elements, so it can be moved
+    // around as bytes regardless of T
+    template<class T, MemF MemFlags, class Allocator>
+    struct is_trivially_relocatable<vector<T, MemFlags, Allocator>>
+    {
+        static constexpr bool value = true;
+    };
 }
 
 #endif // __MTL_VECTOR__INCLUDED__
@@ -9,7 +9,7 @@ namespace NEONengine
 
     engine::result engine::initialize(char const* szDefaultFontPath)
     {
-        auto font = ace::fontCreateFromPath(szDefaultFontPath);
+        auto font = font_handle(assetsGetFont(szDefaultFontPath));
         if (!font)
         {
             NE_LOG("Could not load default font '%s'", szDefaultFontPath);
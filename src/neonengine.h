@@ -9,6 +9,7 @@
 #include <mtl/expected.h>
 #include <mtl/memory.h>
 
+#include "core/assets.h"
 #include "core/game_data.h"
 #include "core/screen.h"
 #include "core/text_render.h"
@@ -35,7 +36,7 @@ namespace NEONengine
         static result initialize(char const* szDefaultFontPath);
 
         private:  //////////////////////////////////////////////////////////////////////////////////
-        ace::font_ptr _pDefaultFont{ nullptr };
+        font_handle _pDefaultFont{ nullptr };
         text_renderer_ptr _pDefaultTextRenderer{ nullptr };
     };
 
@@ -49,6 +50,14 @@ namespace NEONengine
         g_stateDialogueTest,        //
         g_stateLangTest;
 
+    /**
+     * @brief Queues the files of the language selection on the loader, so
+     * they load while the state before it fades out.
+     *
+     * @see loaderStart()
+     */
+    void langSelectPreload(void);
+
 #ifdef ACE_TEST_RUNNER
     extern tState g_stateTestRunner;
 #endif
@@ -9,6 +9,8 @@
 #include <ace/utils/font.h>
 #include <ace/utils/palette.h>
 
+#include <mtl/alloc_stats.h>
+
 #include "core/screen.h"
 
 namespace NEONengine
@@ -16,7 +18,7 @@ namespace NEONengine
     static tFont* s_pFont;
     static tTextBitMap* s_pTextBmp;
     static tTextBitMap* s_pElapsedTimeBmp;
-    static char s_memSize[64];
+    static char s_memSize[160];
     static char s_elapsedTime[32];
     static ULONG s_ulDelta = 0;
     static ULONG s_ulFps;
@@ -27,9 +29,9 @@ namespace NEONengine
     {
         logBlockBegin("debugViewCreate");
 
-        s_pFont = fontCreateFromPath("data/font.fnt");
+        s_pFont = assetsGetFont("data/font.fnt");
 
-        s_pTextBmp = fontCreateTextBitMap(160, s_pFont->uwHeight * 3);
+        s_pTextBmp = fontCreateTextBitMap(224, s_pFont->uwHeight * 4);
         s_pElapsedTimeBmp = fontCreateTextBitMap(160, s_pFont->uwHeight);
         s_ulDelta = timerGet();
 
@@ -47,7 +49,25 @@ namespace NEONengine
 
         s_ulDelta = ulNow;
 
-        sprintf(s_memSize, "Chip: %ld KB \nFast: %ld KB \nAny:  %ld KB ", memGetFreeChipSize() >> 10, AvailMem(MEMF_FAST) >> 10, AvailMem(MEMF_ANY) >> 10);
+        // Free memory, then what mtl has live/at peak in each type
+        auto const& stats = mtl::get_alloc_stats();
+        constexpr size_t CHIP = mtl::to<size_t>(mtl::alloc_mem::Chip);
+        auto const& chip = stats.byMem[CHIP];
+        auto const& fast = stats.byMem[mtl::to<size_t>(mtl::alloc_mem::Fast)];
+        auto const& any = stats.byMem[mtl::to<size_t>(mtl::alloc_mem::Any)];
+
+        // Subsystem holding the most Chip RAM
+        size_t topTag = 0;
+        for (size_t tag = 1; tag < mtl::ALLOC_TAG_COUNT; ++tag)
+        {
+            if (stats.byTagMem[tag][CHIP].liveBytes > stats.byTagMem[topTag][CHIP].liveBytes) topTag = tag;
+        }
+
+        sprintf(s_memSize, "Chip: %ld KB (%ld/%ld) \nFast: %ld KB (%ld/%ld) \nAny:  %ld KB (%ld/%ld) \nChip user: %s %ld KB ",
+                memGetFreeChipSize() >> 10, chip.liveBytes >> 10, chip.peakBytes >> 10,
+                AvailMem(MEMF_FAST) >> 10, fast.liveBytes >> 10, fast.peakBytes >> 10,
+                AvailMem(MEMF_ANY) >> 10, any.liveBytes >> 10, any.peakBytes >> 10,
+                mtl::alloc_tag_name(mtl::to<mtl::alloc_tag>(topTag)), stats.byTagMem[topTag][CHIP].liveBytes >> 10);
         //sprintf(s_memSize, "Chip: %ld KB ", memGetChipSize() >> 10);
         fontFillTextBitMap(s_pFont, s_pTextBmp, s_memSize);
 
@@ -63,7 +83,7 @@ namespace NEONengine
 
     void debugViewDestroy(void)
     {
-        fontDestroy(s_pFont);
+        assetsRelease(s_pFont);
         fontDestroyTextBitMap(s_pTextBmp);
         fontDestroyTextBitMap(s_pElapsedTimeBmp);
     }
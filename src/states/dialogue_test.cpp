@@ -12,13 +12,21 @@
 #include <ace++/bitmap.h>
 #include <ace++/font.h>
 
+#include <mtl/arena.h>
+
 #include "core/nine_patch.h"
 #include "core/screen.h"
 #include "core/text_render.h"
+#include "core/vfs.h"
 
 namespace NEONengine
 {
-    ace::font_ptr s_pFont{ nullptr };
+    constexpr size_t DIALOGUE_ARENA_SIZE = 2048;
+
+    // Everything the state allocates for itself, released in one go on exit
+    static mtl::arena s_arena(DIALOGUE_ARENA_SIZE, mtl::MemF::Fast);
+
+    font_handle s_pFont{ nullptr };
     text_renderer_ptr s_pTextRenderer{ nullptr };
 
     void dialogueTestCreate(void)
@@ -28,18 +36,19 @@ namespace NEONengine
         screenFadeFromBlack(g_mainScreen, 25, 0, nullptr);
         screenClear(g_mainScreen, 0);
 
-        paletteLoadFromPath("data/core/base.plt", screenGetPalette(g_mainScreen), 255);
-        auto pFont = ace::fontCreateFromPath("data/font.fnt");
+        assetsLoadPalette("data/core/base.plt", screenGetPalette(g_mainScreen), 255);
+        s_pFont = font_handle(assetsGetFont("data/font.fnt"));
 
-        auto renderer_result = text_renderer::create(pFont.get());
+        auto renderer_result = text_renderer::create(s_pFont.get(), &s_arena);
         if (!renderer_result)
         {
             NE_LOG("Failed to create text renderer: Error code %d",
                    mtl::to<int>(renderer_result.error()));
             return;
         }
+        s_pTextRenderer = mtl::move(renderer_result.value());
 
-        auto pPatchBitmap = ace::bitmapCreateFromPath("data/core/frame_9.bm", 0);
+        auto pPatchBitmap = ace::bitmap_ptr(vfsBitmapCreate("data/core/frame_9.bm", 0));
 
         bstr_view text
             = "I'm the love child of Icarus and Sisyphus; no matter how hard I try to rise above, "
@@ -91,8 +100,11 @@ namespace NEONengine
 
     void dialogueTestDestroy(void)
     {
-        s_pTextRenderer.release();
-        s_pFont.release();
+        // The renderer lives in the arena, only its destructor is left to run before the
+        // arena goes, to free what its line buffers spilled to the heap
+        if (s_pTextRenderer) { mtl::destroy_in_place(s_pTextRenderer.release()); }
+        s_arena.release();
+        s_pFont.reset(nullptr);
     }
 
     tState g_stateDialogueTest = {
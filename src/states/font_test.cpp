@@ -25,10 +25,13 @@ namespace NEONengine
                   UBYTE ubColorIdx,
                   text_justify justification)
     {
-        auto pTextBmp
-            = g_pEngine->default_text_renderer()->create_text(bstr, uwMaxWidth, justification);
-        fontDrawTextBitMap(
-            screenGetBackBuffer(g_mainScreen), pTextBmp.get(), uwX, uwY, ubColorIdx, FONT_COOKIE);
+        g_pEngine->default_text_renderer()->draw_text(screenGetBackBuffer(g_mainScreen),
+                                                      bstr,
+                                                      uwX,
+                                                      uwY,
+                                                      uwMaxWidth,
+                                                      ubColorIdx,
+                                                      justification);
     }
 
     void fontTestCreate(void)
@@ -38,7 +41,7 @@ namespace NEONengine
         screenFadeFromBlack(g_mainScreen, 25, 0, NULL);
         screenClear(g_mainScreen, 0);
 
-        paletteLoadFromPath("data/core/base.plt", screenGetPalette(g_mainScreen), 255);
+        assetsLoadPalette("data/core/base.plt", screenGetPalette(g_mainScreen), 255);
 
         drawText("Press the Spacebar",
                  0,
@@ -10,9 +10,12 @@
 
 #include <mtl/utility.h>
 
+#include "core/language.h"
 #include "core/layer.h"
+#include "core/loader.h"
 #include "core/mouse_pointer.h"
 #include "core/screen.h"
+#include "core/vfs.h"
 
 namespace NEONengine
 {
@@ -80,6 +83,15 @@ namespace NEONengine
     void cbOnReleased(Hotspot *pHotspot)
     {
         logWrite("Releasing %d", (UWORD)(ULONG)pHotspot->context);
+
+        // The rows of the atlas are in the order of the languages
+        intptr_t id = CONTEXT_GET_ID((intptr_t)pHotspot->context);
+        languageSet(mtl::to<Language>(id >> 1));
+    }
+
+    void langSelectPreload(void)
+    {
+        loaderAddBitmap("data/core/flags.bm", 0, &s_pFlagsAtlas);
     }
 
     void langSelectCreate(void)
@@ -88,8 +100,12 @@ namespace NEONengine
         screenFadeFromBlack(g_mainScreen, FADE_DURATION, 0, NULL);
         screenClear(g_mainScreen, 0);
 
-        paletteLoadFromPath("data/core/base.plt", screenGetPalette(g_mainScreen), 255);
-        s_pFlagsAtlas = bitmapCreateFromPath("data/core/flags.bm", 0);
+        // The palette is still fading out until now, so it is loaded here
+        assetsLoadPalette("data/core/base.plt", screenGetPalette(g_mainScreen), 255);
+
+        // Whatever was preloaded and is not done yet, or failed
+        loaderFinish();
+        if (!s_pFlagsAtlas) { s_pFlagsAtlas = vfsBitmapCreate("data/core/flags.bm", 0); }
 
         mousePointerCreate("data/core/pointers.bm");
         s_flagsLayer = layerCreate();
@@ -164,6 +180,7 @@ namespace NEONengine
         logBlockEnd(STATE_NAME);
 
         bitmapDestroy(s_pFlagsAtlas);
+        s_pFlagsAtlas = NULL;
 
         mousePointerDestroy();
         layerDestroy(s_flagsLayer);
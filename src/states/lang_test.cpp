@@ -8,6 +8,7 @@
 #include <ace++/font.h>
 #include <ace++/log.h>
 
+#include <mtl/arena.h>
 #include <mtl/utility.h>
 
 #include "core/screen.h"
@@ -16,6 +17,11 @@
 
 namespace NEONengine
 {
+    constexpr size_t LANG_TEST_ARENA_SIZE = 1024;
+
+    // Holds the string table for as long as the state is active
+    static mtl::arena s_arena(LANG_TEST_ARENA_SIZE, mtl::MemF::Fast);
+
     void langTestCreate()
     {
         ACE_LOG_BLOCK("langTestCreate");
@@ -23,9 +29,9 @@ namespace NEONengine
         screenFadeFromBlack(g_mainScreen, 25, 0, nullptr);
         screenClear(g_mainScreen, 0);
 
-        paletteLoadFromPath("data/core/base.plt", screenGetPalette(g_mainScreen), 255);
+        assetsLoadPalette("data/core/base.plt", screenGetPalette(g_mainScreen), 255);
 
-        auto string_result = string_table::create_from_file("data/lang/test.noir");
+        auto string_result = string_table::create_from_file("data/lang/test.noir", &s_arena);
         if (!string_result)
         {
             NE_LOG("Failed to load string table: Error code %d",
@@ -46,7 +52,10 @@ namespace NEONengine
 
     void langTestProcess() {}
 
-    void langTestDestroy() {}
+    void langTestDestroy()
+    {
+        s_arena.release();
+    }
 
     tState g_stateLangTest = {
         .cbCreate  = langTestCreate,
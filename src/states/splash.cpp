@@ -5,8 +5,10 @@
 #include <ace/managers/viewport/simplebuffer.h>
 #include <ace/utils/palette.h>
 
+#include "core/loader.h"
 #include "core/music.h"
 #include "core/screen.h"
+#include "core/vfs.h"
 
 namespace NEONengine
 {
@@ -19,6 +21,8 @@ namespace NEONengine
 
     static enum SplashState s_currentState;
     static UWORD s_uwDelay;
+    static UBYTE s_ubFadedOut;
+    static UBYTE s_ubPreloaded;
 
     #define STATE_NAME "State: Splash Screen"
     #define FADE_DURATION 25
@@ -28,13 +32,15 @@ namespace NEONengine
     void processState(void);
     void onFadeInComplete(void);
     void onFadeOutComplete(void);
+    void onPreloadComplete(UBYTE ubSuccess);
+    void leaveWhenReady(void);
 
     void splashCreate(void)
     {
         logBlockBegin(STATE_NAME);
 
-        paletteLoadFromPath("data/mpg.plt", screenGetPalette(g_mainScreen), 255);
-        tBitMap *pLogo = bitmapCreateFromPath("data/mpg.bm", 0);
+        vfsPaletteLoad("data/mpg.plt", screenGetPalette(g_mainScreen), 255);
+        tBitMap *pLogo = vfsBitmapCreate("data/mpg.bm", 0);
 
         screenBlitCopy(g_mainScreen, pLogo, 0, 0, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, MINTERM_COPY);
 
@@ -73,6 +79,11 @@ namespace NEONengine
                 break;
 
             case SPLASH_STATE_FADE_OUT:
+                // The language selection loads while the logo fades out
+                s_ubFadedOut  = 0;
+                s_ubPreloaded = 0;
+                langSelectPreload();
+                loaderStart(onPreloadComplete);
                 screenFadeToBlack(g_mainScreen, FADE_DURATION, 0, onFadeOutComplete);
                 break;
         }
@@ -109,9 +120,29 @@ namespace NEONengine
         changeState(SPLASH_STATE_WAIT);
     }
 
+    /*
+    * Leaves once both the fade and the preload are done, whichever is last.
+    */
+    void leaveWhenReady(void)
+    {
+        if (s_ubFadedOut && s_ubPreloaded)
+        {
+            stateChange(g_gameStateManager, &g_stateLangSelect);
+        }
+    }
+
     void onFadeOutComplete(void)
     {
-        stateChange(g_gameStateManager, &g_stateLangSelect);
+        s_ubFadedOut = 1;
+        leaveWhenReady();
+    }
+
+    void onPreloadComplete(UBYTE ubSuccess)
+    {
+        // The language selection loads anything that failed itself
+        (void)ubSuccess;
+        s_ubPreloaded = 1;
+        leaveWhenReady();
     }
 
     void splashDestroy(void)
@@ -0,0 +1,106 @@
+#ifndef __ALLOC_STATS_TESTS_H__INCLUDED__
+#define __ALLOC_STATS_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include "mtl/alloc_stats.h"
+#include "mtl/arena.h"
+#include "mtl/memory.h"
+#include "test_macros.h"
+
+#ifdef MTL_ALLOC_STATS
+
+namespace NEONengine::tests
+{
+    constexpr size_t STATS_FAST = mtl::to<size_t>(mtl::alloc_mem::Fast);
+    constexpr size_t STATS_CHIP = mtl::to<size_t>(mtl::alloc_mem::Chip);
+    constexpr size_t STATS_UI   = mtl::to<size_t>(mtl::alloc_tag::Ui);
+
+    TEST_IMPL(test_alloc_stats_counts_new_and_delete)
+    {
+        auto const& fast     = mtl::get_alloc_stats().byMem[STATS_FAST];
+        uint32_t liveBefore  = fast.liveBytes;
+        uint32_t allocBefore = fast.allocCount;
+        uint32_t freeBefore  = fast.freeCount;
+
+        auto pBlock = new (mtl::MemF::Fast) uint8_t[300];
+        TEST_ASSERT(fast.liveBytes >= liveBefore + 300, "Live bytes did not grow");
+        TEST_ASSERT(fast.allocCount == allocBefore + 1, "Allocation was not counted");
+
+        delete[] pBlock;
+        TEST_ASSERT(fast.liveBytes == liveBefore, "Live bytes did not return to start");
+        TEST_ASSERT(fast.freeCount == freeBefore + 1, "Free was not counted");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_alloc_stats_attributes_tag_and_mem)
+    {
+        auto const& uiChip  = mtl::get_alloc_stats().byTagMem[STATS_UI][STATS_CHIP];
+        uint32_t liveBefore = uiChip.liveBytes;
+
+        uint8_t* pBlock;
+        {
+            auto tag = mtl::alloc_tag_scope(mtl::alloc_tag::Ui);
+            pBlock   = new (mtl::MemF::Chip) uint8_t[20];
+        }
+        TEST_ASSERT(mtl::current_alloc_tag() == mtl::alloc_tag::Untagged, "Tag scope leaked");
+        TEST_ASSERT(uiChip.liveBytes > liveBefore, "Tagged Chip block was not attributed");
+
+        // Freed outside the scope, still credited back to the right tag
+        delete[] pBlock;
+        TEST_ASSERT(uiChip.liveBytes == liveBefore, "Free was attributed to another tag");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_alloc_stats_tracks_peak)
+    {
+        auto const& total = mtl::get_alloc_stats().total;
+        mtl::reset_alloc_peaks();
+        uint32_t liveBefore = total.liveBytes;
+
+        auto pBlock = new uint8_t[1000];
+        delete[] pBlock;
+
+        TEST_ASSERT(total.peakBytes >= liveBefore + 1000, "Peak did not record the block");
+        mtl::reset_alloc_peaks();
+        TEST_ASSERT(total.peakBytes == total.liveBytes, "Peak was not reset");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_alloc_stats_histogram_uses_requested_size)
+    {
+        auto const& histogram = mtl::get_alloc_stats().histogram;
+        uint32_t before       = histogram[2];  // 17..24 bytes
+
+        delete[] new uint8_t[24];
+        TEST_ASSERT(histogram[2] == before + 1, "Allocation landed in the wrong bin");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_alloc_stats_counts_arena_blocks)
+    {
+        auto const& fast    = mtl::get_alloc_stats().byMem[STATS_FAST];
+        uint32_t liveBefore = fast.liveBytes;
+        {
+            mtl::arena arena(512, mtl::MemF::Fast);
+            arena.allocate(16);
+            TEST_ASSERT(fast.liveBytes >= liveBefore + 512, "Arena block was not counted");
+        }
+        TEST_ASSERT(fast.liveBytes == liveBefore, "Released arena block was not counted");
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(alloc_stats)
+    TEST(test_alloc_stats_counts_new_and_delete)
+    TEST(test_alloc_stats_attributes_tag_and_mem)
+    TEST(test_alloc_stats_tracks_peak)
+    TEST(test_alloc_stats_histogram_uses_requested_size)
+    TEST(test_alloc_stats_counts_arena_blocks)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // MTL_ALLOC_STATS
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __ALLOC_STATS_TESTS_H__INCLUDED__
@@ -0,0 +1,113 @@
+#ifndef __ARENA_TESTS_H__INCLUDED__
+#define __ARENA_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include <stdint.h>
+
+#include "mtl/arena.h"
+#include "test_macros.h"
+
+namespace NEONengine::tests
+{
+    struct arena_tracked
+    {
+        explicit arena_tracked(int* pDestroyed) : _pDestroyed(pDestroyed) {}
+        ~arena_tracked() { ++*_pDestroyed; }
+
+        int* _pDestroyed;
+    };
+
+    TEST_IMPL(test_arena_respects_alignment)
+    {
+        mtl::arena arena(256);
+        arena.allocate(1, 1);
+        void* ptr = arena.allocate(8, 8);
+        TEST_ASSERT((reinterpret_cast<uintptr_t>(ptr) & 7) == 0, "Allocation is not aligned");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_arena_reset_reclaims_memory)
+    {
+        mtl::arena arena(256);
+        void* first = arena.allocate(64);
+        arena.allocate(64);
+        arena.reset();
+
+        TEST_ASSERT(arena.used() == 0, "Reset did not clear the used byte count");
+        TEST_ASSERT(arena.allocate(64) == first, "Reset did not rewind the arena");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_arena_chains_overflow_blocks)
+    {
+        mtl::arena arena(64);
+        void* small = arena.allocate(48);
+        void* large = arena.allocate(200);
+
+        TEST_ASSERT(small && large, "Arena did not grow past its first block");
+        TEST_ASSERT(arena.owns(small) && arena.owns(large), "Arena does not own its blocks");
+
+        arena.reset();
+        TEST_ASSERT(!arena.owns(large), "Overflow block survived a reset");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_arena_create_destroys_on_reset)
+    {
+        int destroyed = 0;
+        mtl::arena arena(256);
+        arena.create<arena_tracked>(&destroyed);
+        arena.create<arena_tracked>(&destroyed);
+        TEST_ASSERT(destroyed == 0, "Objects destroyed too early");
+
+        arena.reset();
+        TEST_ASSERT(destroyed == 2, "Reset did not run the destructors");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_arena_unique_ptr_destroys_in_place)
+    {
+        int destroyed = 0;
+        mtl::arena arena(256);
+        {
+            auto pTracked = mtl::make_unique<arena_tracked>(arena, &destroyed);
+            TEST_ASSERT(arena.owns(pTracked.get()), "Object was not placed in the arena");
+        }
+        TEST_ASSERT(destroyed == 1, "arena_ptr did not run the destructor");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_arena_vector_uses_arena)
+    {
+        mtl::arena arena(256);
+        auto numbers = mtl::arena_vector<int>(mtl::arena_allocator(&arena));
+        for (int i = 0; i < 10; ++i) { numbers.push_back(i); }
+
+        TEST_ASSERT(arena.owns(numbers.data()), "Vector storage is not in the arena");
+        TEST_ASSERT(numbers[9] == 9, "Vector lost its contents while growing");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_arena_placement_new)
+    {
+        mtl::arena arena(256);
+        auto pValues = new (arena) uint32_t[4];
+        TEST_ASSERT(arena.owns(pValues), "Placement new did not use the arena");
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(arena)
+    TEST(test_arena_respects_alignment)
+    TEST(test_arena_reset_reclaims_memory)
+    TEST(test_arena_chains_overflow_blocks)
+    TEST(test_arena_create_destroys_on_reset)
+    TEST(test_arena_unique_ptr_destroys_in_place)
+    TEST(test_arena_vector_uses_arena)
+    TEST(test_arena_placement_new)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __ARENA_TESTS_H__INCLUDED__
@@ -0,0 +1,96 @@
+#ifndef __BITSET_TESTS_H__INCLUDED__
+#define __BITSET_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include "mtl/bitset.h"
+#include "test_macros.h"
+
+namespace NEONengine::tests
+{
+    static_assert(mtl::popcount(0xF0F0000Fu) == 12);
+    static_assert(sizeof(mtl::bitset<64>) == 8);
+
+    TEST_IMPL(test_bitset_set_clear_test)
+    {
+        mtl::bitset<100> bits;
+        TEST_ASSERT(bits.none(), "New bitset is not empty");
+
+        bits.set(0);
+        bits.set(31);
+        bits.set(32);
+        bits.set(99);
+        bits.assign(50, true);
+        bits.assign(31, false);
+
+        TEST_ASSERT(bits.test(0) && bits.test(32) && bits.test(50) && bits.test(99), "Bit not set");
+        TEST_ASSERT(!bits.test(31) && !bits.test(1), "Bit set unexpectedly");
+        TEST_ASSERT(bits.count() == 4, "Wrong count");
+        TEST_ASSERT(bits.word(1) == 0x00040001u, "Bits landed in the wrong word");
+
+        bits.clear(0);
+        bits.flip(99);
+        TEST_ASSERT(bits.count() == 2, "Clear or flip failed");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_bitset_all_ignores_unused_bits)
+    {
+        mtl::bitset<40> bits;
+        bits.set_all();
+        TEST_ASSERT(bits.all() && bits.count() == 40, "set_all set unused bits");
+
+        bits.clear(39);
+        TEST_ASSERT(!bits.all() && bits.any(), "all() missed a cleared bit");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_dynamic_bitset_resize_keeps_bits)
+    {
+        mtl::dynamic_bitset<> bits(20);
+        bits.set(3);
+        bits.set(19);
+
+        TEST_ASSERT(bits.resize(300), "Resize failed");
+        TEST_ASSERT(bits.test(3) && bits.test(19) && bits.count() == 2, "Bits lost growing");
+
+        bits.set(250);
+        TEST_ASSERT(bits.resize(10), "Shrink failed");
+        TEST_ASSERT(bits.test(3) && bits.count() == 1, "Shrinking kept dropped bits");
+
+        TEST_ASSERT(bits.resize(64) && !bits.test(19), "Dropped bit came back");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_dynamic_bitset_snapshot_restore)
+    {
+        mtl::dynamic_bitset<> bits(70);
+        bits.set(1);
+        bits.set(69);
+
+        uint32_t saved[3];
+        TEST_ASSERT(bits.snapshot_size() == sizeof(saved), "Unexpected snapshot size");
+        bits.snapshot(saved);
+
+        bits.clear_all();
+        bits.set(5);
+        TEST_ASSERT(bits.restore(saved, sizeof(saved)), "Restore reported a size mismatch");
+        TEST_ASSERT(bits.test(1) && bits.test(69) && !bits.test(5), "Restore lost bits");
+
+        // An older, shorter save restores what it has and clears the rest
+        TEST_ASSERT(!bits.restore(saved, sizeof(uint32_t)), "Short restore reported a match");
+        TEST_ASSERT(bits.test(1) && !bits.test(69), "Short restore was not cleared");
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(bitset)
+    TEST(test_bitset_set_clear_test)
+    TEST(test_bitset_all_ignores_unused_bits)
+    TEST(test_dynamic_bitset_resize_keeps_bits)
+    TEST(test_dynamic_bitset_snapshot_restore)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __BITSET_TESTS_H__INCLUDED__
@@ -0,0 +1,91 @@
+#ifndef __FLAT_HASH_MAP_TESTS_H__INCLUDED__
+#define __FLAT_HASH_MAP_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include "mtl/flat_hash_map.h"
+#include "utils/bstr_view.h"
+#include "test_macros.h"
+
+namespace NEONengine::tests
+{
+    static_assert(mtl::hash<bstr_view>()("neon") == mtl::hash_bytes("neon", 4));
+
+    TEST_IMPL(test_flat_hash_map_insert_and_find)
+    {
+        mtl::flat_hash_map<uint16_t, int> map;
+        for (uint16_t id = 0; id < 200; ++id)
+        {
+            TEST_ASSERT(map.insert(id, id * 3), "Insert failed");
+        }
+
+        TEST_ASSERT(map.size() == 200, "Wrong size");
+        TEST_ASSERT(!map.insert(7, 0), "Duplicate key was inserted");
+        for (uint16_t id = 0; id < 200; ++id)
+        {
+            auto pValue = map.find(id);
+            TEST_ASSERT(pValue && *pValue == id * 3, "Value not found");
+        }
+        TEST_ASSERT(!map.find(200), "Found a key that was never inserted");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_flat_hash_map_capacity_is_power_of_two)
+    {
+        mtl::flat_hash_map<uint32_t, uint32_t> map(100);
+        size_t capacity = map.capacity();
+
+        TEST_ASSERT(capacity >= 100 && (capacity & (capacity - 1)) == 0, "Bad capacity");
+        for (uint32_t i = 0; i < 100; ++i) { map[i * 1024] = i; }
+        TEST_ASSERT(map.capacity() == capacity, "Grew despite reserve()");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_flat_hash_map_erase_keeps_chains)
+    {
+        mtl::flat_hash_map<uint32_t, uint32_t> map;
+        for (uint32_t i = 0; i < 48; ++i) { map.insert(i, i); }
+
+        // Erase every other key, the rest must stay reachable
+        for (uint32_t i = 0; i < 48; i += 2) { TEST_ASSERT(map.erase(i), "Erase failed"); }
+        TEST_ASSERT(!map.erase(0), "Erased a missing key");
+        TEST_ASSERT(map.size() == 24, "Wrong size after erase");
+        for (uint32_t i = 1; i < 48; i += 2) { TEST_ASSERT(map.contains(i), "Key lost in erase"); }
+        for (uint32_t i = 0; i < 48; i += 2) { TEST_ASSERT(!map.contains(i), "Erased key found"); }
+
+        size_t visited = 0;
+        for (auto const& item : map)
+        {
+            TEST_ASSERT(item.key == item.value, "Iterator returned a bad entry");
+            ++visited;
+        }
+        TEST_ASSERT(visited == 24, "Iterator skipped or repeated entries");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_flat_hash_map_string_keys)
+    {
+        mtl::flat_hash_map<bstr_view, int> map;
+        map.insert("door", 1);
+        map.insert("window", 2);
+        map["painting"] = 3;
+
+        char key[] = { 'w', 'i', 'n', 'd', 'o', 'w' };
+        auto pValue = map.find(bstr_view(key, sizeof(key)));
+        TEST_ASSERT(pValue && *pValue == 2, "Lookup by equal string failed");
+        TEST_ASSERT(map["painting"] == 3 && map.size() == 3, "operator[] failed");
+        TEST_ASSERT(!map.contains("wind"), "Found a prefix");
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(flat_hash_map)
+    TEST(test_flat_hash_map_insert_and_find)
+    TEST(test_flat_hash_map_capacity_is_power_of_two)
+    TEST(test_flat_hash_map_erase_keeps_chains)
+    TEST(test_flat_hash_map_string_keys)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __FLAT_HASH_MAP_TESTS_H__INCLUDED__
@@ -0,0 +1,74 @@
+#ifndef __LANGUAGE_TESTS_H__INCLUDED__
+#define __LANGUAGE_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include <ace/managers/log.h>
+
+#include "core/language.h"
+#include "core/vfs.h"
+#include "mtl/alloc_stats.h"
+#include "test_macros.h"
+
+#ifdef MTL_ALLOC_STATS
+
+namespace NEONengine::tests
+{
+    // English and Italian, both with the English strings, see the top level CMakeLists.txt
+    constexpr char const* LANGUAGE_TEST_PACK = "data/lang/test_languages.noir";
+
+    // Switches back and forth, with no language loaded before or after
+    static char const* languageSwitchBackAndForth()
+    {
+        auto const& text    = mtl::get_alloc_stats().byTag[mtl::to<size_t>(mtl::alloc_tag::Text)];
+        uint32_t liveBefore = text.liveBytes;
+
+        TEST_ASSERT(languageCreate(Language::EN, LANGUAGE_TEST_PACK), "Could not load English");
+        uint32_t liveLoaded = text.liveBytes;
+        TEST_ASSERT(liveLoaded > liveBefore, "Strings were not counted as Text");
+
+        for (int i = 0; i < 3; ++i)
+        {
+            TEST_ASSERT(languageSet(Language::IT), "Could not switch to Italian");
+            TEST_ASSERT(text.liveBytes == liveLoaded, "Switching kept the old tables");
+            TEST_ASSERT(languageSet(Language::EN), "Could not switch back to English");
+            TEST_ASSERT(text.liveBytes == liveLoaded, "Switching back kept the old tables");
+        }
+
+        languageDestroy();
+        TEST_ASSERT(text.liveBytes == liveBefore, "languageDestroy() kept the tables");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_language_switch_frees_old_tables)
+    {
+        // The pack is only built with noirpack, see the top level CMakeLists.txt
+        tFile* pPack = vfsOpen(LANGUAGE_TEST_PACK);
+        if (!pPack)
+        {
+            logWrite("SKIP: no '%s', noirpack was not found", LANGUAGE_TEST_PACK);
+            TEST_SUCCESS;
+        }
+        fileClose(pPack);
+
+        // The language the engine loaded would otherwise count as the baseline
+        languageDestroy();
+        char const* szError = languageSwitchBackAndForth();
+        languageDestroy();
+
+        // Back to the language the rest of the run expects
+        languageCreate(Language::EN);
+        TEST_ASSERT(!szError, szError);
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(language)
+    TEST(test_language_switch_frees_old_tables)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // MTL_ALLOC_STATS
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __LANGUAGE_TESTS_H__INCLUDED__
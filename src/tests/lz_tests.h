@@ -0,0 +1,79 @@
+#ifndef __LZ_TESTS_H__INCLUDED__
+#define __LZ_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include "test_macros.h"
+#include "utils/lz.h"
+
+namespace NEONengine::tests
+{
+    // "AB", a match overlapping its own output, then "C": ABABABABABC
+    static UBYTE const s_lzOverlap[] = { 0x24, 'A', 'B', 0x00, 0x02, 0x10, 'C' };
+
+    // 'Z', then a 300 byte match at offset 1, which needs two length bytes
+    static UBYTE const s_lzLongRun[] = { 0x1F, 'Z', 0x00, 0x01, 255, 26, 0x00 };
+
+    TEST_IMPL(test_lz_decompresses_matches)
+    {
+        UBYTE ubOut[302];
+
+        ubOut[11] = 0xAA;
+        TEST_ASSERT(lzDecompress(s_lzOverlap, sizeof(s_lzOverlap), ubOut, 11),
+                    "Valid stream was rejected");
+        TEST_ASSERT(__builtin_memcmp(ubOut, "ABABABABABC", 11) == 0, "Wrong output");
+        TEST_ASSERT(ubOut[11] == 0xAA, "Wrote past the output");
+
+        ubOut[301] = 0xAA;
+        TEST_ASSERT(lzDecompress(s_lzLongRun, sizeof(s_lzLongRun), ubOut, 301),
+                    "Long match was rejected");
+        for (UWORD i = 0; i < 301; ++i) { TEST_ASSERT(ubOut[i] == 'Z', "Wrong run output"); }
+        TEST_ASSERT(ubOut[301] == 0xAA, "Wrote past the output");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_lz_decompresses_in_place)
+    {
+        // The stream sits at the end of the buffer, 4 bytes past the output
+        UBYTE ubBuffer[15];
+        UBYTE *pStream = ubBuffer + sizeof(ubBuffer) - sizeof(s_lzOverlap);
+        __builtin_memcpy(pStream, s_lzOverlap, sizeof(s_lzOverlap));
+
+        TEST_ASSERT(lzDecompress(pStream, sizeof(s_lzOverlap), ubBuffer, 11),
+                    "In place decompression failed");
+        TEST_ASSERT(__builtin_memcmp(ubBuffer, "ABABABABABC", 11) == 0, "Wrong output");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_lz_rejects_corrupt_streams)
+    {
+        static UBYTE const farMatch[]  = { 0x10, 'A', 0x00, 0x02, 0x00 };
+        static UBYTE const noOffset[]  = { 0x10, 'A', 0x00, 0x00, 0x00 };
+        static UBYTE const halfMatch[] = { 0x10, 'A', 0x00 };
+        static UBYTE const longLits[]  = { 0x50, 'A', 'B' };
+        UBYTE ubOut[16];
+
+        TEST_ASSERT(!lzDecompress(farMatch, sizeof(farMatch), ubOut, 5),
+                    "Match before the output was accepted");
+        TEST_ASSERT(!lzDecompress(noOffset, sizeof(noOffset), ubOut, 5), "Offset 0 was accepted");
+        TEST_ASSERT(!lzDecompress(halfMatch, sizeof(halfMatch), ubOut, 5),
+                    "Cut short offset was accepted");
+        TEST_ASSERT(!lzDecompress(longLits, sizeof(longLits), ubOut, 5),
+                    "Literals past the stream were accepted");
+        TEST_ASSERT(!lzDecompress(s_lzOverlap, sizeof(s_lzOverlap), ubOut, 10),
+                    "Output past its size was accepted");
+        TEST_ASSERT(!lzDecompress(s_lzOverlap, sizeof(s_lzOverlap), ubOut, 12),
+                    "Short output was accepted");
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(lz)
+    TEST(test_lz_decompresses_matches)
+    TEST(test_lz_decompresses_in_place)
+    TEST(test_lz_rejects_corrupt_streams)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __LZ_TESTS_H__INCLUDED__
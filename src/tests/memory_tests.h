@@ -0,0 +1,112 @@
+#ifndef __MEMORY_TESTS_H__INCLUDED__
+#define __MEMORY_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include <ace/managers/memory.h>
+
+#include "mtl/memory.h"
+#include "mtl/slab.h"
+#include "mtl/vector.h"
+#include "test_macros.h"
+
+namespace NEONengine::tests
+{
+    struct sized_tracked
+    {
+        explicit sized_tracked(int* pDestroyed) : _pDestroyed(pDestroyed) {}
+        ~sized_tracked() { ++*_pDestroyed; }
+
+        int* _pDestroyed;
+    };
+
+    TEST_IMPL(test_sized_alloc_small_blocks_use_slabs)
+    {
+        void* ptr = mtl::sized_alloc(24, MEMF_FAST);
+        TEST_ASSERT(ptr, "Could not allocate");
+        TEST_ASSERT(mtl::slab_block_size(ptr) != 0, "Small sized block did not come from a slab");
+        mtl::sized_free(ptr, 24);
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_sized_alloc_large_blocks_round_trip)
+    {
+        auto pBlock = static_cast<UBYTE*>(mtl::sized_alloc(1000, MEMF_FAST | MEMF_CLEAR));
+        TEST_ASSERT(pBlock, "Could not allocate");
+        TEST_ASSERT(mtl::slab_block_size(pBlock) == 0, "Large block came from a slab");
+        for (int i = 0; i < 1000; ++i) { TEST_ASSERT(pBlock[i] == 0, "Block not cleared"); }
+        mtl::sized_free(pBlock, 1000);
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_sized_make_unique_frees_object)
+    {
+        int destroyed = 0;
+        {
+            auto pTracked = mtl::make_unique<sized_tracked>(&destroyed);
+            TEST_ASSERT(pTracked, "Could not allocate");
+        }
+        TEST_ASSERT(destroyed == 1, "Object was not destroyed with its pointer");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_sized_vector_survives_growth)
+    {
+        mtl::vector<uint32_t> values;
+        for (uint32_t i = 0; i < 500; ++i) { values.push_back(i); }
+        for (uint32_t i = 0; i < 500; ++i) { TEST_ASSERT(values[i] == i, "Vector lost data"); }
+
+        values.shrink_to_fit();
+        TEST_ASSERT(values.capacity() == 500, "Vector did not shrink");
+        TEST_ASSERT(values[499] == 499, "Vector lost data while shrinking");
+        TEST_SUCCESS;
+    }
+
+    static char s_purgeOrder[4];
+    static int s_purgeCount;
+
+    static size_t purgeFirst(size_t, ULONG)
+    {
+        s_purgeOrder[s_purgeCount++] = 'a';
+        return 10;
+    }
+
+    static size_t purgeSecond(size_t, ULONG)
+    {
+        s_purgeOrder[s_purgeCount++] = 'b';
+        return 10;
+    }
+
+    TEST_IMPL(test_purgers_run_in_priority_order)
+    {
+        s_purgeCount = 0;
+        TEST_ASSERT(mtl::add_purger(purgeSecond, 200), "Could not add purger");
+        TEST_ASSERT(mtl::add_purger(purgeFirst, 10), "Could not add purger");
+
+        TEST_ASSERT(mtl::purge_memory(15, MEMF_FAST) == 20, "Wrong number of bytes freed");
+        TEST_ASSERT(s_purgeCount == 2 && s_purgeOrder[0] == 'a' && s_purgeOrder[1] == 'b',
+                    "Purgers ran out of order");
+
+        // The first one frees enough on its own
+        s_purgeCount = 0;
+        TEST_ASSERT(mtl::purge_memory(5, MEMF_FAST) == 10, "Wrong number of bytes freed");
+        TEST_ASSERT(s_purgeCount == 1, "Purged more than needed");
+
+        mtl::remove_purger(purgeFirst);
+        mtl::remove_purger(purgeSecond);
+        TEST_ASSERT(mtl::purge_memory(5, MEMF_FAST) == 0, "Purger still registered");
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(memory)
+    TEST(test_sized_alloc_small_blocks_use_slabs)
+    TEST(test_sized_alloc_large_blocks_round_trip)
+    TEST(test_sized_make_unique_frees_object)
+    TEST(test_sized_vector_survives_growth)
+    TEST(test_purgers_run_in_priority_order)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __MEMORY_TESTS_H__INCLUDED__
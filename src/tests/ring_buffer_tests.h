@@ -0,0 +1,53 @@
+#ifndef __RING_BUFFER_TESTS_H__INCLUDED__
+#define __RING_BUFFER_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include "mtl/ring_buffer.h"
+#include "test_macros.h"
+
+namespace NEONengine::tests
+{
+    TEST_IMPL(test_ring_buffer_fifo_order_and_full)
+    {
+        mtl::ring_buffer<int, 4> buffer;
+        for (int i = 0; i < 4; ++i) { TEST_ASSERT(buffer.push(i), "Push into free slot failed"); }
+        TEST_ASSERT(buffer.full() && !buffer.push(4), "Push into a full buffer succeeded");
+
+        int value = -1;
+        for (int i = 0; i < 4; ++i)
+        {
+            TEST_ASSERT(buffer.pop(value) && value == i, "Popped out of order");
+        }
+        TEST_ASSERT(buffer.empty() && !buffer.pop(value), "Pop from an empty buffer succeeded");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_ring_buffer_wraps_around)
+    {
+        mtl::ring_buffer<uint16_t, 8> buffer;
+        uint16_t next = 0, expected = 0, value;
+
+        // Keep the fill level moving so the indices wrap many times
+        for (int round = 0; round < 100; ++round)
+        {
+            for (int i = 0; i < 5; ++i) { buffer.push(next++); }
+            TEST_ASSERT(buffer.peek() && *buffer.peek() == expected, "Peek returned the wrong item");
+            while (buffer.size() > 2)
+            {
+                buffer.pop(value);
+                TEST_ASSERT(value == expected++, "Item lost while wrapping");
+            }
+        }
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(ring_buffer)
+    TEST(test_ring_buffer_fifo_order_and_full)
+    TEST(test_ring_buffer_wraps_around)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __RING_BUFFER_TESTS_H__INCLUDED__
@@ -0,0 +1,147 @@
+#ifndef __SCRIPT_TESTS_H__INCLUDED__
+#define __SCRIPT_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include "core/game_flags.h"
+#include "core/script.h"
+#include "test_macros.h"
+
+namespace NEONengine::tests
+{
+    struct script_test_log
+    {
+        UWORD uwSaid[4];
+        UBYTE ubSaidCount;
+        UBYTE ubWaitOnSay;
+    };
+
+    static UBYTE scriptTestCommand(ScriptOp eOp, UWORD const *puwArgs, void *pUserData)
+    {
+        auto *pLog = static_cast<script_test_log *>(pUserData);
+        if (eOp == ScriptOp::SAY && pLog->ubSaidCount < 4)
+        {
+            pLog->uwSaid[pLog->ubSaidCount++] = puwArgs[0];
+        }
+        return !pLog->ubWaitOnSay;
+    }
+
+    // if (flag 1) { say 100; set flag 2 } say 200
+    static UWORD const s_branchScript[] = {
+        3, 1,      // 0: PUSH_FLAG 1
+        34, 7,     // 2: JUMP_IF_FALSE -> 9
+        144, 100,  // 4: SAY 100
+        2, 4, 2,   // 6: SET flag 2
+        144, 200,  // 9: SAY 200
+        47,        // 11: END
+    };
+
+    TEST_IMPL(test_script_branches_on_flags)
+    {
+        TEST_ASSERT(gameFlagsReserve(8), "Could not reserve flags");
+        gameFlagsClearAll();
+        TEST_ASSERT(scriptLoad(s_branchScript, sizeof(s_branchScript) / sizeof(UWORD)),
+                    "Valid bytecode was rejected");
+
+        script_test_log log = {};
+        ScriptVm vm;
+        scriptVmInit(&vm, scriptTestCommand, &log);
+
+        TEST_ASSERT(scriptStart(&vm, 0), "Could not start the script");
+        TEST_ASSERT(scriptRun(&vm, SCRIPT_FRAME_BUDGET) == ScriptStatus::IDLE,
+                    "Script did not end");
+        TEST_ASSERT(log.ubSaidCount == 1 && log.uwSaid[0] == 200, "Took the wrong branch");
+        TEST_ASSERT(!gameFlagIsSet(2), "Skipped code set a flag");
+
+        log.ubSaidCount = 0;
+        gameFlagSet(1);
+        scriptStart(&vm, 0);
+        TEST_ASSERT(scriptRun(&vm, SCRIPT_FRAME_BUDGET) == ScriptStatus::IDLE,
+                    "Script did not end");
+        TEST_ASSERT(log.ubSaidCount == 2 && log.uwSaid[0] == 100 && log.uwSaid[1] == 200,
+                    "Took the wrong branch");
+        TEST_ASSERT(gameFlagIsSet(2), "Flag was not set");
+
+        scriptUnload();
+        gameFlagsClearAll();
+        TEST_SUCCESS;
+    }
+
+    // An endless loop, two lines of text and a loop pushing until the stack overflows
+    static UWORD const s_loopScript[] = {
+        32, 0,       // 0: JUMP -> 0
+        144, 1,      // 2: SAY 1
+        144, 2,      // 4: SAY 2
+        47,          // 6: END
+        3, 0,        // 7: PUSH_FLAG 0
+        32, 0xFFFE,  // 9: JUMP -> 7
+    };
+
+    TEST_IMPL(test_script_budget_wait_and_stack)
+    {
+        TEST_ASSERT(gameFlagsReserve(8), "Could not reserve flags");
+        TEST_ASSERT(scriptLoad(s_loopScript, sizeof(s_loopScript) / sizeof(UWORD)),
+                    "Valid bytecode was rejected");
+
+        script_test_log log = {};
+        ScriptVm vm;
+        scriptVmInit(&vm, scriptTestCommand, &log);
+
+        scriptStart(&vm, 0);
+        TEST_ASSERT(scriptRun(&vm, 10) == ScriptStatus::RUNNING, "Budget did not stop the loop");
+        TEST_ASSERT(scriptRun(&vm, 10) == ScriptStatus::RUNNING, "Budget did not stop the loop");
+        TEST_ASSERT(vm.ulInstructionCount == 20, "Ran more instructions than budgeted");
+
+        log.ubWaitOnSay = 1;
+        scriptStart(&vm, 2);
+        TEST_ASSERT(scriptRun(&vm, 10) == ScriptStatus::WAITING, "SAY did not pause");
+        TEST_ASSERT(log.ubSaidCount == 1, "Ran past the pause");
+        log.ubWaitOnSay = 0;
+        TEST_ASSERT(scriptRun(&vm, 10) == ScriptStatus::IDLE, "Script did not resume");
+        TEST_ASSERT(log.ubSaidCount == 2 && log.uwSaid[1] == 2, "Resumed at the wrong place");
+
+        scriptStart(&vm, 7);
+        TEST_ASSERT(scriptRun(&vm, SCRIPT_FRAME_BUDGET) == ScriptStatus::FAILED,
+                    "Stack overflow was not caught");
+        TEST_ASSERT(vm.ubStackSize == 0, "Failed script kept its stack");
+
+        scriptUnload();
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_script_rejects_invalid_code)
+    {
+        static UWORD const unknownOp[]  = { 99, 47 };
+        static UWORD const noOperands[] = { 144 };
+        static UWORD const midJump[]    = { 32, 3, 144, 1, 47 };
+        static UWORD const noEnd[]      = { 144, 1 };
+        static UWORD const otherStore[] = { 2, 5, 1, 47 };
+
+        TEST_ASSERT(!scriptLoad(unknownOp, 2), "Unknown opcode was accepted");
+        TEST_ASSERT(!scriptLoad(noOperands, 1), "Missing operand was accepted");
+        TEST_ASSERT(!scriptLoad(midJump, 5), "Jump into an operand was accepted");
+        TEST_ASSERT(!scriptLoad(noEnd, 2), "Code running off its end was accepted");
+        TEST_ASSERT(!scriptLoad(otherStore, 4), "Unknown store was accepted");
+
+        TEST_ASSERT(scriptLoad(s_branchScript, sizeof(s_branchScript) / sizeof(UWORD)),
+                    "Valid bytecode was rejected");
+        ScriptVm vm;
+        scriptVmInit(&vm, scriptTestCommand, 0);
+        TEST_ASSERT(!scriptStart(&vm, 5), "Started inside an instruction");
+        TEST_ASSERT(!scriptStart(&vm, SCRIPT_NONE), "Started SCRIPT_NONE");
+        TEST_ASSERT(scriptRun(&vm, SCRIPT_FRAME_BUDGET) == ScriptStatus::IDLE, "Ran no script");
+
+        scriptUnload();
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(script)
+    TEST(test_script_branches_on_flags)
+    TEST(test_script_budget_wait_and_stack)
+    TEST(test_script_rejects_invalid_code)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __SCRIPT_TESTS_H__INCLUDED__
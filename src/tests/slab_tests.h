@@ -0,0 +1,92 @@
+#ifndef __SLAB_TESTS_H__INCLUDED__
+#define __SLAB_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include <ace/managers/memory.h>
+
+#include "mtl/slab.h"
+#include "test_macros.h"
+
+namespace NEONengine::tests
+{
+    TEST_IMPL(test_slab_rejects_large_blocks)
+    {
+        void* ptr = mtl::slab_alloc(mtl::SLAB_MAX_BLOCK_SIZE + 1, MEMF_FAST);
+        TEST_ASSERT(ptr == nullptr, "Blocks larger than the biggest class must not be pooled");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_slab_rejects_unpooled_flags)
+    {
+        void* ptr = mtl::slab_alloc(16, MEMF_FAST | MEMF_REVERSE);
+        TEST_ASSERT(ptr == nullptr, "Unusual memory flags must bypass the slabs");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_slab_reuses_freed_block)
+    {
+        void* first = mtl::slab_alloc(20, MEMF_FAST);
+        TEST_ASSERT(first, "Could not allocate from slab");
+        TEST_ASSERT(mtl::slab_free(first), "Slab did not recognise its own block");
+
+        void* second = mtl::slab_alloc(24, MEMF_FAST);
+        TEST_ASSERT(second == first, "Freed block of the same class was not reused");
+        mtl::slab_free(second);
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_slab_clears_memory)
+    {
+        auto pDirty = static_cast<UBYTE*>(mtl::slab_alloc(64, MEMF_FAST));
+        for (int i = 0; i < 64; ++i) { pDirty[i] = 0xAA; }
+        mtl::slab_free(pDirty);
+
+        auto pClean = static_cast<UBYTE*>(mtl::slab_alloc(64, MEMF_FAST | MEMF_CLEAR));
+        for (int i = 0; i < 64; ++i) { TEST_ASSERT(pClean[i] == 0, "MEMF_CLEAR block not zeroed"); }
+        mtl::slab_free(pClean);
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_slab_does_not_own_foreign_memory)
+    {
+        void* pForeign = memAllocFast(32);
+        TEST_ASSERT(!mtl::slab_free(pForeign), "Slab claimed a block it did not allocate");
+        memFree(pForeign, 32);
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_slab_blocks_do_not_overlap)
+    {
+        UBYTE* blocks[64];
+        for (int i = 0; i < 64; ++i)
+        {
+            blocks[i] = static_cast<UBYTE*>(mtl::slab_alloc(32, MEMF_FAST));
+            TEST_ASSERT(blocks[i], "Could not allocate from slab");
+            for (int b = 0; b < 32; ++b) { blocks[i][b] = static_cast<UBYTE>(i); }
+        }
+
+        for (int i = 0; i < 64; ++i)
+        {
+            for (int b = 0; b < 32; ++b)
+            {
+                TEST_ASSERT(blocks[i][b] == static_cast<UBYTE>(i), "Slab blocks overlap");
+            }
+            mtl::slab_free(blocks[i]);
+        }
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(slab)
+    TEST(test_slab_rejects_large_blocks)
+    TEST(test_slab_rejects_unpooled_flags)
+    TEST(test_slab_reuses_freed_block)
+    TEST(test_slab_clears_memory)
+    TEST(test_slab_does_not_own_foreign_memory)
+    TEST(test_slab_blocks_do_not_overlap)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __SLAB_TESTS_H__INCLUDED__
@@ -0,0 +1,107 @@
+#ifndef __SMALL_VECTOR_TESTS_H__INCLUDED__
+#define __SMALL_VECTOR_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include "mtl/small_vector.h"
+#include "test_macros.h"
+#include "vector_tests.h"
+
+namespace NEONengine::tests
+{
+    TEST_IMPL(test_small_vector_stays_inline)
+    {
+        mtl::small_vector<int, 4> values;
+        for (int i = 0; i < 4; ++i) { values.push_back(i); }
+
+        TEST_ASSERT(values.is_inline(), "Spilled before exceeding the inline capacity");
+        TEST_ASSERT(values.capacity() == 4, "Inline capacity is wrong");
+        TEST_ASSERT(values[3] == 3, "Wrong value stored");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_small_vector_spills_and_shrinks_back)
+    {
+        mtl::small_vector<int, 4> values;
+        for (int i = 0; i < 20; ++i) { values.push_back(i); }
+
+        TEST_ASSERT(!values.is_inline() && values.capacity() >= 20, "Did not spill to the heap");
+        for (int i = 0; i < 20; ++i) { TEST_ASSERT(values[i] == i, "Value lost while spilling"); }
+
+        values.resize(3);
+        values.shrink_to_fit();
+        TEST_ASSERT(values.is_inline(), "Did not return to the inline storage");
+        TEST_ASSERT(values.size() == 3 && values[2] == 2, "Value lost while shrinking");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_small_vector_moves_inline_and_heap)
+    {
+        mtl::small_vector<int, 4> inlineValues(2, 7);
+        mtl::small_vector<int, 4> heapValues(10, 9);
+        int const* pHeap = heapValues.data();
+
+        mtl::small_vector<int, 4> movedInline(mtl::move(inlineValues));
+        mtl::small_vector<int, 4> movedHeap;
+        movedHeap = mtl::move(heapValues);
+
+        TEST_ASSERT(movedInline.is_inline() && movedInline.size() == 2, "Inline move failed");
+        TEST_ASSERT(movedInline[1] == 7, "Inline elements were not moved");
+        TEST_ASSERT(movedHeap.data() == pHeap, "Heap buffer was not taken over");
+        TEST_ASSERT(inlineValues.empty() && heapValues.empty(), "Source not left empty");
+        TEST_ASSERT(heapValues.is_inline(), "Source still points at the taken buffer");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_small_vector_insert_own_element)
+    {
+        mtl::small_vector<int, 4> values;
+        for (int i = 0; i < 3; ++i) { values.push_back(i); }
+
+        // Inline with room to spare, only shifts
+        values.insert(values.begin(), values[1]);
+        TEST_ASSERT(values.is_inline() && values[0] == 1, "Inserted an element after shifting");
+
+        // Inline and full, spills to the heap before the copy
+        values.insert(values.begin(), values[3]);
+        TEST_ASSERT(!values.is_inline() && values[0] == 2, "Inserted an element after spilling");
+
+        // On the heap with room to spare, only shifts
+        TEST_ASSERT(values.capacity() > values.size(), "No room left on the heap");
+        values.insert(values.begin(), values[2]);
+        TEST_ASSERT(values[0] == 0, "Inserted an element after shifting on the heap");
+
+        int const expected[] = { 0, 2, 1, 0, 1, 2 };
+        TEST_ASSERT(values.size() == 6, "Wrong size after insert");
+        for (int i = 0; i < 6; ++i) { TEST_ASSERT(values[i] == expected[i], "Wrong order"); }
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_small_vector_destroys_elements)
+    {
+        {
+            mtl::small_vector<vector_counted, 2> values;
+            for (int i = 0; i < 5; ++i) { values.emplace_back(i); }
+            values.erase(values.begin());
+            values.insert(values.begin(), vector_counted(-1));
+
+            auto copy = values;
+            TEST_ASSERT(copy.size() == 5 && copy[0].value == -1, "Copy differs");
+            TEST_ASSERT(vector_counted::s_live == 10, "Elements leaked or destroyed twice");
+        }
+        TEST_ASSERT(vector_counted::s_live == 0, "Elements leaked");
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(small_vector)
+    TEST(test_small_vector_stays_inline)
+    TEST(test_small_vector_spills_and_shrinks_back)
+    TEST(test_small_vector_moves_inline_and_heap)
+    TEST(test_small_vector_insert_own_element)
+    TEST(test_small_vector_destroys_elements)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __SMALL_VECTOR_TESTS_H__INCLUDED__
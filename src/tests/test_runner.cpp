@@ -11,6 +11,18 @@
 #include "tests/bstring_tests.h"
 #include "tests/lang_tests.h"
 #include "tests/bstr_view_tests.h"
+#include "tests/memory_tests.h"
+#include "tests/vector_tests.h"
+#include "tests/small_vector_tests.h"
+#include "tests/flat_hash_map_tests.h"
+#include "tests/bitset_tests.h"
+#include "tests/ring_buffer_tests.h"
+#include "tests/script_tests.h"
+#include "tests/lz_tests.h"
+#include "tests/slab_tests.h"
+#include "tests/arena_tests.h"
+#include "tests/alloc_stats_tests.h"
+#include "tests/language_tests.h"
 
 namespace NEONengine::tests
 {
@@ -26,6 +38,20 @@ namespace NEONengine::tests
         // RUN_SUITE(bstring);
         // RUN_SUITE(lang);
         RUN_SUITE(bstr_view);
+        RUN_SUITE(slab);
+        RUN_SUITE(memory);
+        RUN_SUITE(vector);
+        RUN_SUITE(small_vector);
+        RUN_SUITE(flat_hash_map);
+        RUN_SUITE(bitset);
+        RUN_SUITE(ring_buffer);
+        RUN_SUITE(script);
+        RUN_SUITE(lz);
+        RUN_SUITE(arena);
+#ifdef MTL_ALLOC_STATS
+        RUN_SUITE(alloc_stats);
+        RUN_SUITE(language);
+#endif
 
         logBlockEnd("testRunner");
     }
@@ -0,0 +1,129 @@
+#ifndef __VECTOR_TESTS_H__INCLUDED__
+#define __VECTOR_TESTS_H__INCLUDED__
+
+#ifdef ACE_TEST_RUNNER
+
+#include "mtl/vector.h"
+#include "test_macros.h"
+
+namespace NEONengine::tests
+{
+    /**
+     * @brief Counts its live instances, so leaks and double destruction show.
+     */
+    struct vector_counted
+    {
+        static inline int s_live = 0;
+
+        vector_counted(int value = 0) : value(value) { ++s_live; }
+        vector_counted(vector_counted const& other) : value(other.value) { ++s_live; }
+        vector_counted(vector_counted&& other) : value(other.value) { ++s_live; }
+        vector_counted& operator=(vector_counted const&) = default;
+        ~vector_counted() { --s_live; }
+
+        int value;
+    };
+
+    static_assert(mtl::is_trivially_relocatable_v<int>);
+    static_assert(mtl::is_trivially_relocatable_v<mtl::vector<vector_counted>>);
+    static_assert(!mtl::is_trivially_relocatable_v<vector_counted>);
+
+    TEST_IMPL(test_vector_insert_range)
+    {
+        mtl::vector<int> values;
+        int const start[] = { 1, 2, 5, 6 };
+        int const middle[] = { 3, 4 };
+        values.insert(values.end(), start, start + 4);
+        values.insert(values.begin() + 2, middle, middle + 2);
+
+        TEST_ASSERT(values.size() == 6, "Wrong size after insert");
+        for (int i = 0; i < 6; ++i) { TEST_ASSERT(values[i] == i + 1, "Wrong order after insert"); }
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_vector_insert_own_element)
+    {
+        int const start[] = { 0, 1, 2, 3 };
+        mtl::vector<int> values(start);
+
+        // Full, so it grows before the copy
+        values.reserve(values.size());
+        values.insert(values.begin(), values[3]);
+        TEST_ASSERT(values[0] == 3, "Inserted an element after growing");
+
+        // Room to spare, so only shifts
+        values.reserve(values.size() * 2);
+        values.insert(values.begin(), values[2]);
+        TEST_ASSERT(values.size() == 6 && values[0] == 1, "Inserted an element after shifting");
+        TEST_ASSERT(values[1] == 3 && values[5] == 3, "Wrong order after insert");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_vector_erase_range)
+    {
+        int const start[] = { 1, 2, 3, 4, 5, 6 };
+        mtl::vector<int> values(start);
+
+        int* pNext = values.erase(values.begin() + 1, values.begin() + 3);
+        TEST_ASSERT(*pNext == 4, "Erase returned the wrong element");
+        TEST_ASSERT(values.size() == 4, "Wrong size after erase");
+        TEST_ASSERT(values[0] == 1 && values[1] == 4 && values[3] == 6, "Wrong order after erase");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_vector_shifts_non_trivial_elements)
+    {
+        {
+            mtl::vector<vector_counted> values;
+            for (int i = 0; i < 10; ++i) { values.push_back(vector_counted(i)); }
+            values.insert(values.begin(), vector_counted(-1));
+            values.erase(values.begin() + 5);
+
+            TEST_ASSERT(values.size() == 10, "Wrong size after insert and erase");
+            TEST_ASSERT(values[0].value == -1 && values[5].value == 5, "Wrong order");
+            TEST_ASSERT(vector_counted::s_live == 10, "Elements leaked or destroyed twice");
+        }
+        TEST_ASSERT(vector_counted::s_live == 0, "Elements leaked");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_vector_relocates_nested_vectors)
+    {
+        mtl::vector<mtl::vector<int>> rows;
+        for (int i = 0; i < 20; ++i)
+        {
+            rows.emplace_back();
+            rows.back().push_back(i);
+        }
+        rows.erase(rows.begin());
+
+        TEST_ASSERT(rows.size() == 19 && rows[0][0] == 1, "Nested vector lost while erasing");
+        TEST_ASSERT(rows[18][0] == 19, "Nested vector lost while growing");
+        TEST_SUCCESS;
+    }
+
+    TEST_IMPL(test_vector_copy)
+    {
+        int const start[] = { 7, 8, 9 };
+        mtl::vector<int> values(start);
+        mtl::vector<int> copy(values);
+        mtl::vector<int> assigned;
+        assigned = values;
+
+        TEST_ASSERT(copy == values && assigned == values, "Copies differ from the original");
+        TEST_SUCCESS;
+    }
+
+    TEST_SUITE_BEGIN(vector)
+    TEST(test_vector_insert_range)
+    TEST(test_vector_insert_own_element)
+    TEST(test_vector_erase_range)
+    TEST(test_vector_shifts_non_trivial_elements)
+    TEST(test_vector_relocates_nested_vectors)
+    TEST(test_vector_copy)
+    TEST_SUITE_END
+}  // namespace NEONengine::tests
+
+#endif  // ACE_TEST_RUNNER
+
+#endif  // __VECTOR_TESTS_H__INCLUDED__
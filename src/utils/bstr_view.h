@@ -36,6 +36,7 @@
 #include <mini_std/stdint.h>
 #include <mini_std/string.h>
 
+#include <mtl/hash.h>
 #include <mtl/utility.h>
 
 namespace NEONengine
@@ -233,4 +234,16 @@ namespace NEONengine
     };
 }  // namespace NEONengine
 
+/**
+ * @brief Lets bstr_view be used as a key of the mtl hash containers.
+ */
+template<>
+struct mtl::hash<NEONengine::bstr_view>
+{
+    constexpr uint32_t operator()(NEONengine::bstr_view view) const noexcept
+    {
+        return hash_bytes(view.data(), view.length());
+    }
+};
+
 #endif  // __BSTR_VIEW__INCLUDED__
@@ -9,6 +9,7 @@
 #include <ace/managers/ptplayer.h>
 #include <ace/utils/palette.h>
 
+#include <mtl/alloc_stats.h>
 #include <mtl/memory.h>
 
 namespace NEONengine
@@ -22,6 +23,8 @@ namespace NEONengine
                       pPalette,
                       ubColorCount);
 
+        auto tag = alloc_tag_scope(alloc_tag::Ui);
+
         tFade *pFade        = new (MemF::Fast | MemF::Clear) tFade();
         pFade->eState       = FADE_STATE_IDLE;
         pFade->pView        = pView;
@@ -37,7 +40,7 @@ namespace NEONengine
         else
         {
             uwMaxColors        = 32;
-            pFade->pPaletteRef = new (MemF::Fast | MemF::Clear) UWORD(sizeof(UWORD) * uwMaxColors);
+            pFade->pPaletteRef = (UWORD *)memAlloc(sizeof(UWORD) * uwMaxColors, MEMF_FAST | MEMF_CLEAR);
         }
 
         if (ubColorCount > uwMaxColors)
@@ -62,7 +65,7 @@ namespace NEONengine
             memFree(pFade->pPaletteRef, sizeof(UWORD) * (32));
         }
 
-        memFree(pFade, sizeof(*pFade));
+        delete pFade;
     }
 
     void fadeSet(tFade *pFade,
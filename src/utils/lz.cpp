@@ -0,0 +1,68 @@
+#include "lz.h"
+
+namespace NEONengine
+{
+    /*
+     * Internal function.
+     * Adds the extra length bytes of a 15 length field to *pulLength.
+     * Returns 0 if the stream ends first.
+     */
+    static UBYTE lzReadLength(UBYTE const **ppSrc, UBYTE const *pSrcEnd, ULONG *pulLength)
+    {
+        UBYTE const *pSrc = *ppSrc;
+        UBYTE ubByte;
+        do
+        {
+            if (pSrc == pSrcEnd) return 0;
+            ubByte = *pSrc++;
+            *pulLength += ubByte;
+        } while (ubByte == 255);
+
+        *ppSrc = pSrc;
+        return 1;
+    }
+
+    UBYTE lzDecompress(UBYTE const *pSrc, ULONG ulSrcSize, UBYTE *pDst, ULONG ulDstSize)
+    {
+        UBYTE const *pSrcEnd   = pSrc + ulSrcSize;
+        UBYTE *const pDstStart = pDst;
+        UBYTE *const pDstEnd   = pDst + ulDstSize;
+
+        // Lengths are checked once per sequence, the copies themselves are
+        // plain byte loops. Byte copies keep overlapping matches (runs of
+        // the same bytes) and in place decompression working.
+        while (pSrc != pSrcEnd)
+        {
+            UBYTE ubToken = *pSrc++;
+
+            ULONG ulLiterals = ubToken >> 4;
+            if (ulLiterals == 15 && !lzReadLength(&pSrc, pSrcEnd, &ulLiterals)) return 0;
+            if (ulLiterals > (ULONG)(pSrcEnd - pSrc) || ulLiterals > (ULONG)(pDstEnd - pDst))
+            {
+                return 0;
+            }
+            while (ulLiterals--) { *pDst++ = *pSrc++; }
+
+            // The last sequence has literals only
+            if (pSrc == pSrcEnd) break;
+            if (pSrcEnd - pSrc < 2) return 0;
+
+            ULONG ulOffset = (pSrc[0] << 8) | pSrc[1];
+            pSrc += 2;
+            ULONG ulLength = ubToken & 15;
+            if (ulLength == 15 && !lzReadLength(&pSrc, pSrcEnd, &ulLength)) return 0;
+            ulLength += LZ_MIN_MATCH;
+
+            if (!ulOffset || ulOffset > (ULONG)(pDst - pDstStart)
+                || ulLength > (ULONG)(pDstEnd - pDst))
+            {
+                return 0;
+            }
+
+            UBYTE const *pMatch = pDst - ulOffset;
+            while (ulLength--) { *pDst++ = *pMatch++; }
+        }
+
+        return pDst == pDstEnd;
+    }
+}  // namespace NEONengine
@@ -0,0 +1,49 @@
+#ifndef __LZ_H__INCLUDED__
+#define __LZ_H__INCLUDED__
+
+#include <ace/types.h>
+
+namespace NEONengine
+{
+    /**
+     * @brief Shortest match the LZ format can encode.
+     */
+    #define LZ_MIN_MATCH 4
+
+    /**
+     * @brief Largest distance a match can reach back.
+     */
+    #define LZ_MAX_OFFSET 0xFFFF
+
+    /**
+     * @brief Decompresses an LZ stream as written by the neonpack tool.
+     *
+     * The stream is a series of byte aligned sequences:
+     *
+     *   token: literal count << 4 | (match length - LZ_MIN_MATCH)
+     *   more literal count bytes, if the count is 15
+     *   the literals
+     *   match offset, big-endian UWORD, 1 being the last byte written
+     *   more match length bytes, if the length field is 15
+     *
+     * A count of 15 carries on in the following bytes, each adding up to 255
+     * and stopping after the first one below 255. The last sequence ends
+     * after its literals.
+     *
+     * There are no tables and nothing is read ahead, so the stream can be
+     * decompressed in place: with the stream placed at the end of a buffer
+     * big enough for the output plus the margin neonpack works out, the
+     * output never catches up with the input still to be read.
+     *
+     * @param pSrc The compressed stream.
+     * @param ulSrcSize Size of the stream in bytes.
+     * @param pDst Where to write the decompressed bytes.
+     * @param ulDstSize Number of bytes the stream decompresses to.
+     * @return UBYTE 1 on success, 0 if the stream is corrupt or does not
+     * decompress to exactly ulDstSize bytes. Nothing outside pDst is written
+     * either way.
+     */
+    UBYTE lzDecompress(UBYTE const *pSrc, ULONG ulSrcSize, UBYTE *pDst, ULONG ulDstSize);
+}
+
+#endif // __LZ_H__INCLUDED__
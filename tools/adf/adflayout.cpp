@@ -0,0 +1,594 @@
+/**
+ * @file adflayout.cpp
+ * @brief Lays out a floppy image so the files read while booting sit on
+ * contiguous tracks, in the order they are read, and reports the head seeks
+ * that takes before and after.
+ *
+ *   adflayout boot.trace in.adf [out.adf]
+ *
+ * The trace lists the files in the order they are opened, one path per line
+ * relative to the game's directory, # starts a comment. A build with
+ * VFS_TRACE set records it in vfs.trace, see core/vfs.h. The executable is
+ * loaded before the engine runs, so it has to be added as the first line.
+ * Paths that are not on the disk, such as files inside data.pak, are
+ * skipped.
+ *
+ * Every block is moved rather than the disk rebuilt, so names, dates,
+ * protection bits and the boot block stay as they are. The root block stays
+ * in the middle of the disk with the bitmap after it, and the rest is laid
+ * out as one run:
+ *
+ *   for each traced file in trace order, the directories it is the first
+ *   to need, its header, then its data and extension blocks in the order
+ *   they are read
+ *   the remaining directories and files, in directory order
+ *
+ * The run starts just past the bitmap, where the head is after the disk is
+ * mounted, or early enough for the traced part to end with the disk rather
+ * than wrap around to its start. Only OFS and FFS disks without directory
+ * caches are supported.
+ *
+ * Seeks are estimated with trackdisk.device reading a cylinder (22 blocks)
+ * at a time: each file costs the blocks of its lookup, which are the root
+ * block, its directories and the headers in its hash chain, then its own
+ * blocks. Every change of cylinder counts as a seek.
+ *
+ * The output is read back and every file compared with the original before
+ * the tool reports success.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+#include <mtl/vector.h>
+
+#include "../neon/neon_file.h"
+
+static uint32_t const BLOCK_SIZE          = 512;
+static uint32_t const BLOCK_COUNT         = 1760;  // 880 KB double density
+static uint32_t const ROOT_BLOCK          = 880;
+static uint32_t const BLOCKS_PER_CYLINDER = 22;  // 11 sectors on each side
+
+static uint32_t const T_HEADER    = 2;
+static uint32_t const ST_ROOT     = 1;
+static uint32_t const ST_USERDIR  = 2;
+static uint32_t const ST_FILE     = 0xFFFFFFFD;  // -3
+static uint32_t const HASH_SIZE   = 72;
+static uint32_t const PATH_LENGTH = 256;
+
+// Offsets of the longs used in header, extension and data blocks
+static uint32_t const L_TYPE       = 0;
+static uint32_t const L_HEADER_KEY = 1;
+static uint32_t const L_HIGH_SEQ   = 2;
+static uint32_t const L_FIRST_DATA = 4;  // Next data block in an OFS data block
+static uint32_t const L_CHECKSUM   = 5;
+static uint32_t const L_TABLE      = 6;  // Hash table, or data blocks from the end
+static uint32_t const L_BM_PAGES   = 79;
+static uint32_t const L_BM_EXT     = 104;
+static uint32_t const L_HASH_CHAIN = 124;
+static uint32_t const L_PARENT     = 125;
+static uint32_t const L_EXTENSION  = 126;
+static uint32_t const L_SEC_TYPE   = 127;
+
+struct adf_disk
+{
+    mtl::vector<unsigned char> image;
+    bool bOfs;
+
+    unsigned char* block(uint32_t ulBlock) { return image.data() + ulBlock * BLOCK_SIZE; }
+    unsigned char const* block(uint32_t ulBlock) const
+    {
+        return image.data() + ulBlock * BLOCK_SIZE;
+    }
+
+    uint32_t get(uint32_t ulBlock, uint32_t ulLong) const
+    {
+        return readLong(block(ulBlock) + ulLong * 4);
+    }
+
+    void set(uint32_t ulBlock, uint32_t ulLong, uint32_t ulValue)
+    {
+        unsigned char* pData = block(ulBlock) + ulLong * 4;
+        for (int i = 0; i < 4; ++i) { pData[i] = (ulValue >> (24 - i * 8)) & 0xFF; }
+    }
+};
+
+struct adf_file
+{
+    char szPath[PATH_LENGTH];
+    mtl::vector<uint32_t> lookup;  ///< Blocks read to find the file
+    mtl::vector<uint32_t> blocks;  ///< Header, then data and extension blocks in read order
+    mtl::vector<uint32_t> headers; ///< Header and extension blocks
+    mtl::vector<uint32_t> data;    ///< Data blocks in file order
+    uint32_t ulSize;
+};
+
+struct adf_tree
+{
+    mtl::vector<uint32_t> dirs;
+    mtl::vector<uint32_t> bitmaps;
+    mtl::vector<adf_file> files;
+};
+
+struct seek_count
+{
+    uint32_t ulSeeks;
+    uint32_t ulCylinders;
+};
+
+static bool validBlock(uint32_t ulBlock)
+{
+    return ulBlock >= 2 && ulBlock < BLOCK_COUNT;
+}
+
+/**
+ * @brief Sum of the longs of a block, which a valid checksum makes 0.
+ */
+static uint32_t blockSum(adf_disk const& disk, uint32_t ulBlock)
+{
+    uint32_t ulSum = 0;
+    for (uint32_t i = 0; i < BLOCK_SIZE / 4; ++i) { ulSum += disk.get(ulBlock, i); }
+    return ulSum;
+}
+
+static void fixChecksum(adf_disk& disk, uint32_t ulBlock, uint32_t ulLong)
+{
+    disk.set(ulBlock, ulLong, 0);
+    disk.set(ulBlock, ulLong, -blockSum(disk, ulBlock));
+}
+
+static void blockName(adf_disk const& disk, uint32_t ulBlock, char* szName)
+{
+    unsigned char const* pBlock = disk.block(ulBlock);
+    uint32_t ulLength           = pBlock[432] < 31 ? pBlock[432] : 30;
+    memcpy(szName, pBlock + 433, ulLength);
+    szName[ulLength] = '\0';
+}
+
+/**
+ * @brief Collects the blocks of a file header and its extension blocks.
+ */
+static bool readFileBlocks(adf_disk const& disk, uint32_t ulHeader, adf_file& file)
+{
+    file.ulSize        = disk.get(ulHeader, 81);  // byte_size
+    uint32_t ulCurrent = ulHeader;
+    while (ulCurrent)
+    {
+        if (!validBlock(ulCurrent) || blockSum(disk, ulCurrent)) return false;
+
+        file.blocks.push_back(ulCurrent);
+        file.headers.push_back(ulCurrent);
+        uint32_t ulCount = disk.get(ulCurrent, L_HIGH_SEQ);
+        if (ulCount > HASH_SIZE) return false;
+
+        for (uint32_t i = 0; i < ulCount; ++i)
+        {
+            uint32_t ulData = disk.get(ulCurrent, L_TABLE + HASH_SIZE - 1 - i);
+            if (!validBlock(ulData)) return false;
+            file.blocks.push_back(ulData);
+            file.data.push_back(ulData);
+        }
+        ulCurrent = disk.get(ulCurrent, L_EXTENSION);
+    }
+    return true;
+}
+
+static bool readDir(adf_disk const& disk,
+                    uint32_t ulDir,
+                    char const* szPath,
+                    mtl::vector<uint32_t> const& lookup,
+                    adf_tree& tree)
+{
+    mtl::vector<uint32_t> dirLookup = lookup;
+    dirLookup.push_back(ulDir);
+
+    for (uint32_t i = 0; i < HASH_SIZE; ++i)
+    {
+        mtl::vector<uint32_t> chain = dirLookup;
+        for (uint32_t ulEntry = disk.get(ulDir, L_TABLE + i); ulEntry;
+             ulEntry          = disk.get(ulEntry, L_HASH_CHAIN))
+        {
+            if (!validBlock(ulEntry) || blockSum(disk, ulEntry)
+                || disk.get(ulEntry, L_TYPE) != T_HEADER)
+            {
+                fprintf(stderr, "'%s': bad header block %u\n", szPath, ulEntry);
+                return false;
+            }
+
+            char szName[32];
+            char szEntryPath[PATH_LENGTH];
+            blockName(disk, ulEntry, szName);
+            snprintf(szEntryPath, PATH_LENGTH, "%s%s%s", szPath, *szPath ? "/" : "", szName);
+
+            uint32_t ulSecType = disk.get(ulEntry, L_SEC_TYPE);
+            if (ulSecType == ST_USERDIR)
+            {
+                tree.dirs.push_back(ulEntry);
+                if (!readDir(disk, ulEntry, szEntryPath, chain, tree)) return false;
+            }
+            else if (ulSecType == ST_FILE)
+            {
+                adf_file file = {};
+                memcpy(file.szPath, szEntryPath, PATH_LENGTH);
+                file.lookup = chain;
+                if (!readFileBlocks(disk, ulEntry, file))
+                {
+                    fprintf(stderr, "'%s': bad file blocks\n", szEntryPath);
+                    return false;
+                }
+                tree.files.push_back(mtl::move(file));
+            }
+            else
+            {
+                fprintf(stderr, "'%s': links are not supported\n", szEntryPath);
+                return false;
+            }
+
+            // The next entries of the chain are only found past this one
+            chain.push_back(ulEntry);
+        }
+    }
+    return true;
+}
+
+static bool readDisk(adf_disk& disk, adf_tree& tree)
+{
+    if (disk.image.size() != BLOCK_COUNT * BLOCK_SIZE) return false;
+
+    unsigned char const* pBoot = disk.image.data();
+    if (memcmp(pBoot, "DOS", 3) != 0 || pBoot[3] > 3)
+    {
+        fprintf(stderr, "Only OFS and FFS disks without directory caches are supported\n");
+        return false;
+    }
+    disk.bOfs = (pBoot[3] & 1) == 0;
+
+    if (disk.get(ROOT_BLOCK, L_TYPE) != T_HEADER || disk.get(ROOT_BLOCK, L_SEC_TYPE) != ST_ROOT
+        || blockSum(disk, ROOT_BLOCK) || disk.get(ROOT_BLOCK, L_BM_EXT))
+    {
+        fprintf(stderr, "Bad root block\n");
+        return false;
+    }
+
+    for (uint32_t i = 0; i < 25; ++i)
+    {
+        uint32_t ulBitmap = disk.get(ROOT_BLOCK, L_BM_PAGES + i);
+        if (ulBitmap) tree.bitmaps.push_back(ulBitmap);
+    }
+
+    return readDir(disk, ROOT_BLOCK, "", mtl::vector<uint32_t>(), tree);
+}
+
+/**
+ * @brief The file a trace line names: the same path, or one ending in
+ * "/path", as AmigaDOS compares names without case.
+ */
+static adf_file const* findFile(adf_tree const& tree, char const* szPath)
+{
+    size_t length = strlen(szPath);
+    for (auto const& file : tree.files)
+    {
+        size_t fileLength = strlen(file.szPath);
+        if (fileLength < length) continue;
+
+        char const* pTail = file.szPath + fileLength - length;
+        if (strcasecmp(pTail, szPath) == 0 && (pTail == file.szPath || pTail[-1] == '/'))
+        {
+            return &file;
+        }
+    }
+    return nullptr;
+}
+
+static bool readTrace(char const* szPath, adf_tree const& tree, mtl::vector<int>& order)
+{
+    FILE* pFile = fopen(szPath, "r");
+    if (!pFile) return false;
+
+    char szLine[PATH_LENGTH];
+    while (fgets(szLine, sizeof(szLine), pFile))
+    {
+        char* pEnd = szLine + strlen(szLine);
+        while (pEnd > szLine && (pEnd[-1] == '\n' || pEnd[-1] == '\r' || pEnd[-1] == ' '))
+        {
+            *--pEnd = '\0';
+        }
+        if (!*szLine || *szLine == '#') continue;
+
+        adf_file const* pFile = findFile(tree, szLine);
+        if (!pFile)
+        {
+            printf("  %s: not on the disk, skipped\n", szLine);
+            continue;
+        }
+
+        int index = pFile - tree.files.data();
+        bool bSeen = false;
+        for (int other : order) bSeen |= other == index;
+        if (!bSeen) order.push_back(index);
+    }
+    fclose(pFile);
+    return true;
+}
+
+static seek_count countSeeks(adf_tree const& tree, mtl::vector<int> const& order)
+{
+    // Directories stay in the DOS buffers once read, the root from the mount on
+    mtl::vector<bool> isDir(BLOCK_COUNT, false);
+    mtl::vector<bool> buffered(BLOCK_COUNT, false);
+    for (uint32_t ulDir : tree.dirs) isDir[ulDir] = true;
+    isDir[ROOT_BLOCK] = true;
+    buffered[ROOT_BLOCK] = true;
+
+    seek_count count = {};
+    uint32_t ulHead  = ROOT_BLOCK / BLOCKS_PER_CYLINDER;
+    auto visit       = [&](uint32_t ulBlock) {
+        uint32_t ulCylinder = ulBlock / BLOCKS_PER_CYLINDER;
+        if (ulCylinder == ulHead) return;
+
+        count.ulCylinders += ulCylinder > ulHead ? ulCylinder - ulHead : ulHead - ulCylinder;
+        if (ulCylinder != ulHead + 1) ++count.ulSeeks;
+        ulHead = ulCylinder;
+    };
+
+    for (int index : order)
+    {
+        for (uint32_t ulBlock : tree.files[index].lookup)
+        {
+            if (!buffered[ulBlock]) visit(ulBlock);
+            buffered[ulBlock] = isDir[ulBlock];
+        }
+        for (uint32_t ulBlock : tree.files[index].blocks) visit(ulBlock);
+    }
+    return count;
+}
+
+/**
+ * @brief Picks the new place of every block, see the file comment.
+ */
+static bool planLayout(adf_tree const& tree,
+                       mtl::vector<int> const& order,
+                       mtl::vector<uint32_t>& newBlock)
+{
+    mtl::vector<bool> isDir(BLOCK_COUNT, false);
+    for (uint32_t ulDir : tree.dirs) isDir[ulDir] = true;
+
+    // The directories each traced file needs, then the file
+    mtl::vector<uint32_t> stream;
+    mtl::vector<bool> streamed(BLOCK_COUNT, false);
+    auto add = [&](uint32_t ulBlock) {
+        if (!streamed[ulBlock]) stream.push_back(ulBlock);
+        streamed[ulBlock] = true;
+    };
+    for (int index : order)
+    {
+        for (uint32_t ulBlock : tree.files[index].lookup)
+        {
+            if (isDir[ulBlock]) add(ulBlock);
+        }
+        for (uint32_t ulBlock : tree.files[index].blocks) add(ulBlock);
+    }
+    size_t tracedSize = stream.size();
+    for (uint32_t ulBlock : tree.dirs) add(ulBlock);
+    for (auto const& file : tree.files)
+    {
+        for (uint32_t ulBlock : file.blocks) add(ulBlock);
+    }
+
+    // The bitmap next to the root, both are read when the disk is mounted
+    mtl::vector<bool> taken(BLOCK_COUNT, false);
+    newBlock.clear();
+    newBlock.resize(BLOCK_COUNT, 0);
+    newBlock[ROOT_BLOCK] = ROOT_BLOCK;
+    taken[ROOT_BLOCK]    = true;
+    uint32_t ulNext      = ROOT_BLOCK + 1;
+    for (uint32_t ulBlock : tree.bitmaps)
+    {
+        newBlock[ulBlock] = ulNext;
+        taken[ulNext++]   = true;
+    }
+
+    // The traced blocks run up to the end of the disk at the latest, so they
+    // don't wrap around
+    uint32_t ulReserved = ulNext - ROOT_BLOCK;
+    if (tracedSize + ulReserved > BLOCK_COUNT - ulNext)
+    {
+        ulNext = tracedSize + ulReserved + 2 > BLOCK_COUNT
+                     ? 2
+                     : BLOCK_COUNT - tracedSize - ulReserved;
+    }
+
+    uint32_t ulPlaced = 0;
+    for (uint32_t ulBlock : stream)
+    {
+        while (taken[ulNext]) ulNext = ulNext + 1 < BLOCK_COUNT ? ulNext + 1 : 2;
+        if (++ulPlaced > BLOCK_COUNT - 2 - ulReserved) return false;
+
+        newBlock[ulBlock] = ulNext;
+        taken[ulNext]     = true;
+    }
+    return true;
+}
+
+static void mapLong(adf_disk& disk, uint32_t ulBlock, uint32_t ulLong, mtl::vector<uint32_t> const& newBlock)
+{
+    uint32_t ulValue = disk.get(ulBlock, ulLong);
+    if (ulValue) disk.set(ulBlock, ulLong, newBlock[ulValue]);
+}
+
+/**
+ * @brief Copies every block to its new place and points everything that
+ * refers to a block at its new place.
+ */
+static void writeLayout(adf_disk const& in,
+                        adf_tree const& tree,
+                        mtl::vector<uint32_t> const& newBlock,
+                        adf_disk& out)
+{
+    out.bOfs = in.bOfs;
+    out.image.clear();
+    out.image.resize(in.image.size(), 0);
+    memcpy(out.block(0), in.block(0), 2 * BLOCK_SIZE);
+
+    for (uint32_t ulOld = 2; ulOld < BLOCK_COUNT; ++ulOld)
+    {
+        if (newBlock[ulOld]) memcpy(out.block(newBlock[ulOld]), in.block(ulOld), BLOCK_SIZE);
+    }
+
+    // Headers, extension blocks and the root: the keys, tables and links
+    auto mapHeader = [&](uint32_t ulBlock, bool bDataTable) {
+        mapLong(out, ulBlock, L_HEADER_KEY, newBlock);
+        for (uint32_t i = 0; i < HASH_SIZE; ++i) mapLong(out, ulBlock, L_TABLE + i, newBlock);
+        if (bDataTable) mapLong(out, ulBlock, L_FIRST_DATA, newBlock);
+        mapLong(out, ulBlock, L_HASH_CHAIN, newBlock);
+        mapLong(out, ulBlock, L_PARENT, newBlock);
+        mapLong(out, ulBlock, L_EXTENSION, newBlock);
+        fixChecksum(out, ulBlock, L_CHECKSUM);
+    };
+
+    for (uint32_t i = 0; i < 25; ++i) mapLong(out, ROOT_BLOCK, L_BM_PAGES + i, newBlock);
+    mapHeader(ROOT_BLOCK, false);
+    for (uint32_t ulDir : tree.dirs) mapHeader(newBlock[ulDir], false);
+
+    for (auto const& file : tree.files)
+    {
+        for (uint32_t ulBlock : file.headers) mapHeader(newBlock[ulBlock], true);
+        if (!in.bOfs) continue;
+
+        // FFS data blocks are only data, OFS ones have a header of their own
+        for (uint32_t ulBlock : file.data)
+        {
+            uint32_t ulNew = newBlock[ulBlock];
+            mapLong(out, ulNew, L_HEADER_KEY, newBlock);
+            mapLong(out, ulNew, L_FIRST_DATA, newBlock);
+            fixChecksum(out, ulNew, L_CHECKSUM);
+        }
+    }
+
+    mtl::vector<bool> used(BLOCK_COUNT, false);
+    for (uint32_t ulOld = 2; ulOld < BLOCK_COUNT; ++ulOld)
+    {
+        if (newBlock[ulOld]) used[newBlock[ulOld]] = true;
+    }
+
+    // A set bit is a free block, from block 2 on
+    uint32_t ulBlock = 2;
+    for (uint32_t ulBitmap : tree.bitmaps)
+    {
+        uint32_t ulNew = newBlock[ulBitmap];
+        for (uint32_t i = 1; i < BLOCK_SIZE / 4; ++i)
+        {
+            uint32_t ulFree = 0;
+            for (uint32_t j = 0; j < 32; ++j, ++ulBlock)
+            {
+                if (ulBlock < BLOCK_COUNT && !used[ulBlock]) ulFree |= 1u << j;
+            }
+            out.set(ulNew, i, ulFree);
+        }
+        fixChecksum(out, ulNew, 0);
+    }
+}
+
+/**
+ * @brief Contents of a file, from its data blocks.
+ */
+static void fileBytes(adf_disk const& disk, adf_file const& file, mtl::vector<unsigned char>& out)
+{
+    out.clear();
+    uint32_t ulOffset = disk.bOfs ? 24 : 0;
+    for (uint32_t ulBlock : file.data)
+    {
+        uint32_t ulSize = disk.bOfs ? disk.get(ulBlock, 3) : BLOCK_SIZE;
+        unsigned char const* pData = disk.block(ulBlock) + ulOffset;
+        for (uint32_t i = 0; i < ulSize && out.size() < file.ulSize; ++i) out.push_back(pData[i]);
+    }
+}
+
+static bool verifyLayout(adf_disk const& in, adf_tree const& before, adf_disk& out, adf_tree& after)
+{
+    if (!readDisk(out, after) || after.files.size() != before.files.size()) return false;
+
+    mtl::vector<unsigned char> original, moved;
+    for (auto const& file : before.files)
+    {
+        adf_file const* pMoved = findFile(after, file.szPath);
+        if (!pMoved) return false;
+
+        fileBytes(in, file, original);
+        fileBytes(out, *pMoved, moved);
+        if (original.size() != file.ulSize || moved.size() != original.size()
+            || memcmp(original.data(), moved.data(), original.size()) != 0)
+        {
+            fprintf(stderr, "'%s' does not match after the layout\n", file.szPath);
+            return false;
+        }
+    }
+
+    for (uint32_t ulBitmap : after.bitmaps)
+    {
+        if (blockSum(out, ulBitmap)) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3 || argc > 4)
+    {
+        fprintf(stderr, "usage: %s boot.trace in.adf [out.adf]\n", argv[0]);
+        return 2;
+    }
+
+    adf_disk disk;
+    adf_tree tree;
+    if (!readFile(argv[2], disk.image) || !readDisk(disk, tree))
+    {
+        fprintf(stderr, "'%s' is not a floppy image this tool supports\n", argv[2]);
+        return 1;
+    }
+
+    mtl::vector<int> order;
+    if (!readTrace(argv[1], tree, order))
+    {
+        fprintf(stderr, "Could not read '%s'\n", argv[1]);
+        return 1;
+    }
+
+    seek_count before = countSeeks(tree, order);
+    printf("%s: %zu of %zu files traced, %u seeks over %u cylinders\n",
+           argv[2],
+           order.size(),
+           tree.files.size(),
+           before.ulSeeks,
+           before.ulCylinders);
+    if (argc == 3) return 0;
+
+    mtl::vector<uint32_t> newBlock;
+    if (!planLayout(tree, order, newBlock))
+    {
+        fprintf(stderr, "The files do not fit\n");
+        return 1;
+    }
+
+    adf_disk out;
+    adf_tree outTree;
+    writeLayout(disk, tree, newBlock, out);
+    if (!verifyLayout(disk, tree, out, outTree)) return 1;
+
+    // The same files, found again in the new image
+    mtl::vector<int> outOrder;
+    for (int index : order)
+    {
+        outOrder.push_back(findFile(outTree, tree.files[index].szPath) - outTree.files.data());
+    }
+
+    if (!writeFile(argv[3], out.image))
+    {
+        fprintf(stderr, "Could not write '%s'\n", argv[3]);
+        return 1;
+    }
+
+    seek_count after = countSeeks(outTree, outOrder);
+    printf("%s: %u seeks over %u cylinders\n", argv[3], after.ulSeeks, after.ulCylinders);
+    return 0;
+}
@@ -0,0 +1,127 @@
+/**
+ * @file hash_map_bench.cpp
+ * @brief Compares mtl::flat_hash_map lookups with a linear scan.
+ *
+ * The scan walks an array of key/value pairs, which is what looking an id up
+ * in a list (or a list-like array) costs today. Both are run for integer ids
+ * and for bstr_view keys, looking up every key once in a shuffled order.
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include <mtl/flat_hash_map.h>
+#include <mtl/vector.h>
+
+#include "utils/bstr_view.h"
+
+using NEONengine::bstr_view;
+
+static double nowSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Keeps the optimiser from discarding the work
+static volatile uint32_t s_sink;
+
+template<class K>
+struct pair_entry
+{
+    K key;
+    uint32_t value;
+};
+
+template<class K>
+static uint32_t scanFind(mtl::vector<pair_entry<K>> const& entries, K const& key)
+{
+    for (auto const& entry : entries)
+    {
+        if (entry.key == key) return entry.value;
+    }
+    return 0;
+}
+
+/**
+ * @brief Runs the lookups for one key type and size.
+ *
+ * @param keys Keys in insertion order.
+ * @param order Indices of keys in lookup order.
+ */
+template<class K>
+static void runSuite(char const* szType,
+                     mtl::vector<K> const& keys,
+                     mtl::vector<uint32_t> const& order)
+{
+    size_t count = keys.size();
+
+    mtl::vector<pair_entry<K>> entries;
+    mtl::flat_hash_map<K, uint32_t> map;
+    for (size_t i = 0; i < count; ++i)
+    {
+        entries.push_back(pair_entry<K>{ keys[i], static_cast<uint32_t>(i) });
+        map.insert(keys[i], static_cast<uint32_t>(i));
+    }
+
+    // A scan costs count/2 compares per lookup, keep its total work similar per size
+    size_t rounds = 20000000 / (count * count) + 1;
+
+    double start = nowSeconds();
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        for (auto index : order) { s_sink = s_sink + scanFind(entries, keys[index]); }
+    }
+    double scan = nowSeconds() - start;
+
+    start = nowSeconds();
+    for (size_t round = 0; round < rounds; ++round)
+    {
+        for (auto index : order) { s_sink = s_sink + *map.find(keys[index]); }
+    }
+    double hashed = nowSeconds() - start;
+
+    size_t lookups = rounds * count;
+    printf("%-12s %6zu %12.1f %12.1f %8.1fx\n",
+           szType,
+           count,
+           scan * 1e9 / lookups,
+           hashed * 1e9 / lookups,
+           scan / hashed);
+}
+
+int main()
+{
+    static char names[4096][16];
+
+    printf("mtl::flat_hash_map vs linear scan (ns per lookup)\n");
+    printf("%-12s %6s %12s %12s %9s\n", "key", "count", "scan", "hash map", "speedup");
+
+    static uint32_t const counts[] = { 16, 256, 4096 };
+    for (uint32_t count : counts)
+    {
+        // Fixed LCG shuffle so every run looks the keys up in the same order
+        mtl::vector<uint32_t> order;
+        for (uint32_t i = 0; i < count; ++i) { order.push_back(i); }
+        uint32_t seed = 12345;
+        for (uint32_t i = count - 1; i > 0; --i)
+        {
+            seed = seed * 1103515245u + 12345u;
+            mtl::swap(order[i], order[(seed >> 8) % (i + 1)]);
+        }
+
+        mtl::vector<uint16_t> ids;
+        mtl::vector<bstr_view> strings;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            ids.push_back(static_cast<uint16_t>(i));
+            int length = snprintf(names[i], sizeof(names[i]), "hotspot_%u", i);
+            strings.push_back(bstr_view(names[i], length));
+        }
+
+        runSuite<uint16_t>("uint16_t", ids, order);
+        runSuite<bstr_view>("bstr_view", strings, order);
+    }
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * @file script_bench.cpp
+ * @brief Measures the script VM on the scripts of a .neon file.
+ *
+ * Every script referenced by an interaction, a scene or a dialogue choice is
+ * run to the end, over and over, with a different set of flags each round so
+ * both sides of the branches are taken. Commands do nothing and never pause,
+ * so the numbers are the cost of the VM itself.
+ *
+ *   script_bench [path/to/file.neon]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <mtl/vector.h>
+
+#include "core/game_flags.h"
+#include "core/script.h"
+
+using namespace NEONengine;
+
+static double nowSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Keeps the optimiser from discarding the commands
+static volatile uint32_t s_sink;
+
+static UBYTE benchCommand(ScriptOp eOp, UWORD const *puwArgs, void * /*pUserData*/)
+{
+    s_sink = s_sink + static_cast<UWORD>(eOp) + puwArgs[0];
+    return 1;
+}
+
+static UWORD readWord(unsigned char const *pData)
+{
+    return static_cast<UWORD>((pData[0] << 8) | pData[1]);
+}
+
+static ULONG readLong(unsigned char const *pData)
+{
+    return (static_cast<ULONG>(readWord(pData)) << 16) | readWord(pData + 2);
+}
+
+struct chunk_layout
+{
+    char szName[5];
+    ULONG ulEntrySize;
+    ULONG ulScriptField;  ///< Byte offset of the script offset in an entry, or 0
+};
+
+// Entry sizes as written by the editor, see game_data.h
+static chunk_layout const s_chunks[] = {
+    { "LOCS", 32, 0 },  { "SCNS", 22, 6 },  { "RGNS", 16, 14 }, { "TEXT", 10, 0 },
+    { "DLGS", 4, 0 },   { "PAGE", 18, 0 },  { "CHCE", 14, 10 }, { "BYTE", 2, 0 },
+    { "SHPE", 4, 0 },   { "PALS", 128, 0 }, { "PALU", 4, 0 },   { "SPKR", 16, 0 },
+};
+
+/**
+ * @brief Pulls the bytecode and the script entry points out of a .neon file.
+ */
+static bool loadNeon(char const *szPath, mtl::vector<UWORD> &code, mtl::vector<UWORD> &entries)
+{
+    FILE *pFile = fopen(szPath, "rb");
+    if (!pFile) return false;
+
+    fseek(pFile, 0, SEEK_END);
+    long size = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+    auto *pData = static_cast<unsigned char *>(malloc(size));
+    bool ok     = fread(pData, 1, size, pFile) == static_cast<size_t>(size);
+    fclose(pFile);
+
+    // Magic and version, then chunks of name, entry count and entries
+    for (long offset = 8; ok && offset + 8 <= size;)
+    {
+        chunk_layout const *pLayout = nullptr;
+        for (auto const &layout : s_chunks)
+        {
+            if (__builtin_memcmp(pData + offset, layout.szName, 4) == 0) pLayout = &layout;
+        }
+        if (!pLayout)
+        {
+            ok = false;
+            break;
+        }
+
+        // gutter.neon ends in a SPKR header without its entries, the engine
+        // skips unknown chunks too, so a truncated chunk just ends the file
+        ULONG ulCount = readLong(pData + offset + 4);
+        offset += 8;
+        if (offset + static_cast<long>(ulCount * pLayout->ulEntrySize) > size) break;
+
+        for (ULONG i = 0; i < ulCount; ++i)
+        {
+            unsigned char const *pEntry = pData + offset + i * pLayout->ulEntrySize;
+            if (pLayout->ulScriptField)
+            {
+                UWORD uwScript = readWord(pEntry + pLayout->ulScriptField);
+                if (uwScript != SCRIPT_NONE) entries.push_back(uwScript);
+            }
+            else if (pLayout->szName[0] == 'B')
+            {
+                code.push_back(readWord(pEntry));
+            }
+        }
+        offset += ulCount * pLayout->ulEntrySize;
+    }
+
+    free(pData);
+    return ok && !code.empty();
+}
+
+int main(int argc, char **argv)
+{
+    char const *szPath = argc > 1 ? argv[1] : GUTTER_NEON_PATH;
+
+    mtl::vector<UWORD> code;
+    mtl::vector<UWORD> entries;
+    if (!loadNeon(szPath, code, entries))
+    {
+        fprintf(stderr, "Could not read '%s'\n", szPath);
+        return 1;
+    }
+
+    if (!scriptLoad(code.data(), code.size()) || !gameFlagsReserve(256))
+    {
+        fprintf(stderr, "Could not load the scripts of '%s'\n", szPath);
+        return 1;
+    }
+
+    ScriptVm vm;
+    scriptVmInit(&vm, benchCommand, nullptr);
+
+    static uint32_t const ROUNDS = 100000;
+    static uint32_t flags[256 / 32];
+    ULONG ulLongest = 0;
+    ULONG ulFrames  = 0;
+    uint32_t seed   = 12345;
+
+    double start = nowSeconds();
+    for (uint32_t round = 0; round < ROUNDS; ++round)
+    {
+        // New flags every round, from a fixed LCG so runs are comparable
+        for (uint32_t &word : flags)
+        {
+            seed = seed * 1103515245u + 12345u;
+            word = seed;
+        }
+        gameFlagsRestore(flags, sizeof(flags));
+
+        for (UWORD uwEntry : entries)
+        {
+            ULONG ulBefore = vm.ulInstructionCount;
+            scriptStart(&vm, uwEntry);
+            while (scriptRun(&vm, SCRIPT_FRAME_BUDGET) == ScriptStatus::RUNNING) { ++ulFrames; }
+
+            ULONG ulRan = vm.ulInstructionCount - ulBefore;
+            if (ulRan > ulLongest) ulLongest = ulRan;
+        }
+    }
+    double elapsed = nowSeconds() - start;
+
+    double runs = static_cast<double>(ROUNDS) * entries.size();
+    printf("%s: %zu words of bytecode, %zu scripts\n", szPath, code.size(), entries.size());
+    printf("%lu instructions in %.3f s\n", (unsigned long)vm.ulInstructionCount, elapsed);
+    printf("%.1f M instructions/s, %.2f ns per instruction\n",
+           vm.ulInstructionCount / elapsed * 1e-6,
+           elapsed * 1e9 / vm.ulInstructionCount);
+    printf("%.1f instructions per script, longest %lu, %lu frames over budget\n",
+           vm.ulInstructionCount / runs,
+           (unsigned long)ulLongest,
+           (unsigned long)ulFrames);
+
+    scriptUnload();
+    gameFlagsDestroy();
+    return 0;
+}
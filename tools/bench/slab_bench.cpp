@@ -0,0 +1,150 @@
+/**
+ * @file slab_bench.cpp
+ * @brief Compares the slab allocator against the header-tracked memAlloc path.
+ *
+ * The tracked path is the one operator new used before the slabs existed:
+ * one memAlloc per object with a size header rounded up to max alignment and
+ * a trailing debug canary.
+ *
+ * On the host memAlloc is the C heap, whose per-thread cache is itself a
+ * size-class allocator, so the timings only show that the slab path stays in
+ * the same league. On a 68k every tracked allocation is an exec AllocMem
+ * first-fit walk plus Forbid/Permit, which the slabs skip entirely. The
+ * per-block footprint figures are exact for both.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <ace/managers/memory.h>
+
+#include <mtl/slab.h>
+
+static constexpr size_t HEADER_SIZE = (sizeof(uint32_t) + alignof(max_align_t) - 1)
+                                      & ~(alignof(max_align_t) - 1);
+static constexpr size_t CANARY_SIZE = sizeof(uint32_t);
+
+static constexpr size_t LIVE_SLOTS = 1024;
+static constexpr size_t OPERATIONS = 4000000;
+
+static void* trackedAlloc(size_t size)
+{
+    auto pRaw = static_cast<uint8_t*>(memAlloc(HEADER_SIZE + size + CANARY_SIZE, MEMF_FAST));
+    *reinterpret_cast<uint32_t*>(pRaw) = static_cast<uint32_t>(size);
+    return pRaw + HEADER_SIZE;
+}
+
+static void trackedFree(void* ptr)
+{
+    auto pRaw = static_cast<uint8_t*>(ptr) - HEADER_SIZE;
+    memFree(pRaw, HEADER_SIZE + *reinterpret_cast<uint32_t*>(pRaw) + CANARY_SIZE);
+}
+
+static void* slabAlloc(size_t size)
+{
+    return mtl::slab_alloc(size, MEMF_FAST);
+}
+
+static void slabFree(void* ptr)
+{
+    mtl::slab_free(ptr);
+}
+
+static double nowSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Keeps LIVE_SLOTS objects alive and randomly replaces them, which is what a
+ * game does with hotspots, renderers and small tables over time. The random
+ * sequence is generated up front so only the allocator is timed.
+ */
+struct churn_op
+{
+    uint16_t slot;
+    uint16_t size;
+};
+
+static churn_op s_ops[OPERATIONS];
+static void* s_slots[LIVE_SLOTS];
+
+static void prepareChurn(size_t minSize, size_t maxSize)
+{
+    srand(1234);
+    for (auto& op : s_ops)
+    {
+        op.slot = static_cast<uint16_t>(rand() % LIVE_SLOTS);
+        op.size = static_cast<uint16_t>(minSize + rand() % (maxSize - minSize + 1));
+    }
+}
+
+static double runChurn(void* (*pAlloc)(size_t), void (*pFree)(void*))
+{
+    for (size_t i = 0; i < LIVE_SLOTS; ++i) { s_slots[i] = pAlloc(s_ops[i].size); }
+
+    double start = nowSeconds();
+    for (auto const& op : s_ops)
+    {
+        pFree(s_slots[op.slot]);
+        s_slots[op.slot] = pAlloc(op.size);
+    }
+    double elapsed = nowSeconds() - start;
+
+    for (size_t i = 0; i < LIVE_SLOTS; ++i) { pFree(s_slots[i]); }
+
+    return elapsed;
+}
+
+static size_t slabBlockSize(size_t size)
+{
+    for (auto classSize : mtl::SLAB_CLASS_SIZES)
+    {
+        if (size <= classSize) return classSize;
+    }
+    return size;
+}
+
+int main()
+{
+    struct scenario
+    {
+        char const* szName;
+        size_t minSize;
+        size_t maxSize;
+    } const scenarios[] = {
+        { "8-32 bytes", 8, 32 },
+        { "24-64 bytes", 24, 64 },
+        { "8-128 bytes", 8, 128 },
+    };
+
+    printf("Slab allocator vs header-tracked memAlloc (%zu live blocks, %zu ops)\n",
+           LIVE_SLOTS,
+           OPERATIONS);
+    printf("%-14s %12s %12s %8s\n", "sizes", "tracked ns", "slab ns", "speedup");
+
+    for (auto const& s : scenarios)
+    {
+        prepareChurn(s.minSize, s.maxSize);
+        double tracked = runChurn(trackedAlloc, trackedFree);
+        double slab    = runChurn(slabAlloc, slabFree);
+        printf("%-14s %12.1f %12.1f %7.2fx\n",
+               s.szName,
+               tracked * 1e9 / OPERATIONS,
+               slab * 1e9 / OPERATIONS,
+               tracked / slab);
+    }
+
+    printf("\nPer-block footprint in bytes (excluding exec's own chunk rounding)\n");
+    printf("%-8s %10s %10s\n", "request", "tracked", "slab");
+    size_t const sizes[] = { 8, 12, 20, 36, 56, 100 };
+    for (auto size : sizes)
+    {
+        printf("%-8zu %10zu %10zu\n", size, HEADER_SIZE + size + CANARY_SIZE, slabBlockSize(size));
+    }
+
+    mtl::slab_trim();
+    return 0;
+}
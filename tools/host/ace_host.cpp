@@ -0,0 +1,115 @@
+/**
+ * @file ace_host.cpp
+ * @brief Minimal host implementation of the ACE calls used by mtl, so engine
+ * containers and allocators can be benchmarked and tested natively.
+ */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ace/managers/log.h>
+#include <ace/managers/memory.h>
+#include <ace/managers/system.h>
+#include <ace/utils/file.h>
+
+static UBYTE s_ubSystemUsed = 1;
+
+void* memAlloc(ULONG ulSize, ULONG ulFlags)
+{
+    return (ulFlags & MEMF_CLEAR) ? calloc(1, ulSize) : malloc(ulSize);
+}
+
+void memFree(void* pMem, ULONG /*ulSize*/)
+{
+    free(pMem);
+}
+
+void* memAllocFast(ULONG ulSize)
+{
+    return memAlloc(ulSize, MEMF_FAST);
+}
+
+void* memAllocFastClear(ULONG ulSize)
+{
+    return memAlloc(ulSize, MEMF_FAST | MEMF_CLEAR);
+}
+
+void* memAllocChip(ULONG ulSize)
+{
+    return memAlloc(ulSize, MEMF_CHIP);
+}
+
+void* memAllocChipClear(ULONG ulSize)
+{
+    return memAlloc(ulSize, MEMF_CHIP | MEMF_CLEAR);
+}
+
+ULONG memGetFreeChipSize(void)
+{
+    return 2UL << 20;
+}
+
+ULONG memGetFreeSize(void)
+{
+    return 64UL << 20;
+}
+
+ULONG AvailMem(ULONG ulFlags)
+{
+    return (ulFlags & MEMF_CHIP) ? memGetFreeChipSize() : memGetFreeSize();
+}
+
+void logWrite(char const* szFormat, ...)
+{
+    va_list args;
+    va_start(args, szFormat);
+    vfprintf(stderr, szFormat, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+void logBlockBegin(char const* szBlockName, ...)
+{
+    (void)szBlockName;
+}
+
+void logBlockEnd(char const* szBlockName)
+{
+    (void)szBlockName;
+}
+
+void systemUse(void)
+{
+    s_ubSystemUsed = 1;
+}
+
+void systemUnuse(void)
+{
+    s_ubSystemUsed = 0;
+}
+
+UBYTE systemIsUsed(void)
+{
+    return s_ubSystemUsed;
+}
+
+tFile* fileOpen(char const* szPath, char const* szMode)
+{
+    return reinterpret_cast<tFile*>(fopen(szPath, szMode));
+}
+
+void fileClose(tFile* pFile)
+{
+    fclose(reinterpret_cast<FILE*>(pFile));
+}
+
+ULONG fileRead(tFile* pFile, void* pDest, ULONG ulSize)
+{
+    return fread(pDest, 1, ulSize, reinterpret_cast<FILE*>(pFile));
+}
+
+ULONG fileWrite(tFile* pFile, void const* pSrc, ULONG ulSize)
+{
+    return fwrite(pSrc, 1, ulSize, reinterpret_cast<FILE*>(pFile));
+}
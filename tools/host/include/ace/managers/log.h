@@ -0,0 +1,12 @@
+/**
+ * @file log.h
+ * @brief Host stand-in for ACE's log manager, writes to stderr.
+ */
+#ifndef __HOST__ACE_LOG_H__INCLUDED__
+#define __HOST__ACE_LOG_H__INCLUDED__
+
+void logWrite(char const* szFormat, ...);
+void logBlockBegin(char const* szBlockName, ...);
+void logBlockEnd(char const* szBlockName);
+
+#endif  // __HOST__ACE_LOG_H__INCLUDED__
@@ -0,0 +1,36 @@
+/**
+ * @file memory.h
+ * @brief Host stand-in for ACE's memory manager, backed by the C heap.
+ *
+ * Only what mtl needs to compile and run on the host is provided. The flag
+ * values mirror exec/memory.h.
+ */
+#ifndef __HOST__ACE_MEMORY_H__INCLUDED__
+#define __HOST__ACE_MEMORY_H__INCLUDED__
+
+#include <ace/types.h>
+
+#define MEMF_ANY        (0L)
+#define MEMF_PUBLIC     (1L << 0)
+#define MEMF_CHIP       (1L << 1)
+#define MEMF_FAST       (1L << 2)
+#define MEMF_LOCAL      (1L << 8)
+#define MEMF_24BITDMA   (1L << 9)
+#define MEMF_KICK       (1L << 10)
+#define MEMF_CLEAR      (1L << 16)
+#define MEMF_LARGEST    (1L << 17)
+#define MEMF_REVERSE    (1L << 18)
+#define MEMF_TOTAL      (1L << 19)
+#define MEMF_NO_EXPUNGE (-2147483647L - 1)
+
+void* memAlloc(ULONG ulSize, ULONG ulFlags);
+void memFree(void* pMem, ULONG ulSize);
+void* memAllocFast(ULONG ulSize);
+void* memAllocFastClear(ULONG ulSize);
+void* memAllocChip(ULONG ulSize);
+void* memAllocChipClear(ULONG ulSize);
+ULONG memGetFreeChipSize(void);
+ULONG memGetFreeSize(void);
+ULONG AvailMem(ULONG ulFlags);
+
+#endif  // __HOST__ACE_MEMORY_H__INCLUDED__
@@ -0,0 +1,14 @@
+/**
+ * @file system.h
+ * @brief Host stand-in for ACE's system manager. OS ownership is a no-op.
+ */
+#ifndef __HOST__ACE_SYSTEM_H__INCLUDED__
+#define __HOST__ACE_SYSTEM_H__INCLUDED__
+
+#include <ace/types.h>
+
+void systemUse(void);
+void systemUnuse(void);
+UBYTE systemIsUsed(void);
+
+#endif  // __HOST__ACE_SYSTEM_H__INCLUDED__
@@ -0,0 +1,27 @@
+/**
+ * @file types.h
+ * @brief Host stand-in for ACE's base types.
+ */
+#ifndef __HOST__ACE_TYPES_H__INCLUDED__
+#define __HOST__ACE_TYPES_H__INCLUDED__
+
+#include <exec/types.h>
+
+typedef struct _tUwCoordYX
+{
+    UWORD uwY;
+    UWORD uwX;
+} tUwCoordYX;
+
+typedef struct _tUwRect
+{
+    UWORD uwY;
+    UWORD uwX;
+    UWORD uwWidth;
+    UWORD uwHeight;
+} tUwRect;
+
+#define MIN(x, y) ((x) < (y) ? (x) : (y))
+#define MAX(x, y) ((x) > (y) ? (x) : (y))
+
+#endif  // __HOST__ACE_TYPES_H__INCLUDED__
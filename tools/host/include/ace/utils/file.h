@@ -0,0 +1,17 @@
+/**
+ * @file file.h
+ * @brief Host stand-in for ACE's file utilities, backed by stdio.
+ */
+#ifndef __HOST__ACE_FILE_H__INCLUDED__
+#define __HOST__ACE_FILE_H__INCLUDED__
+
+#include <ace/types.h>
+
+typedef struct _tFile tFile;
+
+tFile* fileOpen(char const* szPath, char const* szMode);
+void fileClose(tFile* pFile);
+ULONG fileRead(tFile* pFile, void* pDest, ULONG ulSize);
+ULONG fileWrite(tFile* pFile, void const* pSrc, ULONG ulSize);
+
+#endif  // __HOST__ACE_FILE_H__INCLUDED__
@@ -0,0 +1,21 @@
+/**
+ * @file types.h
+ * @brief Host stand-in for the exec base types used by the engine.
+ */
+#ifndef __HOST__EXEC_TYPES_H__INCLUDED__
+#define __HOST__EXEC_TYPES_H__INCLUDED__
+
+#include <stdint.h>
+
+typedef uint8_t UBYTE;
+typedef int8_t BYTE;
+typedef uint16_t UWORD;
+typedef int16_t WORD;
+typedef uint32_t ULONG;
+typedef int32_t LONG;
+typedef void* APTR;
+
+#define TRUE  1
+#define FALSE 0
+
+#endif  // __HOST__EXEC_TYPES_H__INCLUDED__
@@ -0,0 +1,10 @@
+/**
+ * @file stdint.h
+ * @brief Host stand-in for ACE's mini_std/stdint.h.
+ */
+#ifndef __HOST__MINI_STD_STDINT_H__INCLUDED__
+#define __HOST__MINI_STD_STDINT_H__INCLUDED__
+
+#include <stdint.h>
+
+#endif  // __HOST__MINI_STD_STDINT_H__INCLUDED__
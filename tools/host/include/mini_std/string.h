@@ -0,0 +1,10 @@
+/**
+ * @file string.h
+ * @brief Host stand-in for ACE's mini_std/string.h.
+ */
+#ifndef __HOST__MINI_STD_STRING_H__INCLUDED__
+#define __HOST__MINI_STD_STRING_H__INCLUDED__
+
+#include <string.h>
+
+#endif  // __HOST__MINI_STD_STRING_H__INCLUDED__
@@ -0,0 +1,14 @@
+/**
+ * @file neonengine.h
+ * @brief Host stand-in for the engine header, for the engine sources that
+ * only take its logging from it. Found before src/neonengine.h, as the host
+ * include directory comes first.
+ */
+#ifndef __HOST__NEONENGINE_H__INCLUDED__
+#define __HOST__NEONENGINE_H__INCLUDED__
+
+#include <ace/managers/log.h>
+
+#define NE_LOG(fmt, ...) logWrite("NEONengine: " fmt, ##__VA_ARGS__)
+
+#endif  // __HOST__NEONENGINE_H__INCLUDED__
@@ -0,0 +1,151 @@
+/**
+ * @file lz_compress.cpp
+ * @brief Lazy matching LZ compressor with hash chains. The data it packs is
+ * a few KB per chunk, so the whole 64 KB window is searched.
+ */
+#include "lz_compress.h"
+
+#include "utils/lz.h"
+
+using namespace NEONengine;
+
+static uint32_t const HASH_BITS = 16;
+static uint32_t const NO_POS    = 0xFFFFFFFF;
+
+struct lz_match
+{
+    uint32_t ulLength;
+    uint32_t ulOffset;
+};
+
+struct lz_finder
+{
+    unsigned char const* pData;
+    uint32_t ulSize;
+    mtl::vector<uint32_t> head;
+    mtl::vector<uint32_t> prev;
+    uint32_t ulInserted;
+};
+
+static uint32_t hashAt(unsigned char const* pData)
+{
+    uint32_t value = pData[0] | (pData[1] << 8) | (pData[2] << 16) | (uint32_t(pData[3]) << 24);
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/**
+ * @brief Adds every position before ulPos to the hash chains.
+ */
+static void insertUpTo(lz_finder& finder, uint32_t ulPos)
+{
+    for (; finder.ulInserted < ulPos; ++finder.ulInserted)
+    {
+        uint32_t ulAt = finder.ulInserted;
+        if (ulAt + LZ_MIN_MATCH > finder.ulSize) continue;
+
+        uint32_t ulHash     = hashAt(finder.pData + ulAt);
+        finder.prev[ulAt]   = finder.head[ulHash];
+        finder.head[ulHash] = ulAt;
+    }
+}
+
+static lz_match findMatch(lz_finder& finder, uint32_t ulPos)
+{
+    lz_match best = { 0, 0 };
+    if (ulPos + LZ_MIN_MATCH > finder.ulSize) return best;
+
+    insertUpTo(finder, ulPos);
+    unsigned char const* pData = finder.pData;
+    for (uint32_t ulCandidate = finder.head[hashAt(pData + ulPos)];
+         ulCandidate != NO_POS && ulPos - ulCandidate <= LZ_MAX_OFFSET;
+         ulCandidate = finder.prev[ulCandidate])
+    {
+        uint32_t ulLength = 0;
+        while (ulPos + ulLength < finder.ulSize
+               && pData[ulCandidate + ulLength] == pData[ulPos + ulLength])
+        {
+            ++ulLength;
+        }
+
+        // Candidates come nearest first, so ties keep the shortest offset
+        if (ulLength > best.ulLength) best = { ulLength, ulPos - ulCandidate };
+    }
+
+    if (best.ulLength < LZ_MIN_MATCH) best.ulLength = 0;
+    return best;
+}
+
+/**
+ * @brief Writes the bytes continuing a length field of 15.
+ */
+static void writeLength(mtl::vector<unsigned char>& out, uint32_t ulLength)
+{
+    for (ulLength -= 15; ulLength >= 255; ulLength -= 255) { out.push_back(255); }
+    out.push_back(ulLength);
+}
+
+static void writeSequence(mtl::vector<unsigned char>& out,
+                          unsigned char const* pLiterals,
+                          uint32_t ulLiterals,
+                          lz_match const& match)
+{
+    uint32_t ulLengthField = match.ulLength ? match.ulLength - LZ_MIN_MATCH : 0;
+    uint32_t ulToken       = (ulLiterals < 15 ? ulLiterals : 15) << 4;
+    ulToken |= ulLengthField < 15 ? ulLengthField : 15;
+    out.push_back(ulToken);
+    if (ulLiterals >= 15) writeLength(out, ulLiterals);
+    for (uint32_t i = 0; i < ulLiterals; ++i) { out.push_back(pLiterals[i]); }
+
+    if (!match.ulLength) return;
+
+    out.push_back(match.ulOffset >> 8);
+    out.push_back(match.ulOffset & 0xFF);
+    if (ulLengthField >= 15) writeLength(out, ulLengthField);
+}
+
+void lzCompress(unsigned char const* pData,
+                uint32_t ulSize,
+                mtl::vector<unsigned char>& out,
+                uint32_t* pulMargin)
+{
+    lz_finder finder = { pData, ulSize, {}, {}, 0 };
+    finder.head.resize(1u << HASH_BITS, NO_POS);
+    finder.prev.resize(ulSize, NO_POS);
+
+    size_t start       = out.size();
+    uint32_t ulLiteral = 0;
+    uint32_t ulPos     = 0;
+    int32_t lAhead     = 0;  // Most output bytes written ahead of the input read
+    while (ulPos < ulSize)
+    {
+        lz_match match = findMatch(finder, ulPos);
+
+        // Lazy matching: a literal now is worth it for a longer match next
+        if (match.ulLength && findMatch(finder, ulPos + 1).ulLength > match.ulLength + 1)
+        {
+            match.ulLength = 0;
+        }
+
+        if (!match.ulLength)
+        {
+            ++ulPos;
+            continue;
+        }
+
+        writeSequence(out, pData + ulLiteral, ulPos - ulLiteral, match);
+        ulPos += match.ulLength;
+        ulLiteral = ulPos;
+
+        // The match is written without reading input, which is where the
+        // output can catch up with the input when decompressing in place
+        int32_t lRead = out.size() - start;
+        if (int32_t(ulPos) - lRead > lAhead) lAhead = ulPos - lRead;
+    }
+    writeSequence(out, pData + ulLiteral, ulSize - ulLiteral, { 0, 0 });
+
+    // With the stream at the end of a buffer of ulSize + margin bytes, input
+    // byte n sits at ulSize + margin - packed size + n
+    int32_t lPacked = out.size() - start;
+    int32_t lMargin = lAhead - int32_t(ulSize) + lPacked;
+    *pulMargin      = lMargin > 0 ? lMargin : 0;
+}
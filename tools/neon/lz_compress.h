@@ -0,0 +1,22 @@
+/**
+ * @file lz_compress.h
+ * @brief Host side compressor for the LZ format of utils/lz.h.
+ */
+#ifndef __TOOLS__LZ_COMPRESS_H__INCLUDED__
+#define __TOOLS__LZ_COMPRESS_H__INCLUDED__
+
+#include <mtl/vector.h>
+
+/**
+ * @brief Compresses ulSize bytes, appending the stream to out.
+ *
+ * @param pulMargin Receives the number of bytes the buffer needs past the
+ * end of the decompressed data to decompress the stream in place, with the
+ * stream placed at the very end of the buffer.
+ */
+void lzCompress(unsigned char const* pData,
+                uint32_t ulSize,
+                mtl::vector<unsigned char>& out,
+                uint32_t* pulMargin);
+
+#endif  // __TOOLS__LZ_COMPRESS_H__INCLUDED__
@@ -0,0 +1,381 @@
+/**
+ * @file neon_check.cpp
+ * @brief Checks every reference of a .neon file against the chunk counts.
+ *
+ * Scene indices in Scene::uwBackgroundId, Interaction::uwGotoScene and
+ * GOTO_LOCATION are relative to their location, so each entry is checked
+ * against the location that owns it.
+ */
+#include "neon_check.h"
+
+#include <stdio.h>
+
+#include "core/script.h"
+
+using namespace NEONengine;
+
+static UWORD const NONE = 0xFFFF;
+
+struct checker
+{
+    neon_file const& file;
+    uint32_t ulStringCount;
+    uint32_t ulErrors;
+    mtl::vector<bool> instructionStarts;
+
+    uint32_t count(chunk_id id) const { return file[id].ulCount; }
+
+    template<typename T>
+    T const* entries(chunk_id id) const
+    {
+        return file[id].entries<T>();
+    }
+};
+
+static char const* nameOf(chunk_id id)
+{
+    return g_chunkTypes[static_cast<int>(id)].szName;
+}
+
+static uint32_t rangeCount(Range const& range)
+{
+    if (range.uwFirstIndex == NONE || range.uwLastIndex < range.uwFirstIndex) return 0;
+
+    return range.uwLastIndex - range.uwFirstIndex + 1;
+}
+
+static void checkRange(checker& check,
+                       chunk_id owner,
+                       uint32_t ulIndex,
+                       char const* szField,
+                       Range const& range,
+                       chunk_id target)
+{
+    if (rangeCount(range) && range.uwLastIndex >= check.count(target))
+    {
+        fprintf(stderr,
+                "%s[%u].%s: %u-%u is past the %u entries of %s\n",
+                nameOf(owner),
+                ulIndex,
+                szField,
+                range.uwFirstIndex,
+                range.uwLastIndex,
+                check.count(target),
+                nameOf(target));
+        ++check.ulErrors;
+    }
+}
+
+static void checkId(checker& check,
+                    chunk_id owner,
+                    uint32_t ulIndex,
+                    char const* szField,
+                    UWORD uwId,
+                    uint32_t ulCount)
+{
+    if (uwId != NONE && uwId >= ulCount)
+    {
+        fprintf(stderr,
+                "%s[%u].%s: %u is not below %u\n",
+                nameOf(owner),
+                ulIndex,
+                szField,
+                uwId,
+                ulCount);
+        ++check.ulErrors;
+    }
+}
+
+static void checkText(checker& check,
+                      chunk_id owner,
+                      uint32_t ulIndex,
+                      char const* szField,
+                      UWORD uwTextId)
+{
+    if (check.ulStringCount) checkId(check, owner, ulIndex, szField, uwTextId, check.ulStringCount);
+}
+
+static void checkTextRange(checker& check,
+                           chunk_id owner,
+                           uint32_t ulIndex,
+                           char const* szField,
+                           Range const& range)
+{
+    if (check.ulStringCount && rangeCount(range))
+    {
+        checkId(check, owner, ulIndex, szField, range.uwLastIndex, check.ulStringCount);
+    }
+}
+
+static void checkScript(checker& check,
+                        chunk_id owner,
+                        uint32_t ulIndex,
+                        char const* szField,
+                        UWORD uwOffset)
+{
+    if (uwOffset == SCRIPT_NONE) return;
+
+    if (uwOffset >= check.instructionStarts.size() || !check.instructionStarts[uwOffset])
+    {
+        fprintf(stderr,
+                "%s[%u].%s: no script starts at offset %u\n",
+                nameOf(owner),
+                ulIndex,
+                szField,
+                uwOffset);
+        ++check.ulErrors;
+    }
+}
+
+/**
+ * @brief Location owning each scene, NONE for scenes of no location.
+ */
+static void findSceneOwners(checker const& check, mtl::vector<UWORD>& owners)
+{
+    owners.resize(check.count(chunk_id::SCENES), NONE);
+
+    auto const* pLocations = check.entries<Location>(chunk_id::LOCATIONS);
+    for (uint32_t i = 0; i < check.count(chunk_id::LOCATIONS); ++i)
+    {
+        Range const& scenes = pLocations[i].scenes;
+        for (uint32_t j = 0; j < rangeCount(scenes); ++j)
+        {
+            if (scenes.uwFirstIndex + j < owners.size()) owners[scenes.uwFirstIndex + j] = i;
+        }
+    }
+}
+
+static bool checkBytecode(checker& check)
+{
+    auto const* puwCode = check.entries<UWORD>(chunk_id::BYTECODE);
+    uint32_t ulSize     = check.count(chunk_id::BYTECODE);
+    if (!scriptLoad(puwCode, ulSize))
+    {
+        fprintf(stderr, "BYTE: the engine rejects the bytecode\n");
+        ++check.ulErrors;
+        return false;
+    }
+    scriptUnload();
+
+    auto const* pLocations = check.entries<Location>(chunk_id::LOCATIONS);
+    check.instructionStarts.resize(ulSize, false);
+    for (uint32_t ulPc = 0; ulPc < ulSize; ulPc += 1 + scriptOperandCount(puwCode[ulPc]))
+    {
+        check.instructionStarts[ulPc] = true;
+
+        UWORD const* puwArgs = puwCode + ulPc + 1;
+        switch (static_cast<ScriptOp>(puwCode[ulPc]))
+        {
+            case ScriptOp::START_DIALOGUE:
+                checkId(check,
+                        chunk_id::BYTECODE,
+                        ulPc,
+                        "START_DIALOGUE",
+                        puwArgs[0],
+                        check.count(chunk_id::DIALOGUES));
+                break;
+
+            case ScriptOp::GOTO_LOCATION:
+                checkId(check,
+                        chunk_id::BYTECODE,
+                        ulPc,
+                        "GOTO_LOCATION",
+                        puwArgs[0],
+                        check.count(chunk_id::LOCATIONS));
+                if (puwArgs[0] < check.count(chunk_id::LOCATIONS))
+                {
+                    checkId(check,
+                            chunk_id::BYTECODE,
+                            ulPc,
+                            "GOTO_LOCATION scene",
+                            puwArgs[1],
+                            rangeCount(pLocations[puwArgs[0]].scenes));
+                }
+                break;
+
+            case ScriptOp::SET_SPEAKER:
+                checkId(check, chunk_id::BYTECODE, ulPc, "SET_SPEAKER", puwArgs[0], 8);
+                break;
+
+            case ScriptOp::SAY:
+                checkText(check, chunk_id::BYTECODE, ulPc, "SAY", puwArgs[0]);
+                break;
+
+            case ScriptOp::MENU_ITEM:
+                checkText(check, chunk_id::BYTECODE, ulPc, "MENU_ITEM", puwArgs[0]);
+                break;
+
+            default: break;
+        }
+    }
+    return true;
+}
+
+static void checkLocations(checker& check)
+{
+    auto const* pLocations = check.entries<Location>(chunk_id::LOCATIONS);
+    for (uint32_t i = 0; i < check.count(chunk_id::LOCATIONS); ++i)
+    {
+        Location const& location = pLocations[i];
+        checkText(check, chunk_id::LOCATIONS, i, "uwNameId", location.uwNameId);
+        checkTextRange(check, chunk_id::LOCATIONS, i, "backgrounds", location.backgrounds);
+        checkRange(check, chunk_id::LOCATIONS, i, "scenes", location.scenes, chunk_id::SCENES);
+        checkRange(check, chunk_id::LOCATIONS, i, "shapes", location.shapes, chunk_id::SHAPES);
+    }
+}
+
+static void checkScenes(checker& check, mtl::vector<UWORD> const& owners)
+{
+    auto const* pLocations = check.entries<Location>(chunk_id::LOCATIONS);
+    auto const* pScenes    = check.entries<Scene>(chunk_id::SCENES);
+    for (uint32_t i = 0; i < check.count(chunk_id::SCENES); ++i)
+    {
+        Scene const& scene = pScenes[i];
+        checkText(check, chunk_id::SCENES, i, "uwNameId", scene.uwNameId);
+        checkTextRange(check, chunk_id::SCENES, i, "descriptions", scene.descriptions);
+        checkScript(check, chunk_id::SCENES, i, "uwOnEnterScriptId", scene.uwOnEnterScriptId);
+        checkScript(check, chunk_id::SCENES, i, "uwOnExitScriptId", scene.uwOnExitScriptId);
+        checkRange(check,
+                   chunk_id::SCENES,
+                   i,
+                   "interactiveAreas",
+                   scene.interactiveAreas,
+                   chunk_id::INTERACTIONS);
+        checkRange(check,
+                   chunk_id::SCENES,
+                   i,
+                   "textRegions",
+                   scene.textRegions,
+                   chunk_id::TEXT_REGIONS);
+
+        if (owners[i] == NONE)
+        {
+            fprintf(stderr, "SCNS[%u]: no location has this scene\n", i);
+            ++check.ulErrors;
+            continue;
+        }
+        checkId(check,
+                chunk_id::SCENES,
+                i,
+                "uwBackgroundId",
+                scene.uwBackgroundId,
+                rangeCount(pLocations[owners[i]].backgrounds));
+    }
+}
+
+static void checkInteractions(checker& check, mtl::vector<UWORD> const& owners)
+{
+    auto const* pLocations    = check.entries<Location>(chunk_id::LOCATIONS);
+    auto const* pScenes       = check.entries<Scene>(chunk_id::SCENES);
+    auto const* pInteractions = check.entries<Interaction>(chunk_id::INTERACTIONS);
+    for (uint32_t i = 0; i < check.count(chunk_id::INTERACTIONS); ++i)
+    {
+        Interaction const& interaction = pInteractions[i];
+        checkText(check, chunk_id::INTERACTIONS, i, "uwDescriptionId", interaction.uwDescriptionId);
+        checkScript(check, chunk_id::INTERACTIONS, i, "uwScriptOffset", interaction.uwScriptOffset);
+    }
+
+    // Scene changes stay inside the location of the scene using the interaction
+    for (uint32_t i = 0; i < check.count(chunk_id::SCENES); ++i)
+    {
+        Range const& areas = pScenes[i].interactiveAreas;
+        if (owners[i] == NONE || areas.uwLastIndex >= check.count(chunk_id::INTERACTIONS)) continue;
+
+        uint32_t ulSceneCount = rangeCount(pLocations[owners[i]].scenes);
+        for (uint32_t j = 0; j < rangeCount(areas); ++j)
+        {
+            uint32_t ulIndex = areas.uwFirstIndex + j;
+            checkId(check,
+                    chunk_id::INTERACTIONS,
+                    ulIndex,
+                    "uwGotoScene",
+                    pInteractions[ulIndex].uwGotoScene,
+                    ulSceneCount);
+        }
+    }
+}
+
+static void checkDialogues(checker& check)
+{
+    uint32_t ulPageCount = check.count(chunk_id::DIALOGUE_PAGES);
+
+    auto const* pDialogues = check.entries<Dialogue>(chunk_id::DIALOGUES);
+    for (uint32_t i = 0; i < check.count(chunk_id::DIALOGUES); ++i)
+    {
+        Dialogue const& dialogue = pDialogues[i];
+        if (dialogue.uwFirstPageId + dialogue.uwPageCount > ulPageCount)
+        {
+            fprintf(stderr,
+                    "DLGS[%u]: pages %u+%u are past the %u entries of PAGE\n",
+                    i,
+                    dialogue.uwFirstPageId,
+                    dialogue.uwPageCount,
+                    ulPageCount);
+            ++check.ulErrors;
+        }
+    }
+
+    auto const* pPages = check.entries<DialoguePage>(chunk_id::DIALOGUE_PAGES);
+    for (uint32_t i = 0; i < ulPageCount; ++i)
+    {
+        DialoguePage const& page = pPages[i];
+        checkText(check, chunk_id::DIALOGUE_PAGES, i, "uwTextId", page.uwTextId);
+        checkId(check, chunk_id::DIALOGUE_PAGES, i, "uwGotoPageId", page.uwGotoPageId, ulPageCount);
+        checkRange(check,
+                   chunk_id::DIALOGUE_PAGES,
+                   i,
+                   "choices",
+                   page.choices,
+                   chunk_id::DIALOGUE_CHOICES);
+    }
+
+    auto const* pChoices = check.entries<DialogueChoice>(chunk_id::DIALOGUE_CHOICES);
+    for (uint32_t i = 0; i < check.count(chunk_id::DIALOGUE_CHOICES); ++i)
+    {
+        DialogueChoice const& choice = pChoices[i];
+        checkText(check, chunk_id::DIALOGUE_CHOICES, i, "uwTextId", choice.uwTextId);
+        checkId(check,
+                chunk_id::DIALOGUE_CHOICES,
+                i,
+                "uwGotoPageId",
+                choice.uwGotoPageId,
+                ulPageCount);
+        checkScript(check, chunk_id::DIALOGUE_CHOICES, i, "uwScriptOffset", choice.uwScriptOffset);
+    }
+}
+
+bool neonCheck(neon_file const& file, uint32_t ulStringCount)
+{
+    checker check = { file, ulStringCount, 0, {} };
+
+    // Entry points are checked against the instructions, so the code goes first
+    if (!checkBytecode(check)) return false;
+
+    mtl::vector<UWORD> owners;
+    findSceneOwners(check, owners);
+
+    checkLocations(check);
+    checkScenes(check, owners);
+    checkInteractions(check, owners);
+    checkDialogues(check);
+
+    auto const* pTextRegions = check.entries<TextRegion>(chunk_id::TEXT_REGIONS);
+    for (uint32_t i = 0; i < check.count(chunk_id::TEXT_REGIONS); ++i)
+    {
+        checkText(check, chunk_id::TEXT_REGIONS, i, "uwTextId", pTextRegions[i].uwTextId);
+    }
+
+    auto const* pShapes = check.entries<Shape>(chunk_id::SHAPES);
+    for (uint32_t i = 0; i < check.count(chunk_id::SHAPES); ++i)
+    {
+        checkId(check,
+                chunk_id::SHAPES,
+                i,
+                "uwPaletteId",
+                pShapes[i].uwPaletteId,
+                check.count(chunk_id::PALETTES));
+    }
+
+    if (check.ulErrors) fprintf(stderr, "%u problems found\n", check.ulErrors);
+    return !check.ulErrors;
+}
@@ -0,0 +1,21 @@
+/**
+ * @file neon_check.h
+ * @brief Checks every reference of a .neon file against the chunk counts.
+ */
+#ifndef __TOOLS__NEON_CHECK_H__INCLUDED__
+#define __TOOLS__NEON_CHECK_H__INCLUDED__
+
+#include "neon_file.h"
+
+/**
+ * @brief Checks the ranges, ids and script offsets of every entry, and the
+ * bytecode itself with the engine's scriptLoad(). Every problem found is
+ * printed to stderr.
+ *
+ * @param ulStringCount Number of strings in the language files, 0 to skip
+ * checking text ids.
+ * @return true if nothing was found.
+ */
+bool neonCheck(neon_file const& file, uint32_t ulStringCount);
+
+#endif  // __TOOLS__NEON_CHECK_H__INCLUDED__
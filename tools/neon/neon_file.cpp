@@ -0,0 +1,128 @@
+/**
+ * @file neon_file.cpp
+ * @brief Reading and writing the chunks of a .neon file.
+ */
+#include "neon_file.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace NEONengine;
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Entries are swapped to little-endian");
+
+chunk_type const g_chunkTypes[static_cast<int>(chunk_id::COUNT)] = {
+    { "LOCS", sizeof(Location), sizeof(Location), false },
+    { "SCNS", sizeof(Scene), sizeof(Scene), true },
+    { "RGNS", sizeof(Interaction), sizeof(Interaction), true },
+    { "TEXT", sizeof(TextRegion), offsetof(TextRegion, ubJustify), true },
+    { "DLGS", sizeof(Dialogue), sizeof(Dialogue), false },
+    { "PAGE", sizeof(DialoguePage), offsetof(DialoguePage, ubEnabled), false },
+    { "CHCE", sizeof(DialogueChoice), offsetof(DialogueChoice, ubEnabled), false },
+    { "BYTE", sizeof(UWORD), sizeof(UWORD), false },
+    { "SHPE", sizeof(Shape), sizeof(Shape), true },
+    { "PALS", sizeof(PaletteEntry) * 32, 0, false },
+    { "PALU", sizeof(PaletteEntry), 0, false },
+};
+
+uint32_t readLong(unsigned char const* pData)
+{
+    return (uint32_t(pData[0]) << 24) | (uint32_t(pData[1]) << 16) | (uint32_t(pData[2]) << 8)
+           | pData[3];
+}
+
+void writeLong(mtl::vector<unsigned char>& out, uint32_t value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8) { out.push_back((value >> shift) & 0xFF); }
+}
+
+bool readFile(char const* szPath, mtl::vector<unsigned char>& data)
+{
+    FILE* pFile = fopen(szPath, "rb");
+    if (!pFile) return false;
+
+    unsigned char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), pFile)) > 0)
+    {
+        for (size_t i = 0; i < read; ++i) { data.push_back(buffer[i]); }
+    }
+    fclose(pFile);
+    return true;
+}
+
+bool writeFile(char const* szPath, mtl::vector<unsigned char> const& data)
+{
+    FILE* pFile = fopen(szPath, "wb");
+    if (!pFile) return false;
+
+    bool ok = fwrite(data.data(), 1, data.size(), pFile) == data.size();
+    return fclose(pFile) == 0 && ok;
+}
+
+/**
+ * @brief Swaps the UWORDs of every entry, which turns big-endian entries
+ * into host ones and back.
+ */
+static void swapWords(chunk_type const& type, unsigned char* pData, uint32_t ulCount)
+{
+    for (uint32_t i = 0; i < ulCount; ++i, pData += type.ulEntrySize)
+    {
+        for (uint32_t j = 0; j < type.ulWordBytes; j += 2)
+        {
+            unsigned char high = pData[j];
+            pData[j]           = pData[j + 1];
+            pData[j + 1]       = high;
+        }
+    }
+}
+
+bool neonReadV2(mtl::vector<unsigned char> const& data, neon_file& file)
+{
+    for (int i = 0; i < static_cast<int>(chunk_id::COUNT); ++i)
+    {
+        file.chunks[i].pType   = &g_chunkTypes[i];
+        file.chunks[i].ulCount = 0;
+        file.chunks[i].data.clear();
+    }
+
+    if (data.size() < 8 || memcmp(data.data(), "NEON", 4) != 0) return false;
+    if (readLong(data.data() + 4) != NEON_V2) return false;
+
+    size_t offset = 8;
+    while (offset + 8 <= data.size())
+    {
+        neon_chunk* pChunk = nullptr;
+        for (auto& chunk : file.chunks)
+        {
+            if (memcmp(data.data() + offset, chunk.pType->szName, 4) == 0) pChunk = &chunk;
+        }
+        if (!pChunk)
+        {
+            fprintf(stderr, "Stopping at unknown chunk '%.4s'\n", data.data() + offset);
+            break;
+        }
+
+        pChunk->ulCount = readLong(data.data() + offset + 4);
+        offset += 8;
+        if (pChunk->size() > data.size() - offset)
+        {
+            fprintf(stderr, "'%s' chunk is cut short\n", pChunk->pType->szName);
+            return false;
+        }
+
+        pChunk->data.clear();
+        for (uint32_t i = 0; i < pChunk->size(); ++i) { pChunk->data.push_back(data[offset + i]); }
+        swapWords(*pChunk->pType, pChunk->data.data(), pChunk->ulCount);
+        offset += pChunk->size();
+    }
+    return true;
+}
+
+void neonChunkBytes(neon_chunk const& chunk, mtl::vector<unsigned char>& out)
+{
+    out.clear();
+    for (uint32_t i = 0; i < chunk.size(); ++i) { out.push_back(chunk.data[i]); }
+    swapWords(*chunk.pType, out.data(), chunk.ulCount);
+}
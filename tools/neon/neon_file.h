@@ -0,0 +1,95 @@
+/**
+ * @file neon_file.h
+ * @brief Host side model of a .neon file: its chunks, byte swapped to host
+ * order so the entries can be used as the engine structs of game_data.h.
+ */
+#ifndef __TOOLS__NEON_FILE_H__INCLUDED__
+#define __TOOLS__NEON_FILE_H__INCLUDED__
+
+#include <mtl/vector.h>
+
+#include "core/game_data.h"
+
+static uint32_t const NEON_V2 = 0x00020000;
+static uint32_t const NEON_V3 = 0x00030000;
+
+struct chunk_type
+{
+    char szName[5];
+    uint32_t ulEntrySize;
+    uint32_t ulWordBytes;  ///< Leading bytes of an entry made of UWORDs, the rest are UBYTEs
+    bool bPerLocation;     ///< Loaded by gameDataLoadLocation(), a slice at a time
+};
+
+/**
+ * @brief Chunk types in file order. Must match the chunk table in
+ * game_data.cpp.
+ */
+enum class chunk_id
+{
+    LOCATIONS,
+    SCENES,
+    INTERACTIONS,
+    TEXT_REGIONS,
+    DIALOGUES,
+    DIALOGUE_PAGES,
+    DIALOGUE_CHOICES,
+    BYTECODE,
+    SHAPES,
+    PALETTES,
+    UI_PALETTE,
+    COUNT,
+};
+
+extern chunk_type const g_chunkTypes[static_cast<int>(chunk_id::COUNT)];
+
+struct neon_chunk
+{
+    chunk_type const* pType;
+    uint32_t ulCount;
+    mtl::vector<unsigned char> data;  ///< Entries in host byte order
+
+    uint32_t size() const { return ulCount * pType->ulEntrySize; }
+
+    template<typename T>
+    T* entries()
+    {
+        return reinterpret_cast<T*>(data.data());
+    }
+
+    template<typename T>
+    T const* entries() const
+    {
+        return reinterpret_cast<T const*>(data.data());
+    }
+};
+
+/**
+ * @brief Every chunk type has a chunk, empty if the file has none.
+ */
+struct neon_file
+{
+    neon_chunk chunks[static_cast<int>(chunk_id::COUNT)];
+
+    neon_chunk& operator[](chunk_id id) { return chunks[static_cast<int>(id)]; }
+    neon_chunk const& operator[](chunk_id id) const { return chunks[static_cast<int>(id)]; }
+};
+
+uint32_t readLong(unsigned char const* pData);
+void writeLong(mtl::vector<unsigned char>& out, uint32_t value);
+
+bool readFile(char const* szPath, mtl::vector<unsigned char>& data);
+bool writeFile(char const* szPath, mtl::vector<unsigned char> const& data);
+
+/**
+ * @brief Reads a version 2 file. Like the engine, it stops at the first
+ * unknown chunk, whose size can not be known.
+ */
+bool neonReadV2(mtl::vector<unsigned char> const& data, neon_file& file);
+
+/**
+ * @brief The entries of a chunk as stored in a file, big-endian.
+ */
+void neonChunkBytes(neon_chunk const& chunk, mtl::vector<unsigned char>& out);
+
+#endif  // __TOOLS__NEON_FILE_H__INCLUDED__
@@ -0,0 +1,171 @@
+/**
+ * @file neon_optimize.cpp
+ * @brief Size and locality passes over a checked .neon file.
+ */
+#include "neon_optimize.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace NEONengine;
+
+static UWORD const NONE = 0xFFFF;
+
+static uint32_t rangeCount(Range const& range)
+{
+    if (range.uwFirstIndex == NONE || range.uwLastIndex < range.uwFirstIndex) return 0;
+
+    return range.uwLastIndex - range.uwFirstIndex + 1;
+}
+
+static uint32_t canonicalRange(Range& range)
+{
+    if (rangeCount(range) || (range.uwFirstIndex == NONE && range.uwLastIndex == NONE)) return 0;
+
+    range = { NONE, NONE };
+    return 1;
+}
+
+/**
+ * @brief The editor writes empty ranges in several ways, e.g. 45-44 after
+ * the last used entry. One spelling compresses better.
+ */
+static void canonicalEmptyRanges(neon_file& file)
+{
+    uint32_t ulChanged = 0;
+
+    auto* pLocations = file[chunk_id::LOCATIONS].entries<Location>();
+    for (uint32_t i = 0; i < file[chunk_id::LOCATIONS].ulCount; ++i)
+    {
+        ulChanged += canonicalRange(pLocations[i].backgrounds);
+        ulChanged += canonicalRange(pLocations[i].scenes);
+        ulChanged += canonicalRange(pLocations[i].shapes);
+    }
+
+    auto* pScenes = file[chunk_id::SCENES].entries<Scene>();
+    for (uint32_t i = 0; i < file[chunk_id::SCENES].ulCount; ++i)
+    {
+        ulChanged += canonicalRange(pScenes[i].descriptions);
+        ulChanged += canonicalRange(pScenes[i].interactiveAreas);
+        ulChanged += canonicalRange(pScenes[i].textRegions);
+    }
+
+    auto* pPages = file[chunk_id::DIALOGUE_PAGES].entries<DialoguePage>();
+    for (uint32_t i = 0; i < file[chunk_id::DIALOGUE_PAGES].ulCount; ++i)
+    {
+        ulChanged += canonicalRange(pPages[i].choices);
+    }
+
+    printf("  %u empty ranges rewritten\n", ulChanged);
+}
+
+/**
+ * @brief Palettes are only referenced through Shape::uwPaletteId.
+ */
+static void mergePalettes(neon_file& file)
+{
+    neon_chunk& palettes = file[chunk_id::PALETTES];
+    uint32_t ulSize      = palettes.pType->ulEntrySize;
+
+    mtl::vector<UWORD> remap;
+    mtl::vector<unsigned char> merged;
+    uint32_t ulMerged = 0;
+    for (uint32_t i = 0; i < palettes.ulCount; ++i)
+    {
+        unsigned char const* pPalette = palettes.data.data() + i * ulSize;
+
+        uint32_t ulFound = ulMerged;
+        for (uint32_t j = 0; j < ulMerged && ulFound == ulMerged; ++j)
+        {
+            if (memcmp(merged.data() + j * ulSize, pPalette, ulSize) == 0) ulFound = j;
+        }
+
+        remap.push_back(ulFound);
+        if (ulFound < ulMerged) continue;
+
+        for (uint32_t j = 0; j < ulSize; ++j) { merged.push_back(pPalette[j]); }
+        ++ulMerged;
+    }
+
+    auto* pShapes = file[chunk_id::SHAPES].entries<Shape>();
+    for (uint32_t i = 0; i < file[chunk_id::SHAPES].ulCount; ++i)
+    {
+        if (pShapes[i].uwPaletteId != NONE) pShapes[i].uwPaletteId = remap[pShapes[i].uwPaletteId];
+    }
+
+    printf("  %u palettes merged\n", palettes.ulCount - ulMerged);
+    palettes.data    = mtl::move(merged);
+    palettes.ulCount = ulMerged;
+}
+
+/**
+ * @brief Puts the entries of a chunk used through a Scene range in scene
+ * order. Scenes are in location order, so every location becomes one slice
+ * with nothing of other locations in between. Entries no scene uses are
+ * dropped. Ranges that partly overlap can't be kept contiguous, the chunk is
+ * left alone then.
+ */
+static void regroupByScene(neon_file& file, chunk_id id, Range Scene::*pRange)
+{
+    neon_chunk& chunk = file[id];
+    auto* pScenes     = file[chunk_id::SCENES].entries<Scene>();
+    uint32_t ulScenes = file[chunk_id::SCENES].ulCount;
+
+    for (uint32_t i = 0; i < ulScenes; ++i)
+    {
+        Range const& a = pScenes[i].*pRange;
+        for (uint32_t j = i + 1; j < ulScenes && rangeCount(a); ++j)
+        {
+            Range const& b = pScenes[j].*pRange;
+            bool same      = a.uwFirstIndex == b.uwFirstIndex && a.uwLastIndex == b.uwLastIndex;
+            bool apart     = a.uwLastIndex < b.uwFirstIndex || b.uwLastIndex < a.uwFirstIndex;
+            if (rangeCount(b) && !same && !apart)
+            {
+                printf("  %s left in place, scenes %u and %u share part of their ranges\n",
+                       chunk.pType->szName,
+                       i,
+                       j);
+                return;
+            }
+        }
+    }
+
+    uint32_t ulSize = chunk.pType->ulEntrySize;
+    mtl::vector<UWORD> newFirst;
+    newFirst.resize(chunk.ulCount, NONE);
+    mtl::vector<unsigned char> regrouped;
+    uint32_t ulCount = 0;
+    for (uint32_t i = 0; i < ulScenes; ++i)
+    {
+        Range& range = pScenes[i].*pRange;
+        if (!rangeCount(range)) continue;
+
+        if (newFirst[range.uwFirstIndex] == NONE)
+        {
+            newFirst[range.uwFirstIndex] = ulCount;
+            unsigned char const* pEntries = chunk.data.data() + range.uwFirstIndex * ulSize;
+            for (uint32_t j = 0; j < rangeCount(range) * ulSize; ++j)
+            {
+                regrouped.push_back(pEntries[j]);
+            }
+            ulCount += rangeCount(range);
+        }
+
+        UWORD uwFirst = newFirst[range.uwFirstIndex];
+        range         = { uwFirst, UWORD(uwFirst + rangeCount(range) - 1) };
+    }
+
+    printf("  %s regrouped by scene, %u unused entries dropped\n",
+           chunk.pType->szName,
+           chunk.ulCount - ulCount);
+    chunk.data    = mtl::move(regrouped);
+    chunk.ulCount = ulCount;
+}
+
+void neonOptimize(neon_file& file)
+{
+    canonicalEmptyRanges(file);
+    mergePalettes(file);
+    regroupByScene(file, chunk_id::INTERACTIONS, &Scene::interactiveAreas);
+    regroupByScene(file, chunk_id::TEXT_REGIONS, &Scene::textRegions);
+}
@@ -0,0 +1,23 @@
+/**
+ * @file neon_optimize.h
+ * @brief Size and locality passes over a checked .neon file.
+ */
+#ifndef __TOOLS__NEON_OPTIMIZE_H__INCLUDED__
+#define __TOOLS__NEON_OPTIMIZE_H__INCLUDED__
+
+#include "neon_file.h"
+
+/**
+ * @brief Rewrites the file so it packs smaller and each location is one
+ * contiguous slice of every per-location chunk:
+ *
+ * - empty ranges are all written as 0xFFFF-0xFFFF,
+ * - identical palettes are merged and Shape::uwPaletteId remapped,
+ * - interactions and text regions are put in the order of the scenes using
+ *   them, dropping those no scene uses.
+ *
+ * The file must have passed neonCheck(). Prints what changed.
+ */
+void neonOptimize(neon_file& file);
+
+#endif  // __TOOLS__NEON_OPTIMIZE_H__INCLUDED__
@@ -0,0 +1,274 @@
+/**
+ * @file neonpack.cpp
+ * @brief Checks a version 2 .neon file as written by the editor, optimises
+ * it and converts it into version 3, which starts with a chunk directory so
+ * the engine can load one location at a time, and has its chunks compressed.
+ *
+ *   neonpack [--check] [--keep-order] [--strings lang.noir] in.neon [out.neon]
+ *
+ *   --check       Only check the file, nothing is written
+ *   --keep-order  Write the entries as they are, see neon_optimize.h
+ *   --strings     Also check text ids against the strings of a .noir file
+ *
+ * Every range, id and script offset is checked before anything is written,
+ * see neon_check.h, and the tool fails if any is out of bounds.
+ *
+ * Version 3 layout, all values big-endian:
+ *
+ *   "NEON", 0x00030000, chunk count, in place margin
+ *   chunk count x { name, entry count, offset from the start of the file,
+ *                   compressed size or 0 if stored }
+ *   chunk entries, each chunk starting on a 4 byte boundary
+ *
+ * Chunks the engine loads whole are compressed with utils/lz.h when that
+ * makes them smaller. The engine decompresses them in place, and the in
+ * place margin is how many bytes past the end of a chunk that needs.
+ * Per-location chunks are read a slice at a time, so they are stored.
+ *
+ * The output is read back, decompressed the way the engine does it and
+ * compared with the chunks before the tool reports success.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <mtl/vector.h>
+
+#include "lz_compress.h"
+#include "neon_check.h"
+#include "neon_file.h"
+#include "neon_optimize.h"
+#include "utils/lz.h"
+
+using namespace NEONengine;
+
+struct packed_chunk
+{
+    chunk_type const* pType;
+    uint32_t ulCount;
+    mtl::vector<unsigned char> bytes;   ///< Big-endian entries
+    mtl::vector<unsigned char> packed;  ///< Empty if stored
+    uint32_t ulMargin;
+
+    uint32_t storedSize() const { return packed.empty() ? bytes.size() : packed.size(); }
+};
+
+/**
+ * @brief Number of strings of a .noir file, 0 if it can't be read.
+ */
+static uint32_t readStringCount(char const* szPath)
+{
+    mtl::vector<unsigned char> data;
+    if (!readFile(szPath, data) || data.size() < 16 || memcmp(data.data(), "NOIR", 4) != 0
+        || memcmp(data.data() + 8, "STRG", 4) != 0)
+    {
+        return 0;
+    }
+    return readLong(data.data() + 12);
+}
+
+/**
+ * @brief Compresses the chunks the engine loads whole, keeping the result
+ * only when it is smaller. Returns the largest in place margin, rounded up
+ * so allocations stay long aligned.
+ */
+static uint32_t packChunks(neon_file const& file, mtl::vector<packed_chunk>& chunks)
+{
+    uint32_t ulMargin = 0;
+    for (auto const& chunk : file.chunks)
+    {
+        packed_chunk current = {};
+        current.pType        = chunk.pType;
+        current.ulCount      = chunk.ulCount;
+        neonChunkBytes(chunk, current.bytes);
+
+        if (!chunk.pType->bPerLocation && !current.bytes.empty())
+        {
+            lzCompress(current.bytes.data(),
+                       current.bytes.size(),
+                       current.packed,
+                       &current.ulMargin);
+            if (current.packed.size() >= current.bytes.size())
+            {
+                current.packed.clear();
+                current.ulMargin = 0;
+            }
+            if (current.ulMargin > ulMargin) ulMargin = current.ulMargin;
+        }
+        chunks.push_back(mtl::move(current));
+    }
+    return (ulMargin + 3) & ~3u;
+}
+
+static void writeV3(mtl::vector<packed_chunk> const& chunks,
+                    uint32_t ulMargin,
+                    mtl::vector<unsigned char>& out)
+{
+    out.clear();
+    out.push_back('N');
+    out.push_back('E');
+    out.push_back('O');
+    out.push_back('N');
+    writeLong(out, NEON_V3);
+    writeLong(out, chunks.size());
+    writeLong(out, ulMargin);
+
+    uint32_t offset = 16 + chunks.size() * 16;
+    for (auto const& current : chunks)
+    {
+        out.push_back(current.pType->szName[0]);
+        out.push_back(current.pType->szName[1]);
+        out.push_back(current.pType->szName[2]);
+        out.push_back(current.pType->szName[3]);
+        writeLong(out, current.ulCount);
+        writeLong(out, offset);
+        writeLong(out, current.packed.size());
+        offset = (offset + current.storedSize() + 3) & ~3u;
+    }
+
+    for (auto const& current : chunks)
+    {
+        auto const& data = current.packed.empty() ? current.bytes : current.packed;
+        for (unsigned char byte : data) { out.push_back(byte); }
+        while (out.size() & 3) { out.push_back(0); }
+    }
+}
+
+/**
+ * @brief Decompresses a chunk like gameDataLoad() does: the stream is placed
+ * at the end of a buffer of the chunk size plus the margin and decompressed
+ * to its start.
+ */
+static bool unpackInPlace(unsigned char const* pPacked,
+                          uint32_t ulPackedSize,
+                          uint32_t ulSize,
+                          uint32_t ulMargin,
+                          mtl::vector<unsigned char>& buffer)
+{
+    if (ulPackedSize > ulSize + ulMargin) return false;
+
+    buffer.clear();
+    buffer.resize(ulSize + ulMargin, 0);
+    UBYTE* pStream = buffer.data() + buffer.size() - ulPackedSize;
+    memcpy(pStream, pPacked, ulPackedSize);
+    return lzDecompress(pStream, ulPackedSize, buffer.data(), ulSize);
+}
+
+/**
+ * @brief Reads the directory of a version 3 file back and checks every chunk
+ * against the original.
+ */
+static bool verifyV3(mtl::vector<unsigned char> const& out,
+                     mtl::vector<packed_chunk> const& chunks)
+{
+    if (readLong(out.data() + 8) != chunks.size()) return false;
+
+    uint32_t ulMargin = readLong(out.data() + 12);
+    mtl::vector<unsigned char> buffer;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        unsigned char const* pEntry  = out.data() + 16 + i * 16;
+        uint32_t ulOffset            = readLong(pEntry + 8);
+        uint32_t ulPackedSize        = readLong(pEntry + 12);
+        packed_chunk const& original = chunks[i];
+        uint32_t ulSize              = original.bytes.size();
+
+        unsigned char const* pData = out.data() + ulOffset;
+        uint32_t ulStoredSize      = ulPackedSize ? ulPackedSize : ulSize;
+        bool ok = memcmp(pEntry, original.pType->szName, 4) == 0
+                  && readLong(pEntry + 4) == original.ulCount
+                  && ulOffset + ulStoredSize <= out.size();
+        if (ok && ulPackedSize)
+        {
+            ok    = unpackInPlace(pData, ulPackedSize, ulSize, ulMargin, buffer);
+            pData = buffer.data();
+        }
+
+        if (!ok || memcmp(pData, original.bytes.data(), ulSize) != 0)
+        {
+            fprintf(stderr, "'%s' chunk does not match after packing\n", original.pType->szName);
+            return false;
+        }
+    }
+    return true;
+}
+
+static int usage(char const* szTool)
+{
+    fprintf(stderr,
+            "usage: %s [--check] [--keep-order] [--strings lang.noir] in.neon [out.neon]\n",
+            szTool);
+    return 2;
+}
+
+int main(int argc, char** argv)
+{
+    bool bCheckOnly       = false;
+    bool bOptimize        = true;
+    char const* szStrings = nullptr;
+    char const* szInput   = nullptr;
+    char const* szOutput  = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--check") == 0) bCheckOnly = true;
+        else if (strcmp(argv[i], "--keep-order") == 0) bOptimize = false;
+        else if (strcmp(argv[i], "--strings") == 0 && i + 1 < argc) szStrings = argv[++i];
+        else if (!szInput) szInput = argv[i];
+        else if (!szOutput) szOutput = argv[i];
+        else return usage(argv[0]);
+    }
+    if (!szInput || (!szOutput && !bCheckOnly)) return usage(argv[0]);
+
+    uint32_t ulStringCount = 0;
+    if (szStrings && !(ulStringCount = readStringCount(szStrings)))
+    {
+        fprintf(stderr, "'%s' is not a .noir file\n", szStrings);
+        return 1;
+    }
+
+    mtl::vector<unsigned char> input;
+    neon_file file;
+    if (!readFile(szInput, input) || !neonReadV2(input, file))
+    {
+        fprintf(stderr, "'%s' is not a version 2 .neon file\n", szInput);
+        return 1;
+    }
+
+    if (!neonCheck(file, ulStringCount)) return 1;
+    printf("%s: checked%s\n", szInput, ulStringCount ? ", text ids included" : "");
+    if (bCheckOnly) return 0;
+
+    if (bOptimize)
+    {
+        neonOptimize(file);
+
+        // Whatever the passes did must still hold up
+        if (!neonCheck(file, ulStringCount)) return 1;
+    }
+
+    mtl::vector<packed_chunk> chunks;
+    uint32_t ulMargin = packChunks(file, chunks);
+    mtl::vector<unsigned char> output;
+    writeV3(chunks, ulMargin, output);
+    if (!verifyV3(output, chunks)) return 1;
+
+    if (!writeFile(szOutput, output))
+    {
+        fprintf(stderr, "Could not write '%s'\n", szOutput);
+        return 1;
+    }
+
+    for (auto const& current : chunks)
+    {
+        printf("  %s %6u -> %6u bytes\n",
+               current.pType->szName,
+               (uint32_t)current.bytes.size(),
+               current.storedSize());
+    }
+    printf("%s: %zu chunks, %zu -> %zu bytes, in place margin %u\n",
+           szOutput,
+           chunks.size(),
+           input.size(),
+           output.size(),
+           ulMargin);
+    return 0;
+}
@@ -0,0 +1,810 @@
+/**
+ * @file noirpack.cpp
+ * @brief Converts a .noir string table as written by the editor into version
+ * 3, which carries an index of the strings so the engine can look them up as
+ * loaded, without scanning them or keeping a pointer to each.
+ *
+ *   noirpack [--compress] [--layout font.fnt game.neon] in.noir out.noir
+ *   noirpack [--compress] [--layout font.fnt game.neon] --languages
+ *            en=in.noir it=in.noir... out.noir
+ *
+ *   --compress    Compress the strings, if that takes less memory in the game
+ *   --layout      Lay out the text of every text region of game.neon in the
+ *                 font, and write the lines after the strings
+ *   --languages   Convert the table of each language and pack them together,
+ *                 each given as the code of the language, en, it or de, an
+ *                 equals sign and the path
+ *
+ * Version 3 layout, all values big-endian:
+ *
+ *   "NOIR", version 3 (16 bits), language (16 bits)
+ *   "STRG", string count, size of the strings, offset bytes (16 bits), encoding (16 bits)
+ *   index, padded to 4 bytes
+ *   strings, each a 32 bit length followed by its characters, as in version 2
+ *
+ * With 2 offset bytes the index is a base offset for every 64 strings, then
+ * the offset of each string from the base of its group. That only holds when
+ * the strings of every group span less than 64 KB; otherwise the index is
+ * the 24 bit offset of each string. Must match core/string_table.cpp.
+ *
+ * Compressed files have encoding 1, and a dictionary before the index:
+ *
+ *   literal count, pair count, length of the longest string, 0 (16 bits each)
+ *   the character of each literal code, then the two codes of each pair code
+ *
+ * Each string is then a run of codes, without a length, ending where the next
+ * one starts. The characters the strings use are numbered from 0, and the
+ * codes left over stand for the pair of codes that was most frequent when
+ * each was handed out, byte pair encoding. Prose takes about half the memory
+ * that way, dictionary and all, while a string still decodes on its own.
+ *
+ * With --layout the strings are followed by the lines of the text of each
+ * text region, broken and justified like text_renderer::create_text() does,
+ * see core/text_layout_table.h:
+ *
+ *   "LAYT", entry count, line count
+ *   entry count x { text id, region width, justification (8 bits), line
+ *                   count (8 bits), first line }, sorted in that order
+ *   line count x { first character, end, x }, 16 bits each
+ *
+ * The font is read as ACE writes it, the width and height of its bitmap
+ * (16 bits), the character count (8 bits), then where the glyph of each
+ * character starts in the bitmap (16 bits each), the glyph of a character
+ * ending where the next starts.
+ *
+ * A language pack holds the same strings in several languages, for the game
+ * to switch between them with one seek, see core/language.h:
+ *
+ *   "NLNG", 0x00010000, language count, string count
+ *   language count x { language, offset from the start of the pack, size }
+ *   the version 3 table of each language, each starting on 4 bytes
+ *
+ * The string count is shared, each table has the same ids, with an index of
+ * its own since the strings are of different lengths in every language.
+ *
+ * The output is read back, and every string looked up like the engine does
+ * and compared with the original before the tool reports success.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <mtl/vector.h>
+
+#include "../neon/neon_file.h"
+#include "core/text_layout.h"
+
+static uint32_t const NOIR_V3     = 3;
+static uint32_t const GROUP_SIZE  = 64;  // Must match STRING_GROUP_SIZE in string_table.h
+static uint32_t const CACHE_SLOTS = 8;   // Must match STRING_CACHE_SLOTS in string_table.h
+static uint32_t const PAIR_DEPTH  = 24;  // Must match STRING_PAIR_DEPTH in string_table.h
+
+static uint32_t const ENCODING_PLAIN = 0;
+static uint32_t const ENCODING_PAIRS = 1;
+
+static uint32_t const MAX_LAYOUT_LINES = 0xFF;  // Fit the line count of an entry
+
+static uint32_t const LANGUAGE_PACK_VERSION = 0x00010000;
+
+// In the order of string_table::supported_languages, the number the pack stores
+static char const* const s_szLanguageCodes[] = { "en", "it", "de" };
+static uint32_t const LANGUAGE_COUNT = sizeof(s_szLanguageCodes) / sizeof(s_szLanguageCodes[0]);
+
+struct noir_file
+{
+    uint32_t ulLanguage;
+    mtl::vector<unsigned char> strings;  ///< As stored, length then characters
+    mtl::vector<uint32_t> offsets;       ///< Of each string in strings
+};
+
+struct pair_dictionary
+{
+    mtl::vector<unsigned char> literals;  ///< Character of each literal code
+    mtl::vector<unsigned char> pairs;     ///< Two codes for each code after the literals
+    mtl::vector<unsigned char> codes;     ///< Of all the strings, one after the other
+    mtl::vector<uint32_t> offsets;        ///< Of each string in codes
+    uint32_t ulMaxLength;
+};
+
+/**
+ * @brief The text regions to lay out, and the font to do it in.
+ */
+struct layout_source
+{
+    uint16_t glyphWidths[256];                    ///< As fontGlyphWidth() returns them
+    mtl::vector<NEONengine::TextRegion> regions;  ///< One of each id, width and justification
+};
+
+static void writeWord(mtl::vector<unsigned char>& out, uint32_t value)
+{
+    out.push_back((value >> 8) & 0xFF);
+    out.push_back(value & 0xFF);
+}
+
+static bool readNoir(mtl::vector<unsigned char> const& data, noir_file& file)
+{
+    if (data.size() < 20 || memcmp(data.data(), "NOIR", 4) != 0
+        || memcmp(data.data() + 8, "STRG", 4) != 0)
+    {
+        return false;
+    }
+
+    uint32_t ulVersion = (data[4] << 8) | data[5];
+    uint32_t ulCount   = readLong(data.data() + 12);
+    uint32_t ulSize    = readLong(data.data() + 16);
+    if (ulVersion >= NOIR_V3 || data.size() < 20 + ulSize) return false;
+
+    file.ulLanguage = (data[6] << 8) | data[7];
+    for (uint32_t i = 0; i < ulSize; ++i) { file.strings.push_back(data[20 + i]); }
+
+    uint32_t ulOffset = 0;
+    for (uint32_t i = 0; i < ulCount; ++i)
+    {
+        if (ulOffset + 4 > ulSize) return false;
+
+        file.offsets.push_back(ulOffset);
+        ulOffset += 4 + readLong(file.strings.data() + ulOffset);
+    }
+    return ulOffset <= ulSize;
+}
+
+/**
+ * @brief Whether the strings of every group fit 16 bit offsets from the
+ * first one.
+ */
+static bool fitsWords(mtl::vector<uint32_t> const& offsets)
+{
+    for (size_t i = 0; i < offsets.size(); ++i)
+    {
+        if (offsets[i] - offsets[i - i % GROUP_SIZE] > 0xFFFF) return false;
+    }
+    return true;
+}
+
+static uint32_t indexSize(uint32_t ulCount, uint32_t ulOffsetBytes)
+{
+    uint32_t ulBases = ulOffsetBytes == 2 ? (ulCount + GROUP_SIZE - 1) / GROUP_SIZE * 4 : 0;
+    return (ulBases + ulCount * ulOffsetBytes + 3) & ~3u;
+}
+
+static void writeHeader(noir_file const& file,
+                        uint32_t ulDataSize,
+                        uint32_t ulOffsetBytes,
+                        uint32_t ulEncoding,
+                        mtl::vector<unsigned char>& out)
+{
+    out.clear();
+    out.push_back('N');
+    out.push_back('O');
+    out.push_back('I');
+    out.push_back('R');
+    writeWord(out, NOIR_V3);
+    writeWord(out, file.ulLanguage);
+    out.push_back('S');
+    out.push_back('T');
+    out.push_back('R');
+    out.push_back('G');
+    writeLong(out, file.offsets.size());
+    writeLong(out, ulDataSize);
+    writeWord(out, ulOffsetBytes);
+    writeWord(out, ulEncoding);
+}
+
+static void writeIndex(mtl::vector<uint32_t> const& offsets,
+                       uint32_t ulOffsetBytes,
+                       mtl::vector<unsigned char>& out)
+{
+    uint32_t ulCount = offsets.size();
+    if (ulOffsetBytes == 2)
+    {
+        for (uint32_t i = 0; i < ulCount; i += GROUP_SIZE) { writeLong(out, offsets[i]); }
+        for (uint32_t i = 0; i < ulCount; ++i)
+        {
+            writeWord(out, offsets[i] - offsets[i - i % GROUP_SIZE]);
+        }
+    }
+    else
+    {
+        for (uint32_t offset : offsets)
+        {
+            out.push_back((offset >> 16) & 0xFF);
+            writeWord(out, offset);
+        }
+    }
+    while (out.size() & 3) { out.push_back(0); }
+}
+
+static uint32_t writeV3(noir_file const& file, mtl::vector<unsigned char>& out)
+{
+    uint32_t ulOffsetBytes = fitsWords(file.offsets) ? 2 : 3;
+
+    writeHeader(file, file.strings.size(), ulOffsetBytes, ENCODING_PLAIN, out);
+    writeIndex(file.offsets, ulOffsetBytes, out);
+    for (unsigned char byte : file.strings) { out.push_back(byte); }
+    return ulOffsetBytes;
+}
+
+/**
+ * @brief Hands out the codes the characters leave over to the most frequent
+ * pairs, as long as a pair saves more than the two bytes it takes in the
+ * dictionary, and does not nest deeper than the engine decodes.
+ */
+static void compressPairs(noir_file const& file, pair_dictionary& dictionary)
+{
+    uint32_t ulCount = file.offsets.size();
+    bool used[256]   = {};
+    for (uint32_t i = 0; i < ulCount; ++i)
+    {
+        uint32_t ulLength           = readLong(file.strings.data() + file.offsets[i]);
+        unsigned char const* pChars = file.strings.data() + file.offsets[i] + 4;
+        for (uint32_t c = 0; c < ulLength; ++c) { used[pChars[c]] = true; }
+    }
+
+    unsigned char literalCodes[256];
+    for (uint32_t c = 0; c < 256; ++c)
+    {
+        if (!used[c]) continue;
+
+        literalCodes[c] = dictionary.literals.size();
+        dictionary.literals.push_back(c);
+    }
+
+    dictionary.ulMaxLength = 0;
+    for (uint32_t i = 0; i < ulCount; ++i)
+    {
+        uint32_t ulLength           = readLong(file.strings.data() + file.offsets[i]);
+        unsigned char const* pChars = file.strings.data() + file.offsets[i] + 4;
+        dictionary.offsets.push_back(dictionary.codes.size());
+        for (uint32_t c = 0; c < ulLength; ++c)
+        {
+            dictionary.codes.push_back(literalCodes[pChars[c]]);
+        }
+        if (ulLength > dictionary.ulMaxLength) dictionary.ulMaxLength = ulLength;
+    }
+
+    uint32_t depths[256] = {};
+    mtl::vector<uint32_t> counts;
+    for (uint32_t code = dictionary.literals.size(); code < 256; ++code)
+    {
+        counts.clear();
+        counts.resize(0x10000, 0);
+        for (uint32_t i = 0; i < ulCount; ++i)
+        {
+            uint32_t ulEnd = i + 1 < ulCount ? dictionary.offsets[i + 1] : dictionary.codes.size();
+            for (uint32_t c = dictionary.offsets[i]; c + 1 < ulEnd; ++c)
+            {
+                uint32_t first = dictionary.codes[c], second = dictionary.codes[c + 1];
+                if (depths[first] >= PAIR_DEPTH || depths[second] >= PAIR_DEPTH) continue;
+
+                counts[first << 8 | second]++;
+                if (first == second && c + 2 < ulEnd && dictionary.codes[c + 2] == first) ++c;
+            }
+        }
+
+        uint32_t ulBest = 0;
+        for (uint32_t pair = 1; pair < 0x10000; ++pair)
+        {
+            if (counts[pair] > counts[ulBest]) ulBest = pair;
+        }
+        if (counts[ulBest] <= 2) break;
+
+        uint32_t first = ulBest >> 8, second = ulBest & 0xFF;
+        dictionary.pairs.push_back(first);
+        dictionary.pairs.push_back(second);
+        depths[code] = 1 + (depths[first] > depths[second] ? depths[first] : depths[second]);
+
+        // Replaces the pair from left to right, in place since the codes only get fewer
+        uint32_t ulOut = 0, ulStart = 0;
+        for (uint32_t i = 0; i < ulCount; ++i)
+        {
+            uint32_t ulEnd = i + 1 < ulCount ? dictionary.offsets[i + 1] : dictionary.codes.size();
+            dictionary.offsets[i] = ulOut;
+            for (uint32_t c = ulStart; c < ulEnd; ++c)
+            {
+                if (c + 1 < ulEnd && dictionary.codes[c] == first
+                    && dictionary.codes[c + 1] == second)
+                {
+                    dictionary.codes[ulOut++] = code;
+                    ++c;
+                }
+                else dictionary.codes[ulOut++] = dictionary.codes[c];
+            }
+            ulStart = ulEnd;
+        }
+        dictionary.codes.resize(ulOut);
+    }
+}
+
+static uint32_t writeCompressed(noir_file const& file,
+                                pair_dictionary const& dictionary,
+                                mtl::vector<unsigned char>& out)
+{
+    uint32_t ulOffsetBytes = fitsWords(dictionary.offsets) ? 2 : 3;
+
+    writeHeader(file, dictionary.codes.size(), ulOffsetBytes, ENCODING_PAIRS, out);
+    writeWord(out, dictionary.literals.size());
+    writeWord(out, dictionary.pairs.size() / 2);
+    writeWord(out, dictionary.ulMaxLength);
+    writeWord(out, 0);
+    for (unsigned char literal : dictionary.literals) { out.push_back(literal); }
+    for (unsigned char code : dictionary.pairs) { out.push_back(code); }
+    while (out.size() & 3) { out.push_back(0); }
+
+    writeIndex(dictionary.offsets, ulOffsetBytes, out);
+    for (unsigned char code : dictionary.codes) { out.push_back(code); }
+    return ulOffsetBytes;
+}
+
+/**
+ * @brief Offset of a string, looked up like string_table::offset_of() does.
+ */
+static uint32_t readOffset(unsigned char const* pIndex,
+                           uint32_t ulCount,
+                           uint32_t ulOffsetBytes,
+                           uint32_t i)
+{
+    if (ulOffsetBytes == 2)
+    {
+        uint32_t ulBases             = (ulCount + GROUP_SIZE - 1) / GROUP_SIZE * 4;
+        unsigned char const* pOffset = pIndex + ulBases + i * 2;
+        return readLong(pIndex + i / GROUP_SIZE * 4) + ((pOffset[0] << 8) | pOffset[1]);
+    }
+
+    unsigned char const* pOffset = pIndex + i * 3;
+    return (pOffset[0] << 16) | (pOffset[1] << 8) | pOffset[2];
+}
+
+/**
+ * @brief Looks every string up like string_table::get_string() does.
+ */
+static bool verifyV3(mtl::vector<unsigned char> const& out, noir_file const& file)
+{
+    uint32_t ulCount              = readLong(out.data() + 12);
+    uint32_t ulSize               = readLong(out.data() + 16);
+    uint32_t ulOffsetBytes        = (out[20] << 8) | out[21];
+    unsigned char const* pIndex   = out.data() + 24;
+    unsigned char const* pStrings = pIndex + indexSize(ulCount, ulOffsetBytes);
+    if (ulCount != file.offsets.size() || pStrings + ulSize != out.data() + out.size())
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < ulCount; ++i)
+    {
+        uint32_t ulOffset = readOffset(pIndex, ulCount, ulOffsetBytes, i);
+        uint32_t ulLength = readLong(file.strings.data() + file.offsets[i]) + 4;
+        if (ulOffset + ulLength > ulSize
+            || memcmp(pStrings + ulOffset, file.strings.data() + file.offsets[i], ulLength) != 0)
+        {
+            fprintf(stderr, "String %u does not match after packing\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Decodes every string like string_table::decode() does.
+ */
+static bool verifyCompressed(mtl::vector<unsigned char> const& out, noir_file const& file)
+{
+    uint32_t ulCount       = readLong(out.data() + 12);
+    uint32_t ulSize        = readLong(out.data() + 16);
+    uint32_t ulOffsetBytes = (out[20] << 8) | out[21];
+    uint32_t ulLiterals    = (out[24] << 8) | out[25];
+    uint32_t ulPairs       = (out[26] << 8) | out[27];
+    uint32_t ulMaxLength   = (out[28] << 8) | out[29];
+    unsigned char const* pLiterals = out.data() + 32;
+    unsigned char const* pPairs    = pLiterals + ulLiterals;
+    unsigned char const* pIndex    = out.data() + 32 + ((ulLiterals + ulPairs * 2 + 3) & ~3u);
+    unsigned char const* pStrings  = pIndex + indexSize(ulCount, ulOffsetBytes);
+    if (ulCount != file.offsets.size() || pStrings + ulSize != out.data() + out.size())
+    {
+        return false;
+    }
+
+    mtl::vector<unsigned char> text;
+    for (uint32_t i = 0; i < ulCount; ++i)
+    {
+        uint32_t ulStart = readOffset(pIndex, ulCount, ulOffsetBytes, i);
+        uint32_t ulEnd
+            = i + 1 < ulCount ? readOffset(pIndex, ulCount, ulOffsetBytes, i + 1) : ulSize;
+
+        text.clear();
+        unsigned char stack[PAIR_DEPTH + 1];
+        for (uint32_t c = ulStart; c < ulEnd && ulEnd <= ulSize; ++c)
+        {
+            uint32_t top = 0;
+            stack[top++] = pStrings[c];
+            while (top)
+            {
+                uint32_t code = stack[--top];
+                if (code < ulLiterals) text.push_back(pLiterals[code]);
+                else if (code - ulLiterals < ulPairs && top + 2 <= PAIR_DEPTH + 1)
+                {
+                    stack[top++] = pPairs[(code - ulLiterals) * 2 + 1];
+                    stack[top++] = pPairs[(code - ulLiterals) * 2];
+                }
+                else return false;
+            }
+        }
+
+        uint32_t ulLength = readLong(file.strings.data() + file.offsets[i]);
+        if (text.size() != ulLength || ulLength > ulMaxLength
+            || memcmp(text.data(), file.strings.data() + file.offsets[i] + 4, ulLength) != 0)
+        {
+            fprintf(stderr, "String %u does not match after compressing\n", i);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Whether a region comes before another in a layout table, by text id,
+ * width, then justification.
+ */
+static bool regionPrecedes(NEONengine::TextRegion const& lhs, NEONengine::TextRegion const& rhs)
+{
+    if (lhs.uwTextId != rhs.uwTextId) return lhs.uwTextId < rhs.uwTextId;
+    if (lhs.uwWidth != rhs.uwWidth) return lhs.uwWidth < rhs.uwWidth;
+    return lhs.ubJustify < rhs.ubJustify;
+}
+
+/**
+ * @brief Reads the width of each glyph of a font, and the text regions of a
+ * game, skipping those whose justification the renderer does not know.
+ */
+static bool readLayoutSource(char const* szFont, char const* szNeon, layout_source& source)
+{
+    mtl::vector<unsigned char> font;
+    if (!readFile(szFont, font) || font.size() < 5 || font.size() < 5u + font[4] * 2)
+    {
+        fprintf(stderr, "'%s' is not a font\n", szFont);
+        return false;
+    }
+
+    uint32_t ulChars = font[4];
+    for (uint32_t c = 0; c < 256; ++c)
+    {
+        source.glyphWidths[c] = 0;
+        if (c + 1 >= ulChars) continue;
+
+        unsigned char const* pOffset = font.data() + 5 + c * 2;
+        source.glyphWidths[c]        = ((pOffset[2] << 8) | pOffset[3])
+                                - ((pOffset[0] << 8) | pOffset[1]);
+    }
+
+    mtl::vector<unsigned char> input;
+    neon_file game = {};
+    if (!readFile(szNeon, input) || !neonReadV2(input, game))
+    {
+        fprintf(stderr, "'%s' is not a version 2 .neon file\n", szNeon);
+        return false;
+    }
+
+    neon_chunk const& chunk = game[chunk_id::TEXT_REGIONS];
+    auto const* pRegions    = chunk.entries<NEONengine::TextRegion>();
+    for (uint32_t i = 0; i < chunk.ulCount; ++i)
+    {
+        NEONengine::TextRegion const& region = pRegions[i];
+        if (region.ubJustify > (uint32_t)NEONengine::text_justify::CENTER)
+        {
+            fprintf(stderr, "%s: text region %u has an unknown justification\n", szNeon, i);
+            continue;
+        }
+
+        // Sorted as the engine looks them up, and each only once
+        uint32_t j = 0;
+        while (j < source.regions.size() && regionPrecedes(source.regions[j], region)) { ++j; }
+        if (j < source.regions.size() && !regionPrecedes(region, source.regions[j])) continue;
+
+        source.regions.insert(source.regions.begin() + j, region);
+    }
+    return true;
+}
+
+/**
+ * @brief Appends the lines of the text of every region, for the regions
+ * whose text the table has.
+ */
+static bool writeLayouts(layout_source const& source,
+                         noir_file const& file,
+                         char const* szInput,
+                         mtl::vector<unsigned char>& out)
+{
+    mtl::vector<unsigned char> entries;
+    mtl::vector<unsigned char> lines;
+    uint32_t ulEntryCount = 0;
+    uint32_t ulLineCount  = 0;
+    for (auto const& region : source.regions)
+    {
+        if (region.uwTextId >= file.offsets.size()) continue;
+
+        auto text = NEONengine::bstr_view::from_bstr(file.strings.data()
+                                                     + file.offsets[region.uwTextId]);
+        if (text.length() > 0xFFFF)
+        {
+            fprintf(stderr, "%s: string %u is too long to lay out\n", szInput, region.uwTextId);
+            return false;
+        }
+
+        auto justification = (NEONengine::text_justify)region.ubJustify;
+        uint32_t ulFirstLine = ulLineCount;
+        uint32_t ulStart     = 0;
+        NEONengine::text_line line{};
+        while (NEONengine::text_break_line(
+            text, &ulStart, region.uwWidth, source.glyphWidths, &line))
+        {
+            if (ulLineCount - ulFirstLine == MAX_LAYOUT_LINES)
+            {
+                fprintf(stderr,
+                        "%s: string %u does not fit %u pixels\n",
+                        szInput,
+                        region.uwTextId,
+                        region.uwWidth);
+                return false;
+            }
+
+            uint16_t width = NEONengine::text_line_width(text, line, source.glyphWidths);
+            writeWord(lines, line.start);
+            writeWord(lines, line.end);
+            writeWord(lines, NEONengine::text_justify_line(width, region.uwWidth, justification));
+            ++ulLineCount;
+        }
+
+        if (ulFirstLine > 0xFFFF)
+        {
+            fprintf(stderr, "%s: too many lines to lay out\n", szInput);
+            return false;
+        }
+
+        writeWord(entries, region.uwTextId);
+        writeWord(entries, region.uwWidth);
+        entries.push_back(region.ubJustify);
+        entries.push_back(ulLineCount - ulFirstLine);
+        writeWord(entries, ulFirstLine);
+        ++ulEntryCount;
+    }
+
+    out.push_back('L');
+    out.push_back('A');
+    out.push_back('Y');
+    out.push_back('T');
+    writeLong(out, ulEntryCount);
+    writeLong(out, ulLineCount);
+    for (unsigned char byte : entries) { out.push_back(byte); }
+    for (unsigned char byte : lines) { out.push_back(byte); }
+
+    printf("%s: %u texts laid out in %u lines, %zu bytes\n",
+           szInput,
+           ulEntryCount,
+           ulLineCount,
+           entries.size() + lines.size());
+    return true;
+}
+
+/**
+ * @brief Converts a table to version 3, compressed if asked and if that
+ * saves memory, and checks every string of the result. The layouts follow if
+ * there is a source to make them from.
+ */
+static bool convertNoir(char const* szInput,
+                        bool bCompress,
+                        layout_source const* pLayout,
+                        noir_file& file,
+                        mtl::vector<unsigned char>& output)
+{
+    mtl::vector<unsigned char> input;
+    if (!readFile(szInput, input) || !readNoir(input, file))
+    {
+        fprintf(stderr, "'%s' is not a version 1 or 2 .noir file\n", szInput);
+        return false;
+    }
+
+    uint32_t ulOffsetBytes = writeV3(file, output);
+    if (!verifyV3(output, file)) return false;
+
+    // What the game keeps in memory: all but the headers, and a compressed table's cache
+    uint32_t ulPlainSize = output.size() - 24;
+    if (bCompress)
+    {
+        pair_dictionary dictionary = {};
+        compressPairs(file, dictionary);
+
+        mtl::vector<unsigned char> compressed;
+        uint32_t ulCompressedOffsetBytes = writeCompressed(file, dictionary, compressed);
+        if (!verifyCompressed(compressed, file)) return false;
+
+        uint32_t ulCompressedSize = compressed.size() - 32 + CACHE_SLOTS * dictionary.ulMaxLength;
+        printf("%s: %u -> %u bytes in memory compressed, with %zu pairs of %zu characters\n",
+               szInput,
+               ulPlainSize,
+               ulCompressedSize,
+               dictionary.pairs.size() / 2,
+               dictionary.literals.size());
+        if (ulCompressedSize < ulPlainSize && !dictionary.pairs.empty())
+        {
+            output        = mtl::move(compressed);
+            ulOffsetBytes = ulCompressedOffsetBytes;
+        }
+        else printf("%s: left uncompressed, it would not save memory\n", szInput);
+    }
+
+    printf("%s: %zu strings, %u byte index of %u bit offsets, was %zu bytes of pointers\n",
+           szInput,
+           file.offsets.size(),
+           indexSize(file.offsets.size(), ulOffsetBytes),
+           ulOffsetBytes * 8,
+           file.offsets.size() * 4);
+    return !pLayout || writeLayouts(*pLayout, file, szInput, output);
+}
+
+/**
+ * @brief The language of a "code=path" argument, LANGUAGE_COUNT if unknown.
+ */
+static uint32_t parseLanguage(char const* szArg, char const** pszPath)
+{
+    for (uint32_t i = 0; i < LANGUAGE_COUNT; ++i)
+    {
+        size_t codeLength = strlen(s_szLanguageCodes[i]);
+        if (strncmp(szArg, s_szLanguageCodes[i], codeLength) == 0 && szArg[codeLength] == '=')
+        {
+            *pszPath = szArg + codeLength + 1;
+            return i;
+        }
+    }
+    return LANGUAGE_COUNT;
+}
+
+/**
+ * @brief Packs the tables of several languages, which must have the same
+ * number of strings.
+ */
+static bool writeLanguagePack(char const* const* pszInputs,
+                              uint32_t ulInputCount,
+                              bool bCompress,
+                              layout_source const* pLayout,
+                              mtl::vector<unsigned char>& out)
+{
+    mtl::vector<uint32_t> languages;
+    mtl::vector<noir_file> files;
+    mtl::vector<mtl::vector<unsigned char>> tables;
+    for (uint32_t i = 0; i < ulInputCount; ++i)
+    {
+        char const* szPath = nullptr;
+        uint32_t language  = parseLanguage(pszInputs[i], &szPath);
+        if (language == LANGUAGE_COUNT)
+        {
+            fprintf(stderr, "'%s' is not en=, it= or de= followed by a path\n", pszInputs[i]);
+            return false;
+        }
+
+        noir_file file = {};
+        mtl::vector<unsigned char> table;
+        if (!convertNoir(szPath, bCompress, pLayout, file, table)) return false;
+
+        for (uint32_t j = 0; j < files.size(); ++j)
+        {
+            if (languages[j] == language)
+            {
+                fprintf(stderr, "%s is given twice\n", s_szLanguageCodes[language]);
+                return false;
+            }
+            if (files[j].offsets.size() != file.offsets.size())
+            {
+                fprintf(stderr,
+                        "'%s' has %zu strings, '%s' %zu\n",
+                        pszInputs[j],
+                        files[j].offsets.size(),
+                        pszInputs[i],
+                        file.offsets.size());
+                return false;
+            }
+        }
+
+        languages.push_back(language);
+        files.push_back(mtl::move(file));
+        tables.push_back(mtl::move(table));
+    }
+
+    out.clear();
+    out.push_back('N');
+    out.push_back('L');
+    out.push_back('N');
+    out.push_back('G');
+    writeLong(out, LANGUAGE_PACK_VERSION);
+    writeLong(out, ulInputCount);
+    writeLong(out, files[0].offsets.size());
+
+    uint32_t ulOffset = 16 + ulInputCount * 12;
+    for (uint32_t i = 0; i < ulInputCount; ++i)
+    {
+        writeLong(out, languages[i]);
+        writeLong(out, ulOffset);
+        writeLong(out, tables[i].size());
+        ulOffset = (ulOffset + tables[i].size() + 3) & ~3u;
+    }
+
+    for (auto const& table : tables)
+    {
+        for (unsigned char byte : table) { out.push_back(byte); }
+        while (out.size() & 3) { out.push_back(0); }
+    }
+
+    // Each table was verified on its own, that leaves where the directory says they are
+    for (uint32_t i = 0; i < ulInputCount; ++i)
+    {
+        unsigned char const* pEntry = out.data() + 16 + i * 12;
+        uint32_t ulTableOffset      = readLong(pEntry + 4);
+        if (readLong(pEntry + 8) != tables[i].size()
+            || ulTableOffset + tables[i].size() > out.size()
+            || memcmp(out.data() + ulTableOffset, tables[i].data(), tables[i].size()) != 0)
+        {
+            fprintf(stderr, "'%s' does not match after packing\n", pszInputs[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    bool bCompress  = false;
+    bool bLanguages = false;
+    char const* szFont = nullptr;
+    char const* szNeon = nullptr;
+    int arg            = 1;
+    for (; arg < argc && strncmp(argv[arg], "--", 2) == 0; ++arg)
+    {
+        if (strcmp(argv[arg], "--compress") == 0) bCompress = true;
+        else if (strcmp(argv[arg], "--languages") == 0) bLanguages = true;
+        else if (strcmp(argv[arg], "--layout") == 0 && arg + 2 < argc)
+        {
+            szFont = argv[++arg];
+            szNeon = argv[++arg];
+        }
+        else break;
+    }
+
+    int inputCount = argc - arg - 1;
+    if (inputCount < 1 || (!bLanguages && inputCount != 1)
+        || (bLanguages && inputCount > (int)LANGUAGE_COUNT))
+    {
+        fprintf(stderr,
+                "usage: %s [--compress] [--layout font.fnt game.neon] in.noir out.noir\n"
+                "       %s [--compress] [--layout font.fnt game.neon]"
+                " --languages en=in.noir it=in.noir... out.noir\n",
+                argv[0],
+                argv[0]);
+        return 2;
+    }
+    char const* szOutput = argv[argc - 1];
+
+    layout_source layout         = {};
+    layout_source const* pLayout = nullptr;
+    if (szFont)
+    {
+        if (!readLayoutSource(szFont, szNeon, layout)) return 1;
+        pLayout = &layout;
+    }
+
+    mtl::vector<unsigned char> output;
+    if (bLanguages)
+    {
+        if (!writeLanguagePack(argv + arg, inputCount, bCompress, pLayout, output)) return 1;
+    }
+    else
+    {
+        noir_file file = {};
+        if (!convertNoir(argv[arg], bCompress, pLayout, file, output)) return 1;
+    }
+
+    if (!writeFile(szOutput, output))
+    {
+        fprintf(stderr, "Could not write '%s'\n", szOutput);
+        return 1;
+    }
+
+    printf("%s: %zu bytes\n", szOutput, output.size());
+    return 0;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file datapack.cpp
+ * @brief Packs the converted data files into one archive, which the engine
+ * keeps open and reads every file from, see core/vfs.h. On a floppy that
+ * saves a directory lookup and a few seeks per file.
+ *
+ *   datapack out.pak file...
+ *
+ * Each file is stored under the path it is given as, so run the tool from
+ * the directory the game runs in, with the paths the game opens:
+ *
+ *   datapack data.pak data/font.fnt data/mpg.bm ...
+ *
+ * Layout, all values big-endian:
+ *
+ *   "NPAK", 0x00020000, file count
+ *   file count x { hash of the path, second hash of the path, offset from
+ *                  the start of the pack, size }
+ *   files, in the order they were given, each starting on a 512 byte sector
+ *
+ * The table is sorted by hash so the engine can binary search it, and the
+ * tool fails if two paths have the same hash. The second hash starts from
+ * another seed, the engine checks it too so a path that is not in the pack
+ * never opens a packed file with the same hash. The pack is padded to a whole
+ * sector, so the engine never reads a short sector.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <mtl/hash.h>
+#include <mtl/vector.h>
+
+#include "../neon/neon_file.h"
+
+static uint32_t const PACK_VERSION = 0x00020000;
+static uint32_t const CHECK_SEED   = 0x4E454F4E;  // Must match VFS_CHECK_SEED in vfs.cpp
+static uint32_t const ENTRY_SIZE   = 16;
+static uint32_t const SECTOR_SIZE  = 512;  // Must match VFS_SECTOR_SIZE in vfs.h
+
+struct pack_entry
+{
+    char const* szPath;
+    uint32_t ulHash;
+    uint32_t ulCheck;
+    uint32_t ulOffset;
+    mtl::vector<unsigned char> data;
+};
+
+static uint32_t roundToSector(uint32_t ulSize)
+{
+    return (ulSize + SECTOR_SIZE - 1) & ~(SECTOR_SIZE - 1);
+}
+
+static void writePack(mtl::vector<pack_entry>& entries, mtl::vector<unsigned char>& out)
+{
+    uint32_t ulOffset = roundToSector(12 + entries.size() * ENTRY_SIZE);
+    for (auto& entry : entries)
+    {
+        entry.ulOffset = ulOffset;
+        ulOffset       = roundToSector(ulOffset + entry.data.size());
+    }
+
+    // The table is sorted, the files stay in the order they were given
+    mtl::vector<pack_entry const*> sorted;
+    for (auto const& entry : entries) sorted.push_back(&entry);
+    for (size_t i = 1; i < sorted.size(); ++i)
+    {
+        for (size_t j = i; j > 0 && sorted[j - 1]->ulHash > sorted[j]->ulHash; --j)
+        {
+            pack_entry const* pSwap = sorted[j - 1];
+            sorted[j - 1]           = sorted[j];
+            sorted[j]               = pSwap;
+        }
+    }
+
+    out.clear();
+    out.push_back('N');
+    out.push_back('P');
+    out.push_back('A');
+    out.push_back('K');
+    writeLong(out, PACK_VERSION);
+    writeLong(out, entries.size());
+    for (auto const* pEntry : sorted)
+    {
+        writeLong(out, pEntry->ulHash);
+        writeLong(out, pEntry->ulCheck);
+        writeLong(out, pEntry->ulOffset);
+        writeLong(out, pEntry->data.size());
+    }
+
+    for (auto const& entry : entries)
+    {
+        while (out.size() < entry.ulOffset) { out.push_back(0); }
+        for (unsigned char byte : entry.data) { out.push_back(byte); }
+    }
+    while (out.size() % SECTOR_SIZE) { out.push_back(0); }
+}
+
+/**
+ * @brief Looks every file up in the table like the engine does, and checks
+ * it reads back the same.
+ */
+static bool verifyPack(mtl::vector<unsigned char> const& out,
+                       mtl::vector<pack_entry> const& entries)
+{
+    uint32_t ulCount = readLong(out.data() + 8);
+    for (auto const& entry : entries)
+    {
+        uint32_t ulLow = 0, ulHigh = ulCount;
+        while (ulLow < ulHigh)
+        {
+            uint32_t ulMid = (ulLow + ulHigh) / 2;
+            if (readLong(out.data() + 12 + ulMid * ENTRY_SIZE) < entry.ulHash) ulLow = ulMid + 1;
+            else ulHigh = ulMid;
+        }
+
+        unsigned char const* pEntry = out.data() + 12 + ulLow * ENTRY_SIZE;
+        uint32_t ulOffset           = readLong(pEntry + 8);
+        uint32_t ulSize             = readLong(pEntry + 12);
+        bool ok = ulLow < ulCount && readLong(pEntry) == entry.ulHash
+                  && readLong(pEntry + 4) == entry.ulCheck && ulSize == entry.data.size()
+                  && ulOffset % SECTOR_SIZE == 0 && ulOffset + ulSize <= out.size()
+                  && memcmp(out.data() + ulOffset, entry.data.data(), ulSize) == 0;
+        if (!ok)
+        {
+            fprintf(stderr, "'%s' does not match after packing\n", entry.szPath);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s out.pak file...\n", argv[0]);
+        return 2;
+    }
+
+    mtl::vector<pack_entry> entries;
+    size_t ulLooseSize = 0;
+    for (int i = 2; i < argc; ++i)
+    {
+        pack_entry entry = {};
+        entry.szPath     = argv[i];
+        entry.ulHash     = mtl::hash_bytes(argv[i], strlen(argv[i]));
+        entry.ulCheck    = mtl::hash_bytes(argv[i], strlen(argv[i]), CHECK_SEED);
+        if (!readFile(argv[i], entry.data))
+        {
+            fprintf(stderr, "Could not read '%s'\n", argv[i]);
+            return 1;
+        }
+
+        for (auto const& other : entries)
+        {
+            if (other.ulHash == entry.ulHash)
+            {
+                fprintf(stderr,
+                        "'%s' and '%s' %s\n",
+                        other.szPath,
+                        entry.szPath,
+                        strcmp(other.szPath, entry.szPath) ? "have the same hash" : "are the same");
+                return 1;
+            }
+        }
+
+        ulLooseSize += entry.data.size();
+        entries.push_back(mtl::move(entry));
+    }
+
+    mtl::vector<unsigned char> output;
+    writePack(entries, output);
+    if (!verifyPack(output, entries)) return 1;
+
+    if (!writeFile(argv[1], output))
+    {
+        fprintf(stderr, "Could not write '%s'\n", argv[1]);
+        return 1;
+    }
+
+    for (auto const& entry : entries)
+    {
+        printf("  %08x %6u %s\n", entry.ulOffset, (uint32_t)entry.data.size(), entry.szPath);
+    }
+    printf("%s: %zu files, %zu -> %zu bytes\n", argv[1], entries.size(), ulLooseSize, output.size());
+    return 0;
+}
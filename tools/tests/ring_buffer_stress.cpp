@@ -0,0 +1,94 @@
+/**
+ * @file ring_buffer_stress.cpp
+ * @brief Pushes millions of items through mtl::ring_buffer from one thread
+ * and pops them on another.
+ *
+ * Each item carries its sequence number plus values derived from it, so a
+ * lost, duplicated, reordered or half-copied item is detected. A small
+ * capacity keeps the buffer full or empty most of the time, which is where
+ * the index handover matters.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#include <mtl/ring_buffer.h>
+
+constexpr uint32_t ITEM_COUNT = 10000000;
+
+struct item
+{
+    uint32_t sequence;
+    uint32_t inverted;
+    uint32_t squared;
+    uint32_t tag;
+};
+
+static item makeItem(uint32_t sequence)
+{
+    return item{ sequence, ~sequence, sequence * sequence, sequence ^ 0xA5A5A5A5u };
+}
+
+static mtl::ring_buffer<item, 64> s_buffer;
+
+static void* producer(void*)
+{
+    for (uint32_t i = 0; i < ITEM_COUNT; ++i)
+    {
+        item value = makeItem(i);
+        while (!s_buffer.push(value)) { sched_yield(); }
+    }
+    return nullptr;
+}
+
+int main()
+{
+    pthread_t thread;
+    if (pthread_create(&thread, nullptr, producer, nullptr) != 0)
+    {
+        printf("Could not start the producer thread\n");
+        return 1;
+    }
+
+    uint32_t failures = 0;
+    size_t maxFill    = 0;
+    for (uint32_t expected = 0; expected < ITEM_COUNT; ++expected)
+    {
+        item value;
+        // Yield so this also finishes on a single core
+        while (!s_buffer.pop(value)) { sched_yield(); }
+
+        item reference = makeItem(expected);
+        if (value.sequence != reference.sequence || value.inverted != reference.inverted
+            || value.squared != reference.squared || value.tag != reference.tag)
+        {
+            if (failures++ < 10)
+            {
+                printf("Item %u: got sequence %u (%08x %08x %08x)\n",
+                       expected,
+                       value.sequence,
+                       value.inverted,
+                       value.squared,
+                       value.tag);
+            }
+        }
+
+        size_t fill = s_buffer.size();
+        if (fill > maxFill) maxFill = fill;
+    }
+
+    pthread_join(thread, nullptr);
+
+    if (!s_buffer.empty())
+    {
+        printf("Buffer holds %zu items after the last pop\n", s_buffer.size());
+        ++failures;
+    }
+
+    printf("%u items, %u failures, max fill %zu of %zu\n",
+           ITEM_COUNT,
+           failures,
+           maxFill,
+           s_buffer.capacity());
+    return failures ? 1 : 0;
+}
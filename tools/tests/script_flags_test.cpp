@@ -0,0 +1,110 @@
+/**
+ * @file script_flags_test.cpp
+ * @brief Checks that the flag store gameDataLoad() reserves covers the flags
+ * of the scripts, not only those of the dialogues.
+ *
+ * Appends a script setting a flag above every flag of the dialogues of a
+ * .neon file to its bytecode, reserves flags the way gameDataLoad() does and
+ * checks the flag can be set and read back.
+ */
+#include <stdio.h>
+
+#include <mtl/vector.h>
+
+#include "../neon/neon_file.h"
+#include "core/game_flags.h"
+#include "core/script.h"
+
+using namespace NEONengine;
+
+static void coverFlag(ULONG* pulCount, UWORD uwFlagId)
+{
+    if (uwFlagId != GAME_FLAG_NONE && uwFlagId >= *pulCount) *pulCount = uwFlagId + 1;
+}
+
+// As gameDataFlagCount() in game_data.cpp
+static ULONG dialogueFlagCount(neon_file const& file)
+{
+    ULONG ulCount = 0;
+
+    neon_chunk const& pages = file[chunk_id::DIALOGUE_PAGES];
+    for (uint32_t i = 0; i < pages.ulCount; ++i)
+    {
+        DialoguePage const& page = pages.entries<DialoguePage>()[i];
+        coverFlag(&ulCount, page.uwSetFlagIdOnSelection);
+        coverFlag(&ulCount, page.uwClearFlagIdOnSelection);
+        coverFlag(&ulCount, page.uwCheckFlag);
+    }
+
+    neon_chunk const& choices = file[chunk_id::DIALOGUE_CHOICES];
+    for (uint32_t i = 0; i < choices.ulCount; ++i)
+    {
+        DialogueChoice const& choice = choices.entries<DialogueChoice>()[i];
+        coverFlag(&ulCount, choice.uwSetFlagIdOnSelection);
+        coverFlag(&ulCount, choice.uwClearFlagIdOnSelection);
+        coverFlag(&ulCount, choice.uwCheckFlag);
+    }
+    return ulCount;
+}
+
+int main(int argc, char** argv)
+{
+    char const* szPath = argc > 1 ? argv[1] : GUTTER_NEON_PATH;
+
+    mtl::vector<unsigned char> input;
+    neon_file file = {};
+    if (!readFile(szPath, input) || !neonReadV2(input, file))
+    {
+        fprintf(stderr, "Could not read '%s'\n", szPath);
+        return 1;
+    }
+
+    neon_chunk const& bytecode = file[chunk_id::BYTECODE];
+    mtl::vector<UWORD> code;
+    for (uint32_t i = 0; i < bytecode.ulCount; ++i)
+    {
+        code.push_back(bytecode.entries<UWORD>()[i]);
+    }
+
+    ULONG ulDialogueFlags = dialogueFlagCount(file);
+    UWORD uwScriptFlag    = ulDialogueFlags + 10;
+    UWORD const script[]  = {
+        static_cast<UWORD>(ScriptOp::SET), SCRIPT_STORE_FLAGS, uwScriptFlag,
+        static_cast<UWORD>(ScriptOp::PUSH_FLAG), GAME_FLAG_NONE,
+        static_cast<UWORD>(ScriptOp::END),
+    };
+    for (UWORD uwWord : script) { code.push_back(uwWord); }
+
+    ULONG ulScriptFlags = 0;
+    if (!scriptLoad(code.data(), code.size(), &ulScriptFlags))
+    {
+        fprintf(stderr, "Could not load the scripts of '%s'\n", szPath);
+        return 1;
+    }
+    if (ulScriptFlags != uwScriptFlag + 1u)
+    {
+        fprintf(stderr, "Scripts need %u flags, expected %u\n", ulScriptFlags, uwScriptFlag + 1);
+        return 1;
+    }
+
+    ULONG ulFlagCount = ulDialogueFlags > ulScriptFlags ? ulDialogueFlags : ulScriptFlags;
+    if (!gameFlagsReserve(ulFlagCount))
+    {
+        fprintf(stderr, "Could not reserve %u flags\n", ulFlagCount);
+        return 1;
+    }
+
+    gameFlagSet(uwScriptFlag);
+    if (!gameFlagIsSet(uwScriptFlag))
+    {
+        fprintf(stderr, "Script flag %u above the %u dialogue flags was dropped\n",
+                uwScriptFlag,
+                ulDialogueFlags);
+        return 1;
+    }
+
+    printf("%s: %u dialogue flags, %u with the scripts\n", szPath, ulDialogueFlags, ulFlagCount);
+    gameFlagsDestroy();
+    scriptUnload();
+    return 0;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file text_justify_test.cpp
+ * @brief Checks where text_justify_line() starts lines, including lines
+ * wider than the space they are justified in, which start at the left.
+ */
+#include <stdio.h>
+
+#include "core/text_layout.h"
+
+using namespace NEONengine;
+
+static int s_failures;
+
+static void expect(uint16_t lineWidth, uint16_t maxWidth, text_justify justification, uint16_t x)
+{
+    uint16_t got = text_justify_line(lineWidth, maxWidth, justification);
+    if (got != x)
+    {
+        fprintf(stderr,
+                "Line %u wide in %u, justified %d: starts at %u, expected %u\n",
+                lineWidth,
+                maxWidth,
+                static_cast<int>(justification),
+                got,
+                x);
+        ++s_failures;
+    }
+}
+
+int main()
+{
+    expect(40, 100, text_justify::LEFT, 0);
+    expect(40, 100, text_justify::RIGHT, 60);
+    expect(40, 100, text_justify::CENTER, 30);
+
+    expect(100, 100, text_justify::RIGHT, 0);
+    expect(100, 100, text_justify::CENTER, 0);
+
+    // Wider than the region, e.g. a word longer than a line
+    expect(130, 100, text_justify::LEFT, 0);
+    expect(130, 100, text_justify::RIGHT, 0);
+    expect(130, 100, text_justify::CENTER, 0);
+    expect(40, 0, text_justify::CENTER, 0);
+
+    if (s_failures) return 1;
+
+    printf("text_justify_line: all lines start inside their region\n");
+    return 0;
+}
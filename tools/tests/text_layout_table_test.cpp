@@ -0,0 +1,338 @@
+/**
+ * @file text_layout_table_test.cpp
+ * @brief Checks that the lines noirpack --layout writes are the lines the
+ * renderer would find, looked up with text_layout_table::find().
+ *
+ *   text_layout_table_test --fixture font.fnt strings.noir
+ *   text_layout_table_test font.fnt game.neon strings.noir laid_out.noir
+ *
+ * The first writes a font and a version 2 string table with a text for
+ * every text region of gutter.neon, for noirpack to lay out. The second
+ * loads the layouts noirpack wrote like the engine does, and checks the
+ * lines of every text region against text_break_line() and
+ * text_justify_line().
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <mtl/vector.h>
+
+#include "../neon/neon_file.h"
+#include "core/text_layout.h"
+#include "core/text_layout_table.h"
+
+using namespace NEONengine;
+
+static uint32_t const FIXTURE_CHARS   = 128;
+static uint32_t const FIXTURE_STRINGS = 946;  // Past the highest text id of gutter.neon
+static uint32_t const GROUP_SIZE      = 64;   // Must match STRING_GROUP_SIZE in string_table.h
+
+static char const* const s_szWords[] = {
+    "the", "gutter", "rain", "neon", "sign", "flickers", "over", "a",
+    "wet", "street", "and", "nobody", "looks", "up", "Icarus", "Sisyphus",
+};
+static uint32_t const WORD_COUNT = sizeof(s_szWords) / sizeof(s_szWords[0]);
+
+static int s_failures;
+
+static void writeWord(mtl::vector<unsigned char>& out, uint32_t value)
+{
+    out.push_back((value >> 8) & 0xFF);
+    out.push_back(value & 0xFF);
+}
+
+static uint32_t readWord(unsigned char const* pData)
+{
+    return (pData[0] << 8) | pData[1];
+}
+
+static void appendHost(mtl::vector<unsigned char>& out, void const* pValue, size_t size)
+{
+    auto const* pBytes = static_cast<unsigned char const*>(pValue);
+    for (size_t i = 0; i < size; ++i) { out.push_back(pBytes[i]); }
+}
+
+/**
+ * @brief Glyphs 2 to 6 pixels wide, for lines to break at different places
+ * in every region.
+ */
+static uint16_t fixtureGlyphWidth(uint32_t c)
+{
+    return c == ' ' ? 3 : 2 + (c * 7) % 5;
+}
+
+/**
+ * @brief Words picked from the id, with a word too long for any region and
+ * new lines in some, so every way a line can break is laid out.
+ */
+static void fixtureText(uint32_t id, mtl::vector<unsigned char>& text)
+{
+    uint32_t seed      = id * 2654435761u + 1;
+    uint32_t wordCount = id % 24;
+    for (uint32_t i = 0; i < wordCount; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        if (i) text.push_back((seed >> 28) == 0 ? '\n' : ' ');
+
+        char const* szWord = s_szWords[(seed >> 16) % WORD_COUNT];
+        if (id % 3 == 0 && i == wordCount / 2) szWord = "Aaaaaaaaaaaaaaaaaaaaaaaaaaaah";
+        while (*szWord) { text.push_back(*szWord++); }
+    }
+}
+
+static bool writeFixture(char const* szFont, char const* szStrings)
+{
+    mtl::vector<unsigned char> font;
+    uint32_t ulOffset = 0;
+    writeWord(font, 0);
+    writeWord(font, 8);
+    font.push_back(FIXTURE_CHARS);
+    for (uint32_t c = 0; c < FIXTURE_CHARS; ++c)
+    {
+        writeWord(font, ulOffset);
+        ulOffset += fixtureGlyphWidth(c);
+    }
+    font[0] = (ulOffset >> 8) & 0xFF;
+    font[1] = ulOffset & 0xFF;
+
+    mtl::vector<unsigned char> strings;
+    mtl::vector<unsigned char> text;
+    for (uint32_t id = 0; id < FIXTURE_STRINGS; ++id)
+    {
+        text.clear();
+        fixtureText(id, text);
+        writeLong(strings, text.size());
+        for (unsigned char c : text) { strings.push_back(c); }
+    }
+
+    mtl::vector<unsigned char> noir;
+    appendHost(noir, "NOIR", 4);
+    writeWord(noir, 2);
+    writeWord(noir, 0);
+    appendHost(noir, "STRG", 4);
+    writeLong(noir, FIXTURE_STRINGS);
+    writeLong(noir, strings.size());
+    for (unsigned char byte : strings) { noir.push_back(byte); }
+
+    return writeFile(szFont, font) && writeFile(szStrings, noir);
+}
+
+/**
+ * @brief Widths of the glyphs of a font, read like noirpack does.
+ */
+static bool readGlyphWidths(char const* szFont, uint16_t* pGlyphWidths)
+{
+    mtl::vector<unsigned char> font;
+    if (!readFile(szFont, font) || font.size() < 5u + font[4] * 2) return false;
+
+    for (uint32_t c = 0; c < 256; ++c)
+    {
+        pGlyphWidths[c] = c + 1 < font[4] ? readWord(font.data() + 7 + c * 2)
+                                                - readWord(font.data() + 5 + c * 2)
+                                          : 0;
+    }
+    return true;
+}
+
+/**
+ * @brief Where each string of a version 2 table starts, its length first.
+ */
+static bool readStrings(char const* szStrings,
+                        mtl::vector<unsigned char>& noir,
+                        mtl::vector<uint32_t>& offsets)
+{
+    if (!readFile(szStrings, noir) || noir.size() < 20) return false;
+
+    uint32_t ulOffset = 20;
+    for (uint32_t i = 0; i < readLong(noir.data() + 12); ++i)
+    {
+        if (ulOffset + 4 > noir.size()) return false;
+
+        offsets.push_back(ulOffset);
+        ulOffset += 4 + readLong(noir.data() + ulOffset);
+    }
+    return ulOffset <= noir.size();
+}
+
+/**
+ * @brief The layouts after the strings of a version 3 table, in host byte
+ * order, as the engine reads them on the Amiga.
+ */
+static bool readLayouts(char const* szLaidOut, mtl::vector<unsigned char>& layouts)
+{
+    mtl::vector<unsigned char> noir;
+    if (!readFile(szLaidOut, noir) || noir.size() < 24 || readWord(noir.data() + 22) != 0)
+    {
+        fprintf(stderr, "'%s' is not an uncompressed version 3 .noir file\n", szLaidOut);
+        return false;
+    }
+
+    // As indexSize() in noirpack
+    uint32_t ulCount       = readLong(noir.data() + 12);
+    uint32_t ulOffsetBytes = readWord(noir.data() + 20);
+    uint32_t ulBases       = ulOffsetBytes == 2 ? (ulCount + GROUP_SIZE - 1) / GROUP_SIZE * 4 : 0;
+    uint32_t ulLayouts     = 24 + ((ulBases + ulCount * ulOffsetBytes + 3) & ~3u)
+                         + readLong(noir.data() + 16);
+    if (ulLayouts + 12 > noir.size() || memcmp(noir.data() + ulLayouts, "LAYT", 4) != 0)
+    {
+        fprintf(stderr, "'%s' has no layouts after its strings\n", szLaidOut);
+        return false;
+    }
+
+    unsigned char const* pChunk = noir.data() + ulLayouts;
+    uint32_t header[3]          = { readLong(pChunk), readLong(pChunk + 4), readLong(pChunk + 8) };
+    if (ulLayouts + 12 + header[1] * 8 + header[2] * 6 > noir.size())
+    {
+        fprintf(stderr, "'%s' ends before its %u lines\n", szLaidOut, header[2]);
+        return false;
+    }
+    appendHost(layouts, header, sizeof(header));
+
+    unsigned char const* pEntry = pChunk + 12;
+    for (uint32_t i = 0; i < header[1]; ++i, pEntry += 8)
+    {
+        uint16_t words[2] = { (uint16_t)readWord(pEntry), (uint16_t)readWord(pEntry + 2) };
+        uint16_t firstLine = readWord(pEntry + 6);
+        appendHost(layouts, words, sizeof(words));
+        appendHost(layouts, pEntry + 4, 2);
+        appendHost(layouts, &firstLine, sizeof(firstLine));
+    }
+
+    unsigned char const* pLine = pEntry;
+    for (uint32_t i = 0; i < header[2] * 3; ++i, pLine += 2)
+    {
+        uint16_t value = readWord(pLine);
+        appendHost(layouts, &value, sizeof(value));
+    }
+    return true;
+}
+
+/**
+ * @brief The lines of a text as text_renderer::create_text() lays it out.
+ */
+static void checkRegion(TextRegion const& region,
+                        text_layout const& layout,
+                        bstr_view const& text,
+                        uint16_t const* pGlyphWidths)
+{
+    auto justification = (text_justify)region.ubJustify;
+    uint32_t ulStart   = 0;
+    uint32_t ulLine    = 0;
+    text_line line{};
+    while (text_break_line(text, &ulStart, region.uwWidth, pGlyphWidths, &line))
+    {
+        uint16_t width = text_line_width(text, line, pGlyphWidths);
+        uint16_t x     = text_justify_line(width, region.uwWidth, justification);
+        if (ulLine >= layout.lineCount || layout.pLines[ulLine].start != line.start
+            || layout.pLines[ulLine].end != line.end || layout.pLines[ulLine].x != x)
+        {
+            fprintf(stderr,
+                    "Text %u in %u justified %u: line %u is not %u-%u at %u\n",
+                    region.uwTextId,
+                    region.uwWidth,
+                    region.ubJustify,
+                    ulLine,
+                    line.start,
+                    line.end,
+                    x);
+            ++s_failures;
+            return;
+        }
+        ++ulLine;
+    }
+
+    if (ulLine != layout.lineCount)
+    {
+        fprintf(stderr,
+                "Text %u in %u: %u lines laid out, %u expected\n",
+                region.uwTextId,
+                region.uwWidth,
+                layout.lineCount,
+                ulLine);
+        ++s_failures;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc == 4 && strcmp(argv[1], "--fixture") == 0)
+    {
+        if (writeFixture(argv[2], argv[3])) return 0;
+
+        fprintf(stderr, "Could not write the fixture\n");
+        return 1;
+    }
+    if (argc != 5)
+    {
+        fprintf(stderr, "Usage: %s font.fnt game.neon strings.noir laid_out.noir\n", argv[0]);
+        return 1;
+    }
+
+    uint16_t glyphWidths[256];
+    mtl::vector<unsigned char> input, noir, layouts;
+    mtl::vector<uint32_t> offsets;
+    neon_file game = {};
+    if (!readGlyphWidths(argv[1], glyphWidths) || !readFile(argv[2], input)
+        || !neonReadV2(input, game) || !readStrings(argv[3], noir, offsets)
+        || !readLayouts(argv[4], layouts))
+    {
+        fprintf(stderr, "Could not read the font, game, strings or layouts\n");
+        return 1;
+    }
+
+    // Through a file, as create_from_fd() reads them
+    char szHostPath[512];
+    snprintf(szHostPath, sizeof(szHostPath), "%s.host", argv[4]);
+    tFile* pFile = fileOpen(szHostPath, "wb");
+    if (!pFile || fileWrite(pFile, layouts.data(), layouts.size()) != layouts.size())
+    {
+        fprintf(stderr, "Could not write '%s'\n", szHostPath);
+        return 1;
+    }
+    fileClose(pFile);
+
+    pFile       = fileOpen(szHostPath, "rb");
+    auto result = text_layout_table::create_from_fd(pFile);
+    fileClose(pFile);
+    if (!result)
+    {
+        fprintf(stderr, "Could not load the layouts: %d\n", static_cast<int>(result.error()));
+        return 1;
+    }
+    auto pLayouts = mtl::move(result.value());
+
+    uint32_t ulLines            = 0;
+    neon_chunk const& chunk     = game[chunk_id::TEXT_REGIONS];
+    TextRegion const* pRegions  = chunk.entries<TextRegion>();
+    for (uint32_t i = 0; i < chunk.ulCount; ++i)
+    {
+        TextRegion const& region = pRegions[i];
+        if (region.uwTextId >= offsets.size()) continue;
+
+        auto layout = pLayouts->find(
+            region.uwTextId, region.uwWidth, (text_justify)region.ubJustify);
+        checkRegion(region,
+                    layout,
+                    bstr_view::from_bstr(noir.data() + offsets[region.uwTextId]),
+                    glyphWidths);
+        ulLines += layout.lineCount;
+
+        if (pLayouts->find(region.uwTextId, region.uwWidth + 1, text_justify::LEFT).lineCount)
+        {
+            fprintf(stderr, "Text %u found in a region it was not laid out for\n", region.uwTextId);
+            ++s_failures;
+        }
+    }
+
+    if (!ulLines)
+    {
+        fprintf(stderr, "No text region of '%s' was laid out\n", argv[2]);
+        return 1;
+    }
+    if (s_failures) return 1;
+
+    printf("text_layout_table: %u text regions found in %u lines, as the renderer lays them out\n",
+           chunk.ulCount,
+           ulLines);
+    return 0;
+}